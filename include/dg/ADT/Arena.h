@@ -0,0 +1,116 @@
+#ifndef DG_ADT_ARENA_H_
+#define DG_ADT_ARENA_H_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace dg {
+namespace ADT {
+
+///
+// Bump-pointer allocator. The memory is allocated in big chunks
+// and it is released only all at once when the arena is destroyed.
+// The arena does not call destructors of the created objects,
+// use ArenaPtr (or call the destructor manually) for objects
+// that own some resources.
+class Arena {
+    enum : size_t { ChunkSize = 64 * 1024 };
+
+    std::vector<std::unique_ptr<char[]>> _chunks;
+    char *_cur{nullptr};
+    char *_end{nullptr};
+    size_t _allocated{0};
+
+    void *allocateSlow(size_t size, size_t align) {
+        // objects that do not fit into a chunk get their own chunk
+        size_t chunkSize = ChunkSize;
+        if (size + align > chunkSize)
+            chunkSize = size + align;
+        _chunks.emplace_back(new char[chunkSize]);
+        _cur = _chunks.back().get();
+        _end = _cur + chunkSize;
+
+        void *mem = alignCurrent(align);
+        assert(mem && "The chunk is too small");
+        _cur = static_cast<char *>(mem) + size;
+        return mem;
+    }
+
+    void *alignCurrent(size_t align) {
+        auto addr = reinterpret_cast<uintptr_t>(_cur);
+        auto aligned = (addr + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+        return aligned <= reinterpret_cast<uintptr_t>(_end) ?
+                    reinterpret_cast<void *>(aligned) : nullptr;
+    }
+
+public:
+    Arena() = default;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    Arena(Arena&& rhs)
+    : _chunks(std::move(rhs._chunks)), _cur(rhs._cur),
+      _end(rhs._end), _allocated(rhs._allocated) {
+        rhs._cur = rhs._end = nullptr;
+        rhs._allocated = 0;
+    }
+
+    Arena& operator=(Arena&& rhs) {
+        _chunks = std::move(rhs._chunks);
+        _cur = rhs._cur;
+        _end = rhs._end;
+        _allocated = rhs._allocated;
+        rhs._cur = rhs._end = nullptr;
+        rhs._allocated = 0;
+        return *this;
+    }
+
+    void *allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+        assert(align > 0 && (align & (align - 1)) == 0
+               && "Alignment must be a power of two");
+        _allocated += size;
+
+        if (_cur) {
+            if (void *mem = alignCurrent(align)) {
+                if (static_cast<size_t>(_end - static_cast<char *>(mem)) >= size) {
+                    _cur = static_cast<char *>(mem) + size;
+                    return mem;
+                }
+            }
+        }
+
+        return allocateSlow(size, align);
+    }
+
+    template <typename T, typename... Args>
+    T *create(Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // the number of bytes requested by the users of the arena
+    size_t getAllocatedBytes() const { return _allocated; }
+    size_t getChunksNum() const { return _chunks.size(); }
+};
+
+///
+// Deleter for std::unique_ptr to objects created in an arena:
+// it only calls the destructor, the memory is released with the arena.
+template <typename T>
+struct ArenaDeleter {
+    void operator()(T *ptr) const { ptr->~T(); }
+};
+
+// owning pointer to an object from an arena. The arena must outlive
+// the pointer (i.e., it should be declared before the pointer)
+template <typename T>
+using ArenaPtr = std::unique_ptr<T, ArenaDeleter<T>>;
+
+} // namespace ADT
+} // namespace dg
+
+#endif // DG_ADT_ARENA_H_
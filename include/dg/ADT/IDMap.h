@@ -0,0 +1,65 @@
+#ifndef DG_ADT_ID_MAP_H_
+#define DG_ADT_ID_MAP_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace dg {
+namespace ADT {
+
+///
+// Mapping of dense numeric IDs (e.g., IDs of nodes) to values,
+// stored in a vector indexed by the ID. Use it to attach data
+// to nodes of a graph instead of allocating the data separately
+// and storing a pointer into the node.
+// IDs without a value are mapped to a default-constructed value.
+template <typename ValueT>
+class IDMap {
+    std::vector<ValueT> _values;
+
+public:
+    using value_type = ValueT;
+    using iterator = typename std::vector<ValueT>::iterator;
+    using const_iterator = typename std::vector<ValueT>::const_iterator;
+
+    IDMap() = default;
+    explicit IDMap(size_t size) : _values(size) {}
+
+    // get the value for the ID, the map grows if needed
+    ValueT& operator[](size_t id) {
+        if (id >= _values.size())
+            _values.resize(id + 1);
+        return _values[id];
+    }
+
+    // get the value or nullptr if the ID is out of the map
+    ValueT *get(size_t id) {
+        return id < _values.size() ? &_values[id] : nullptr;
+    }
+
+    const ValueT *get(size_t id) const {
+        return id < _values.size() ? &_values[id] : nullptr;
+    }
+
+    // get the value for the ID or a default-constructed value
+    // (e.g., nullptr for maps to pointers) if the ID is out of the map
+    ValueT lookup(size_t id) const {
+        return id < _values.size() ? _values[id] : ValueT();
+    }
+
+    void reserve(size_t size) { _values.reserve(size); }
+    void resize(size_t size) { _values.resize(size); }
+    void clear() { _values.clear(); }
+    size_t size() const { return _values.size(); }
+    bool empty() const { return _values.empty(); }
+
+    iterator begin() { return _values.begin(); }
+    iterator end() { return _values.end(); }
+    const_iterator begin() const { return _values.begin(); }
+    const_iterator end() const { return _values.end(); }
+};
+
+} // namespace ADT
+} // namespace dg
+
+#endif // DG_ADT_ID_MAP_H_
@@ -1,7 +1,11 @@
 #ifndef DG_GENERIC_CALLGRAPH_H_
 #define DG_GENERIC_CALLGRAPH_H_
 
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
 #include <map>
+#include <unordered_set>
 #include <vector>
 
 namespace dg {
@@ -10,43 +14,29 @@ template <typename ValueT>
 class GenericCallGraph {
 public:
     class FuncNode {
+        friend class GenericCallGraph;
+
         unsigned _id;
         unsigned _scc_id{0};
         std::vector<FuncNode *> _calls;
         std::vector<FuncNode *> _callers;
-
-        template <typename Cont>
-        bool _contains(const FuncNode *x, const Cont& C) const {
-            for (auto s : C) {
-                if (s == x)
-                    return true;
-            }
-            return false;
-        }
+        const GenericCallGraph *_graph;
 
     public:
         const ValueT value;
 
-        FuncNode(unsigned id, const ValueT& nd) : _id(id), value(nd) {};
+        FuncNode(unsigned id, const ValueT& nd, const GenericCallGraph *graph)
+        : _id(id), _graph(graph), value(nd) {};
         FuncNode(FuncNode&&) = default;
 
-        bool calls(const FuncNode *x) const { return _contains(x, _calls); }
-        bool isCalledBy(FuncNode *x) const { return _contains(x, _callers); }
+        bool calls(const FuncNode *x) const { return _graph->calls(this, x); }
+        bool isCalledBy(const FuncNode *x) const { return _graph->calls(x, this); }
 
         unsigned getID() const { return _id; }
+        // the id of the SCC of the node, valid after computeSCCs()
         unsigned getSCCId() const { return _scc_id; }
         void setSCCId(unsigned id) { _scc_id = id; }
 
-
-        bool addCall(FuncNode *x) {
-            if (calls(x))
-                return false;
-            _calls.push_back(x);
-            if (!x->isCalledBy(this))
-                x->_callers.push_back(this);
-            return true;
-        }
-
         const std::vector<FuncNode *>& getCalls() const { return _calls; }
         // alias for getCalls()
         const std::vector<FuncNode *>& successors() const { return getCalls(); }
@@ -55,21 +45,71 @@ public:
         const ValueT& getValue() const { return value; };
     };
 
+    ///
+    // Strongly connected component of the call graph,
+    // i.e., a node of the condensed (acyclic) call graph
+    class SCCNode {
+        friend class GenericCallGraph;
+
+        std::vector<FuncNode *> _nodes;
+        // the ids of the SCCs called from this SCC and of the callers
+        std::vector<unsigned> _calls;
+        std::vector<unsigned> _callers;
+        bool _recursive{false};
+
+    public:
+        const std::vector<FuncNode *>& getNodes() const { return _nodes; }
+        const std::vector<unsigned>& getCalls() const { return _calls; }
+        const std::vector<unsigned>& getCallers() const { return _callers; }
+        // does the SCC contain a cycle (a recursion)?
+        bool isRecursive() const { return _recursive; }
+    };
+
 private:
     unsigned last_id{0};
 
     FuncNode *getOrCreate(const ValueT& v) {
         auto it = _mapping.find(v);
         if (it == _mapping.end()) {
-            auto newIt = _mapping.emplace(v, FuncNode(++last_id, v));
+            auto newIt = _mapping.emplace(v, FuncNode(++last_id, v, this));
+            _nodes.push_back(&newIt.first->second);
+            _sccsValid = false;
             return &newIt.first->second;
         }
         return &it->second;
     }
 
+    static uint64_t _edgeKey(const FuncNode *a, const FuncNode *b) {
+        return (static_cast<uint64_t>(a->getID()) << 32) | b->getID();
+    }
+
     std::map<const ValueT, FuncNode> _mapping;
+    // nodes in the order of creation (nodes[id - 1] has the id 'id')
+    std::vector<FuncNode *> _nodes;
+    // the edges (caller id, callee id) for fast checking of duplicates
+    std::unordered_set<uint64_t> _edges;
+
+    // SCCs in the reverse topological order (callees first)
+    std::vector<SCCNode> _sccs;
+    bool _sccsValid{false};
+
+    void _computeSCCs();
 
 public:
+    GenericCallGraph() = default;
+    GenericCallGraph(const GenericCallGraph&) = delete;
+    GenericCallGraph& operator=(const GenericCallGraph&) = delete;
+
+    // the nodes stay in place (std::map does not move its elements),
+    // only their pointer to the graph must be updated
+    GenericCallGraph(GenericCallGraph&& rhs)
+    : last_id(rhs.last_id), _mapping(std::move(rhs._mapping)),
+      _nodes(std::move(rhs._nodes)), _edges(std::move(rhs._edges)),
+      _sccs(std::move(rhs._sccs)), _sccsValid(rhs._sccsValid) {
+        for (auto& it : _mapping)
+            it.second._graph = this;
+        rhs._sccsValid = false;
+    }
 
     // just create a node for the value
     // (e.g., the entry node)
@@ -81,7 +121,29 @@ public:
     bool addCall(const ValueT& a, const ValueT& b) {
         auto A = getOrCreate(a);
         auto B = getOrCreate(b);
-        return A->addCall(B);
+        if (!_edges.insert(_edgeKey(A, B)).second)
+            return false;
+
+        A->_calls.push_back(B);
+        B->_callers.push_back(A);
+        _sccsValid = false;
+        return true;
+    }
+
+    bool calls(const FuncNode *a, const FuncNode *b) const {
+        return _edges.count(_edgeKey(a, b)) > 0;
+    }
+
+    ///
+    // Get the strongly connected components of the call graph
+    // (computed on demand, again after the graph has changed).
+    // The SCCs are in a reverse topological order, i.e., every SCC
+    // comes after all SCCs that it calls, and the index of an SCC
+    // in the vector is the SCC id of its nodes.
+    const std::vector<SCCNode>& getSCCs() {
+        if (!_sccsValid)
+            _computeSCCs();
+        return _sccs;
     }
 
     const FuncNode *get(const ValueT& v) const {
@@ -101,6 +163,7 @@ public:
     }
 
     bool empty() const { return _mapping.empty(); }
+    size_t size() const { return _mapping.size(); }
 
     auto begin() -> decltype(_mapping.begin()) { return _mapping.begin(); }
     auto end() -> decltype(_mapping.end()) { return _mapping.end(); }
@@ -108,6 +171,101 @@ public:
     auto end() const -> decltype(_mapping.end()) { return _mapping.end(); }
 };
 
+///
+// Tarjan's algorithm without recursion (the call chains may be long).
+// Every SCC is finished after all SCCs reachable from it, so the SCCs
+// are created in the reverse topological order.
+template <typename ValueT>
+void GenericCallGraph<ValueT>::_computeSCCs() {
+    const unsigned nodesNum = _nodes.size();
+    // indices and lowpoints are indexed by the node ids (starting from 1),
+    // the index 0 means unvisited
+    std::vector<unsigned> index(nodesNum + 1, 0);
+    std::vector<unsigned> lowpt(nodesNum + 1, 0);
+    std::vector<bool> onStack(nodesNum + 1, false);
+    std::vector<FuncNode *> stack;
+    // DFS stack: the node and the position in its successors
+    std::vector<std::pair<FuncNode *, unsigned>> dfs;
+    unsigned lastIndex = 0;
+
+    _sccs.clear();
+
+    for (FuncNode *root : _nodes) {
+        if (index[root->getID()] != 0)
+            continue;
+
+        dfs.emplace_back(root, 0);
+        index[root->getID()] = lowpt[root->getID()] = ++lastIndex;
+        stack.push_back(root);
+        onStack[root->getID()] = true;
+
+        while (!dfs.empty()) {
+            FuncNode *node = dfs.back().first;
+            unsigned& pos = dfs.back().second;
+            const unsigned id = node->getID();
+
+            if (pos < node->_calls.size()) {
+                FuncNode *succ = node->_calls[pos++];
+                const unsigned sid = succ->getID();
+                if (index[sid] == 0) {
+                    index[sid] = lowpt[sid] = ++lastIndex;
+                    stack.push_back(succ);
+                    onStack[sid] = true;
+                    dfs.emplace_back(succ, 0);
+                } else if (onStack[sid]) {
+                    lowpt[id] = std::min(lowpt[id], index[sid]);
+                }
+                continue;
+            }
+
+            // all successors are processed
+            dfs.pop_back();
+            if (!dfs.empty()) {
+                const unsigned pid = dfs.back().first->getID();
+                lowpt[pid] = std::min(lowpt[pid], lowpt[id]);
+            }
+
+            if (lowpt[id] != index[id])
+                continue;
+
+            const unsigned sccId = _sccs.size();
+            _sccs.emplace_back();
+            auto& scc = _sccs.back();
+            FuncNode *w;
+            do {
+                w = stack.back();
+                stack.pop_back();
+                onStack[w->getID()] = false;
+                w->setSCCId(sccId);
+                scc._nodes.push_back(w);
+            } while (w != node);
+        }
+    }
+
+    // the edges of the condensed graph
+    std::unordered_set<uint64_t> edges;
+    for (unsigned sccId = 0; sccId < _sccs.size(); ++sccId) {
+        auto& scc = _sccs[sccId];
+        scc._recursive = scc._nodes.size() > 1;
+        for (FuncNode *node : scc._nodes) {
+            for (FuncNode *succ : node->_calls) {
+                const unsigned succId = succ->getSCCId();
+                if (succId == sccId) {
+                    scc._recursive = true;
+                    continue;
+                }
+                assert(succId < sccId && "SCCs are not in a topological order");
+                if (edges.insert((static_cast<uint64_t>(sccId) << 32) | succId).second) {
+                    scc._calls.push_back(succId);
+                    _sccs[succId]._callers.push_back(sccId);
+                }
+            }
+        }
+    }
+
+    _sccsValid = true;
+}
+
 } // namespace dg
 
 #endif
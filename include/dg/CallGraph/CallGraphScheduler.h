@@ -0,0 +1,118 @@
+#ifndef DG_CALLGRAPH_SCHEDULER_H_
+#define DG_CALLGRAPH_SCHEDULER_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "dg/CallGraph/CallGraph.h"
+
+namespace dg {
+
+///
+// Run a callback on every SCC of a call graph once the SCCs that
+// it depends on are done. In the bottom-up order, an SCC depends on
+// the SCCs that it calls (so the callees are processed before
+// the callers, e.g., to compute summaries of functions), in the top-down
+// order, an SCC depends on the SCCs that call it (e.g., to propagate
+// the calling contexts). SCCs that do not depend on each other
+// may be processed in parallel by several threads.
+//
+// The callback gets the SCC (GenericCallGraph::SCCNode) and must not
+// change the call graph. With one thread, the SCCs are processed
+// in a fixed order given by their ids.
+template <typename ValueT>
+class CallGraphScheduler {
+    using SCCNode = typename GenericCallGraph<ValueT>::SCCNode;
+
+    const std::vector<SCCNode>& _sccs;
+    unsigned _threads;
+
+    template <typename Fun>
+    void _runParallel(Fun& fun, bool bottomUp) {
+        const size_t sccsNum = _sccs.size();
+        // the number of unfinished SCCs that the SCC depends on
+        std::vector<size_t> pending(sccsNum);
+        std::vector<unsigned> ready;
+        for (unsigned i = 0; i < sccsNum; ++i) {
+            const auto& scc = _sccs[i];
+            pending[i] = bottomUp ? scc.getCalls().size() : scc.getCallers().size();
+            if (pending[i] == 0)
+                ready.push_back(i);
+        }
+
+        std::mutex mtx;
+        std::condition_variable cv;
+        size_t finished = 0;
+
+        auto worker = [&]() {
+            std::unique_lock<std::mutex> lock(mtx);
+            while (true) {
+                cv.wait(lock, [&]() { return !ready.empty() || finished == sccsNum; });
+                if (ready.empty())
+                    return;
+
+                unsigned cur = ready.back();
+                ready.pop_back();
+
+                lock.unlock();
+                fun(_sccs[cur]);
+                lock.lock();
+
+                const auto& scc = _sccs[cur];
+                for (unsigned dep : bottomUp ? scc.getCallers() : scc.getCalls()) {
+                    if (--pending[dep] == 0)
+                        ready.push_back(dep);
+                }
+
+                if (++finished == sccsNum || ready.size() > 1)
+                    cv.notify_all();
+                else if (!ready.empty())
+                    cv.notify_one();
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < _threads; ++t)
+            pool.emplace_back(worker);
+        worker();
+        for (auto& thread : pool)
+            thread.join();
+    }
+
+public:
+    // 'threads' = 0 means the number of hardware threads
+    CallGraphScheduler(GenericCallGraph<ValueT>& CG, unsigned threads = 1)
+    : _sccs(CG.getSCCs()), _threads(threads) {
+        if (_threads == 0)
+            _threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // process callees before callers
+    template <typename Fun>
+    void bottomUp(Fun fun) {
+        if (_threads > 1 && _sccs.size() > 1) {
+            _runParallel(fun, true);
+            return;
+        }
+        // the SCCs are in the reverse topological order
+        for (const auto& scc : _sccs)
+            fun(scc);
+    }
+
+    // process callers before callees
+    template <typename Fun>
+    void topDown(Fun fun) {
+        if (_threads > 1 && _sccs.size() > 1) {
+            _runParallel(fun, false);
+            return;
+        }
+        for (auto it = _sccs.rbegin(), et = _sccs.rend(); it != et; ++it)
+            fun(*it);
+    }
+};
+
+} // namespace dg
+
+#endif // DG_CALLGRAPH_SCHEDULER_H_
@@ -1,7 +1,10 @@
 #ifndef DG_DATA_DEPENDENCE_ANALYSIS_OPTIONS_H_
 #define DG_DATA_DEPENDENCE_ANALYSIS_OPTIONS_H_
 
+#include <cassert>
+#include <iosfwd>
 #include <map>
+#include <string>
 
 #include "dg/Offset.h"
 #include "dg/AnalysisOptions.h"
@@ -81,6 +84,9 @@ struct FunctionModel {
         return defines(i) || uses(i);
     }
 
+    const std::map<unsigned, Operand>& getDefines() const { return _defines; }
+    const std::map<unsigned, Operand>& getUses() const { return _uses; }
+
 private:
     std::map<unsigned, Operand> _defines;
     std::map<unsigned, Operand> _uses;
@@ -139,6 +145,23 @@ struct DataDependenceAnalysisOptions : AnalysisOptions {
             M.name = name;
         M.addUse(def);
     }
+
+    ///
+    // Read models of functions (a model library) from the stream.
+    // Every line of the input is one of:
+    //
+    //   alloc NAME TYPE                   # TYPE is malloc, calloc, alloca,
+    //                                     # realloc, malloc0 or calloc0
+    //   def NAME OPERAND OFFSET LEN       # the function writes the memory
+    //                                     # pointed to by the operand
+    //   use NAME OPERAND OFFSET LEN       # the function reads the memory
+    //
+    // OFFSET and LEN are a number, 'unknown' or 'opN' for the value
+    // of the N-th argument (see functionModelAddDef), '#' starts a comment.
+    // The models from the input replace the models of the same functions
+    // that are already defined. Returns false and sets 'error'
+    // if the input is malformed, the options are not changed then.
+    bool readFunctionModels(std::istream& in, std::string& error);
 };
 
 } // namespace dg
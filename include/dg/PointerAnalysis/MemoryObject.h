@@ -1,9 +1,12 @@
 #ifndef DG_MEMORY_OBJECT_H_
 #define DG_MEMORY_OBJECT_H_
 
+#include <algorithm>
 #include <map>
 #include <unordered_map>
 #include <set>
+#include <utility>
+#include <vector>
 #include <cassert>
 
 #ifndef NDEBUG
@@ -16,39 +19,223 @@
 namespace dg {
 namespace pta {
 
+///
+// Pointers stored in a memory object. The pointers are kept in a flat
+// array of (offset, points-to set) pairs sorted by the offsets
+// (objects have usually only a few fields with pointers). The union
+// of all the points-to sets is cached, so that a load from an unknown
+// offset does not need to go over all the fields.
+//
+// An object with too many fields can be summarized (see summarize()):
+// the pointers at the offset 'off' are then stored at 'off % stride',
+// so all elements of an array share the points-to sets of their fields.
 struct MemoryObject
 {
-    using PointsToMapT = std::map<Offset, PointsToSetT>;
+    using FieldT = std::pair<Offset, PointsToSetT>;
+    using PointsToMapT = std::vector<FieldT>;
 
     MemoryObject(/*uint64_t s = 0, bool isheap = false, */PSNode *n = nullptr)
         : node(n) /*, is_heap(isheap), size(s)*/ {}
 
     // where was this memory allocated? for debugging
     PSNode *node;
+
+private:
     // possible pointers stored in this memory object
-    PointsToMapT pointsTo;
+    PointsToMapT _fields;
+    // if not 0, the object is summarized with this stride
+    Offset::type _stride{0};
+    // the union of the points-to sets of all fields,
+    // valid only if _unionValid is true
+    PointsToSetT _union;
+    bool _unionValid{true};
+
+    struct OffsetLess {
+        bool operator()(const FieldT& f, const Offset& off) const {
+            return f.first < off;
+        }
+    };
+
+    PointsToMapT::iterator lowerBound(const Offset off) {
+        return std::lower_bound(_fields.begin(), _fields.end(), off, OffsetLess());
+    }
+
+    PointsToMapT::const_iterator lowerBound(const Offset off) const {
+        return std::lower_bound(_fields.begin(), _fields.end(), off, OffsetLess());
+    }
+
+    PointsToSetT& getOrCreate(const Offset off) {
+        auto it = lowerBound(off);
+        if (it == _fields.end() || it->first != off)
+            it = _fields.emplace(it, off, PointsToSetT());
+        return it->second;
+    }
 
-    PointsToSetT& getPointsTo(const Offset off) { return pointsTo[off]; }
+    // the set S was changed by adding pointers. Adding a pointer
+    // with unknown offset removes the pointers with the same target
+    // from S, so the union must be then computed again.
+    void updateUnion(const PointsToSetT& S, bool removesPointers) {
+        if (removesPointers)
+            _unionValid = false;
+        else if (_unionValid)
+            _union.add(S);
+    }
 
-    PointsToMapT::iterator find(const Offset off) {
-        return pointsTo.find(off);
+    static Offset::type gcd(Offset::type a, Offset::type b) {
+        while (b != 0) {
+            Offset::type t = a % b;
+            a = b;
+            b = t;
+        }
+        return a;
+    }
+
+public:
+    // the offset under which the pointers at 'off' are stored
+    Offset mapOffset(const Offset off) const {
+        if (_stride == 0 || off.isUnknown())
+            return off;
+        return Offset(*off % _stride);
+    }
+
+    bool isSummarized() const { return _stride != 0; }
+    Offset::type getStride() const { return _stride; }
+
+    // the points-to set at the offset (created if it does not exist).
+    // The caller may modify the set, so the cached union is dropped.
+    PointsToSetT& getPointsTo(const Offset off) {
+        _unionValid = false;
+        return getOrCreate(mapOffset(off));
     }
 
     PointsToMapT::const_iterator find(const Offset off) const {
-        return pointsTo.find(off);
+        const Offset mapped = mapOffset(off);
+        auto it = lowerBound(mapped);
+        if (it != _fields.end() && it->first == mapped)
+            return it;
+        return _fields.end();
     }
 
-    PointsToMapT::iterator begin() { return pointsTo.begin(); }
-    PointsToMapT::iterator end() { return pointsTo.end(); }
-    PointsToMapT::const_iterator begin() const { return pointsTo.begin(); }
-    PointsToMapT::const_iterator end() const { return pointsTo.end(); }
+    bool has(const Offset off) const { return find(off) != _fields.end(); }
+
+    // the fields are modifiable through the non-const iterators,
+    // so the cached union is dropped
+    PointsToMapT::iterator begin() { _unionValid = false; return _fields.begin(); }
+    PointsToMapT::iterator end() { return _fields.end(); }
+    PointsToMapT::const_iterator begin() const { return _fields.begin(); }
+    PointsToMapT::const_iterator end() const { return _fields.end(); }
+
+    const PointsToMapT& fields() const { return _fields; }
+    size_t size() const { return _fields.size(); }
+    bool empty() const { return _fields.empty(); }
+
+    // the number of fields at known offsets
+    size_t getFieldsNum() const {
+        if (!_fields.empty() && _fields.back().first.isUnknown())
+            return _fields.size() - 1;
+        return _fields.size();
+    }
+
+    void clear() {
+        _fields.clear();
+        _stride = 0;
+        _union.clear();
+        _unionValid = true;
+    }
+
+    // the union of the points-to sets of all fields
+    // (i.e., what may be read from an unknown offset)
+    const PointsToSetT& getPointsToUnion() {
+        if (!_unionValid) {
+            _union.clear();
+            for (const auto& it : _fields)
+                _union.add(it.second);
+            _unionValid = true;
+        }
+        return _union;
+    }
+
+    ///
+    // Store the pointers at the offset 'off' to 'off % stride'.
+    // If the object is already summarized, the new stride
+    // is the gcd of the strides.
+    void summarize(Offset::type stride) {
+        assert(stride > 0 && "Invalid stride");
+        if (_stride != 0)
+            stride = gcd(_stride, stride);
+        if (stride == _stride)
+            return;
+        _stride = stride;
+
+        PointsToMapT fields;
+        fields.swap(_fields);
+        for (auto& it : fields) {
+            PointsToSetT& S = getOrCreate(mapOffset(it.first));
+            if (S.empty())
+                S = std::move(it.second);
+            else
+                S.add(it.second);
+        }
+        // the union did not change
+    }
+
+    // summarize this object the same way as 'rhs' is summarized
+    // (before merging the fields of 'rhs' into this object)
+    void summarizeAs(const MemoryObject& rhs) {
+        if (rhs.isSummarized())
+            summarize(rhs.getStride());
+    }
+
+    ///
+    // Find a stride for summarizing the object: the smallest
+    // period of the offsets of the fields, that is, the smallest
+    // multiple p of the gcd of the offsets such that every field
+    // at the offset 'off' has a field also at 'off + p'
+    // (unless 'off + p' is behind the last field). If there is
+    // no such period, the result is the gcd of the offsets.
+    Offset::type computeStride() const {
+        std::vector<Offset::type> offsets;
+        offsets.reserve(_fields.size());
+        for (const auto& it : _fields) {
+            if (!it.first.isUnknown())
+                offsets.push_back(*it.first);
+        }
+
+        if (offsets.size() < 2)
+            return 1;
+
+        Offset::type g = 0;
+        for (auto off : offsets)
+            g = gcd(off - offsets[0], g);
+        if (g == 0)
+            return 1;
+
+        const Offset::type last = offsets.back();
+        for (Offset::type p = g; p <= (last - offsets[0]) / 2; p += g) {
+            bool periodic = true;
+            for (auto off : offsets) {
+                if (off + p > last)
+                    break;
+                if (!std::binary_search(offsets.begin(), offsets.end(), off + p)) {
+                    periodic = false;
+                    break;
+                }
+            }
+            if (periodic)
+                return p;
+        }
+
+        return g;
+    }
 
     bool merge(const MemoryObject& rhs) {
+        summarizeAs(rhs);
+
         bool changed = false;
-        for (auto& rit : rhs.pointsTo) {
+        for (auto& rit : rhs._fields) {
             if (rit.second.empty())
                 continue;
-            changed |= pointsTo[rit.first].add(rit.second);
+            changed |= addPointsTo(rit.first, rit.second);
         }
 
         return changed;
@@ -59,14 +246,21 @@ struct MemoryObject
         assert(ptr.target != nullptr
                && "Cannot have NULL target, use unknown instead");
 
-        return pointsTo[off].add(ptr);
+        PointsToSetT& S = getOrCreate(mapOffset(off));
+        bool changed = S.add(ptr);
+        if (changed)
+            updateUnion(S, ptr.offset.isUnknown());
+        return changed;
     }
 
     bool addPointsTo(const Offset& off, const PointsToSetT& pointers)
     {
         if (pointers.empty())
             return false;
-        return pointsTo[off].add(pointers);
+        bool changed = getOrCreate(mapOffset(off)).add(pointers);
+        if (changed && _unionValid)
+            _union.add(pointers);
+        return changed;
     }
 
     bool addPointsTo(const Offset& off,
@@ -74,18 +268,28 @@ struct MemoryObject
     {
         if (pointers.size() == 0)
             return false;
-        return pointsTo[off].add(pointers);
+        PointsToSetT& S = getOrCreate(mapOffset(off));
+        bool changed = S.add(pointers);
+        if (changed) {
+            bool unknown = false;
+            for (const auto& ptr : pointers)
+                unknown |= ptr.offset.isUnknown();
+            updateUnion(S, unknown);
+        }
+        return changed;
     }
 
 #ifndef NDEBUG
     void dump() const {
         std::cout << "MO [" << this << "] for ";
-        node->dump(); 
+        node->dump();
     }
 
     void dumpv() const {
         dump();
-        for (const auto& it : pointsTo) {
+        if (_stride != 0)
+            std::cout << "summarized with stride " << _stride << "\n";
+        for (const auto& it : _fields) {
             std::cout << "[";
             it.first.dump();
             std::cout << "]";
@@ -397,6 +397,8 @@ class PSNodeAlloc : public PSNode {
     bool is_global = false;
     // is it a temporary value? (its address cannot be taken)
     bool is_temporary = false;
+    // the size of elements if the memory is an array (0 if unknown)
+    uint64_t element_size = 0;
 
 public:
     PSNodeAlloc(unsigned id, bool isTemp = false)
@@ -422,6 +424,9 @@ public:
 
     void setIsTemporary() { is_temporary = true; }
     bool isTemporary() const { return is_temporary; }
+
+    void setElementSize(uint64_t s) { element_size = s; }
+    uint64_t getElementSize() const { return element_size; }
 };
 
 #if 0
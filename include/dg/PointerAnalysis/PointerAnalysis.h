@@ -2,6 +2,8 @@
 #define DG_POINTER_ANALYSIS_H_
 
 #include <cassert>
+#include <cstdint>
+#include <unordered_set>
 #include <vector>
 
 #include "dg/PointerAnalysis/Pointer.h"
@@ -9,6 +11,7 @@
 #include "dg/PointerAnalysis/PointerGraph.h"
 #include "dg/PointerAnalysis/PointerAnalysisOptions.h"
 #include "dg/ADT/Queue.h"
+#include "dg/ADT/IDMap.h"
 
 namespace dg {
 namespace pta {
@@ -36,6 +39,44 @@ protected:
 
     const PointerAnalysisOptions options{};
 
+    // should queue_changed() use the worklist of dependent nodes?
+    // (set in initialize_queue())
+    bool _worklist{false};
+    // the nodes that are in to_process (indexed by the ID of the node)
+    std::vector<bool> _queued;
+    // the nodes reachable from the entry or from the nodes that changed
+    // the graph. Only these and the nodes from the same subgraphs
+    // (indexed by the ID of the subgraph) are processed,
+    // so that we do not process dead procedures.
+    std::vector<bool> _reachable;
+    std::vector<bool> _liveSubgraphs;
+    // the nodes that read the memory of the given allocation
+    // (indexed by the ID of the allocation)
+    std::vector<std::vector<PSNode *>> _readers;
+    // (allocation ID << 32 | reader ID) pairs that are in _readers
+    std::unordered_set<uint64_t> _readersSet;
+
+    // statistics of the worklist
+    size_t _maxProcessed{0};
+    size_t _bfsFallbacks{0};
+
+    // demand-driven solving (see initializeDemand()):
+    // STORE and MEMCPY nodes that write to the given allocation
+    // (indexed by the ID of the allocation) -- the allocation is known
+    // without solving the graph (the pointer is a GEP or CAST of the allocation)
+    ADT::IDMap<std::vector<PSNode *>> _writers;
+    // the STORE and MEMCPY nodes that are not in _writers and were not
+    // added to the demanded nodes yet
+    std::vector<PSNode *> _indirectWriters;
+    // the allocations whose writers were added to the demanded nodes
+    std::vector<bool> _writersAdded;
+
+    // can the analysis use the worklist of dependent nodes?
+    // The processing of a node must depend only on its operands
+    // and on the memory read by the node via getMemoryObjects()
+    // (not on the state of the predecessors in the CFG).
+    virtual bool supportsWorklist() const { return false; }
+
 public:
 
     PointerAnalysis(PointerGraph *ps,
@@ -93,6 +134,10 @@ public:
         assert(root && "Do not have root of PG");
         // rely on C++11 move semantics
         to_process = PG->getNodes(root);
+
+        _worklist = options.worklist && supportsWorklist();
+        if (_worklist)
+            initialize_worklist();
     }
 
     void queue_globals() {
@@ -118,10 +163,23 @@ public:
         return !changed.empty();
     }
 
+    // Queue the nodes that must be processed again because
+    // of the nodes changed in the last iteration. With the worklist,
+    // only the nodes that depend on the changed nodes are queued
+    // (see queue_dependent()), otherwise we queue all the nodes
+    // reachable from the changed nodes.
     void queue_changed() {
         unsigned last_processed_num = to_process.size();
+        if (last_processed_num > _maxProcessed)
+            _maxProcessed = last_processed_num;
         to_process.clear();
 
+        if (_worklist) {
+            queue_dependent();
+            changed.clear();
+            return;
+        }
+
         if (!changed.empty()) {
             // DONT std::move - it prevents compiler from copy ellision
             to_process = PG->getNodes(changed /* starting set */,
@@ -136,8 +194,35 @@ public:
         }
     }
 
+    void queue_dependent();
+
     bool run();
 
+    ///
+    // Demand-driven solving: call initializeDemand() instead of run()
+    // and then solveDemand() for the nodes whose points-to sets are needed.
+    // Only the nodes that the points-to set of the node depends on are
+    // processed, i.e., its operands (transitively) and the STORE and MEMCPY
+    // nodes that may write to the memory read by the processed nodes.
+    // The processed nodes are solved to the fixpoint and stay solved,
+    // so the next queries reuse them.
+    //
+    // It is supported only by the analyses that support the worklist
+    // and for graphs that can not change during the analysis
+    // (i.e., without calls via function pointers and threads).
+    // Returns false if the demand-driven solving is not supported,
+    // run() must be used then.
+    bool initializeDemand();
+
+    // Solve the points-to set of the node. Returns false if it would need
+    // to process more than 'budget' new nodes (0 means no limit).
+    // The points-to sets are then incomplete and run() must be used.
+    bool solveDemand(PSNode *node, size_t budget = 0);
+
+    bool isDemandSolved(const PSNode *node) const {
+        return node->getID() < _reachable.size() && _reachable[node->getID()];
+    }
+
     // generic error
     // @msg - message for the user
     // XXX: maybe create some enum that will represent the error
@@ -184,6 +269,61 @@ private:
     // check the sanity of results of pointer analysis
     void sanityCheck();
 
+    bool isLive(const PointerSubgraph *subg) const {
+        return subg && subg->getID() < _liveSubgraphs.size() &&
+               _liveSubgraphs[subg->getID()];
+    }
+
+    bool isReachable(PSNode *n) const {
+        auto id = n->getID();
+        if (id >= _reachable.size())
+            return false;
+        return _reachable[id] || isLive(n->getParent());
+    }
+
+    void setReachable(PSNode *n);
+    void initialize_worklist();
+
+    void queueNode(PSNode *n) {
+        if (!isReachable(n) || _queued[n->getID()])
+            return;
+        _queued[n->getID()] = true;
+        to_process.push_back(n);
+    }
+
+    void queueReaders(PSNode *node, PSNode *pointer);
+
+    void addReader(MemoryObject *mo, PSNode *reader) {
+        if (!_worklist)
+            return;
+        auto id = mo->node->getID();
+        if (!_readersSet.insert((uint64_t(id) << 32) | reader->getID()).second)
+            return;
+        if (id >= _readers.size())
+            _readers.resize(id + 1);
+        _readers[id].push_back(reader);
+    }
+
+    // summarize the object if it has too many fields
+    // (see PointerAnalysisOptions::maxObjectFields)
+    void summarizeObject(MemoryObject *mo) {
+        if (options.maxObjectFields == 0 ||
+            mo->getFieldsNum() <= options.maxObjectFields)
+            return;
+
+        // prefer the size of elements of arrays,
+        // guess the stride from the offsets otherwise
+        auto *alloc = PSNodeAlloc::get(mo->node);
+        Offset::type elemSize = alloc ? alloc->getElementSize() : 0;
+
+        auto stride = mo->getStride();
+        mo->summarize(elemSize > 0 ? elemSize : mo->computeStride());
+        // the stride did not help, make the object field-insensitive
+        if (mo->getStride() == stride ||
+            mo->getFieldsNum() > options.maxObjectFields)
+            mo->summarize(1);
+    }
+
     bool processNode(PSNode *);
     bool processLoad(PSNode *node);
     bool processGep(PSNode *node);
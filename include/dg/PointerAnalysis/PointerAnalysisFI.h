@@ -5,6 +5,8 @@
 #include <vector>
 #include <memory>
 
+#include "dg/ADT/Arena.h"
+#include "dg/ADT/IDMap.h"
 #include "PointerAnalysis.h"
 
 namespace dg {
@@ -15,7 +17,11 @@ namespace pta {
 //
 class PointerAnalysisFI : public PointerAnalysis
 {
-    std::vector<std::unique_ptr<MemoryObject>> memory_objects;
+    // memory objects of allocations indexed by the ID of the allocation.
+    // The objects are allocated in the arena (declared first,
+    // so that it outlives the objects)
+    ADT::Arena _arena;
+    ADT::IDMap<ADT::ArenaPtr<MemoryObject>> _memoryObjects;
 
     void preprocessGEPs()
     {
@@ -36,13 +42,24 @@ class PointerAnalysisFI : public PointerAnalysis
         }
     }
 
+protected:
+    // the memory objects do not depend on the CFG
+    bool supportsWorklist() const override { return true; }
+
 public:
 
     PointerAnalysisFI(PointerGraph *ps) : PointerAnalysisFI(ps, {}) {}
 
     PointerAnalysisFI(PointerGraph *ps, const PointerAnalysisOptions& opts)
     : PointerAnalysis(ps, opts) {
-        memory_objects.reserve(std::max(ps->size() / 100, static_cast<size_t>(8)));
+        _memoryObjects.reserve(ps->size());
+    }
+
+    // get the memory object of the allocation (nullptr if there
+    // is no memory object for the node)
+    MemoryObject *getMemoryObject(const PSNode *n) const {
+        auto *mo = _memoryObjects.get(n->getID());
+        return mo ? mo->get() : nullptr;
     }
 
     void preprocess() override {
@@ -71,14 +88,11 @@ public:
         assert(n->getType() == PSNodeType::ALLOC
                || n->getType() == PSNodeType::UNKNOWN_MEM);
 
-        MemoryObject *mo = n->getData<MemoryObject>();
-        if (!mo) {
-            mo = new MemoryObject(n);
-            memory_objects.emplace_back(mo);
-            n->setData<MemoryObject>(mo);
-        }
+        auto& mo = _memoryObjects[n->getID()];
+        if (!mo)
+            mo.reset(_arena.create<MemoryObject>(n));
 
-        objects.push_back(mo);
+        objects.push_back(mo.get());
     }
 };
 
@@ -4,6 +4,7 @@
 #include <cassert>
 #include <memory>
 
+#include "dg/ADT/IDMap.h"
 #include "MemoryObject.h"
 #include "PointerGraph.h"
 
@@ -28,14 +29,21 @@ public:
         assert(opts.preprocessGeps == false
                && "Preprocessing GEPs does not work correctly for FS analysis");
         memoryMaps.reserve(ps->size() / 5);
+        _nodesMemoryMaps.reserve(ps->size());
         ps->computeLoops();
     }
 
     PointerAnalysisFS(PointerGraph *ps) : PointerAnalysisFS(ps, {}) {}
 
+    // get the memory map of the node (nullptr if the node
+    // has not been processed yet)
+    MemoryMapT *getMemoryMap(const PSNode *n) const {
+        return _nodesMemoryMaps.lookup(n->getID());
+    }
+
     bool beforeProcessed(PSNode *n) override
     {
-        MemoryMapT *mm = n->getData<MemoryMapT>();
+        MemoryMapT *mm = getMemoryMap(n);
         if (mm)
             return false;
 
@@ -54,7 +62,7 @@ public:
             // so just add a pointer from the predecessor
             // to this map
             PSNode *pred = n->getSinglePredecessor();
-            mm = pred->getData<MemoryMapT>();
+            mm = getMemoryMap(pred);
             assert(mm && "No memory map in the predecessor");
         }
 
@@ -62,7 +70,7 @@ public:
 
         // memory map initialized, set it as data,
         // so that we won't initialize it again
-        n->setData<MemoryMapT>(mm);
+        setMemoryMap(n, mm);
 
         return true;
     }
@@ -72,7 +80,7 @@ public:
         bool changed = false;
         PointsToSetT *overwritten = nullptr;
 
-        MemoryMapT *mm = n->getData<MemoryMapT>();
+        MemoryMapT *mm = getMemoryMap(n);
         // we must have the memory map, we created it
         // in the beforeProcessed method
         assert(mm && "Do not have memory map");
@@ -91,7 +99,7 @@ public:
         // change, so we don't have to do that)
         if (needsMerge(n)) {
             for (PSNode *p : n->predecessors()) {
-                if (MemoryMapT *pm = p->getData<MemoryMapT>()) {
+                if (MemoryMapT *pm = getMemoryMap(p)) {
                     // merge pm to mm (but only if pm was already created)
                     changed |= mergeMaps(mm, pm, overwritten);
                 }
@@ -100,7 +108,7 @@ public:
             // interprocedural stuff - merge information from calls
             if (auto CR = PSNodeCallRet::get(n)) {
                 for (auto p : CR->getReturns()) {
-                    if (MemoryMapT *pm = p->getData<MemoryMapT>()) {
+                    if (MemoryMapT *pm = getMemoryMap(p)) {
                         // merge pm to mm (but only if pm was already created)
                         changed |= mergeMaps(mm, pm, overwritten);
                     }
@@ -108,7 +116,7 @@ public:
             }
             if (auto E = PSNodeEntry::get(n)) {
                 for (auto p : E->getCallers()) {
-                    if (MemoryMapT *pm = p->getData<MemoryMapT>()) {
+                    if (MemoryMapT *pm = getMemoryMap(p)) {
                         // merge pm to mm (but only if pm was already created)
                         changed |= mergeMaps(mm, pm, overwritten);
                     }
@@ -127,7 +135,7 @@ public:
     void getMemoryObjects(PSNode *where, const Pointer& pointer,
                           std::vector<MemoryObject *>& objects) override
     {
-        MemoryMapT *mm = where->getData<MemoryMapT>();
+        MemoryMapT *mm = getMemoryMap(where);
         assert(mm && "Node does not have memory map");
 
         auto I = mm->find(pointer.target);
@@ -177,12 +185,18 @@ protected:
                              PointsToSetT *overwritten) {
         bool changed = false;
 
-        for (auto& fromIt : from->pointsTo) {
+        // the fields of a summarized object stand for more offsets,
+        // so these cannot be overwritten
+        to->summarizeAs(*from);
+        if (to->isSummarized())
+            overwritten = nullptr;
+
+        for (auto& fromIt : from->fields()) {
             if (overwritten &&
                 overwritten->count(Pointer(node, fromIt.first)))
                 continue;
 
-            auto& S = to->pointsTo[fromIt.first];
+            auto& S = to->getPointsTo(fromIt.first);
             for (const auto& ptr : fromIt.second)
                 changed |= S.add(ptr);
         }
@@ -242,16 +256,23 @@ protected:
 
     void mergeGlobalsState(MemoryMapT *mm, decltype(PG->getGlobals())& globals) {
         for (auto& glob : globals) {
-            if (MemoryMapT *globmm = glob->getData<MemoryMapT>()) {
+            if (MemoryMapT *globmm = getMemoryMap(glob.get())) {
                 mergeMaps(mm, globmm, nullptr);
             }
         }
     }
 
+    void setMemoryMap(const PSNode *n, MemoryMapT *mm) {
+        _nodesMemoryMaps[n->getID()] = mm;
+    }
+
 private:
 
     // keep all the maps in order to free the memory
     std::vector<std::unique_ptr<MemoryMapT>> memoryMaps;
+    // the memory maps of nodes indexed by the ID of the node
+    // (a map is shared by the nodes that can not change it)
+    ADT::IDMap<MemoryMapT *> _nodesMemoryMaps;
 };
 
 } // namespace pta
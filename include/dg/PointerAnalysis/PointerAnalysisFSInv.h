@@ -43,7 +43,7 @@ public:
     // NOTE: we must override this method as it is using our "needsMerge"
     bool beforeProcessed(PSNode *n) override
     {
-        MemoryMapT *mm = n->getData<MemoryMapT>();
+        MemoryMapT *mm = getMemoryMap(n);
         if (mm)
             return false;
 
@@ -62,7 +62,7 @@ public:
             // so just add a pointer from the predecessor
             // to this map
             PSNode *pred = n->getSinglePredecessor();
-            mm = pred->getData<MemoryMapT>();
+            mm = getMemoryMap(pred);
             assert(mm && "No memory map in the predecessor");
         }
 
@@ -70,7 +70,7 @@ public:
 
         // memory map initialized, set it as data,
         // so that we won't initialize it again
-        n->setData<MemoryMapT>(mm);
+        setMemoryMap(n, mm);
 
         return true;
     }
@@ -147,13 +147,13 @@ public:
 
     bool handleInvalidateLocals(PSNode *node, PSNode *pred)
     {
-        MemoryMapT *pmm = pred->getData<MemoryMapT>();
+        MemoryMapT *pmm = getMemoryMap(pred);
         if (!pmm) {
             // predecessor was not processed yet
             return false;
         }
 
-        MemoryMapT *mm = node->getData<MemoryMapT>();
+        MemoryMapT *mm = getMemoryMap(node);
         assert(mm && "Node does not have a memory map");
 
         bool changed = false;
@@ -175,12 +175,13 @@ public:
                 }
             }
 
-            for (auto& it : *pmo) {
-                PointsToSetT& predS = it.second;
+            mo->summarizeAs(*pmo);
+            for (auto& it : pmo->fields()) {
+                const PointsToSetT& predS = it.second;
                 if (predS.empty())
                     continue;
 
-                PointsToSetT& S = mo->pointsTo[it.first];
+                PointsToSetT& S = mo->getPointsTo(it.first);
 
                 // merge pointers from the previous states
                 // but do not include the pointers
@@ -287,28 +288,28 @@ public:
         // is being used for freeing the memory,
         // we can set it to invalidated
         auto mo = getOrCreateMO(mm, target);
-        if (mo->pointsTo.size() == 1) {
-            auto& S = mo->pointsTo[0];
+        if (mo->size() == 1) {
+            auto& S = mo->getPointsTo(0);
             if (S.size() == 1 && (*S.begin()).target == INVALIDATED) {
                 return false; // no update
             }
         }
 
-        mo->pointsTo.clear();
-        mo->pointsTo[0].add(INVALIDATED, 0);
+        mo->clear();
+        mo->addPointsTo(0, Pointer(INVALIDATED, 0));
         return true;
     }
 
     bool invalidateMemory(PSNode *node, PSNode *pred,
                           bool is_free = false)
     {
-        MemoryMapT *pmm = pred->getData<MemoryMapT>();
+        MemoryMapT *pmm = getMemoryMap(pred);
         if (!pmm) {
             // predecessor was not processed yet
             return false;
         }
 
-        MemoryMapT *mm = node->getData<MemoryMapT>();
+        MemoryMapT *mm = getMemoryMap(node);
         assert(mm && "Node does not have memory map");
 
         bool changed = false;
@@ -372,12 +373,13 @@ public:
 
             // merge pointers from pmo to mo, but skip
             // the pointers that may point to the freed memory
-            for (auto& it : *pmo) {
-                PointsToSetT& predS = it.second;
+            mo->summarizeAs(*pmo);
+            for (auto& it : pmo->fields()) {
+                const PointsToSetT& predS = it.second;
                 if (predS.empty()) // keep the map clean
                     continue;
 
-                PointsToSetT& S = mo->pointsTo[it.first];
+                PointsToSetT& S = mo->getPointsTo(it.first);
 
                 // merge pointers from the previous states
                 // but do not include the pointers
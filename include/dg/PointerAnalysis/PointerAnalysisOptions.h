@@ -21,6 +21,24 @@ struct PointerAnalysisOptions : AnalysisOptions {
     PointerAnalysisOptions& setInvalidateNodes(bool b) { invalidateNodes = b; return *this;}
     PointerAnalysisOptions& setPreprocessGeps(bool b)  { preprocessGeps = b; return *this;}
 
+    // After an iteration, queue only the nodes that depend on the changed
+    // nodes (their users and the readers of the changed memory) instead
+    // of all the nodes reachable from the changed nodes. Used only by
+    // the analyses that support it (the flow-insensitive analysis).
+    bool worklist{true};
+
+    PointerAnalysisOptions& setWorklist(bool b) { worklist = b; return *this;}
+
+    // If a memory object has pointers at more than this number
+    // of different offsets (0 = no limit), the object is summarized:
+    // the offsets are taken modulo a stride found from the offsets
+    // (e.g., the size of elements of an array of structures) or,
+    // if that does not help, the object becomes field-insensitive.
+    // Saves time and memory on big arrays for the cost of precision.
+    size_t maxObjectFields{0};
+
+    PointerAnalysisOptions& setMaxObjectFields(size_t n) { maxObjectFields = n; return *this;}
+
     // Perform maximally this number of iterations.
     // If exceeded, the analysis is terminated and points-to sets
     // of the unprocessed nodes are set to {}.
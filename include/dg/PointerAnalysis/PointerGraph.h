@@ -1,6 +1,7 @@
 #ifndef DG_POINTER_GRAPH_H_
 #define DG_POINTER_GRAPH_H_
 
+#include "dg/ADT/Arena.h"
 #include "dg/ADT/Queue.h"
 #include "dg/SubgraphNode.h"
 #include "dg/CallGraph/CallGraph.h"
@@ -126,9 +127,16 @@ class PointerGraph
     // FIXME: this should be PointerSubgraph, not PSNode...
     PointerSubgraph *_entry{nullptr};
 
-    using NodesT = std::vector<std::unique_ptr<PSNode>>;
+public:
+    // the nodes are allocated in the arena of the graph,
+    // the unique_ptrs only call their destructors
+    using NodesT = std::vector<ADT::ArenaPtr<PSNode>>;
+
+private:
     using SubgraphsT = std::vector<std::unique_ptr<PointerSubgraph>>;
 
+    // must be declared before the nodes, so that it outlives them
+    ADT::Arena _arena;
     NodesT nodes;
     SubgraphsT _subgraphs;
 
@@ -149,54 +157,68 @@ class PointerGraph
 
     NodesT _globals;
 
+    // the constructors of nodes are accessible only to the graph,
+    // so we can not use _arena.create()
+    template <typename T, typename... Args>
+    T *_createNode(Args&&... args) {
+        void *mem = _arena.allocate(sizeof(T), alignof(T));
+        return new (mem) T(std::forward<Args>(args)...);
+    }
+
     PSNode *_create(PSNodeType t, va_list args) {
         PSNode *node = nullptr;
 
+        // NOTE: the va_args must be read in separate statements,
+        // the order of evaluation of function arguments is unspecified
         switch (t) {
             case PSNodeType::ALLOC:
-                node = new PSNodeAlloc(getNewNodeId());
+                node = _createNode<PSNodeAlloc>(getNewNodeId());
                 break;
-            case PSNodeType::GEP:
-                node = new PSNodeGep(getNewNodeId(),
-                                     va_arg(args, PSNode *),
-                                     va_arg(args, Offset::type));
+            case PSNodeType::GEP: {
+                PSNode *op = va_arg(args, PSNode *);
+                Offset::type off = va_arg(args, Offset::type);
+                node = _createNode<PSNodeGep>(getNewNodeId(), op, off);
                 break;
-            case PSNodeType::MEMCPY:
-                node = new PSNodeMemcpy(getNewNodeId(),
-                                        va_arg(args, PSNode *),
-                                        va_arg(args, PSNode *),
-                                        va_arg(args, Offset::type));
+            }
+            case PSNodeType::MEMCPY: {
+                PSNode *src = va_arg(args, PSNode *);
+                PSNode *dest = va_arg(args, PSNode *);
+                Offset::type len = va_arg(args, Offset::type);
+                node = _createNode<PSNodeMemcpy>(getNewNodeId(), src, dest, len);
                 break;
-            case PSNodeType::CONSTANT:
-                node = new PSNode(getNewNodeId(), PSNodeType::CONSTANT,
-                                  va_arg(args, PSNode *),
-                                  va_arg(args, Offset::type));
+            }
+            case PSNodeType::CONSTANT: {
+                PSNode *op = va_arg(args, PSNode *);
+                Offset::type off = va_arg(args, Offset::type);
+                node = _createNode<PSNode>(getNewNodeId(), PSNodeType::CONSTANT,
+                                             op, off);
                 break;
+            }
             case PSNodeType::ENTRY:
-                node = new PSNodeEntry(getNewNodeId());
+                node = _createNode<PSNodeEntry>(getNewNodeId());
                 break;
             case PSNodeType::CALL:
-                node = new PSNodeCall(t, getNewNodeId());
+                node = _createNode<PSNodeCall>(t, getNewNodeId());
                 break;
             case PSNodeType::CALL_FUNCPTR:
-                node = new PSNodeCall(t, getNewNodeId());
+                node = _createNode<PSNodeCall>(t, getNewNodeId());
                 node->addOperand(va_arg(args, PSNode *));
                 break;
             case PSNodeType::FORK:
-                node = new PSNodeFork(getNewNodeId());
+                node = _createNode<PSNodeFork>(getNewNodeId());
                 node->addOperand(va_arg(args, PSNode *));
                 break;
             case PSNodeType::JOIN:
-                node = new PSNodeJoin(getNewNodeId());
+                node = _createNode<PSNodeJoin>(getNewNodeId());
                 break;
             case PSNodeType::RETURN:
-                node = new PSNodeRet(getNewNodeId(), args);
+                node = _createNode<PSNodeRet>(getNewNodeId(), args);
                 break;
             case PSNodeType::CALL_RETURN:
-                node = new PSNodeCallRet(getNewNodeId(), args);
+                node = _createNode<PSNodeCallRet>(getNewNodeId(), args);
                 break;
             default:
-                node = new PSNode(getNewNodeId(), t, args);
+                node = _createNode<PSNode>(getNewNodeId(), t, args);
                 break;
         }
 
@@ -301,7 +323,8 @@ public:
         assert(nd->operands.empty() && "This node uses other nodes");
         assert(nodes[nd->getID()].get() == nd && "Inconsistency in nodes");
 
-        // clear the nodes entry
+        // clear the nodes entry (the memory of the node
+        // is released together with the graph)
         nodes[nd->getID()].reset();
     }
 
@@ -105,8 +105,9 @@ public:
     }
 
     bool pointsToTarget(PSNode *target) const {
-        for(const auto& kv : ids) {
-            if(kv.first.target == target && pointers.get(kv.second)) {
+        // the set has at most as many elements as there are ids
+        for (const auto& ptrID : pointers) {
+            if (idVector[ptrID - 1].target == target) {
                 return true;
             }
         }
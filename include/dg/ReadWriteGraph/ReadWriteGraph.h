@@ -1,9 +1,11 @@
 #ifndef DG_READ_WRITE_GRAPH_H_
 #define DG_READ_WRITE_GRAPH_H_
 
+#include <cassert>
 #include <vector>
 #include <memory>
 
+#include "dg/ADT/Arena.h"
 #include "dg/BFS.h"
 #include "dg/ReadWriteGraph/RWNode.h"
 #include "dg/ReadWriteGraph/RWBBlock.h"
@@ -19,9 +21,15 @@ class ReadWriteGraph {
     unsigned int dfsnum{1};
 
     size_t lastNodeID{0};
-    using NodesT = std::vector<std::unique_ptr<RWNode>>;
+    // the nodes are allocated in the arena,
+    // the unique_ptrs only call their destructors
+    using NodesT = std::vector<ADT::ArenaPtr<RWNode>>;
     using SubgraphsT = std::vector<std::unique_ptr<RWSubgraph>>;
 
+    // must be declared before the nodes, so that it outlives them
+    ADT::Arena _arena;
+    // arenas for the nodes created by more threads (see createInPool())
+    std::vector<std::unique_ptr<ADT::Arena>> _pools;
     NodesT _nodes;
     SubgraphsT _subgraphs;
     RWSubgraph *_entry{nullptr};
@@ -71,13 +79,36 @@ public:
 
     RWNode& create(RWNodeType t) {
       if (t == RWNodeType::CALL) {
-        _nodes.emplace_back(new RWNodeCall(++lastNodeID));
+        _nodes.emplace_back(_arena.create<RWNodeCall>(++lastNodeID));
       } else {
-        _nodes.emplace_back(new RWNode(++lastNodeID, t));
+        _nodes.emplace_back(_arena.create<RWNode>(++lastNodeID, t));
       }
       return *_nodes.back().get();
     }
 
+    // Create the pools for building the graph by 'num' threads.
+    // A thread creates nodes only in its pool.
+    void setPoolsNum(unsigned num) {
+        while (_pools.size() < num)
+            _pools.emplace_back(new ADT::Arena());
+    }
+
+    // Create a node in the given pool. The node has no ID and it is not
+    // in the graph until it is added by addNode(), so that the IDs do not
+    // depend on the order in which the threads create the nodes.
+    RWNode& createInPool(unsigned pool, RWNodeType t) {
+        assert(pool < _pools.size() && "Invalid pool");
+        if (t == RWNodeType::CALL)
+            return *_pools[pool]->create<RWNodeCall>(0);
+        return *_pools[pool]->create<RWNode>(0, t);
+    }
+
+    void addNode(RWNode *node) {
+        assert(node->getID() == 0 && "The node is already in the graph");
+        node->setID(++lastNodeID);
+        _nodes.emplace_back(node);
+    }
+
     RWSubgraph& createSubgraph() {
       _subgraphs.emplace_back(new RWSubgraph());
       return *_subgraphs.back().get();
@@ -109,6 +140,7 @@ public:
     subgraphs_range subgraphs() { return subgraphs_range(_subgraphs); }
 
     auto size() const -> decltype(_subgraphs.size()) { return _subgraphs.size(); }
+    auto getNodesNum() const -> decltype(_nodes.size()) { return _nodes.size(); }
 };
 
 } // namespace dda
@@ -23,10 +23,6 @@ class SubgraphNode {
     // id of the node. Every node from a graph has a unique ID;
     unsigned int id = 0;
 
-    // data that can an analysis store in node
-    // for its own needs
-    void *data{nullptr};
-
     // data that can user store in the node
     // NOTE: I considered if this way is better than
     // creating subclass of PSNode and have whatever we
@@ -54,6 +50,9 @@ protected:
     // size of the memory
     size_t size{0};
 
+    // for graphs that assign the IDs after creating the nodes
+    void setID(unsigned int i) { id = i; }
+
 public:
 
     SubgraphNode(unsigned id) : id(id) {}
@@ -72,19 +71,6 @@ public:
     void setSCCId(unsigned id) { scc_id = id; }
     unsigned getSCCId() const { return scc_id; }
 
-    // getters & setters for analysis's data in the node
-    template <typename T>
-    T* getData() { return static_cast<T *>(data); }
-    template <typename T>
-    const T* getData() const { return static_cast<T *>(data); }
-
-    template <typename T>
-    void *setData(T *newdata) {
-        void *old = data;
-        data = static_cast<void *>(newdata);
-        return old;
-    }
-
     // getters & setters for user's data in the node
     template <typename T>
     T* getUserData() { return static_cast<T *>(user_data); }
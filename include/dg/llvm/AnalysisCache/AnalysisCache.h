@@ -0,0 +1,308 @@
+#ifndef DG_LLVM_ANALYSIS_CACHE_H_
+#define DG_LLVM_ANALYSIS_CACHE_H_
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ignore unused parameters in LLVM libraries
+#if (__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-parameter"
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/IR/Module.h>
+
+#if (__clang__)
+#pragma clang diagnostic pop // ignore -Wunused-parameter
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "dg/Offset.h"
+
+namespace dg {
+
+class LLVMPointerAnalysis;
+class LLVMDependenceGraph;
+
+namespace dda { class LLVMDataDependenceAnalysis; }
+
+namespace llvmdg {
+
+struct LLVMDependenceGraphOptions;
+
+///
+// Deterministic numbering of the values of a module
+// (functions, globals, aliases, arguments, basic blocks and instructions).
+// Two modules that print to the same IR get the same numbering,
+// so the numbers can be used to refer to values in a file.
+// The id 0 is reserved for "no value".
+class ModuleValueNumbering {
+    std::vector<const llvm::Value *> _values{nullptr};
+    llvm::DenseMap<const llvm::Value *, uint32_t> _ids;
+    // the ids of the arguments, blocks and instructions
+    // of a function form the range [first, second)
+    llvm::DenseMap<const llvm::Function *,
+                   std::pair<uint32_t, uint32_t>> _functionRanges;
+
+    void _add(const llvm::Value *v) {
+        _ids[v] = static_cast<uint32_t>(_values.size());
+        _values.push_back(v);
+    }
+
+public:
+    ModuleValueNumbering(const llvm::Module *M);
+
+    std::pair<uint32_t, uint32_t> getRange(const llvm::Function *F) const {
+        auto it = _functionRanges.find(F);
+        assert(it != _functionRanges.end());
+        return it->second;
+    }
+
+    uint32_t getId(const llvm::Value *v) const {
+        auto it = _ids.find(v);
+        return it == _ids.end() ? 0 : it->second;
+    }
+
+    llvm::Value *getValue(uint32_t id) const {
+        assert(id < _values.size());
+        return const_cast<llvm::Value *>(_values[id]);
+    }
+
+    // the number of values including the reserved id 0
+    uint32_t size() const { return static_cast<uint32_t>(_values.size()); }
+};
+
+///
+// On-disk cache of the results of pointer analysis,
+// data dependence analysis and control dependence analysis.
+//
+// The cache file is a versioned binary file that is mmap-ed
+// when loaded and queried in place. All the data are stored in
+// arrays indexed by the ids from ModuleValueNumbering
+// (compressed-row layout for the points-to sets and definitions),
+// so that no parsing is needed when loading the file.
+// The file is keyed by the hash of the module and the hash
+// of the analysis options, so a stale cache is never used.
+//
+// The results of an incremental analysis (see IncrementalAnalysis)
+// are stored as derived, so that the next version of the module can be
+// analyzed incrementally from them again. As these results may be less
+// precise than the results computed from scratch, derived caches are
+// re-used for the same module only on request.
+class AnalysisCache {
+public:
+    static const uint32_t VERSION = 3;
+
+    struct Key {
+        uint64_t module{0};
+        uint64_t options{0};
+
+        bool operator==(const Key& rhs) const {
+            return module == rhs.module && options == rhs.options;
+        }
+    };
+
+    // a pointer as stored in the file
+    struct Pointer {
+        uint32_t target;
+        uint32_t _pad{0};
+        uint64_t offset;
+    };
+
+    // a function as stored in the file
+    struct FunctionEntry {
+        uint64_t name;  // hash of the name
+        uint64_t hash;  // see hashFunction()
+        uint32_t id;
+        // the range of ids of arguments, blocks and instructions
+        uint32_t first, last;
+        // are the control dependencies of the function stored?
+        uint32_t hasCD;
+    };
+
+    // a global variable or alias as stored in the file
+    struct GlobalEntry {
+        uint64_t name;  // hash of the name
+        uint32_t id;
+        uint32_t _pad{0};
+    };
+
+    enum ValueFlags : uint8_t {
+        // the PTA has a non-empty points-to set for the value
+        HAS_POINTS_TO  = 1,
+        PTS_UNKNOWN    = 1 << 1,
+        PTS_NULL       = 1 << 2,
+        PTS_INVALIDATED= 1 << 3,
+        // the value is a use in data dependence analysis
+        IS_USE         = 1 << 4,
+    };
+
+    // compute the key of the cache for the given module and options
+    static Key computeKey(const llvm::Module *M,
+                          const LLVMDependenceGraphOptions& opts);
+
+    // the name of the cache file (in 'dir') for the given key
+    static std::string getPath(const std::string& dir, const Key& key);
+
+    // the name of the link to the last cache stored
+    // with the given options (the module part of the key is ignored)
+    static std::string getLatestPath(const std::string& dir, const Key& key);
+
+    static uint64_t hashName(const llvm::StringRef& name);
+
+    ///
+    // Hash of the function that does not depend on the rest of the module
+    // (e.g., on the numbering of metadata), so that an unchanged function
+    // keeps its hash when other functions change. Functions with the same
+    // hash have the same arguments, blocks and instructions in the same order.
+    static uint64_t hashFunction(const llvm::Function& F);
+
+    ///
+    // Load the cache for the given key from the directory 'dir'.
+    // Returns nullptr if there is no valid cache for the key
+    // or if the cache is derived and 'allowDerived' is false.
+    static std::unique_ptr<AnalysisCache> load(const std::string& dir,
+                                               const llvm::Module *M,
+                                               const Key& key,
+                                               bool allowDerived = false);
+
+    ///
+    // Load the last cache stored into 'dir' with the same options as 'key'
+    // for an arbitrary (e.g., previous version of the) module
+    // (the cache may be derived).
+    // Such cache can be queried only by ids (see IncrementalAnalysis).
+    // Returns nullptr if there is no such cache.
+    static std::unique_ptr<AnalysisCache> loadLatest(const std::string& dir,
+                                                     const Key& key);
+
+    ///
+    // Store the results of the analyses into the directory 'dir'.
+    // The control dependencies are taken from the (already built) 'dg',
+    // if it is not nullptr. 'derived' is the number of incremental analyses
+    // that the results went through (0 if they were computed from scratch).
+    static bool store(const std::string& dir,
+                      const llvm::Module *M,
+                      const Key& key,
+                      LLVMPointerAnalysis *PTA,
+                      dda::LLVMDataDependenceAnalysis *DDA,
+                      const LLVMDependenceGraph *dg,
+                      uint32_t derived = 0);
+
+    ~AnalysisCache();
+
+    // the number of incremental analyses that the results went through
+    uint32_t getDerived() const { return _derived; }
+    bool isDerived() const { return _derived > 0; }
+
+    // the numbering is not available for caches from loadLatest()
+    bool hasNumbering() const { return _numbering != nullptr; }
+    const ModuleValueNumbering& getNumbering() const {
+        assert(_numbering && "The cache is not for this module");
+        return *_numbering;
+    }
+
+    bool hasPointsTo(const llvm::Value *val) const {
+        return getFlags(val) & HAS_POINTS_TO;
+    }
+
+    uint8_t getFlags(const llvm::Value *val) const {
+        return getFlags(getNumbering().getId(val));
+    }
+
+    ///
+    // Queries by the ids of values as stored in the file
+    uint32_t getNumValues() const { return _numValues; }
+    uint8_t getFlags(uint32_t id) const { return id == 0 ? 0 : _flags[id]; }
+    void getPointers(uint32_t id,
+                     const Pointer *& first, const Pointer *& last) const {
+        assert(id < _numValues);
+        first = _pts + _ptsIdx[id];
+        last = _pts + _ptsIdx[id + 1];
+    }
+
+    const FunctionEntry *functions_begin() const { return _functions; }
+    const FunctionEntry *functions_end() const { return _functions + _functionsNum; }
+    const GlobalEntry *globals_begin() const { return _globals; }
+    const GlobalEntry *globals_end() const { return _globals + _globalsNum; }
+
+    // the control dependencies as pairs of ids of blocks
+    const uint32_t *cd_edges_begin() const { return _cdEdges; }
+    const uint32_t *cd_edges_end() const { return _cdEdges + 2*_cdEdgesNum; }
+
+    // get the pointers stored for the given value
+    // (the range [first, last) is empty if the value has no pointers)
+    void getPointers(const llvm::Value *val,
+                     const Pointer *& first, const Pointer *& last) const;
+
+    bool hasDataDependencies() const { return _defsIdx != nullptr; }
+
+    bool isUse(const llvm::Value *val) const {
+        return getFlags(val) & IS_USE;
+    }
+
+    // NOTE: this method is inline so that the data dependence analysis
+    // can use it without linking to the library with the cache
+    std::vector<llvm::Value *> getDefinitions(const llvm::Value *use) const {
+        assert(hasDataDependencies());
+
+        std::vector<llvm::Value *> defs;
+        auto id = getNumbering().getId(use);
+        if (id == 0)
+            return defs;
+
+        defs.reserve(_defsIdx[id + 1] - _defsIdx[id]);
+        for (auto i = _defsIdx[id]; i < _defsIdx[id + 1]; ++i)
+            defs.push_back(_numbering->getValue(_defs[i]));
+
+        return defs;
+    }
+
+    bool hasControlDependencies() const { return _hasCD; }
+
+    // add the cached control dependencies between blocks
+    // to the constructed graphs of functions
+    void restoreControlDependencies() const;
+
+private:
+    std::unique_ptr<ModuleValueNumbering> _numbering;
+    uint32_t _numValues{0};
+
+    // the mapped file
+    void *_data{nullptr};
+    size_t _size{0};
+
+    // views into the mapped file
+    const uint8_t *_flags{nullptr};
+    const uint32_t *_ptsIdx{nullptr};
+    const Pointer *_pts{nullptr};
+    const uint32_t *_defsIdx{nullptr};
+    const uint32_t *_defs{nullptr};
+    const uint32_t *_cdEdges{nullptr};
+    uint64_t _cdEdgesNum{0};
+    bool _hasCD{false};
+    uint32_t _derived{0};
+    const FunctionEntry *_functions{nullptr};
+    uint64_t _functionsNum{0};
+    const GlobalEntry *_globals{nullptr};
+    uint64_t _globalsNum{0};
+
+    AnalysisCache(const llvm::Module *M)
+    : _numbering(M ? new ModuleValueNumbering(M) : nullptr) {}
+
+    // map the file, if 'checkModule' is false,
+    // only the options part of the key is checked
+    bool _map(const std::string& path, const Key& key, bool checkModule);
+};
+
+} // namespace llvmdg
+} // namespace dg
+
+#endif // DG_LLVM_ANALYSIS_CACHE_H_
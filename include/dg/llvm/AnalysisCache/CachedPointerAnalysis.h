@@ -0,0 +1,96 @@
+#ifndef DG_LLVM_CACHED_POINTER_ANALYSIS_H_
+#define DG_LLVM_CACHED_POINTER_ANALYSIS_H_
+
+#include "dg/llvm/PointerAnalysis/PointerAnalysis.h"
+#include "dg/llvm/AnalysisCache/AnalysisCache.h"
+
+namespace dg {
+namespace llvmdg {
+
+///
+// Points-to set that iterates directly over the pointers
+// stored in the (mmap-ed) analysis cache
+class CachedLLVMPointsToSet : public LLVMPointsToSetImpl {
+    const AnalysisCache& _cache;
+    const AnalysisCache::Pointer *_first{nullptr};
+    const AnalysisCache::Pointer *_last{nullptr};
+    const AnalysisCache::Pointer *_it{nullptr};
+    uint8_t _flags;
+
+public:
+    CachedLLVMPointsToSet(const AnalysisCache& cache, const llvm::Value *val)
+    : _cache(cache), _flags(cache.getFlags(val)) {
+        if (_flags & AnalysisCache::HAS_POINTS_TO) {
+            cache.getPointers(val, _first, _last);
+        } else {
+            // the same as DGLLVMPointerAnalysis: return {unknown}
+            _flags |= AnalysisCache::PTS_UNKNOWN;
+        }
+        _it = _first;
+    }
+
+    bool hasUnknown() const override { return _flags & AnalysisCache::PTS_UNKNOWN; }
+    bool hasNull() const override { return _flags & AnalysisCache::PTS_NULL; }
+    bool hasInvalidated() const override { return _flags & AnalysisCache::PTS_INVALIDATED; }
+
+    size_t size() const override {
+        return (_last - _first) + hasUnknown() + hasNull() + hasInvalidated();
+    }
+
+    LLVMPointer getKnownSingleton() const override {
+        assert(size() == 1 && _first != _last);
+        return LLVMPointer(_cache.getNumbering().getValue(_first->target),
+                           Offset(_first->offset));
+    }
+
+    int position() const override { return static_cast<int>(_it - _first); }
+    bool end() const override { return _it == _last; }
+    void shift() override { assert(_it != _last); ++_it; }
+
+    LLVMPointer get() const override {
+        assert(_it != _last && "Dereferenced end() iterator");
+        return LLVMPointer(_cache.getNumbering().getValue(_it->target),
+                           Offset(_it->offset));
+    }
+
+    LLVMPointsToSet toLLVMPointsToSet() { return LLVMPointsToSet(this); }
+};
+
+///
+// Pointer analysis that answers the queries from the analysis cache
+// instead of running the analysis
+class CachedLLVMPointerAnalysis : public LLVMPointerAnalysis {
+    const AnalysisCache *_cache;
+
+    LLVMPointsToSet _get(const llvm::Value *val) const {
+        return (new CachedLLVMPointsToSet(*_cache, val))->toLLVMPointsToSet();
+    }
+
+public:
+    CachedLLVMPointerAnalysis(const AnalysisCache *cache,
+                              const LLVMPointerAnalysisOptions& opts)
+    : LLVMPointerAnalysis(opts), _cache(cache) {
+        assert(_cache && "Need the cache");
+    }
+
+    bool hasPointsTo(const llvm::Value *val) override {
+        return _cache->hasPointsTo(val);
+    }
+
+    LLVMPointsToSet getLLVMPointsTo(const llvm::Value *val) override {
+        return _get(val);
+    }
+
+    std::pair<bool, LLVMPointsToSet>
+    getLLVMPointsToChecked(const llvm::Value *val) override {
+        return {_cache->hasPointsTo(val), _get(val)};
+    }
+
+    // the results are already computed
+    bool run() override { return true; }
+};
+
+} // namespace llvmdg
+} // namespace dg
+
+#endif // DG_LLVM_CACHED_POINTER_ANALYSIS_H_
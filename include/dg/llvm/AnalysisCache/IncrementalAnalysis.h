@@ -0,0 +1,91 @@
+#ifndef DG_LLVM_INCREMENTAL_ANALYSIS_H_
+#define DG_LLVM_INCREMENTAL_ANALYSIS_H_
+
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "dg/llvm/AnalysisCache/AnalysisCache.h"
+
+namespace dg {
+
+class DGLLVMPointerAnalysis;
+
+namespace llvmdg {
+
+///
+// Re-use of the results of the analyses of a previous version
+// of the module (stored in an AnalysisCache) for the current module.
+//
+// The functions of the two modules are matched by names and compared
+// by AnalysisCache::hashFunction(). The values of unchanged functions
+// and the globals are then mapped by their position, so the previous
+// results can be transferred to the current module:
+//
+//  - the intraprocedural control dependencies of unchanged functions
+//    are taken over and computed only for the changed functions,
+//  - the points-to sets of unchanged values are used as the initial
+//    state of the (flow-insensitive) pointer analysis. The solver then
+//    re-propagates the changes from the changed functions along the
+//    pointer graph (including the call edges) until the fixpoint.
+//    Any initial state yields a sound result, but pointers that were
+//    removed by the changes may be kept (this happens only if the changes
+//    removed some pointer flow).
+//
+// NOTE: this is not an incremental analysis of the pointer graph or
+// the read-write graph. The pointer analysis is still solved over the
+// whole module (only its initial state comes from the previous results)
+// and the data dependence analysis is re-run in full, because the memory
+// SSA summaries of calls make the RWSubgraphs depend on each other.
+// Only the control dependencies are recomputed per changed function.
+class IncrementalAnalysis {
+    std::unique_ptr<AnalysisCache> _previous;
+    // the values of the current module indexed by
+    // the ids of the previous state (nullptr if not mapped)
+    std::vector<const llvm::Value *> _mapping;
+    std::set<const llvm::Function *> _changed;
+    // unchanged functions that have control dependencies in the previous state
+    std::set<const llvm::Function *> _withCD;
+    unsigned _unchangedNum{0};
+
+    void _mapFunctions(const llvm::Module *M);
+
+public:
+    ///
+    // 'changed' are functions that the user knows that changed,
+    // other changed functions are found automatically.
+    IncrementalAnalysis(std::unique_ptr<AnalysisCache> previous,
+                        const llvm::Module *M,
+                        const std::set<const llvm::Function *>& changed = {});
+
+    const std::set<const llvm::Function *>& getChangedFunctions() const {
+        return _changed;
+    }
+
+    bool isChanged(const llvm::Function *F) const {
+        return _changed.count(F) > 0;
+    }
+
+    unsigned getUnchangedFunctionsNum() const { return _unchangedNum; }
+
+    // the number of incremental analyses that the results
+    // of this analysis went through (including this one)
+    uint32_t getDerived() const { return _previous->getDerived() + 1; }
+
+    ///
+    // Set the points-to sets of the nodes of the (initialized but not yet
+    // run) pointer analysis from the previous state.
+    // Return the number of nodes that got a non-empty points-to set.
+    size_t seedPointsTo(DGLLVMPointerAnalysis *PTA) const;
+
+    ///
+    // Add the control dependencies of unchanged functions to the graph
+    // (the graph must be built). Return the constructed functions
+    // whose control dependencies must be computed.
+    std::set<const llvm::Function *> restoreControlDependencies() const;
+};
+
+} // namespace llvmdg
+} // namespace dg
+
+#endif // DG_LLVM_INCREMENTAL_ANALYSIS_H_
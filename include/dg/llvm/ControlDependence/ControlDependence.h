@@ -26,6 +26,10 @@
 namespace dg {
 //namespace cda {
 
+namespace llvmdg {
+class PostDominance;
+}
+
 class LLVMControlDependenceAnalysis {
 public:
     using ValVec = std::vector<llvm::Value *>;
@@ -33,6 +37,9 @@ public:
 private:
     const llvm::Module *_module;
     const LLVMControlDependenceAnalysisOptions _options;
+    // the post-dominance information of the functions of the module,
+    // shared by everything that computes standard control dependencies
+    std::unique_ptr<llvmdg::PostDominance> _postDominance;
     std::unique_ptr<LLVMControlDependenceAnalysisImpl> _impl{nullptr};
     std::unique_ptr<LLVMControlDependenceAnalysisImpl> _interprocImpl{nullptr};
 
@@ -67,14 +74,13 @@ private:
 
 public:
     LLVMControlDependenceAnalysis(const llvm::Module *module,
-                                  const LLVMControlDependenceAnalysisOptions& opts)
-        : _module(module), _options(opts) {
-        initializeImpl();
-    }
+                                  const LLVMControlDependenceAnalysisOptions& opts);
+    ~LLVMControlDependenceAnalysis();
 
     // public API
     const llvm::Module *getModule() const { return _module; }
     const LLVMControlDependenceAnalysisOptions& getOptions() const { return _options; }
+    llvmdg::PostDominance& getPostDominance() { return *_postDominance; }
 
     LLVMControlDependenceAnalysisImpl *getImpl() { return _impl.get(); }
     const LLVMControlDependenceAnalysisImpl *getImpl() const { return _impl.get(); }
@@ -30,6 +30,9 @@
 #include "dg/llvm/DataDependence/LLVMDataDependenceAnalysisOptions.h"
 
 namespace dg {
+
+namespace llvmdg { class AnalysisCache; }
+
 namespace dda {
 
 class LLVMReadWriteGraphBuilder;
@@ -41,6 +44,9 @@ class LLVMDataDependenceAnalysis
     const LLVMDataDependenceAnalysisOptions _options;
     LLVMReadWriteGraphBuilder *builder{nullptr};
     std::unique_ptr<DataDependenceAnalysis> DDA{nullptr};
+    // if set, the results are taken from the cache
+    // and the analysis is not run at all
+    const llvmdg::AnalysisCache *_cache{nullptr};
 
     LLVMReadWriteGraphBuilder *createBuilder();
     DataDependenceAnalysis *createDDA();
@@ -61,7 +67,14 @@ public:
         DDA.reset(createDDA());
     }
 
+    // answer isUse() and getLLVMDefinitions() from the given cache
+    void setCache(const llvmdg::AnalysisCache *cache) { _cache = cache; }
+    const llvmdg::AnalysisCache *getCache() const { return _cache; }
+
     void run() {
+        if (_cache)
+            return;
+
         if (!DDA) {
             buildGraph();
         }
@@ -77,10 +90,7 @@ public:
     const RWNode *getNode(const llvm::Value *val) const;
     const llvm::Value *getValue(const RWNode *node) const;
 
-    bool isUse(const llvm::Value *val) const {
-        auto nd = getNode(val);
-        return nd && nd->isUse();
-    }
+    bool isUse(const llvm::Value *val) const;
 
     bool isDef(const llvm::Value *val) const {
         auto nd = getNode(val);
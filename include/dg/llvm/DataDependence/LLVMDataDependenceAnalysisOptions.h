@@ -11,6 +11,11 @@ struct LLVMDataDependenceAnalysisOptions :
 {
     bool threads{false};
 
+    // the number of threads that build the functions of the read-write
+    // graph (0 = the number of hardware threads). The graph is the same
+    // for any number of threads.
+    unsigned buildThreads{1};
+
     LLVMDataDependenceAnalysisOptions() {
         // setup models for standard functions
 
@@ -0,0 +1,434 @@
+#ifndef LLVM_DG_EXPORT_H_
+#define LLVM_DG_EXPORT_H_
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ignore unused parameters in LLVM libraries
+#if (__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-parameter"
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/raw_ostream.h>
+
+#if (__clang__)
+#pragma clang diagnostic pop // ignore -Wunused-parameter
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "dg/llvm/LLVMDependenceGraph.h"
+#include "dg/llvm/LLVMNode.h"
+#include "dg/llvm/LLVMSummaryEdges.h"
+#include "dg/util/GraphExport.h"
+
+namespace dg {
+namespace debug {
+
+///
+// Export of the LLVM dependence graph through GraphExportWriter.
+// Unlike LLVMDG2Dot, the exporter does not keep the output in memory,
+// it keeps only the numbering of the exported nodes (the functions
+// and neighbours of the nodes are taken from the graph when needed).
+class LLVMDGExporter {
+public:
+    enum EdgeKind { CFG = 0, DD, USE, CD, ID, CALL, SUMMARY, EDGE_KINDS_NUM };
+
+    struct Options {
+        // export only these functions (all if empty)
+        std::set<std::string> functions;
+        // export only the nodes that are at most 'hops' edges far
+        // from one of these nodes (all nodes if empty).
+        // The direction of the edges does not matter.
+        std::set<LLVMNode *> around;
+        unsigned hops{1};
+        // which edges to export, a bitmask of (1 << EdgeKind)
+        uint32_t edges{(1 << CFG) | (1 << DD) | (1 << USE) | (1 << CD)};
+        // the summary edges (exported only if set and SUMMARY is in 'edges')
+        const LLVMSummaryEdges *summaryEdges{nullptr};
+    };
+
+    LLVMDGExporter(const llvm::Module *M, const Options& opts)
+    : _module(M), _options(opts) {}
+
+    static std::vector<std::string> getKindNames() {
+        return {"cfg", "dd", "use", "cd", "id", "call", "summary"};
+    }
+
+    // returns false if writing failed
+    bool exportGraph(GraphExportWriter& writer) {
+        gatherNodes();
+        if (!_options.around.empty())
+            filterNeighborhood();
+
+        if (_nodes.size() > std::numeric_limits<uint32_t>::max()) {
+            llvm::errs() << "The graph has too many nodes to export\n";
+            return false;
+        }
+
+        writer.begin(_nodes.size());
+        for (size_t r = 0; r < _ranges.size(); ++r) {
+            const std::string fun = getFunctionName(_ranges[r].second);
+            size_t end = r + 1 < _ranges.size() ? _ranges[r + 1].first
+                                                 : _nodes.size();
+            for (size_t i = _ranges[r].first; i < end; ++i)
+                writer.node(static_cast<uint32_t>(i), fun, getLabel(_nodes[i]));
+        }
+
+        for (size_t i = 0; i < _nodes.size(); ++i) {
+            forEachSuccessor(_nodes[i], [&](LLVMNode *succ, EdgeKind kind) {
+                auto it = _ids.find(succ);
+                if (it != _ids.end())
+                    writer.edge(static_cast<uint32_t>(i), it->second, kind);
+            }, /* cfgInBlock = */ false);
+        }
+
+        // the control flow edges inside blocks go between the neighbouring
+        // nodes of the blocks, it is cheaper to get them from the blocks
+        if (exportsEdge(CFG)) {
+            forEachExportedGraph([&](LLVMDependenceGraph *graph) {
+                for (auto& bit : graph->getBlocks())
+                    exportBlockEdges(writer, bit.second);
+            });
+        }
+
+        return writer.finish();
+    }
+
+    size_t getNodesNum() const { return _nodes.size(); }
+
+private:
+    const llvm::Module *_module;
+    const Options _options;
+
+    // the exported nodes in the order of their IDs
+    std::vector<LLVMNode *> _nodes;
+    std::unordered_map<LLVMNode *, uint32_t> _ids;
+    // the nodes of one graph (or the global nodes if the graph
+    // is nullptr) are consecutive in _nodes, these are the indices
+    // where the nodes of the graphs start
+    std::vector<std::pair<size_t, LLVMDependenceGraph *>> _ranges;
+
+    bool exportsEdge(EdgeKind kind) const {
+        if (kind == SUMMARY && !_options.summaryEdges)
+            return false;
+        return _options.edges & (1 << kind);
+    }
+
+    bool isExported(LLVMNode *node) const { return _ids.count(node) > 0; }
+
+    void beginRange(LLVMDependenceGraph *graph) {
+        if (!_ranges.empty() && _ranges.back().first == _nodes.size())
+            _ranges.back().second = graph;
+        else
+            _ranges.emplace_back(_nodes.size(), graph);
+    }
+
+    void addNode(LLVMNode *node) {
+        if (node && _ids.emplace(node, static_cast<uint32_t>(_nodes.size())).second)
+            _nodes.push_back(node);
+    }
+
+    void addParameters(DGParameters<LLVMNode> *params) {
+        if (!params)
+            return;
+
+        for (auto& it : *params) {
+            addNode(it.second.in);
+            addNode(it.second.out);
+        }
+        for (auto it = params->global_begin(), et = params->global_end();
+             it != et; ++it) {
+            addNode(it->second.in);
+            addNode(it->second.out);
+        }
+        if (auto *vararg = params->getVarArg()) {
+            addNode(vararg->in);
+            addNode(vararg->out);
+        }
+        addNode(params->getNoReturn());
+    }
+
+    // call 'fun' for the graphs of the exported functions
+    // (in the order of the functions in the module)
+    template <typename Fun>
+    void forEachExportedGraph(Fun fun) const {
+        const auto& CF = getConstructedFunctions();
+        for (const llvm::Function& F : *_module) {
+            if (!_options.functions.empty() &&
+                _options.functions.count(F.getName().str()) == 0)
+                continue;
+
+            auto it = CF.find(const_cast<llvm::Function *>(&F));
+            if (it != CF.end())
+                fun(it->second);
+        }
+    }
+
+    // gather the nodes of the exported functions (in the order
+    // of the functions and instructions in the module)
+    void gatherNodes() {
+        std::set<const void *> globals;
+
+        forEachExportedGraph([&](LLVMDependenceGraph *graph) {
+            auto *F = llvm::cast<llvm::Function>(graph->getEntry()->getKey());
+            beginRange(graph);
+            addNode(graph->getEntry());
+            addParameters(graph->getParameters());
+
+            for (const llvm::BasicBlock& B : *F) {
+                for (const llvm::Instruction& I : B) {
+                    LLVMNode *node = graph->getNode(const_cast<llvm::Instruction *>(&I));
+                    if (!node)
+                        continue;
+                    addNode(node);
+                    addParameters(node->getParameters());
+                }
+            }
+
+            // the artificial nodes (e.g., the unified exit node)
+            for (auto& nit : *graph)
+                addNode(nit.second);
+            addNode(graph->getExit());
+
+            const auto& gnodes = graph->getGlobalNodes();
+            if (gnodes && globals.insert(gnodes.get()).second) {
+                beginRange(nullptr);
+                for (auto& git : *gnodes)
+                    addNode(git.second);
+            }
+        });
+    }
+
+    // the CFG edges inside the block and from its last node
+    void exportBlockEdges(GraphExportWriter& writer, LLVMBBlock *BB) {
+        auto prev = _ids.end();
+        for (LLVMNode *node : BB->getNodes()) {
+            auto it = _ids.find(node);
+            if (prev != _ids.end() && it != _ids.end())
+                writer.edge(prev->second, it->second, CFG);
+            prev = it;
+        }
+
+        if (prev == _ids.end())
+            return;
+        for (const auto& succ : BB->successors()) {
+            LLVMNode *first = succ.target->getFirstNode();
+            auto it = first ? _ids.find(first) : _ids.end();
+            if (it != _ids.end())
+                writer.edge(prev->second, it->second, CFG);
+        }
+    }
+
+    // the neighbours of the node in its block (nullptr if there is none)
+    static LLVMNode *getNextInBlock(LLVMNode *node) {
+        LLVMBBlock *BB = node->getBBlock();
+        if (!BB || BB->getLastNode() == node)
+            return nullptr;
+        const auto& nodes = BB->getNodes();
+        auto it = std::find(nodes.begin(), nodes.end(), node);
+        return it == nodes.end() ? nullptr : *std::next(it);
+    }
+
+    static LLVMNode *getPrevInBlock(LLVMNode *node) {
+        LLVMBBlock *BB = node->getBBlock();
+        if (!BB || BB->getFirstNode() == node)
+            return nullptr;
+        const auto& nodes = BB->getNodes();
+        auto it = std::find(nodes.begin(), nodes.end(), node);
+        return it == nodes.end() ? nullptr : *std::prev(it);
+    }
+
+    // 'cfgInBlock' is false if the CFG edges inside blocks
+    // and from the last nodes of blocks are exported separately
+    template <typename Fun>
+    void forEachSuccessor(LLVMNode *node, Fun fun, bool cfgInBlock = true) {
+        if (exportsEdge(CFG) && cfgInBlock) {
+            if (LLVMNode *next = getNextInBlock(node)) {
+                fun(next, CFG);
+            } else if (LLVMBBlock *BB = node->getBBlock()) {
+                if (BB->getLastNode() == node) {
+                    for (const auto& succ : BB->successors()) {
+                        if (LLVMNode *first = succ.target->getFirstNode())
+                            fun(first, CFG);
+                    }
+                }
+            }
+        }
+
+        if (exportsEdge(DD)) {
+            for (auto it = node->data_begin(), et = node->data_end(); it != et; ++it)
+                fun(*it, DD);
+        }
+        if (exportsEdge(USE)) {
+            for (auto it = node->use_begin(), et = node->use_end(); it != et; ++it)
+                fun(*it, USE);
+        }
+        if (exportsEdge(CD)) {
+            for (auto it = node->control_begin(), et = node->control_end(); it != et; ++it)
+                fun(*it, CD);
+            // control dependencies between blocks go from the last
+            // node of the block (the same as in the .dot dumps)
+            LLVMBBlock *BB = node->getBBlock();
+            if (BB && BB->getLastNode() == node) {
+                for (LLVMBBlock *dep : BB->controlDependence()) {
+                    if (LLVMNode *first = dep->getFirstNode())
+                        fun(first, CD);
+                }
+            }
+        }
+        if (exportsEdge(ID)) {
+            for (auto it = node->interference_begin(), et = node->interference_end(); it != et; ++it)
+                fun(*it, ID);
+        }
+        if (exportsEdge(CALL)) {
+            for (auto *subgraph : node->getSubgraphs())
+                fun(subgraph->getEntry(), CALL);
+        }
+        if (exportsEdge(SUMMARY)) {
+            for (LLVMNode *out : _options.summaryEdges->getSummaryEdges(node))
+                fun(out, SUMMARY);
+        }
+    }
+
+    template <typename Fun>
+    void forEachPredecessor(LLVMNode *node, Fun fun) {
+        if (exportsEdge(CFG)) {
+            if (LLVMNode *prev = getPrevInBlock(node)) {
+                fun(prev);
+            } else if (LLVMBBlock *BB = node->getBBlock()) {
+                if (BB->getFirstNode() == node) {
+                    for (LLVMBBlock *pred : BB->predecessors()) {
+                        if (LLVMNode *last = pred->getLastNode())
+                            fun(last);
+                    }
+                }
+            }
+        }
+
+        if (exportsEdge(DD)) {
+            for (auto it = node->rev_data_begin(), et = node->rev_data_end(); it != et; ++it)
+                fun(*it);
+        }
+        if (exportsEdge(USE)) {
+            for (auto it = node->user_begin(), et = node->user_end(); it != et; ++it)
+                fun(*it);
+        }
+        if (exportsEdge(CD)) {
+            for (auto it = node->rev_control_begin(), et = node->rev_control_end(); it != et; ++it)
+                fun(*it);
+            LLVMBBlock *BB = node->getBBlock();
+            if (BB && BB->getFirstNode() == node) {
+                for (LLVMBBlock *dep : BB->revControlDependence()) {
+                    if (LLVMNode *last = dep->getLastNode())
+                        fun(last);
+                }
+            }
+        }
+        if (exportsEdge(ID)) {
+            for (auto it = node->rev_interference_begin(), et = node->rev_interference_end(); it != et; ++it)
+                fun(*it);
+        }
+        if (exportsEdge(CALL)) {
+            auto *graph = node->getDG();
+            if (graph && graph->getEntry() == node) {
+                for (LLVMNode *caller : graph->getCallers())
+                    fun(caller);
+            }
+        }
+        if (exportsEdge(SUMMARY)) {
+            for (LLVMNode *in : _options.summaryEdges->getRevSummaryEdges(node))
+                fun(in);
+        }
+    }
+
+    // keep only the nodes that are at most 'hops' edges
+    // far from the nodes in _options.around
+    void filterNeighborhood() {
+        std::unordered_map<LLVMNode *, unsigned> distance;
+        std::vector<LLVMNode *> current;
+        for (LLVMNode *node : _options.around) {
+            if (isExported(node) && distance.emplace(node, 0).second)
+                current.push_back(node);
+        }
+
+        for (unsigned hop = 1; hop <= _options.hops && !current.empty(); ++hop) {
+            std::vector<LLVMNode *> next;
+            auto visit = [&](LLVMNode *succ) {
+                if (isExported(succ) && distance.emplace(succ, hop).second)
+                    next.push_back(succ);
+            };
+
+            for (LLVMNode *node : current) {
+                forEachSuccessor(node, [&](LLVMNode *succ, EdgeKind) { visit(succ); });
+                forEachPredecessor(node, visit);
+            }
+            current.swap(next);
+        }
+
+        std::vector<LLVMNode *> nodes;
+        std::vector<std::pair<size_t, LLVMDependenceGraph *>> ranges;
+        nodes.reserve(distance.size());
+        size_t r = 0;
+        for (size_t i = 0; i < _nodes.size(); ++i) {
+            while (r < _ranges.size() && _ranges[r].first <= i)
+                ++r;
+            if (distance.count(_nodes[i]) == 0)
+                continue;
+            // the node is from the graph of _ranges[r - 1]
+            if (ranges.empty() || ranges.back().second != _ranges[r - 1].second)
+                ranges.emplace_back(nodes.size(), _ranges[r - 1].second);
+            nodes.push_back(_nodes[i]);
+        }
+        _nodes.swap(nodes);
+        _ranges.swap(ranges);
+
+        // number the remaining nodes again
+        _ids.clear();
+        for (size_t i = 0; i < _nodes.size(); ++i)
+            _ids[_nodes[i]] = static_cast<uint32_t>(i);
+    }
+
+    // the name of the function of the graph ("" for global nodes)
+    static std::string getFunctionName(LLVMDependenceGraph *graph) {
+        if (!graph)
+            return "";
+        const llvm::Value *entry = graph->getEntry()->getKey();
+        return entry ? entry->getName().str() : "";
+    }
+
+    std::string getLabel(LLVMNode *node) const {
+        const llvm::Value *val = node->getKey();
+        if (!val)
+            return "(null)";
+
+        std::string str;
+        llvm::raw_string_ostream ro(str);
+        if (auto *F = llvm::dyn_cast<llvm::Function>(val)) {
+            ro << "FUNC " << F->getName();
+        } else {
+            ro << *val;
+        }
+        ro.flush();
+
+        // the instructions are indented
+        size_t start = str.find_first_not_of(' ');
+        return start == std::string::npos ? str : str.substr(start);
+    }
+};
+
+} // namespace debug
+} // namespace dg
+
+#endif // LLVM_DG_EXPORT_H_
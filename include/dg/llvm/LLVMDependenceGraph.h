@@ -10,6 +10,7 @@
 #endif
 
 #include <map>
+#include <set>
 #include <unordered_map>
 
 #include "dg/llvm/ThreadRegions/ControlFlowGraph.h"
@@ -30,6 +31,8 @@ namespace dg {
 
 class LLVMPointerAnalysis;
 
+namespace llvmdg { class PostDominance; }
+
 //namespace llvmdg {
 //class LLVMControlDependenceAnalysis;
 //}
@@ -122,13 +125,20 @@ public:
     void addNoreturnDependencies(LLVMNode *noret, LLVMBBlock *from);
     void addNoreturnDependencies();
 
-    void computeControlDependencies(const LLVMControlDependenceAnalysisOptions& opts) {
+    // If 'functions' is not null, compute the intraprocedural control
+    // dependencies only for the given functions (the legacy NTSCD
+    // does not support this). The standard CD takes the post-dominators
+    // from 'postDominance' (shared with the control dependence analysis).
+    void computeControlDependencies(const LLVMControlDependenceAnalysisOptions& opts,
+                                    llvmdg::PostDominance& postDominance,
+                                    const std::set<const llvm::Function *> *functions = nullptr) {
         if (opts.standardCD()) {
-            computePostDominators(true);
+            computePostDominators(postDominance, true, functions);
         } else if (opts.ntscdLegacyCD()) {
+            assert(!functions && "Unsupported");
             computeNonTerminationControlDependencies();
         } else if (opts.ntscdCD() || opts.ntscd2CD() || opts.ntscdRanganathCD()) {
-            computeNTSCD(opts);
+            computeNTSCD(opts, functions);
         } else
             abort();
 
@@ -158,22 +168,19 @@ public:
     LLVMNode *findNode(llvm::Value *value) const;
 
     void addDefUseEdges();
-    void computeInterferenceDependentEdges(ControlFlowGraph * controlFlowGraph);
+    // join the loads and stores of the thread regions using 'threads'
+    // threads (0 = the number of hardware threads)
+    void computeInterferenceDependentEdges(ControlFlowGraph * controlFlowGraph,
+                                           unsigned threads = 1);
     void computeForkJoinDependencies(ControlFlowGraph * controlFlowGraph);
     void computeCriticalSections(ControlFlowGraph * controlFlowGraph);
 private:
-    void computePostDominators(bool addPostDomFrontiers = false);
+    void computePostDominators(llvmdg::PostDominance& postDominance,
+                               bool addPostDomFrontiers = false,
+                               const std::set<const llvm::Function *> *functions = nullptr);
     void computeNonTerminationControlDependencies();
-    void computeNTSCD(const LLVMControlDependenceAnalysisOptions& opts);
-
-    void computeInterferenceDependentEdges(const std::set<const llvm::Instruction *> &loads,
-                                           const std::set<const llvm::Instruction *> &stores);
-
-    std::set<const llvm::Instruction *> getLoadInstructions(const std::set<const llvm::Instruction *> &llvmInstructions) const;
-    std::set<const llvm::Instruction *> getStoreInstructions(const std::set<const llvm::Instruction *> &llvmInstructions) const;
-
-    std::set<const llvm::Instruction *> getInstructionsOfType(const unsigned opCode,
-                                                              const std::set<const llvm::Instruction *> &llvmInstructions) const;
+    void computeNTSCD(const LLVMControlDependenceAnalysisOptions& opts,
+                      const std::set<const llvm::Function *> *functions = nullptr);
 
     // add formal parameters of the function to the graph
     // (graph is a graph of one procedure)
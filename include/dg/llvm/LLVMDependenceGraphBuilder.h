@@ -1,8 +1,8 @@
 #ifndef _DG_LLVM_DEPENDENCE_GRAPH_BUILDER_H_
 #define _DG_LLVM_DEPENDENCE_GRAPH_BUILDER_H_
 
+#include <fstream>
 #include <string>
-#include <ctime> // std::clock
 
 // ignore unused parameters in LLVM libraries
 #if (__clang__)
@@ -27,6 +27,10 @@
 #include "dg/llvm/DataDependence/LLVMDataDependenceAnalysisOptions.h"
 #include "dg/llvm/ControlDependence/ControlDependence.h"
 #include "dg/llvm/ControlDependence/LLVMControlDependenceAnalysisOptions.h"
+#include "dg/llvm/AnalysisCache/AnalysisCache.h"
+#include "dg/util/Profiling.h"
+#include "dg/llvm/AnalysisCache/CachedPointerAnalysis.h"
+#include "dg/llvm/AnalysisCache/IncrementalAnalysis.h"
 
 #include "dg/llvm/PointerAnalysis/PointerAnalysis.h"
 #ifdef HAVE_SVF
@@ -55,19 +59,58 @@ struct LLVMDependenceGraphOptions {
 
     bool verifyGraph{true};
     bool threads{false};
+    // the number of threads used for computing the interference
+    // dependencies (0 = the number of hardware threads)
+    unsigned interferenceThreads{1};
 
     std::string entryFunction{"main"};
 
+    // If not empty, the results of the analyses are stored into
+    // (and loaded from) a cache file in this directory.
+    // The cache is not used with threads.
+    std::string analysisCacheDir{};
+    // If there is no cache for the module in analysisCacheDir,
+    // re-use the results of unchanged functions from the last cache
+    // stored with the same options (see IncrementalAnalysis).
+    // Only the control dependencies are recomputed per function,
+    // the pointer and data dependence analyses run on the whole module.
+    // The results are stored as derived, so the next incremental run
+    // can start from them.
+    bool incrementalAnalysis{false};
+
     void addAllocationFunction(const std::string& name,
                                AllocationFunction F) {
         PTAOptions.addAllocationFunction(name, F);
         DDAOptions.addAllocationFunction(name, F);
     }
+
+    // Read a model library (see DataDependenceAnalysisOptions::
+    // readFunctionModels). The allocation functions from the library
+    // are used also by the pointer analysis.
+    bool readFunctionModels(const std::string& file, std::string& error) {
+        std::ifstream in(file);
+        if (!in.is_open()) {
+            error = "cannot open " + file;
+            return false;
+        }
+
+        if (!DDAOptions.readFunctionModels(in, error))
+            return false;
+
+        for (auto& it : DDAOptions.allocationFunctions)
+            PTAOptions.allocationFunctions[it.first] = it.second;
+        return true;
+    }
 };
 
 class LLVMDependenceGraphBuilder {
     llvm::Module *_M;
     const LLVMDependenceGraphOptions _options;
+    // the cache must be declared before the analyses
+    // as these may refer to it
+    AnalysisCache::Key _cacheKey{};
+    std::unique_ptr<AnalysisCache> _cache{};
+    std::unique_ptr<IncrementalAnalysis> _incremental{};
     std::unique_ptr<LLVMPointerAnalysis> _PTA{};
     std::unique_ptr<LLVMDataDependenceAnalysis> _DDA{nullptr};
     std::unique_ptr<LLVMControlDependenceAnalysis> _CDA{nullptr};
@@ -75,67 +118,104 @@ class LLVMDependenceGraphBuilder {
     std::unique_ptr<ControlFlowGraph> _controlFlowGraph{};
     llvm::Function *_entryFunction{nullptr};
 
+    // wall-clock times of the analyses in seconds
+    // (also reported to debug::Profiler)
     struct Statistics {
-        uint64_t cdaTime{0};
-        uint64_t ptaTime{0};
-        uint64_t rdaTime{0};
-        uint64_t inferaTime{0};
-        uint64_t joinsTime{0};
-        uint64_t critsecTime{0};
+        double cdaTime{0};
+        double ptaTime{0};
+        double rdaTime{0};
+        double inferaTime{0};
+        double joinsTime{0};
+        double critsecTime{0};
     } _statistics;
 
-    std::clock_t _time_start;
-    void _timerStart() { _time_start = std::clock(); }
-    uint64_t _timerEnd() { return (std::clock() - _time_start); }
-
     void _runPointerAnalysis() {
         assert(_PTA && "BUG: No PTA");
 
-        _timerStart();
+        debug::ScopedTimer timer("pta", &_statistics.ptaTime);
+        if (_incremental && _options.PTAOptions.isFI()) {
+            // the previous results are a valid initial state only
+            // for the flow-insensitive analysis
+            auto *dgpta = static_cast<DGLLVMPointerAnalysis *>(_PTA.get());
+            dgpta->initialize();
+            _incremental->seedPointsTo(dgpta);
+        }
         _PTA->run();
-        _statistics.ptaTime = _timerEnd();
     }
 
     void _runDataDependenceAnalysis() {
         assert(_DDA && "BUG: No RD");
 
-        _timerStart();
+        debug::ScopedTimer timer("dda", &_statistics.rdaTime);
         _DDA->run();
-        _statistics.rdaTime = _timerEnd();
     }
 
     void _runControlDependenceAnalysis() {
-        _timerStart();
+        debug::ScopedTimer timer("cda", &_statistics.cdaTime);
+        if (_cache && _cache->hasControlDependencies()) {
+            _cache->restoreControlDependencies();
+            if (_options.CDAOptions.interproceduralCD())
+                _dg->addNoreturnDependencies();
+            return;
+        }
+        if (_incremental && !_options.CDAOptions.ntscdLegacyCD()) {
+            auto functions = _incremental->restoreControlDependencies();
+            _dg->computeControlDependencies(_options.CDAOptions,
+                                            _CDA->getPostDominance(), &functions);
+            return;
+        }
         //_CDA->run();
         // FIXME: until we get rid of the legacy code,
         // use the old way of inserting CD edges directly
         // into the dg
-        _dg->computeControlDependencies(_options.CDAOptions);
-        _statistics.cdaTime = _timerEnd();
+        _dg->computeControlDependencies(_options.CDAOptions,
+                                        _CDA->getPostDominance());
     }
 
     void _runInterferenceDependenceAnalysis() {
-        _timerStart();
-        _dg->computeInterferenceDependentEdges(_controlFlowGraph.get());
-        _statistics.inferaTime = _timerEnd();
+        debug::ScopedTimer timer("interference", &_statistics.inferaTime);
+        _dg->computeInterferenceDependentEdges(_controlFlowGraph.get(),
+                                               _options.interferenceThreads);
     }
 
     void _runForkJoinAnalysis() {
-        _timerStart();
+        debug::ScopedTimer timer("forkjoin", &_statistics.joinsTime);
         _dg->computeForkJoinDependencies(_controlFlowGraph.get());
-        _statistics.joinsTime = _timerEnd();
     }
 
     void _runCriticalSectionAnalysis() {
-        _timerStart();
+        debug::ScopedTimer timer("critsec", &_statistics.critsecTime);
         _dg->computeCriticalSections(_controlFlowGraph.get());
-        _statistics.critsecTime = _timerEnd();
     }
 
     bool verify() const {
         return _dg->verify();
     }
 
+    bool _useAnalysisCache() const {
+        // with threads, we need the results of DG's pointer analysis
+        // (not only the points-to sets), so we do not use the cache
+        return !_options.analysisCacheDir.empty() && !_options.threads;
+    }
+
+    void _storeAnalysisCache() {
+        if (!_useAnalysisCache() || _cache)
+            return;
+
+        // the results of the incremental analysis may be less precise
+        // than the results computed from scratch, so they are stored
+        // as derived: the next incremental analysis can start from them,
+        // but they are not re-used for this module by non-incremental runs
+        uint32_t derived = _incremental ? _incremental->getDerived() : 0;
+
+        // the legacy NTSCD adds the dependencies between instructions
+        // which are not stored in the cache
+        bool storeCD = !_options.CDAOptions.ntscdLegacyCD();
+        AnalysisCache::store(_options.analysisCacheDir, _M, _cacheKey,
+                             _PTA.get(), _DDA.get(),
+                             storeCD ? _dg.get() : nullptr, derived);
+    }
+
 public:
     LLVMDependenceGraphBuilder(llvm::Module *M)
     : LLVMDependenceGraphBuilder(M, {}) {}
@@ -152,9 +232,27 @@ public:
             new ControlFlowGraph(static_cast<DGLLVMPointerAnalysis*>(_PTA.get())) : nullptr),
       _entryFunction(M->getFunction(_options.entryFunction)) {
         assert(_entryFunction && "The entry function not found");
+        if (_cache && _cache->hasDataDependencies())
+            _DDA->setCache(_cache.get());
     }
 
     LLVMPointerAnalysis *createPTA() {
+        if (_useAnalysisCache()) {
+            _cacheKey = AnalysisCache::computeKey(_M, _options);
+            _cache = AnalysisCache::load(_options.analysisCacheDir,
+                                         _M, _cacheKey,
+                                         /* allowDerived = */ _options.incrementalAnalysis);
+            if (_cache)
+                return new CachedLLVMPointerAnalysis(_cache.get(),
+                                                     _options.PTAOptions);
+
+            if (_options.incrementalAnalysis) {
+                if (auto prev = AnalysisCache::loadLatest(_options.analysisCacheDir,
+                                                          _cacheKey))
+                    _incremental.reset(new IncrementalAnalysis(std::move(prev), _M));
+            }
+        }
+
 #ifdef HAVE_SVF
         if (_options.PTAOptions.isSVF())
             return new SVFPointerAnalysis(_M, _options.PTAOptions);
@@ -168,6 +266,26 @@ public:
 
     const Statistics& getStatistics() const { return _statistics; }
 
+    // were the results of the analyses loaded from the cache?
+    bool usedAnalysisCache() const { return _cache != nullptr; }
+
+    ///
+    // Re-use the results of the analyses of a previous version of the module.
+    // 'changed' are the functions that are known to be changed
+    // (others are found by comparing the functions with the previous state).
+    // Must be called before building the graph.
+    void setPreviousAnalysis(std::unique_ptr<AnalysisCache> previous,
+                             const std::set<const llvm::Function *>& changed = {}) {
+        assert(previous && "Need the previous state");
+        if (_cache) // we have the results for this module
+            return;
+        _incremental.reset(new IncrementalAnalysis(std::move(previous), _M, changed));
+    }
+
+    const IncrementalAnalysis *getIncrementalAnalysis() const {
+        return _incremental.get();
+    }
+
     // construct the whole graph with all edges
     std::unique_ptr<LLVMDependenceGraph>&& build() {
         // compute data dependencies
@@ -200,6 +318,8 @@ public:
             return std::move(_dg);
         }
 
+        _storeAnalysisCache();
+
         return std::move(_dg);
     }
 
@@ -252,6 +372,8 @@ public:
             _runCriticalSectionAnalysis();
         }
 
+        _storeAnalysisCache();
+
         return std::move(_dg);
     }
 
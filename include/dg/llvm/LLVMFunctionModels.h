@@ -0,0 +1,103 @@
+#ifndef DG_LLVM_FUNCTION_MODELS_H_
+#define DG_LLVM_FUNCTION_MODELS_H_
+
+#include <unordered_map>
+
+// ignore unused parameters in LLVM libraries
+#if (__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-parameter"
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Module.h>
+
+#if (__clang__)
+#pragma clang diagnostic pop // ignore -Wunused-parameter
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "dg/AnalysisOptions.h"
+#include "dg/DataDependence/DataDependenceAnalysisOptions.h"
+
+namespace dg {
+
+///
+// Allocation functions and models of functions resolved for the functions
+// of a module. The options keep them by the names of functions, here the
+// names are looked up only once for every function (when the table is
+// created) and the builders then query a hash table keyed by
+// llvm::Function instead of comparing the names for every call-site.
+// The table does not change after it is created, so it can be queried
+// from more threads.
+class LLVMFunctionModels {
+public:
+    struct Info {
+        AllocationFunction allocation{AllocationFunction::NONE};
+        const FunctionModel *model{nullptr};
+    };
+
+    // 'models' may be nullptr if the user does not need the models
+    // (e.g., the pointer analysis). The options must outlive the table.
+    LLVMFunctionModels(const llvm::Module *M, const AnalysisOptions& opts,
+                       const DataDependenceAnalysisOptions *models = nullptr)
+    : _options(opts), _models(models) {
+        if (!M)
+            return;
+
+        _functions.reserve(M->size());
+        for (const llvm::Function& F : *M) {
+            Info info = resolve(&F);
+            if (info.allocation != AllocationFunction::NONE || info.model)
+                _functions.emplace(&F, info);
+        }
+        _resolvedModule = M;
+    }
+
+    Info get(const llvm::Function *F) const {
+        auto it = _functions.find(F);
+        if (it != _functions.end())
+            return it->second;
+        // functions that are not in the module (they are not expected,
+        // but do not fail on them)
+        if (F->getParent() != _resolvedModule)
+            return resolve(F);
+        return Info{};
+    }
+
+    AllocationFunction getAllocationFunction(const llvm::Function *F) const {
+        return get(F).allocation;
+    }
+
+    bool isAllocationFunction(const llvm::Function *F) const {
+        return getAllocationFunction(F) != AllocationFunction::NONE;
+    }
+
+    const FunctionModel *getFunctionModel(const llvm::Function *F) const {
+        return get(F).model;
+    }
+
+private:
+    const AnalysisOptions& _options;
+    const DataDependenceAnalysisOptions *_models;
+    const llvm::Module *_resolvedModule{nullptr};
+    // only the functions that have a model or are allocation functions
+    std::unordered_map<const llvm::Function *, Info> _functions;
+
+    Info resolve(const llvm::Function *F) const {
+        Info info;
+        const std::string name = F->getName().str();
+        info.allocation = _options.getAllocationFunction(name);
+        if (_models)
+            info.model = _models->getFunctionModel(name);
+        return info;
+    }
+};
+
+} // namespace dg
+
+#endif // DG_LLVM_FUNCTION_MODELS_H_
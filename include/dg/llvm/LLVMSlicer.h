@@ -22,7 +22,9 @@
 #include <llvm/IR/Instruction.h>
 #include <llvm/IR/GlobalVariable.h>
 #include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
 #include <llvm/Support/raw_ostream.h>
+#include <llvm/Transforms/Utils/Cloning.h>
 
 #if (__clang__)
 #pragma clang diagnostic pop // ignore -Wunused-parameter
@@ -30,6 +32,10 @@
 #pragma GCC diagnostic pop
 #endif
 
+#include <map>
+#include <memory>
+#include <set>
+
 #include "dg/Slicing.h"
 #include "dg/llvm/LLVMDependenceGraph.h"
 #include "dg/llvm/LLVMNode.h"
@@ -159,6 +165,35 @@ public:
         return sl_id;
     }
 
+    ///
+    // Extract the nodes marked with 'sl_id' into a new module.
+    // Unlike slice(), this method does not modify the dependence graph
+    // nor the module 'M', so it can be called repeatedly (e.g., after
+    // marking the nodes for another slicing criterion). The new module
+    // is a clone of 'M' with the same content as 'M' would have after
+    // calling slice().
+    std::unique_ptr<llvm::Module> extract(const llvm::Module *M, uint32_t sl_id)
+    {
+        assert(sl_id != 0 && "Invalid slice ID");
+
+        llvm::ValueToValueMapTy VMap;
+#if LLVM_VERSION_MAJOR >= 7
+        auto clone = llvm::CloneModule(*M, VMap);
+#else
+        std::unique_ptr<llvm::Module> clone(llvm::CloneModule(M, VMap));
+#endif
+
+        for (auto& it : constructedFunctions) {
+            auto *F = llvm::dyn_cast<llvm::Function>(it.first);
+            if (!F || F->getParent() != M || dontTouch(F->getName()))
+                continue;
+
+            extractGraph(it.second, VMap, sl_id);
+        }
+
+        return clone;
+    }
+
 private:
         /*
     void sliceCallNode(LLVMNode *callNode,
@@ -485,6 +520,300 @@ private:
         ensureEntryBlock(graph);
     }
 
+    // The successors of blocks of a graph that is being extracted.
+    // The CFG of the graph is not modified, so we keep the edges here
+    // (nullptr as the target stands for the new exit block).
+    using ExtractedEdge = std::pair<LLVMBBlock *, uint8_t>;
+    using ExtractedCFG = std::map<LLVMBBlock *, std::set<ExtractedEdge>>;
+
+    static bool successorsAreSame(const std::set<ExtractedEdge>& succs)
+    {
+        for (const auto& edge : succs) {
+            if (edge.first != succs.begin()->first)
+                return false;
+        }
+        return true;
+    }
+
+    static void removeSuccessorsTarget(std::set<ExtractedEdge>& succs,
+                                       LLVMBBlock *target)
+    {
+        for (auto I = succs.begin(), E = succs.end(); I != E;) {
+            if (I->first == target)
+                I = succs.erase(I);
+            else
+                ++I;
+        }
+    }
+
+    // the same as sliceBBlocks(), but removes the blocks only from
+    // the extracted CFG and from the cloned function
+    void extractBBlocks(LLVMDependenceGraph *graph, uint32_t slice_id,
+                        ExtractedCFG& cfg, std::set<LLVMBBlock *>& removed,
+                        std::map<LLVMBBlock *, llvm::BasicBlock *>& clonedBlocks)
+    {
+        for (auto& it : graph->getBlocks()) {
+            if (it.second->getSlice() != slice_id)
+                removed.insert(it.second);
+        }
+
+        // removing a block connects its predecessors to its successors,
+        // so the successors of the kept blocks are the kept blocks that
+        // are reachable through the removed blocks (under the label
+        // of the original edge)
+        for (auto& it : graph->getBlocks()) {
+            LLVMBBlock *BB = it.second;
+            if (removed.count(BB) > 0)
+                continue;
+
+            auto& succs = cfg[BB];
+            for (const auto& succ : BB->successors()) {
+                if (removed.count(succ.target) == 0) {
+                    succs.emplace(succ.target, succ.label);
+                    continue;
+                }
+
+                std::set<LLVMBBlock *> visited{succ.target};
+                std::vector<LLVMBBlock *> stack{succ.target};
+                while (!stack.empty()) {
+                    LLVMBBlock *cur = stack.back();
+                    stack.pop_back();
+                    for (const auto& next : cur->successors()) {
+                        if (removed.count(next.target) == 0)
+                            succs.emplace(next.target, succ.label);
+                        else if (visited.insert(next.target).second)
+                            stack.push_back(next.target);
+                    }
+                }
+            }
+        }
+
+        for (LLVMBBlock *blk : removed) {
+            statistics.nodesRemoved += blk->size();
+            statistics.nodesTotal += blk->size();
+            ++statistics.blocksRemoved;
+
+            auto *llvmBB = clonedBlocks[blk];
+            for (auto *succ : llvm::successors(llvmBB)) {
+                if (succ != llvmBB)
+                    adjustPhiNodes(succ, llvmBB);
+            }
+        }
+
+        // drop the references only after adjusting the PHI nodes,
+        // dropping nullifies the successors of the removed blocks
+        for (LLVMBBlock *blk : removed) {
+            auto *llvmBB = clonedBlocks[blk];
+            dropAllUses(llvmBB);
+            for (llvm::Instruction& Inst : *llvmBB)
+                dropAllUses(&Inst);
+        }
+
+        for (LLVMBBlock *blk : removed) {
+            clonedBlocks[blk]->eraseFromParent();
+            clonedBlocks.erase(blk);
+        }
+    }
+
+    // the same as adjustBBlocksSucessors(), but on the extracted CFG.
+    // Returns the new exit block in the cloned function, if it was created.
+    llvm::BasicBlock *extractBBlocksSucessors(LLVMDependenceGraph *graph,
+                                              uint32_t slice_id,
+                                              llvm::Function *F,
+                                              ExtractedCFG& cfg)
+    {
+        using namespace llvm;
+
+        LLVMBBlock *oldExitBB = graph->getExitBB();
+        assert(oldExitBB && "Don't have exit BB");
+
+        BasicBlock *newExitBB = nullptr;
+        auto createExitBB = [&]() {
+            if (newExitBB)
+                return;
+
+            LLVMContext& Ctx = F->getContext();
+            newExitBB = BasicBlock::Create(Ctx, "safe_return");
+            F->getBasicBlockList().push_back(newExitBB);
+            if (F->getReturnType()->isVoidTy())
+                ReturnInst::Create(Ctx, newExitBB);
+            else if (F->getName().equals("main"))
+                ReturnInst::Create(Ctx,
+                                   ConstantInt::get(Type::getInt32Ty(Ctx), 0),
+                                   newExitBB);
+            else
+                ReturnInst::Create(Ctx, UndefValue::get(F->getReturnType()),
+                                   newExitBB);
+        };
+
+        for (auto& it : graph->getBlocks()) {
+            auto cfgit = cfg.find(it.second);
+            if (cfgit == cfg.end())
+                continue;
+
+            LLVMBBlock *BB = it.second;
+            auto& succs = cfgit->second;
+            const auto *tinst = cast<BasicBlock>(it.first)->getTerminator();
+
+            if (succs.empty())
+                continue;
+
+            bool slicedTerminator = BB->getLastNode()->getSlice() != slice_id;
+            if (succs.size() == 2 && slicedTerminator
+                && !successorsAreSame(succs)) {
+                removeSuccessorsTarget(succs, BB);
+                assert(succs.size() == 1 && "Should have only one successor");
+            }
+
+            if (succs.size() == 1 && slicedTerminator) {
+                auto edge = *succs.begin();
+                edge.second = 0;
+                if (edge.first == oldExitBB) {
+                    createExitBB();
+                    edge.first = nullptr;
+                }
+
+                succs.clear();
+                succs.insert(edge);
+                continue;
+            }
+
+            std::set<uint8_t> labels;
+            for (const auto& succ : succs) {
+                if (succ.second == 255 || succ.first == oldExitBB)
+                    continue;
+                labels.insert(succ.second);
+            }
+
+            for (uint8_t i = 0; i < tinst->getNumSuccessors(); ++i) {
+                if (labels.count(i) == 0) {
+                    createExitBB();
+                    succs.emplace(nullptr, i);
+                }
+            }
+
+            if (newExitBB)
+                removeSuccessorsTarget(succs, oldExitBB);
+
+            if (succs.size() > 1 && successorsAreSame(succs)) {
+                LLVMBBlock *succ = succs.begin()->first;
+                succs.clear();
+                succs.emplace(succ, 0);
+            }
+        }
+
+        return newExitBB;
+    }
+
+    void extractGraph(LLVMDependenceGraph *graph,
+                      llvm::ValueToValueMapTy& VMap, uint32_t slice_id)
+    {
+        using namespace llvm;
+
+        auto *F = cast<Function>(VMap[graph->getEntry()->getKey()]);
+
+        // the value handles in VMap follow RAUW, so get the mapping
+        // of the blocks and instructions before changing anything
+        std::map<LLVMBBlock *, BasicBlock *> clonedBlocks;
+        for (auto& it : graph->getBlocks())
+            clonedBlocks[it.second] = cast<BasicBlock>(VMap[it.first]);
+
+        std::vector<std::pair<LLVMNode *, Instruction *>> nodes;
+        for (auto& it : *graph) {
+            auto *I = dyn_cast<Instruction>(it.first);
+            // skip the artificial nodes
+            if (!I || !I->getParent())
+                continue;
+            nodes.emplace_back(it.second, cast<Instruction>(VMap[I]));
+        }
+
+        ExtractedCFG cfg;
+        std::set<LLVMBBlock *> removed;
+        extractBBlocks(graph, slice_id, cfg, removed, clonedBlocks);
+
+        BasicBlock *newExitBB
+            = extractBBlocksSucessors(graph, slice_id, F, cfg);
+
+        for (auto& it : *graph) {
+            LLVMNode *n = it.second;
+            // the node from the new exit block is the exit node
+            // if the exit block was created
+            if (!newExitBB && n == graph->getExit())
+                continue;
+            // the node was removed with its block
+            if (removed.count(n->getBBlock()) > 0)
+                continue;
+
+            ++statistics.nodesTotal;
+            if (shouldSliceInst(n->getKey()) && n->getSlice() != slice_id)
+                ++statistics.nodesRemoved;
+        }
+
+        for (auto& it : nodes) {
+            LLVMNode *n = it.first;
+            if (removed.count(n->getBBlock()) > 0 ||
+                !shouldSliceInst(n->getKey()) || n->getSlice() == slice_id)
+                continue;
+
+            Instruction *I = it.second;
+            I->replaceAllUsesWith(UndefValue::get(I->getType()));
+            I->eraseFromParent();
+        }
+
+        for (auto& it : cfg) {
+            reconnectExtractedBBlock(it.second, clonedBlocks[it.first],
+                                     clonedBlocks, newExitBB);
+        }
+
+        ensureEntryBlock(F);
+    }
+
+    static void reconnectExtractedBBlock(const std::set<ExtractedEdge>& succs,
+                                         llvm::BasicBlock *llvmBB,
+                                         std::map<LLVMBBlock *, llvm::BasicBlock *>& clonedBlocks,
+                                         llvm::BasicBlock *newExitBB)
+    {
+        using namespace llvm;
+
+        auto getBlock = [&](LLVMBBlock *B) -> BasicBlock * {
+            if (!B)
+                return newExitBB;
+            assert(clonedBlocks.count(B) > 0 && "nullptr as BB's key");
+            return clonedBlocks[B];
+        };
+
+        auto tinst = llvmBB->getTerminator();
+        if (!tinst) {
+            LLVMContext& Ctx = llvmBB->getContext();
+            Function *F = llvmBB->getParent();
+
+            if (succs.size() == 1 && succs.begin()->second != 255) {
+                BranchInst::Create(getBlock(succs.begin()->first), llvmBB);
+                return;
+            }
+
+            assert(succs.empty()
+                    && "Creating return to BBlock that has successors");
+
+            if (F->getReturnType()->isVoidTy())
+                ReturnInst::Create(Ctx, llvmBB);
+            else if (F->getName().equals("main"))
+                ReturnInst::Create(Ctx,
+                                   ConstantInt::get(Type::getInt32Ty(Ctx), 0),
+                                   llvmBB);
+            else
+                ReturnInst::Create(Ctx,
+                                   UndefValue::get(F->getReturnType()), llvmBB);
+            return;
+        }
+
+        for (const auto& succ : succs) {
+            if (succ.second == 255)
+                continue;
+            tinst->setSuccessor(succ.second, getBlock(succ.first));
+        }
+    }
+
     bool dontTouch(const llvm::StringRef& r)
     {
         for (const char *n : dont_touch)
@@ -579,10 +908,13 @@ private:
 
     void ensureEntryBlock(LLVMDependenceGraph *graph)
     {
-        using namespace llvm;
+        ensureEntryBlock(llvm::cast<llvm::Function>(graph->getEntry()->getKey()));
+        // FIXME: propagate the change to dependence graph
+    }
 
-        Value *val = graph->getEntry()->getKey();
-        Function *F = cast<Function>(val);
+    static void ensureEntryBlock(llvm::Function *F)
+    {
+        using namespace llvm;
 
         // Function is empty, just bail out
         if(F->begin() == F->end())
@@ -597,7 +929,7 @@ private:
 
         // it has some predecessor, create new one, that will just
         // jump on it
-        LLVMContext& Ctx = graph->getModule()->getContext();
+        LLVMContext& Ctx = F->getContext();
         BasicBlock *block = BasicBlock::Create(Ctx, "single_entry");
 
         // jump to the old entry block
@@ -606,8 +938,6 @@ private:
         // set it as a new entry by pusing the block to the front
         // of the list
         F->getBasicBlockList().push_front(block);
-
-        // FIXME: propagate this change to dependence graph
     }
 
     // do not slice these functions at all
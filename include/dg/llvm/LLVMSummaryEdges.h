@@ -0,0 +1,59 @@
+#ifndef LLVM_DG_SUMMARY_EDGES_H_
+#define LLVM_DG_SUMMARY_EDGES_H_
+
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "dg/llvm/LLVMNode.h"
+
+namespace dg {
+
+class LLVMDependenceGraph;
+
+///
+// Summary edges of the LLVM dependence graph [Horwitz, Reps, Binkley].
+// A summary edge goes from an actual-in to an actual-out parameter
+// of a call-site if the corresponding formal-out parameter of the called
+// function depends on the corresponding formal-in parameter (through
+// control, data and use dependencies and summary edges of the calls
+// in the function).
+//
+// Instead of storing the path edges of the worklist algorithm,
+// every function keeps for each of its nodes a dense bitset of
+// the formal-out parameters that depend on the node. The functions
+// are processed bottom-up in the SCCs of the call graph (the functions
+// in a recursive SCC are iterated until a fixpoint), so the summary
+// edges of the callees are known when the callers are processed.
+// SCCs that do not depend on each other are processed in parallel.
+//
+// The summary edges are kept here, they are not stored in the nodes.
+class LLVMSummaryEdges {
+public:
+    LLVMSummaryEdges();
+    ~LLVMSummaryEdges();
+
+    // compute the summary edges of all constructed functions
+    // ('threads' = 0 means the number of hardware threads)
+    void compute(unsigned threads = 1);
+
+    // actual-out parameters that depend on the actual-in parameter
+    const std::set<LLVMNode *>& getSummaryEdges(LLVMNode *actualIn) const;
+    // actual-in parameters on which the actual-out parameter depends
+    const std::set<LLVMNode *>& getRevSummaryEdges(LLVMNode *actualOut) const;
+
+    size_t getEdgesNum() const;
+
+private:
+    struct FunctionInfo;
+
+    std::unordered_map<const LLVMDependenceGraph *,
+                       std::unique_ptr<FunctionInfo>> _functions;
+
+    FunctionInfo *getInfo(const LLVMNode *node) const;
+};
+
+} // namespace dg
+
+#endif // LLVM_DG_SUMMARY_EDGES_H_
@@ -0,0 +1,93 @@
+#ifndef DG_LLVM_ALIAS_QUERIES_H_
+#define DG_LLVM_ALIAS_QUERIES_H_
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "dg/Offset.h"
+
+namespace llvm {
+class Value;
+}
+
+namespace dg {
+
+class LLVMPointerAnalysis;
+
+///
+// A query "may the 'sizeA' bytes pointed by 'a' overlap
+// with the 'sizeB' bytes pointed by 'b'?"
+// The size 0 or Offset::UNKNOWN means that the size is unknown.
+struct LLVMAliasQuery {
+    const llvm::Value *a;
+    Offset sizeA;
+    const llvm::Value *b;
+    Offset sizeB;
+
+    LLVMAliasQuery(const llvm::Value *a, Offset sizeA,
+                   const llvm::Value *b, Offset sizeB)
+    : a(a), sizeA(sizeA), b(b), sizeB(sizeB) {}
+
+    LLVMAliasQuery(const llvm::Value *a, const llvm::Value *b)
+    : a(a), sizeA(Offset::UNKNOWN), b(b), sizeB(Offset::UNKNOWN) {}
+
+    bool operator==(const LLVMAliasQuery& rhs) const {
+        return a == rhs.a && b == rhs.b &&
+               sizeA == rhs.sizeA && sizeB == rhs.sizeB;
+    }
+};
+
+///
+// Memoized alias queries over the results of a pointer analysis
+// (used by LLVMPointerAnalysis::alias() and mayOverlap()).
+//
+// For every queried pointer we keep the array of (object, offset)
+// pairs of its points-to set sorted by dense ids of the objects,
+// so two pointers are compared by a linear merge of their arrays.
+// The answers are memoized in a hash table keyed by the (normalized)
+// query. The cached data are not updated when the points-to sets
+// change, so call clear() in that case.
+class LLVMAliasQueries {
+    struct Summary {
+        // the points-to set contains unknown memory
+        bool unknown{false};
+        // (object id, offset) sorted by the object id and offset
+        std::vector<std::pair<unsigned, Offset::type>> targets;
+    };
+
+    struct QueryHash {
+        size_t operator()(const LLVMAliasQuery& Q) const {
+            size_t h = std::hash<const llvm::Value *>()(Q.a);
+            h = h * 31 + std::hash<const llvm::Value *>()(Q.b);
+            h = h * 31 + std::hash<Offset::type>()(*Q.sizeA);
+            return h * 31 + std::hash<Offset::type>()(*Q.sizeB);
+        }
+    };
+
+    std::unordered_map<const llvm::Value *, unsigned> _objects;
+    std::unordered_map<const llvm::Value *, Summary> _summaries;
+    std::unordered_map<LLVMAliasQuery, bool, QueryHash> _results;
+
+    const Summary& _getSummary(LLVMPointerAnalysis *PTA, const llvm::Value *val);
+    static bool _overlap(const Summary& A, Offset sizeA,
+                         const Summary& B, Offset sizeB);
+
+public:
+    bool mayOverlap(LLVMPointerAnalysis *PTA, const LLVMAliasQuery& Q);
+
+    // the number of memoized answers
+    size_t size() const { return _results.size(); }
+
+    void clear() {
+        _objects.clear();
+        _summaries.clear();
+        _results.clear();
+    }
+};
+
+} // namespace dg
+
+#endif // DG_LLVM_ALIAS_QUERIES_H_
@@ -199,7 +199,7 @@ public:
             return {false, LLVMPointsToSet(getUnknownPTSet())};
     }
 
-    const std::vector<std::unique_ptr<PSNode>>& getNodes()
+    const PointerGraph::NodesT& getNodes()
     {
         return PS->getNodes();
     }
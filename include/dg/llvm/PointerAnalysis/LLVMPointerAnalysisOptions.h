@@ -12,6 +12,29 @@ struct LLVMPointerAnalysisOptions : public LLVMAnalysisOptions, PointerAnalysisO
 
     bool threads{false};
 
+    // Selective context-sensitivity: the subgraph of a chosen function
+    // is cloned for every call-string of the length up to 'contextDepth'
+    // (0 means that the analysis is context-insensitive).
+    // Recursive functions and functions that call something via
+    // a pointer are never cloned.
+    unsigned contextDepth{0};
+    // clone functions that return memory from an allocation function
+    bool cloneAllocWrappers{true};
+    // clone functions with at most this number of instructions (0 = none)
+    unsigned cloneSmallFunctions{0};
+    // do not create more clones once the clones have this number of nodes
+    size_t maxClonedNodes{100000};
+
+    // Solve the points-to sets when they are queried instead of solving
+    // the whole graph in run(). Only the parts of the graph that the queried
+    // values depend on are processed. It is supported by the flow-insensitive
+    // analysis without cloning and for programs without calls via pointers
+    // and threads, otherwise the whole graph is solved as usual.
+    bool demandDriven{false};
+    // a query that would process more than this number of new nodes
+    // makes the analysis solve the whole graph (0 = no limit)
+    size_t demandBudget{100000};
+
     bool isFS() const { return analysisType == AnalysisType::fs; }
     bool isFSInv() const { return analysisType == AnalysisType::inv; }
     bool isFI() const { return analysisType == AnalysisType::fi; }
@@ -18,6 +18,10 @@
 #pragma GCC diagnostic pop
 #endif
 
+#include <cassert>
+#include <memory>
+#include <vector>
+
 #include "dg/PointerAnalysis/PointsToSet.h"
 
 namespace dg {
@@ -302,16 +306,50 @@ public:
 // This also means that it is possible that iterating over the
 // set yields no elements, but empty() == false
 // (the set contains only unknown or null elements)
-// XXX: would it be easier and actually more efficient
-// just to return a std::vector<LLVMPointer> instead
-// of all this wrapping?
+//
+// The points-to sets of DG are only referenced by the object
+// and iterated directly (no allocation, no virtual calls),
+// so the object is cheap to return by value. Such a view is valid only
+// while the referenced set does not change, i.e., the pointer analysis
+// must not run while the view is used. If the analysis may still change
+// the set (e.g., it is solved on demand by the queries), the object
+// owns a copy of the set instead (see snapshot()).
+// Other implementations (e.g., SVF) are wrapped into LLVMPointsToSetImpl
+// and iterated through its virtual methods.
 class LLVMPointsToSet {
+    // the DG points-to set (if _impl is not set)
+    const PointsToSetT *_pts{nullptr};
+    // the copy of the set that _pts points to, if we own it
+    std::unique_ptr<PointsToSetT> _owned{};
     std::unique_ptr<LLVMPointsToSetImpl> _impl{};
 
+    static const PointsToSetT& _emptyPTSet() {
+        static const PointsToSetT _empty;
+        return _empty;
+    }
+
+    static bool _isReal(const pta::Pointer& ptr) {
+        return ptr.isValid() && !ptr.isInvalidated();
+    }
+
+    static LLVMPointer _toLLVM(const pta::Pointer& ptr) {
+        return LLVMPointer{ptr.target->getUserData<llvm::Value>(), ptr.offset};
+    }
+
 public:
     class const_iterator {
+        // iterators to the DG points-to set
+        PointsToSetT::const_iterator it;
+        PointsToSetT::const_iterator endIt;
         LLVMPointsToSetImpl *impl{nullptr};
 
+        // find next node that has associated llvm::Value
+        // (i.e. skip null, unknown, etc.)
+        void _findNextReal() {
+            while (it != endIt && !_isReal(*it))
+                ++it;
+        }
+
         // impl = null means end iterator
         void _check_end() {
             assert(impl);
@@ -319,7 +357,13 @@ public:
                 impl = nullptr;
         }
 
-        const_iterator(LLVMPointsToSetImpl *impl = nullptr) : impl(impl) {
+        const_iterator(const PointsToSetT& S, bool end)
+        : it(end ? S.end() : S.begin()), endIt(S.end()) {
+            _findNextReal();
+        }
+
+        const_iterator(LLVMPointsToSetImpl *impl)
+        : it(_emptyPTSet().begin()), endIt(_emptyPTSet().end()), impl(impl) {
             // the iterator (impl) may have been shifted during initialization
             // to the end() (because it contains no llvm::Values or the
             // ptset is empty)
@@ -329,8 +373,14 @@ public:
 
     public:
         const_iterator& operator++() {
-            impl->shift();
-            _check_end();
+            if (impl) {
+                impl->shift();
+                _check_end();
+            } else {
+                assert(it != endIt && "Tried to shift end() iterator");
+                ++it;
+                _findNextReal();
+            }
             return *this;
         }
 
@@ -341,20 +391,21 @@ public:
         }
 
         LLVMPointer operator*() const {
-            return impl->get();
+            if (impl)
+                return impl->get();
+            assert(it != endIt && "Dereferenced end() iterator");
+            return _toLLVM(*it);
         }
 
         bool operator==(const const_iterator& rhs) const {
-            if (!impl)
-                return !rhs.impl;
-            if (!rhs.impl)
-                return !impl;
-
-            assert(!impl->end() && rhs.impl->end());
-            assert(impl == rhs.impl && "Compared unrelated iterators"); // catch bugs
-            llvm::errs() << "CMP" << impl << "+" << impl->position() << " == "
-                                  << rhs.impl << "+" << rhs.impl->position() << "\n";
-            return impl == rhs.impl && impl->position() == rhs.impl->position();
+            if (impl || rhs.impl) {
+                // the implementation has only one position,
+                // so the iterators are either the same or one is end()
+                assert((!impl || !rhs.impl || impl == rhs.impl)
+                       && "Compared unrelated iterators"); // catch bugs
+                return impl == rhs.impl;
+            }
+            return it == rhs.it;
         }
 
         bool operator!=(const const_iterator& rhs) const { return !operator==(rhs);}
@@ -362,29 +413,78 @@ public:
         friend class LLVMPointsToSet;
     };
 
+    // a view of the set S (S must not change while the object is used)
+    LLVMPointsToSet(const PointsToSetT& S) : _pts(&S) {}
     LLVMPointsToSet(LLVMPointsToSetImpl *impl) : _impl(impl) {}
-    LLVMPointsToSet() = default;
+    LLVMPointsToSet() : _pts(&_emptyPTSet()) {}
     LLVMPointsToSet(LLVMPointsToSet&&) = default;
     LLVMPointsToSet& operator=(LLVMPointsToSet&&) = default;
 
+    // an object that owns a copy of the set S
+    static LLVMPointsToSet snapshot(const PointsToSetT& S) {
+        LLVMPointsToSet ret;
+        ret._owned.reset(new PointsToSetT(S));
+        ret._pts = ret._owned.get();
+        return ret;
+    }
+
+    // does the object own its set (or the implementation)?
+    bool isSnapshot() const { return _owned != nullptr || _impl != nullptr; }
+
+    // Copy the pointers of this set into a new object that does not
+    // refer to any data of the pointer analysis (not even to the
+    // global tables of the DG points-to sets), so the copy can be
+    // used while the pointer analysis is modified (e.g., from another
+    // thread). The iteration over the copy goes through virtual calls.
+    inline LLVMPointsToSet copy() const;
+
     ///
     // NOTE: this may not be O(1) operation
-    bool hasUnknown() const { return _impl->hasUnknown(); }
-    bool hasNull() const { return _impl->hasNull(); }
-    bool hasInvalidated() const { return _impl->hasInvalidated(); }
-    bool empty() const { return _impl->size() == 0; }
-    size_t size() const { return _impl->size(); }
+    bool hasUnknown() const { return _impl ? _impl->hasUnknown() : _pts->hasUnknown(); }
+    bool hasNull() const { return _impl ? _impl->hasNull() : _pts->hasNull(); }
+    bool hasInvalidated() const { return _impl ? _impl->hasInvalidated() : _pts->hasInvalidated(); }
+    size_t size() const { return _impl ? _impl->size() : _pts->size(); }
+    bool empty() const { return size() == 0; }
 
-    bool isSingleton() const { return _impl->size() == 1; }
+    bool isSingleton() const { return size() == 1; }
     bool isKnownSingleton() const { return isSingleton()
-                                    && !_impl->hasUnknown()
-                                    && !_impl->hasNull()
-                                    && !_impl->hasInvalidated(); }
+                                    && !hasUnknown()
+                                    && !hasNull()
+                                    && !hasInvalidated(); }
 
-    LLVMPointer getKnownSingleton() const { return _impl->getKnownSingleton(); }
+    LLVMPointer getKnownSingleton() const {
+        if (_impl)
+            return _impl->getKnownSingleton();
+        assert(isKnownSingleton());
+        return _toLLVM(*_pts->begin());
+    }
+
+    ///
+    // Store the pointers of this set (the same pointers as the iterators
+    // yield) into 'out'. The previous content of 'out' is dropped,
+    // but its memory is reused, so one vector can serve many queries.
+    void getPointers(std::vector<LLVMPointer>& out) const {
+        out.clear();
+        if (_impl) {
+            for (const auto& ptr : *this)
+                out.push_back(ptr);
+            return;
+        }
 
-    const_iterator begin() const { return const_iterator(_impl.get());}
-    const_iterator end() const { return const_iterator(nullptr); }
+        out.reserve(_pts->size());
+        for (const auto& ptr : *_pts) {
+            if (_isReal(ptr))
+                out.push_back(_toLLVM(ptr));
+        }
+    }
+
+    const_iterator begin() const {
+        return _impl ? const_iterator(_impl.get()) : const_iterator(*_pts, false);
+    }
+
+    const_iterator end() const {
+        return _impl ? const_iterator(nullptr) : const_iterator(*_pts, true);
+    }
 };
 
 
@@ -441,44 +541,42 @@ public:
     }
 };
 
-
-/// Implementation of LLVMPointsToSet that iterates
-//  over the DG's points-to set
-class DGLLVMPointsToSet : public LLVMPointsToSetImplTemplate<const PointsToSetT&> {
-
-    void _findNextReal() override {
-        while (it != PTSet.end() &&
-               (!(*it).isValid() || (*it).isInvalidated())) {
-            ++it;
-            ++_position;
-        }
-    }
+///
+// The implementation of LLVMPointsToSet that owns the pointers
+// (see LLVMPointsToSet::copy())
+class LLVMPointsToVector : public LLVMPointsToSetImpl {
+    std::vector<LLVMPointer> _pointers;
+    size_t _size;
+    bool _hasUnknown, _hasNull, _hasInvalidated;
+    size_t _position{0};
 
 public:
-    DGLLVMPointsToSet(const PointsToSetT& S) : LLVMPointsToSetImplTemplate(S) {
-        initialize_iterator();
+    LLVMPointsToVector(const LLVMPointsToSet& S)
+    : _size(S.size()), _hasUnknown(S.hasUnknown()),
+      _hasNull(S.hasNull()), _hasInvalidated(S.hasInvalidated()) {
+        S.getPointers(_pointers);
     }
 
-    ///
-    // NOTE: this may not be O(1) operation
-    bool hasUnknown() const override { return PTSet.hasUnknown(); }
-    bool hasNull() const override { return PTSet.hasNull(); }
-    bool hasInvalidated() const override { return PTSet.hasInvalidated(); }
-    size_t size() const override { return PTSet.size(); }
+    bool hasUnknown() const override { return _hasUnknown; }
+    bool hasNull() const override { return _hasNull; }
+    bool hasInvalidated() const override { return _hasInvalidated; }
+    size_t size() const override { return _size; }
 
     LLVMPointer getKnownSingleton() const override {
-        assert(isKnownSingleton());
-        auto ptr = (*(PTSet.begin()));
-        return LLVMPointer(ptr.target->getUserData<llvm::Value>(),
-                           ptr.offset);
+        assert(_size == 1 && _pointers.size() == 1);
+        return _pointers[0];
     }
 
-    LLVMPointer get() const override {
-        assert((it != PTSet.end()) && "Dereferenced end() iterator");
-        return LLVMPointer{(*it).target->getUserData<llvm::Value>(), (*it).offset};
-    }
+    int position() const override { return static_cast<int>(_position); }
+    bool end() const override { return _position >= _pointers.size(); }
+    void shift() override { ++_position; }
+    LLVMPointer get() const override { return _pointers[_position]; }
 };
 
+LLVMPointsToSet LLVMPointsToSet::copy() const {
+    return LLVMPointsToSet(new LLVMPointsToVector(*this));
+}
+
 } // namespace dg
 
 #endif // _LLVM_DG_POINTS_TO_SET_H_
@@ -31,6 +31,9 @@
 #include "dg/llvm/PointerAnalysis/LLVMPointerAnalysisOptions.h"
 #include "dg/llvm/PointerAnalysis/PointerGraph.h"
 #include "dg/llvm/PointerAnalysis/LLVMPointsToSet.h"
+#include "dg/llvm/PointerAnalysis/AliasQueries.h"
+
+#include "dg/util/Profiling.h"
 
 
 namespace dg {
@@ -43,6 +46,8 @@ using pta::Pointer;
 ///
 // Interface for LLVM pointer analysis
 class LLVMPointerAnalysis {
+    LLVMAliasQueries _aliasQueries;
+
 protected:
     const LLVMPointerAnalysisOptions options{};
 
@@ -88,6 +93,45 @@ public:
     std::pair<bool, LLVMMemoryRegionSet>
     getAccessedMemory(const llvm::Instruction *I);
 
+    ///
+    // Alias queries. The answers are memoized, so ask them only
+    // when the analysis has finished (or call clearAliasQueries()
+    // after the points-to sets have changed).
+    //
+    // May 'a' and 'b' point to the same memory object?
+    bool alias(const llvm::Value *a, const llvm::Value *b) {
+        return _aliasQueries.mayOverlap(this, LLVMAliasQuery(a, b));
+    }
+
+    // May the 'sizeA' bytes pointed by 'a' overlap with the 'sizeB'
+    // bytes pointed by 'b'? (0 or Offset::UNKNOWN is unknown size)
+    bool mayOverlap(const llvm::Value *a, Offset sizeA,
+                    const llvm::Value *b, Offset sizeB) {
+        return _aliasQueries.mayOverlap(this, LLVMAliasQuery(a, sizeA, b, sizeB));
+    }
+
+    // Answer alias() for every pair of values
+    std::vector<bool>
+    alias(const std::vector<std::pair<const llvm::Value *,
+                                      const llvm::Value *>>& pairs) {
+        std::vector<bool> result;
+        result.reserve(pairs.size());
+        for (const auto& p : pairs)
+            result.push_back(alias(p.first, p.second));
+        return result;
+    }
+
+    // Answer mayOverlap() for every query
+    std::vector<bool> mayOverlap(const std::vector<LLVMAliasQuery>& queries) {
+        std::vector<bool> result;
+        result.reserve(queries.size());
+        for (const auto& Q : queries)
+            result.push_back(_aliasQueries.mayOverlap(this, Q));
+        return result;
+    }
+
+    void clearAliasQueries() { _aliasQueries.clear(); }
+
     virtual bool run() = 0;
 
     virtual ~LLVMPointerAnalysis() = default;
@@ -187,6 +231,8 @@ class DGLLVMPointerAnalysis : public LLVMPointerAnalysis {
     PointerGraph *PS = nullptr;
     std::unique_ptr<pta::PointerAnalysis> PTA{}; // dg pointer analysis object
     std::unique_ptr<LLVMPointerGraphBuilder> _builder;
+    // are the points-to sets solved when queried? (see run())
+    mutable bool _demand{false};
 
     LLVMPointerAnalysisOptions createOptions(const char *entry_func,
                                              uint64_t field_sensitivity,
@@ -205,6 +251,28 @@ class DGLLVMPointerAnalysis : public LLVMPointerAnalysis {
         return _unknownPTSet;
     }
 
+    // solve the points-to set of the node if the analysis is demand-driven
+    void solveOnDemand(PSNode *node) const {
+        if (!_demand || !node || PTA->isDemandSolved(node))
+            return;
+
+        auto& profiler = debug::Profiler::get();
+        profiler.count("pta.demand", "queries");
+
+        bool solved;
+        {
+            debug::ScopedTimer timer("pta.demand");
+            solved = PTA->solveDemand(node, options.demandBudget);
+        }
+
+        if (!solved) {
+            // the query is too expensive, solve the whole graph
+            profiler.count("pta.demand", "fallbacks");
+            _demand = false;
+            PTA->run();
+        }
+    }
+
 public:
 
     DGLLVMPointerAnalysis(const llvm::Module *m,
@@ -220,7 +288,9 @@ public:
     // Get the node from pointer analysis that holds the points-to set.
     // See: getLLVMPointsTo()
     PSNode *getPointsToNode(const llvm::Value *val) const {
-        return _builder->getPointsToNode(val);
+        auto *node = _builder->getPointsToNode(val);
+        solveOnDemand(node);
+        return node;
     }
 
     pta::PointerAnalysis *getPTA() { return PTA.get(); }
@@ -242,18 +312,15 @@ public:
     // points-to set. Moreover, the object has methods hasUnknown()
     // and hasNull() that reflect whether the points-to set of the
     // LLVM value contains unknown element of null.
+    //
+    // The returned object references the points-to set of the analysis.
+    // If the analysis is demand-driven, later queries may still change
+    // the set, so the object gets a copy of the set instead.
     LLVMPointsToSet getLLVMPointsTo(const llvm::Value *val) override {
-        DGLLVMPointsToSet *pts;
-        if (auto node = getPointsToNode(val)) {
-            if (node->pointsTo.empty()) {
-                pts = new DGLLVMPointsToSet(getUnknownPTSet());
-            } else {
-                pts = new DGLLVMPointsToSet(node->pointsTo);
-            }
-        } else {
-            pts = new DGLLVMPointsToSet(getUnknownPTSet());
-        }
-        return pts->toLLVMPointsToSet();
+        const auto& S = getPointsToSet(val);
+        if (_demand)
+            return LLVMPointsToSet::snapshot(S);
+        return LLVMPointsToSet(S);
     }
 
     ///
@@ -263,22 +330,28 @@ public:
     // unknown element when the node does not exists)
     std::pair<bool, LLVMPointsToSet>
     getLLVMPointsToChecked(const llvm::Value *val) override {
-        DGLLVMPointsToSet *pts;
-        if (auto node = getPointsToNode(val)) {
-            if (node->pointsTo.empty()) {
-                pts = new DGLLVMPointsToSet(getUnknownPTSet());
-                return {false, pts->toLLVMPointsToSet()};
-            } else {
-                pts = new DGLLVMPointsToSet(node->pointsTo);
-                return {true, pts->toLLVMPointsToSet()};
-            }
-        } else {
-            pts = new DGLLVMPointsToSet(getUnknownPTSet());
-            return {false, pts->toLLVMPointsToSet()};
+        auto node = getPointsToNode(val);
+        if (node && !node->pointsTo.empty()) {
+            if (_demand)
+                return {true, LLVMPointsToSet::snapshot(node->pointsTo)};
+            return {true, LLVMPointsToSet(node->pointsTo)};
         }
+        return {false, LLVMPointsToSet(getUnknownPTSet())};
+    }
+
+    ///
+    // Get the DG points-to set of the value (a set with the only element
+    // unknown if there is no or empty points-to set for the value).
+    // The set is owned by the pointer analysis. If the analysis is
+    // demand-driven, the set may change with the next query.
+    const PointsToSetT& getPointsToSet(const llvm::Value *val) const {
+        auto node = getPointsToNode(val);
+        if (node && !node->pointsTo.empty())
+            return node->pointsTo;
+        return getUnknownPTSet();
     }
 
-    const std::vector<std::unique_ptr<PSNode>>& getNodes()
+    const PointerGraph::NodesT& getNodes()
     {
         return PS->getNodes();
     }
@@ -298,12 +371,18 @@ public:
         // run the analysis itself
         assert(_builder && "Incorrectly constructed PTA, missing builder");
 
+        debug::ScopedTimer timer("pta.build");
         PS = _builder->buildLLVMPointerGraph();
         if (!PS) {
             llvm::errs() << "Pointer Subgraph was not built, aborting\n";
             abort();
         }
 
+        auto& profiler = debug::Profiler::get();
+        profiler.count("pta.build", "nodes", PS->size());
+        profiler.count("pta.build", "subgraphs", PS->getSubgraphs().size());
+        profiler.count("pta.build", "clones", _builder->getClonesNum());
+
 /*
         pta::PointerGraphOptimizer optimizer(PS);
         optimizer.run();
@@ -353,7 +432,21 @@ public:
         if (!PTA) {
             initialize();
         }
-        return PTA->run();
+        clearAliasQueries();
+
+        if (options.demandDriven && options.contextDepth == 0 &&
+            PTA->initializeDemand()) {
+            // the points-to sets are solved in getPointsToNode()
+            _demand = true;
+            return true;
+        }
+
+        _demand = false;
+        bool ret = PTA->run();
+        // the values from cloned functions are queried
+        // via nodes with points-to sets merged over all contexts
+        _builder->mergeClonedPointsTo();
+        return ret;
     }
 };
 
@@ -1,7 +1,9 @@
 #ifndef _LLVM_DG_POINTER_SUBGRAPH_H_
 #define _LLVM_DG_POINTER_SUBGRAPH_H_
 
+#include <memory>
 #include <unordered_map>
+#include <unordered_set>
 
 // ignore unused parameters in LLVM libraries
 #if (__clang__)
@@ -26,6 +28,7 @@
 #endif
 
 #include "dg/llvm/PointerAnalysis/LLVMPointerAnalysisOptions.h"
+#include "dg/llvm/LLVMFunctionModels.h"
 
 #include "dg/PointerAnalysis/PointerGraph.h"
 #include "dg/PointerAnalysis/PointsToMapping.h"
@@ -44,6 +47,8 @@ class LLVMPointerGraphBuilder
 
     const llvm::Module *M;
     LLVMPointerAnalysisOptions _options;
+    // allocation functions resolved for the functions of the module
+    LLVMFunctionModels _models;
 
     // flag that says whether we are building normally,
     // or the analysis is already running and we are building
@@ -156,6 +161,68 @@ class LLVMPointerGraphBuilder
 
     std::unordered_map<const llvm::Function *, FuncGraph> _funcInfo;
 
+    using NodesMapT = std::unordered_map<const llvm::Value *, PSNodesSeq>;
+
+    // A copy of the subgraph of a function that is built for one
+    // calling context (see LLVMPointerAnalysisOptions::contextDepth).
+    // The clone is connected only to the call-site it was built for.
+    struct FunctionClone {
+        const llvm::Function *function;
+        // the length of the call-string of this clone
+        const unsigned depth;
+        PointerSubgraph *subgraph{nullptr};
+        // the nodes of the instructions and arguments of the clone
+        NodesMapT nodes{};
+        FuncGraph funcInfo{};
+
+        FunctionClone(const llvm::Function *F, unsigned d)
+        : function(F), depth(d) {}
+    };
+
+    std::vector<std::unique_ptr<FunctionClone>> _clones;
+    std::unordered_map<const PointerSubgraph *, FunctionClone *> _clonesMap;
+    // the clone that we are building right now (or nullptr)
+    FunctionClone *_clone{nullptr};
+    // calls in the context-insensitive subgraphs that call a clone
+    std::unordered_set<const llvm::CallInst *> _clonedCalls;
+    // memoized results of isCloneCandidate()
+    std::unordered_map<const llvm::Function *, bool> _cloneCandidates;
+    // the number of nodes in clones (an estimate for unfinished clones)
+    size_t _clonedNodes{0};
+    // nodes with points-to sets of values from the cloned functions
+    // merged over all the contexts
+    std::unordered_map<const llvm::Value *, PSNode *> _mergedNodes;
+
+    bool isCloneCandidate(const llvm::Function *F);
+    bool isAllocationWrapper(const llvm::Function *F);
+    bool shouldClone(const llvm::Function *F);
+    PointerSubgraph& buildClone(const llvm::Function *F);
+    void addCloneOperands(FunctionClone *clone, const llvm::CallInst *CI,
+                          PSNode *callNode);
+
+    FuncGraph& getFuncInfo(const llvm::Function *F) {
+        if (_clone && _clone->function == F)
+            return _clone->funcInfo;
+        return _funcInfo[F];
+    }
+
+    // the map where we store (and look for) the nodes of 'val'.
+    // The instructions and arguments of the function that is being
+    // cloned are stored only in the clone.
+    NodesMapT& nodesMapFor(const llvm::Value *val) {
+        if (_clone) {
+            const llvm::Function *F = nullptr;
+            if (auto *I = llvm::dyn_cast<llvm::Instruction>(val))
+                F = I->getParent()->getParent();
+            else if (auto *A = llvm::dyn_cast<llvm::Argument>(val))
+                F = A->getParent();
+
+            if (F == _clone->function)
+                return _clone->nodes;
+        }
+        return nodes_map;
+    }
+
     // build pointer state subgraph for given graph
     // \return   root node of the graph
     PointerSubgraph& buildFunction(const llvm::Function& F);
@@ -183,7 +250,7 @@ class LLVMPointerGraphBuilder
                              PSNodesBlock& argsBlk, PointerSubgraph& subg);
 
     // map of all nodes we created - use to look up operands
-    std::unordered_map<const llvm::Value *, PSNodesSeq> nodes_map;
+    NodesMapT nodes_map;
     // map of all built subgraphs - the value type is a pair (root, return)
     std::unordered_map<const llvm::Function *, PointerSubgraph *> subgraphs_map;
 
@@ -196,7 +263,7 @@ public:
     inline bool threads() const { return threads_; }
 
     LLVMPointerGraphBuilder(const llvm::Module *m, const LLVMPointerAnalysisOptions& opts)
-        : M(m), _options(opts), threads_(opts.threads) {}
+        : M(m), _options(opts), _models(m, _options), threads_(opts.threads) {}
 
     PointerGraph *buildLLVMPointerGraph();
 
@@ -267,6 +334,14 @@ public:
 
     PointerSubgraph *getSubgraph(const llvm::Function *);
 
+    // Set the points-to sets of the values from cloned functions
+    // to the union over all the clones (and the context-insensitive
+    // copy of the function), so that getPointsToNode() returns
+    // a sound result for them. Call this after the analysis finished.
+    void mergeClonedPointsTo();
+
+    size_t getClonesNum() const { return _clones.size(); }
+
 private:
 
     // create subgraph of function @F (the nodes)
@@ -293,8 +368,9 @@ private:
 
     // get the built nodes for this value or null
     PSNodesSeq *getNodes(const llvm::Value *val) {
-        auto it = nodes_map.find(val);
-        if (it == nodes_map.end())
+        auto& nodes = nodesMapFor(val);
+        auto it = nodes.find(val);
+        if (it == nodes.end())
             return nullptr;
 
         // the node corresponding to the real llvm value
@@ -303,17 +379,19 @@ private:
     }
 
     PSNodesSeq& addNode(const llvm::Value *val, PSNode *node) {
-        assert(nodes_map.find(val) == nodes_map.end());
-        auto it = nodes_map.emplace(val, node);
+        auto& nodes = nodesMapFor(val);
+        assert(nodes.find(val) == nodes.end());
+        auto it = nodes.emplace(val, node);
         node->setUserData(const_cast<llvm::Value *>(val));
 
         return it.first->second;
     }
 
     PSNodesSeq& addNode(const llvm::Value *val, PSNodesSeq seq) {
-        assert(nodes_map.find(val) == nodes_map.end());
+        auto& nodes = nodesMapFor(val);
+        assert(nodes.find(val) == nodes.end());
         seq.getRepresentant()->setUserData(const_cast<llvm::Value *>(val));
-        auto it = nodes_map.emplace(val, std::move(seq));
+        auto it = nodes.emplace(val, std::move(seq));
 
         return it.first->second;
     }
@@ -392,6 +470,10 @@ private:
     PSNodesSeq& createFuncptrCall(const llvm::CallInst *, const llvm::Value *);
 
     PointerSubgraph& createOrGetSubgraph(const llvm::Function *);
+    // create or get the subgraph that should be called from 'CInst'
+    // (this may be a new clone of the subgraph)
+    PointerSubgraph& createOrGetSubgraph(const llvm::Function *,
+                                         const llvm::CallInst *CInst);
     PointerSubgraph& getAndConnectSubgraph(const llvm::Function *F,
                                            const llvm::CallInst *CInst,
                                            PSNode *callNode);
@@ -2,7 +2,6 @@
 #define DG_LLVM_SYSTEM_DEPENDENCE_GRAPH_BUILDER_H_
 
 #include <string>
-#include <ctime> // std::clock
 
 // ignore unused parameters in LLVM libraries
 #if (__clang__)
@@ -35,6 +34,7 @@
 #include "dg/PointerAnalysis/PointerAnalysisFSInv.h"
 #include "dg/PointerAnalysis/Pointer.h"
 #include "dg/Offset.h"
+#include "dg/util/Profiling.h"
 
 namespace llvm {
     class Module;
@@ -56,58 +56,50 @@ class SystemDependenceGraphBuilder {
     std::unique_ptr<ControlFlowGraph> _controlFlowGraph{};
     llvm::Function *_entryFunction{nullptr};
 
+    // wall-clock times of the analyses in seconds
+    // (also reported to debug::Profiler)
     struct Statistics {
-        uint64_t cdTime{0};
-        uint64_t ptaTime{0};
-        uint64_t rdaTime{0};
-        uint64_t inferaTime{0};
-        uint64_t joinsTime{0};
-        uint64_t critsecTime{0};
+        double cdTime{0};
+        double ptaTime{0};
+        double rdaTime{0};
+        double inferaTime{0};
+        double joinsTime{0};
+        double critsecTime{0};
     } _statistics;
 
-    std::clock_t _time_start;
-    void _timerStart() { _time_start = std::clock(); }
-    uint64_t _timerEnd() { return (std::clock() - _time_start); }
-
     void _runPointerAnalysis() {
         assert(_PTA && "BUG: No PTA");
 
-        _timerStart();
+        debug::ScopedTimer timer("pta", &_statistics.ptaTime);
         _PTA->run();
-        _statistics.ptaTime = _timerEnd();
     }
 
     void _runDataDependenceAnalysis() {
         assert(_DDA && "BUG: No RD");
 
-        _timerStart();
+        debug::ScopedTimer timer("dda", &_statistics.rdaTime);
         _DDA->run();
-        _statistics.rdaTime = _timerEnd();
     }
 
     void _runControlDependenceAnalysis() {
-        _timerStart();
+        debug::ScopedTimer timer("cda", &_statistics.cdTime);
         _sdg->computeControlDependencies(_options.cdAlgorithm,
                                         _options.interprocCd);
-        _statistics.cdTime = _timerEnd();
     }
 
     void _runInterferenceDependenceAnalysis() {
-        _timerStart();
+        debug::ScopedTimer timer("interference", &_statistics.inferaTime);
         _sdg->computeInterferenceDependentEdges(_controlFlowGraph.get());
-        _statistics.inferaTime = _timerEnd();
     }
 
     void _runForkJoinAnalysis() {
-        _timerStart();
+        debug::ScopedTimer timer("forkjoin", &_statistics.joinsTime);
         _sdg->computeForkJoinDependencies(_controlFlowGraph.get());
-        _statistics.joinsTime = _timerEnd();
     }
 
     void _runCriticalSectionAnalysis() {
-        _timerStart();
+        debug::ScopedTimer timer("critsec", &_statistics.critsecTime);
         _sdg->computeCriticalSections(_controlFlowGraph.get());
-        _statistics.critsecTime = _timerEnd();
     }
 
     bool verify() const {
@@ -1,18 +1,56 @@
 #ifndef MAYHAPPENINPARALLEL_H
 #define MAYHAPPENINPARALLEL_H
 
+#include <cstdint>
 #include <set>
+#include <unordered_map>
+#include <vector>
 
 #include "ThreadRegion.h"
 
+/**
+ * @brief May-happen-in-parallel relation of thread regions.
+ *
+ * The thread started by a fork may run in parallel with everything that
+ * the parent thread (and the threads it forks) can execute after the fork
+ * and before the join that waits for the thread. The join is taken into
+ * account only when it surely waits for every instance of the thread,
+ * i.e., when the join matches only this fork, the fork cannot be executed
+ * again before the join and the thread does not fork any other threads
+ * (that could outlive it).
+ *
+ * The regions get dense indices (ordered by their ids) and the relation
+ * is stored as a symmetric bit matrix, so the queries take constant time.
+ */
 class MayHappenInParallel
 {
 private:
-    std::set<ThreadRegion *> threadRegions_;
+    std::vector<ThreadRegion *>                             regions_;
+    std::unordered_map<const ThreadRegion *, unsigned>      indices_;
+    std::size_t                                             rowWords_ = 0;
+    std::vector<uint64_t>                                   matrix_;
+
+    uint64_t * row(unsigned index) { return matrix_.data() + index * rowWords_; }
+    const uint64_t * row(unsigned index) const { return matrix_.data() + index * rowWords_; }
+
+    void compute();
+
 public:
     MayHappenInParallel(std::set<ThreadRegion *> threadRegions);
 
     std::set<ThreadRegion *> parallelRegions(ThreadRegion * threadRegion);
+
+    bool mayHappenInParallel(const ThreadRegion * lhs, const ThreadRegion * rhs) const;
+
+    std::size_t size() const { return regions_.size(); }
+
+    unsigned index(const ThreadRegion * threadRegion) const;
+
+    ThreadRegion * region(unsigned index) const { return regions_[index]; }
+
+    bool parallel(unsigned lhs, unsigned rhs) const {
+        return (row(lhs)[rhs / 64] >> (rhs % 64)) & 1;
+    }
 };
 
 #endif // MAYHAPPENINPARALLEL_H
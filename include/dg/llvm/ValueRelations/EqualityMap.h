@@ -3,6 +3,10 @@
 
 #include <memory>
 #include <cassert>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
 
 #ifndef NDEBUG
 #include "getValName.h"
@@ -14,6 +18,19 @@ namespace llvm {
 
 namespace dg {
 
+///
+// Equivalence classes of values. Every value is mapped to its class
+// and the members of a class share one (immutable) set.
+//
+// The map is persistent: it is a chain of layers where every layer
+// stores only the values whose class changed in it (a delta over its
+// parent). A copy of the map shares the whole chain and when a map
+// with a shared top layer is modified, a new layer is put on the top
+// of the chain, so the locations of value relations that are copies of
+// each other share everything but their own changes. Adding a map that
+// shares a part of the chain with this map walks only the layers of
+// the other map above the shared part. The chain is flattened when it
+// gets too long, so that the queries stay fast.
 template <typename T>
 class EqualityMap {
     struct _Cmp {
@@ -23,67 +40,205 @@ class EqualityMap {
         }
     };
 
+public:
     using SetT = std::set<T, _Cmp>;
-    using ClassT = std::shared_ptr<SetT>;
-    std::map<T, ClassT, _Cmp> _map;
-
-    // FIXME: use variadic templates
-    ClassT newClass(const T& a, const T& b) {
-        auto cls = ClassT(new SetT());
-        cls->insert(a);
-        cls->insert(b);
-        return cls;
+
+private:
+    using ClassT = std::shared_ptr<const SetT>;
+
+    // the maximal number of layers under the top layer
+    static const unsigned MAX_DEPTH = 16;
+
+    struct Layer {
+        std::shared_ptr<const Layer> parent;
+        // the classes of the values changed in this layer,
+        // nullptr if the value was removed from the map
+        std::unordered_map<T, ClassT> classes;
+        // the number of layers under this one
+        unsigned depth{0};
+        // the number of values in the map
+        size_t size{0};
+        // was some class shrunk (or a value removed) in this layer?
+        bool shrinks{false};
+    };
+
+    // the top layer, it is modified in place if it is not shared
+    std::shared_ptr<Layer> _top;
+
+    const Layer *_get() const { return _top.get(); }
+
+    // return the entry of the value, nullptr if the value
+    // is not in any layer (the entry itself may be nullptr)
+    static const ClassT *_find(const Layer *L, const T& a) {
+        for (; L; L = L->parent.get()) {
+            auto it = L->classes.find(a);
+            if (it != L->classes.end())
+                return &it->second;
+        }
+        return nullptr;
     }
 
-    ClassT newClass(const T& a) {
-        auto cls = ClassT(new SetT());
-        cls->insert(a);
-        return cls;
+    const SetT *_getClass(const T& a) const {
+        auto cls = _find(_get(), a);
+        return cls ? cls->get() : nullptr;
     }
 
-public:
-    bool add(const T& a, const T& b) {
-        auto itA = _map.find(a);
-        auto itB = _map.find(b);
-        if (itA == _map.end()) {
-            if (itB == _map.end()) {
-                if (a == b) {
-                    auto newcls = newClass(a);
-                    _map[a] = newcls;
-                    assert(newcls.use_count() == 2);
-                } else {
-                    auto newcls = newClass(a, b);
-                    _map[b] = newcls;
-                    _map[a] = newcls;
-                    assert(newcls.use_count() == 3);
-                }
+    std::shared_ptr<Layer> _flatten() const {
+        auto flat = std::make_shared<Layer>();
+        flat->size = _top->size;
+        flat->classes.reserve(_top->size);
+        for (const auto& it : *this) {
+            flat->classes.emplace(it.first, *_find(_get(), it.first));
+        }
+        assert(flat->classes.size() == flat->size);
+        return flat;
+    }
+
+    // get the top layer for modification
+    Layer& _mutable() {
+        if (!_top) {
+            _top = std::make_shared<Layer>();
+        } else if (_top.use_count() > 1) {
+            if (_top->depth >= MAX_DEPTH) {
+                _top = _flatten();
             } else {
-                auto B = itB->second;
-                B->insert(a);
-                _map[a] = B;
+                auto layer = std::make_shared<Layer>();
+                layer->depth = _top->depth + 1;
+                layer->size = _top->size;
+                layer->parent = std::move(_top);
+                _top = std::move(layer);
             }
-        } else {
-            auto A = itA->second;
-            if (itB == _map.end()) {
-                A->insert(b);
-                _map[b] = A;
-            } else {
-                // merge of classes
-                auto B = itB->second;
-                if (A == B)
+        }
+        return *_top;
+    }
+
+    void _setClass(Layer& L, const ClassT& cls) {
+        for (const auto& val : *cls)
+            L.classes[val] = cls;
+    }
+
+    // the top-most layer shared by this map and rhs
+    // (nullptr if there is no such layer)
+    const Layer *_commonLayer(const EqualityMap& rhs) const {
+        const Layer *ours = _get();
+        const Layer *theirs = rhs._get();
+        // the layers form a tree, so get to the same depth
+        // and then go up until the chains meet
+        while (ours && theirs && ours->depth != theirs->depth) {
+            if (ours->depth > theirs->depth)
+                ours = ours->parent.get();
+            else
+                theirs = theirs->parent.get();
+        }
+        while (ours != theirs) {
+            ours = ours->parent.get();
+            theirs = theirs->parent.get();
+        }
+        return ours;
+    }
+
+    // does any layer of this map above 'common' shrink a class?
+    bool _shrinksAbove(const Layer *common) const {
+        for (const Layer *L = _get(); L != common; L = L->parent.get()) {
+            if (L->shrinks)
+                return true;
+        }
+        return false;
+    }
+
+    // add all classes (of rhs) that are in the layers above 'until'
+    bool _addClasses(const EqualityMap& rhs, const Layer *until) {
+        bool changed = false;
+        std::set<const SetT *> added;
+        for (const Layer *L = rhs._get(); L != until; L = L->parent.get()) {
+            for (const auto& it : L->classes) {
+                auto cls = rhs._getClass(it.first);
+                if (!cls || !added.insert(cls).second)
+                    continue;
+                changed |= add(*cls->begin(), *cls);
+            }
+        }
+        return changed;
+    }
+
+public:
+    class const_iterator {
+        const Layer *_top{nullptr};
+        const Layer *_layer{nullptr};
+        typename std::unordered_map<T, ClassT>::const_iterator _it;
+
+        // is the entry not overwritten by an upper layer
+        // (and the value is not removed)?
+        bool _visible() const {
+            if (!_it->second)
+                return false;
+            for (const Layer *L = _top; L != _layer; L = L->parent.get()) {
+                if (L->classes.count(_it->first) > 0)
                     return false;
+            }
+            return true;
+        }
 
-                for (auto& val : *B.get()) {
-                    A->insert(val);
-                    _map[val] = A;
-                }
-                assert(B.use_count() == 1);
-                A->insert(b);
-                assert(_map[b] == A);
+        void _skip() {
+            while (_layer) {
+                while (_it != _layer->classes.end() && !_visible())
+                    ++_it;
+                if (_it != _layer->classes.end())
+                    return;
+                _layer = _layer->parent.get();
+                if (_layer)
+                    _it = _layer->classes.begin();
+            }
+        }
+
+    public:
+        const_iterator() = default;
+        const_iterator(const Layer *top) : _top(top), _layer(top) {
+            if (_layer) {
+                _it = _layer->classes.begin();
+                _skip();
             }
         }
 
-        assert(!_map.empty());
+        // pairs (value, the class of the value)
+        std::pair<T, const SetT *> operator*() const {
+            return {_it->first, _it->second.get()};
+        }
+
+        const_iterator& operator++() { ++_it; _skip(); return *this; }
+        bool operator==(const const_iterator& rhs) const {
+            return _layer == rhs._layer && (!_layer || _it == rhs._it);
+        }
+        bool operator!=(const const_iterator& rhs) const { return !operator==(rhs); }
+    };
+
+    bool add(const T& a, const T& b) {
+        auto A = _getClass(a);
+        auto B = _getClass(b);
+        if (A && A == B)
+            return false;
+        if (a == b && A)
+            return false;
+
+        auto& L = _mutable();
+        std::shared_ptr<SetT> cls;
+        if (A) {
+            cls = std::make_shared<SetT>(*A);
+        } else {
+            cls = std::make_shared<SetT>();
+            cls->insert(a);
+            ++L.size;
+        }
+
+        if (B) {
+            cls->insert(B->begin(), B->end());
+        } else if (a != b) {
+            cls->insert(b);
+            ++L.size;
+        }
+
+        _setClass(L, cls);
+
         assert(get(a) != nullptr);
         assert(get(a) == get(b));
         assert(get(a)->count(a) > 0);
@@ -92,68 +247,92 @@ public:
     }
 
     bool add(const EqualityMap& rhs) {
-        bool changed = false;
-        // FIXME: not very efficient
-        for (auto& it : rhs._map) {
-            for (auto& eq : *it.second.get()) {
-                changed |= add(it.first, eq);
-            }
+        if (rhs.empty() || rhs._top == _top)
+            return false;
+
+        // share the data with rhs
+        if (empty()) {
+            _top = rhs._top;
+            return true;
         }
 
-        return changed;
+        // we have all that is in the shared layer, unless we removed
+        // something from it, so take only the changes above the layer
+        auto common = _commonLayer(rhs);
+        if (common && !_shrinksAbove(common))
+            return _addClasses(rhs, common);
+
+        return _addClasses(rhs, nullptr);
     }
 
     bool add(const T& a, const SetT& S) {
+        // the set may belong to this map and adding may release it
+        const SetT tmp(S);
         bool changed = false;
-        for (auto eq : S) {
+        for (auto eq : tmp) {
             changed |= add(a, eq);
         }
 
         return changed;
     }
 
-    SetT *get(const T& a) {
-        auto it = _map.find(a);
-        if (it == _map.end()) {
-            return nullptr;
-        }
-        return it->second.get();
-    }
-
-    SetT *get(const T& a) const {
-        auto it = _map.find(a);
-        if (it == _map.end()) {
-            return nullptr;
-        }
-        return it->second.get();
+    const SetT *get(const T& a) const {
+        return _getClass(a);
     }
 
     void intersect(const EqualityMap& rhs) {
-        EqualityMap tmp;
-        for (auto& it : rhs) {
-            auto ourS = get(it.first);
-            if (!ourS)
+        if (rhs._top == _top || empty())
+            return;
+
+        // the new classes for pairs (our class, class of rhs),
+        // so that the values in the same new class share it
+        std::map<std::pair<const SetT *, const SetT *>, ClassT> newClasses;
+        std::vector<std::pair<T, ClassT>> changes;
+        for (const auto& it : *this) {
+            auto rhsCls = rhs.get(it.first);
+            if (!rhsCls) {
+                changes.emplace_back(it.first, nullptr);
                 continue;
+            }
 
-            for (auto x : *ourS) {
-                if (it.second->count(x) > 0)
-                    tmp.add(it.first, x);
+            auto& cls = newClasses[{it.second, rhsCls}];
+            if (!cls) {
+                auto S = std::make_shared<SetT>();
+                for (auto x : *it.second) {
+                    if (rhsCls->count(x) > 0)
+                        S->insert(x);
+                }
+                cls = std::move(S);
             }
+
+            if (cls->size() != it.second->size())
+                changes.emplace_back(it.first, cls);
         }
 
-        _map.swap(tmp._map);
+        if (changes.empty())
+            return;
+
+        auto& L = _mutable();
+        L.shrinks = true;
+        for (auto& change : changes) {
+            if (!change.second)
+                --L.size;
+            L.classes[change.first] = std::move(change.second);
+        }
     }
 
-    auto begin() -> decltype(_map.begin()) { return _map.begin(); }
-    auto end() -> decltype(_map.end()) { return _map.end(); }
-    auto begin() const -> decltype(_map.begin()) { return _map.begin(); }
-    auto end() const -> decltype(_map.end()) { return _map.end(); }
+    bool empty() const { return !_top || _top->size == 0; }
+
+    size_t size() const { return _top ? _top->size : 0; }
+
+    const_iterator begin() const { return const_iterator(_get()); }
+    const_iterator end() const { return const_iterator(); }
 
 #ifndef NDEBUG
     void dump() const {
-        std::set<SetT*> classes;
-        for (const auto& it : _map) {
-            classes.insert(it.second.get());
+        std::set<const SetT*> classes;
+        for (const auto& it : *this) {
+            classes.insert(it.second);
         }
 
         if (classes.empty()) {
@@ -120,8 +120,8 @@ struct VRLocation  {
 
     void transitivelyClose() {
         // add all equalities into relations
-        for (auto& it : equalities) {
-            for (auto& it2 : *(it.second.get()))
+        for (const auto& it : equalities) {
+            for (auto& it2 : *it.second)
                 relations.add(VRRelation::Eq(it.first, it2));
         }
 
@@ -3,6 +3,7 @@
 
 #include <memory>
 #include <cassert>
+#include <set>
 
 #ifndef NDEBUG
 #include "getValName.h"
@@ -17,6 +18,8 @@ namespace dg {
 class ReadsMap {
     // pair (a,b) such that b = load a in the future
     std::map<const llvm::Value *, const llvm::Value *> _map;
+    // reads whose value kept changing, we do not track them anymore
+    std::set<const llvm::Value *> _widened;
 
 public:
     auto begin() -> decltype(_map.begin()) { return _map.begin(); }
@@ -26,6 +29,9 @@ public:
 
     bool add(const llvm::Value *from, const llvm::Value *val) {
         assert(val != nullptr);
+        if (!_widened.empty() && _widened.count(from) > 0)
+            return false;
+
         auto it = _map.find(from);
         if (it == _map.end()) {
             _map.emplace_hint(it, from, val);
@@ -55,6 +61,12 @@ public:
         return it->second;
     }
 
+    // forget the read from 'from' for good
+    void widen(const llvm::Value *from) {
+        _map.erase(from);
+        _widened.insert(from);
+    }
+
     void intersect(const ReadsMap& rhs) {
         decltype(_map) tmp;
         for (auto& it : rhs._map) {
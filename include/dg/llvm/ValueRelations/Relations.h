@@ -1,8 +1,13 @@
 #ifndef _DG_LLVM_RELATIONS_H_
 #define _DG_LLVM_RELATIONS_H_
 
+#include <algorithm>
+#include <map>
 #include <memory>
 #include <cassert>
+#include <cstdint>
+#include <set>
+#include <vector>
 
 #ifndef NDEBUG
 #include "getValName.h"
@@ -139,33 +144,40 @@ public:
 
 /// Set of relations for one value
 class Relations {
+    using Entry = std::pair<VRRelationType, const llvm::Value *>;
+
     // this value is in relation with values in rhs
     const llvm::Value *value;
-    // one set for each type of relation
-    std::set<const llvm::Value *> rhs[7]{{}};
+    // pairs (type of relation, rhs) sorted by the type and rhs
+    std::vector<Entry> rhs;
 
 public:
     Relations(const llvm::Value *v) : value(v) {}
 
+    const llvm::Value *getValue() const { return value; }
+
     bool add(const VRRelation& rel) {
         assert(rel.getRelation() != VRRelationType::NONE);
         assert(rel.getLHS() == value);
-        return rhs[rel.getRelation()].insert(rel.getRHS()).second;
+        Entry entry{rel.getRelation(), rel.getRHS()};
+        auto it = std::lower_bound(rhs.begin(), rhs.end(), entry);
+        if (it != rhs.end() && *it == entry)
+            return false;
+        rhs.insert(it, entry);
+        return true;
     }
 
     bool add(const Relations& oth) {
         bool changed = false;
-        for (int i = 0; i < 7; ++i) {
-            for (auto& it : oth.rhs[i])
-                changed |= rhs[i].insert(it).second;
-        }
+        for (const auto& entry : oth.rhs)
+            changed |= add(VRRelation(entry.first, value, entry.second));
 
         return changed;
     }
 
     bool has(VRRelationType t, const llvm::Value *x) const {
         assert(t > 0 && t < 7);
-        return rhs[t].count(x) > 0;
+        return std::binary_search(rhs.begin(), rhs.end(), Entry{t, x});
     }
 
     bool has(const VRRelation& rel) const {
@@ -174,64 +186,34 @@ public:
     }
 
     struct const_iterator {
-        unsigned idx;
         const Relations& relations;
-        std::set<const llvm::Value *>::const_iterator it;
+        std::vector<Entry>::const_iterator it;
 
-        const_iterator(const Relations& r, unsigned idx)
-        : idx(idx), relations(r) {
-            if (idx < 7) {
-                it = relations.rhs[idx].begin();
-                _get_next();
-            }
-        }
+        const_iterator(const Relations& r, std::vector<Entry>::const_iterator it)
+        : relations(r), it(it) {}
 
         VRRelation operator*() const {
-            return VRRelation(static_cast<VRRelationType>(idx),
-                              relations.value, *it);
+            return VRRelation(it->first, relations.value, it->second);
         }
 
         const_iterator& operator++() {
             ++it;
-            _get_next();
             return *this;
         }
 
-        bool operator==(const const_iterator& rhs) const {
-            if (idx < 7) {
-                return idx == rhs.idx ? it == rhs.it : false;
-            }
-
-            return idx == rhs.idx;
-        }
-
+        bool operator==(const const_iterator& rhs) const { return it == rhs.it; }
         bool operator!=(const const_iterator& rhs) const { return !operator==(rhs); }
-    private:
-        void _get_next() {
-            while (idx < 7) {
-                if (it == relations.rhs[idx].end())
-                    ++idx;
-                else
-                    break;
-                if (idx >= 7)
-                    break;
-                it = relations.rhs[idx].begin();
-            }
-        }
     };
 
-    const_iterator begin() const { return const_iterator(*this, 1); }
-    const_iterator end() const { return const_iterator(*this, 7); }
+    const_iterator begin() const { return const_iterator(*this, rhs.begin()); }
+    const_iterator end() const { return const_iterator(*this, rhs.end()); }
 
 
 #ifndef NDEBUG
     void dump() const {
-        for (int i = 1; i < 7; ++i) {
-            for (const auto& r : rhs[i]) {
-                VRRelation(static_cast<VRRelationType>(i),
-                           value, r).dump();
-                std::cout << "\n";
-            }
+        for (const auto& r : *this) {
+            r.dump();
+            std::cout << "\n";
         }
     }
 #endif // NDEBUG
@@ -242,8 +224,194 @@ class RelationsMap {
     // with each relation, add also all relations that follow from transitivity.
     // NOTE: this may cause big overhead
     bool _keep_transitively_closed{false};
-    std::map<const llvm::Value *, Relations> relations;
 
+    ///
+    // The map from values to their relations is a persistent hash array
+    // mapped trie: every node has up to 32 slots that are indexed by
+    // 5 bits of the hash of the value and a slot holds either a subtree
+    // or the relations of one value. The nodes and the relations are
+    // shared by copies of the map and a modification copies only the path
+    // from the root to the modified relations (the nodes that are not
+    // shared are modified in place). So copying the map takes constant time
+    // and adding a map that shares subtrees with this map skips the shared
+    // subtrees.
+    struct Node;
+    using NodePtr = std::shared_ptr<Node>;
+    using RelationsPtr = std::shared_ptr<Relations>;
+
+    struct Slot {
+        NodePtr child;
+        // the relations of a value (if child is nullptr)
+        RelationsPtr relations;
+    };
+
+    struct Node {
+        uint32_t bitmap{0};
+        // the used slots ordered by their index
+        std::vector<Slot> slots;
+
+        unsigned position(unsigned idx) const {
+            return __builtin_popcount(bitmap & ((1u << idx) - 1));
+        }
+
+        bool has(unsigned idx) const { return bitmap & (1u << idx); }
+    };
+
+    NodePtr _root;
+    size_t _size{0};
+
+    static const unsigned BITS = 5;
+
+    // the hash must be a bijection on 64 bits, so that two values differ
+    // at some level of the trie (the trie has 64/BITS + 1 levels)
+    static uint64_t _hash(const llvm::Value *v) {
+        auto h = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(v));
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    static unsigned _index(uint64_t hash, unsigned shift) {
+        return (hash >> shift) & ((1u << BITS) - 1);
+    }
+
+    // copy the object if it is shared
+    template <typename T>
+    static T& _own(std::shared_ptr<T>& ptr) {
+        if (ptr.use_count() > 1)
+            ptr = std::make_shared<T>(*ptr);
+        return *ptr;
+    }
+
+    const Relations *_find(const llvm::Value *v) const {
+        const Node *N = _root.get();
+        auto hash = _hash(v);
+        for (unsigned shift = 0; N; shift += BITS) {
+            auto idx = _index(hash, shift);
+            if (!N->has(idx))
+                return nullptr;
+            const auto& slot = N->slots[N->position(idx)];
+            if (!slot.child) {
+                return slot.relations->getValue() == v ?
+                        slot.relations.get() : nullptr;
+            }
+            N = slot.child.get();
+        }
+        return nullptr;
+    }
+
+    // get the relations of the value for modification
+    Relations& _getMutable(const llvm::Value *v) {
+        if (!_root)
+            _root = std::make_shared<Node>();
+
+        NodePtr *ptr = &_root;
+        auto hash = _hash(v);
+        for (unsigned shift = 0; ; shift += BITS) {
+            assert(shift < 64 && "Two values with the same hash");
+            auto& N = _own(*ptr);
+            auto idx = _index(hash, shift);
+            auto pos = N.position(idx);
+            if (!N.has(idx)) {
+                N.bitmap |= 1u << idx;
+                auto it = N.slots.insert(N.slots.begin() + pos, Slot{});
+                it->relations = std::make_shared<Relations>(v);
+                ++_size;
+                return *it->relations;
+            }
+
+            auto& slot = N.slots[pos];
+            if (slot.child) {
+                ptr = &slot.child;
+                continue;
+            }
+
+            if (slot.relations->getValue() == v)
+                return _own(slot.relations);
+
+            // move the relations of the other value one level down
+            auto child = std::make_shared<Node>();
+            auto otherIdx = _index(_hash(slot.relations->getValue()), shift + BITS);
+            child->bitmap = 1u << otherIdx;
+            child->slots.push_back(Slot{nullptr, std::move(slot.relations)});
+            slot.child = std::move(child);
+            ptr = &slot.child;
+        }
+    }
+
+    // call 'fun' on the relations in 'rhs' that are not shared with 'ours'
+    // (the nodes are at the same level of the tries)
+    template <typename FunT>
+    static void _forEachNotShared(const Node *ours, const Node *rhs, FunT& fun) {
+        if (ours == rhs)
+            return;
+
+        for (unsigned idx = 0; idx < (1u << BITS); ++idx) {
+            if (!rhs->has(idx))
+                continue;
+
+            const auto& slot = rhs->slots[rhs->position(idx)];
+            const Slot *ourSlot = ours && ours->has(idx) ?
+                                  &ours->slots[ours->position(idx)] : nullptr;
+            if (slot.child) {
+                auto ourChild = ourSlot ? ourSlot->child.get() : nullptr;
+                _forEachNotShared(ourChild, slot.child.get(), fun);
+            } else if (!ourSlot || ourSlot->relations != slot.relations) {
+                fun(*slot.relations);
+            }
+        }
+    }
+
+public:
+    class const_iterator {
+        // the path from the root to the current slot
+        std::vector<std::pair<const Node *, unsigned>> _stack;
+
+        // descend to the first relations in the current subtree
+        void _descend() {
+            while (!_stack.empty()) {
+                auto& top = _stack.back();
+                if (top.second >= top.first->slots.size()) {
+                    _stack.pop_back();
+                    if (!_stack.empty())
+                        ++_stack.back().second;
+                    continue;
+                }
+
+                const auto& slot = top.first->slots[top.second];
+                if (!slot.child)
+                    return;
+                _stack.emplace_back(slot.child.get(), 0);
+            }
+        }
+
+    public:
+        const_iterator() = default;
+        const_iterator(const Node *root) {
+            if (root) {
+                _stack.emplace_back(root, 0);
+                _descend();
+            }
+        }
+
+        // pairs (value, the relations of the value)
+        std::pair<const llvm::Value *, const Relations&> operator*() const {
+            const auto& rels = *_stack.back().first->slots[_stack.back().second].relations;
+            return {rels.getValue(), rels};
+        }
+
+        const_iterator& operator++() {
+            ++_stack.back().second;
+            _descend();
+            return *this;
+        }
+
+        bool operator==(const const_iterator& rhs) const { return _stack == rhs._stack; }
+        bool operator!=(const const_iterator& rhs) const { return !operator==(rhs); }
+    };
+
+private:
     bool addTransitiveEq(const VRRelation& rel) {
         bool changed = false;
         if (auto B = get(rel.getRHS())) {
@@ -340,19 +508,14 @@ class RelationsMap {
     }
 
     bool _add(const VRRelation& rel) {
-        auto it = relations.find(rel.getLHS());
-        if (it == relations.end()) {
-            auto n = relations.emplace(std::piecewise_construct,
-                                       std::forward_as_tuple(rel.getLHS()),
-                                       std::forward_as_tuple(rel.getLHS()));
-            return n.first->second.add(rel);
-        } else {
-            return it->second.add(rel);
-        }
+        if (has(rel))
+            return false;
+
+        return _getMutable(rel.getLHS()).add(rel);
     }
 
 public:
-    RelationsMap(bool keep_trans = false) : _keep_transitively_closed(keep_trans), relations{} {}
+    RelationsMap(bool keep_trans = false) : _keep_transitively_closed(keep_trans) {}
     RelationsMap(const RelationsMap&) = default;
 
     bool add(const VRRelation& rel) {
@@ -367,34 +530,53 @@ public:
     }
 
     bool add(const RelationsMap& rhs) {
-        bool changed = false;
+        if (rhs.empty() || rhs._root == _root)
+            return false;
 
-        for (const auto& it : rhs) {
-            for (const auto& rel : it.second) {
-                changed |= add(rel);
+        // share the map with rhs
+        if (empty() &&
+            _keep_transitively_closed == rhs._keep_transitively_closed) {
+            _root = rhs._root;
+            _size = rhs._size;
+            return true;
+        }
+
+        // the relations that are shared with rhs are already here,
+        // so add only the rest (after the walk, adding may change our trie)
+        std::vector<VRRelation> rels;
+        auto collect = [this, &rels](const Relations& R) {
+            for (const auto& rel : R) {
+                if (!has(rel))
+                    rels.push_back(rel);
             }
+        };
+        _forEachNotShared(_root.get(), rhs._root.get(), collect);
+
+        bool changed = false;
+        for (const auto& rel : rels) {
+            changed |= add(rel);
         }
         return changed;
     }
 
     bool has(const VRRelation& rel) const {
-        auto it = relations.find(rel.getLHS());
-        if (it == relations.end())
-            return false;
-        return it->second.has(rel);
+        auto R = _find(rel.getLHS());
+        return R && R->has(rel);
     }
 
-    Relations *get(const llvm::Value *v) {
-        auto it = relations.find(v);
-        if (it == relations.end()) {
-            return nullptr;
-        }
-        return &it->second;
+    const Relations *get(const llvm::Value *v) const {
+        return _find(v);
     }
 
+    bool empty() const { return _size == 0; }
+
     void transitivelyClose() {
-        auto tmp = relations;
-        for (auto& it : tmp) {
+        if (empty())
+            return;
+
+        // the copies share the trie until we add a relation
+        auto tmp = *this;
+        for (const auto& it : tmp) {
             for (const auto& r : it.second) {
                 // add mapping also for right-hand sides of relations
                 add(VRRelation::reverse(r));
@@ -403,8 +585,8 @@ public:
         bool changed;
         do {
             changed = false;
-            auto tmp = relations;
-            for (auto& it : tmp) {
+            auto tmp = *this;
+            for (const auto& it : tmp) {
                 for (const auto& r : it.second) {
                     changed |= _addTransitive(r);
                 }
@@ -414,7 +596,7 @@ public:
 
     /*
 	void intersect(const RelationsMap& rhs) {
-		decltype(relations) tmp;
+		MapT tmp;
 		for (const auto& r : rhs) {
 			if (relations.count(r) > 0)
 				tmp.insert(r);
@@ -423,15 +605,13 @@ public:
 	}
     */
 
-    auto begin() -> decltype(relations.begin()) { return relations.begin(); }
-    auto end() -> decltype(relations.end()) { return relations.end(); }
-    auto begin() const -> decltype(relations.begin()) { return relations.begin(); }
-    auto end() const -> decltype(relations.end()) { return relations.end(); }
+    const_iterator begin() const { return const_iterator(_root.get()); }
+    const_iterator end() const { return const_iterator(); }
 
 #ifndef NDEBUG
     void dump() const {
         std::cout << "{";
-        for (auto& it : relations)
+        for (const auto& it : *this)
             it.second.dump();
         std::cout << "}";
     }
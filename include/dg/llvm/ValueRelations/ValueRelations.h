@@ -24,6 +24,8 @@ namespace analysis {
 class LLVMValueRelations {
 
     const llvm::Module *_M;
+    // if set, only this function is analyzed
+    const llvm::Function *_F{nullptr};
     unsigned last_node_id{0};
 
     // mapping from LLVM Values to relevant CFG nodes
@@ -251,6 +253,11 @@ class LLVMValueRelations {
 public:
     LLVMValueRelations(const llvm::Module *M) : _M(M) {}
 
+    ///
+    // Compute the relations only in the given function. The relations
+    // that hold at call-sites are not passed into the function.
+    LLVMValueRelations(const llvm::Function *F) : _M(F->getParent()), _F(F) {}
+
     VRLocation *getMapping(const llvm::Value *v) {
         auto it = _loc_mapping.find(v);
         return it == _loc_mapping.end() ? nullptr : it->second;
@@ -263,14 +270,26 @@ public:
 
 
     void build() {
+        if (_F) {
+            build(*_F);
+            return;
+        }
+
         for (const auto& F : *_M) {
             build(F);
         }
     }
 
     // FIXME: this should be for each node
-    void compute(unsigned max_iter = 0, unsigned max_interproc_iter = 3) {
-        LLVMValueRelationsAnalysis VRA(_M, max_iter);
+    void compute(unsigned max_iter = 0, unsigned max_interproc_iter = 3,
+                 unsigned widen_after = 10) {
+        if (_F) {
+            LLVMValueRelationsAnalysis VRA(_F, max_iter, widen_after);
+            VRA.run(_blocks);
+            return;
+        }
+
+        LLVMValueRelationsAnalysis VRA(_M, max_iter, widen_after);
         VRA.run(_blocks);
 
         while (--max_interproc_iter > 0) {
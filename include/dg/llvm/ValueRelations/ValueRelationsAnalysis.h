@@ -1,7 +1,11 @@
 #ifndef _DG_LLVM_VALUE_RELATION_ANALYSIS_H_
 #define _DG_LLVM_VALUE_RELATION_ANALYSIS_H_
 
+#include <algorithm>
+#include <functional>
 #include <list>
+#include <queue>
+#include <vector>
 
 // ignore unused parameters in LLVM libraries
 #if (__clang__)
@@ -90,7 +94,11 @@ class LLVMValueRelationsAnalysis {
     // values that might never change
     std::set<const llvm::Value *> fixedValues;
     const llvm::Module *_M;
+    // maximal number of times a location is processed (0 = unlimited)
     unsigned _max_iterations = 0;
+    // after this number of visits of a location, the reads
+    // whose values still change are dropped (0 = never)
+    unsigned _widen_after = 0;
 
     size_t mayBeWritten(const llvm::Value *v) const {
         using namespace llvm;
@@ -221,37 +229,41 @@ class LLVMValueRelationsAnalysis {
         return false;
     }
 
-    void initializeFixed() {
+    void initializeFixed(const llvm::Function& F) {
         using namespace llvm;
 
-        // FIXME: globals
-        for (auto &F : *_M) {
-            for (auto& B : F) {
-                for (auto& I : B) {
-                    if (isOnceDefinedAlloca(&I)) {
-                        //llvm::errs() << "Fixed memory: " << I << "\n";
-                        fixedMemory.insert(&I);
-                    }
+        for (auto& B : F) {
+            for (auto& I : B) {
+                if (isOnceDefinedAlloca(&I)) {
+                    //llvm::errs() << "Fixed memory: " << I << "\n";
+                    fixedMemory.insert(&I);
                 }
             }
+        }
 
-            // FIXME: this is correct only for non-recursive functions
-            // TODO: we can do this search also after branching,
-            // we just must stop at the first join on each path
-            if (!F.isDeclaration()) {
-                std::set<const BasicBlock *> visited;
-                auto B = &F.getEntryBlock();
-                while (B) {
-                    if (!visited.insert(B).second)
-                        break;
-                    for (auto& I : *B)
-                        fixedValues.insert(&I);
-                    B = getBasicBlockUniqueSuccessor(B);
-                }
+        // FIXME: this is correct only for non-recursive functions
+        // TODO: we can do this search also after branching,
+        // we just must stop at the first join on each path
+        if (!F.isDeclaration()) {
+            std::set<const BasicBlock *> visited;
+            auto B = &F.getEntryBlock();
+            while (B) {
+                if (!visited.insert(B).second)
+                    break;
+                for (auto& I : *B)
+                    fixedValues.insert(&I);
+                B = getBasicBlockUniqueSuccessor(B);
             }
         }
     }
 
+    void initializeFixed() {
+        // FIXME: globals
+        for (auto &F : *_M) {
+            initializeFixed(F);
+        }
+    }
+
     static bool hasAlias(const llvm::Value *val,
                          EqualityMap<const llvm::Value *>& E) {
         auto equiv = E.get(val);
@@ -624,10 +636,13 @@ class LLVMValueRelationsAnalysis {
         using namespace llvm;
         bool changed = false;
 
-        for (auto& it : source->equalities) {
+        // the source may be the location itself (a block that loops
+        // to itself), so iterate over a copy (it takes constant time)
+        const auto equalities = source->equalities;
+        for (const auto& it : equalities) {
             if (mightBeChanged(it.first))
                 continue;
-            for (auto eq : *(it.second.get())) {
+            for (auto eq : *it.second) {
                 if (mightBeChanged(eq))
                     continue;
 
@@ -691,6 +706,72 @@ class LLVMValueRelationsAnalysis {
         return changed;
     }
 
+    // collect the information and drop the reads that got overwritten,
+    // so that the values of the reads cannot change forever
+    bool collectWidened(VRLocation *loc) {
+        ReadsMap oldReads = loc->reads;
+        if (!collect(loc))
+            return false;
+
+        for (auto& it : oldReads) {
+            auto val = loc->reads.get(it.first);
+            if (val && val != it.second)
+                loc->reads.widen(it.first);
+        }
+        return true;
+    }
+
+    // get the locations in the reverse post-order
+    template <typename Blocks>
+    static std::vector<VRLocation *> getRPO(Blocks& blocks) {
+        std::vector<VRLocation *> roots;
+        unsigned maxId = 0;
+        for (const auto& B : blocks) {
+            for (const auto& loc : B.second->locations) {
+                maxId = std::max(maxId, loc->id);
+                if (loc->predecessors.empty())
+                    roots.push_back(loc.get());
+            }
+        }
+
+        std::sort(roots.begin(), roots.end(),
+                  [](const VRLocation *a, const VRLocation *b) { return a->id < b->id; });
+
+        std::vector<bool> visited(maxId + 1, false);
+        std::vector<VRLocation *> postorder;
+        std::vector<std::pair<VRLocation *, size_t>> stack;
+
+        auto dfs = [&](VRLocation *root) {
+            if (visited[root->id])
+                return;
+            visited[root->id] = true;
+            stack.emplace_back(root, 0);
+            while (!stack.empty()) {
+                auto& top = stack.back();
+                if (top.second < top.first->successors.size()) {
+                    auto *succ = top.first->successors[top.second++]->target;
+                    if (!visited[succ->id]) {
+                        visited[succ->id] = true;
+                        stack.emplace_back(succ, 0);
+                    }
+                } else {
+                    postorder.push_back(top.first);
+                    stack.pop_back();
+                }
+            }
+        };
+
+        for (auto *root : roots)
+            dfs(root);
+        // locations on cycles that are not reachable from any root
+        for (const auto& B : blocks) {
+            for (const auto& loc : B.second->locations)
+                dfs(loc.get());
+        }
+
+        return std::vector<VRLocation *>(postorder.rbegin(), postorder.rend());
+    }
+
 public:
     template <typename Locs>
     bool mergeStates(VRLocation *dest, Locs& locs) {
@@ -702,42 +783,95 @@ public:
         return changed;
     }
 
+    ///
+    // Compute the fixpoint using a worklist. A location is processed
+    // again only if some of its predecessors changed and the locations
+    // are taken in the reverse post-order, so that every location
+    // is processed after its (non-loop) predecessors.
+    // Return true if the fixpoint was not reached (because
+    // of the limit on the number of iterations).
     template <typename Blocks>
     bool run(Blocks& blocks) {
-        // FIXME: only nodes reachable from changed nodes
-        bool changed;
-        unsigned n = 0;
-        do {
-            ++n;
-
-#ifndef NDEBUG
-            if (n % 1000 == 0) {
-                llvm::errs() << "Iterations: " << n << "\n";
-            }
-#endif
-
-            if (_max_iterations && (n > _max_iterations))
-                break;
-
-            changed = false;
-            for (const auto& B : blocks) {
-                for (const auto& loc : B.second->locations) {
-                    changed |= collect(loc.get());
+        auto order = getRPO(blocks);
+
+        unsigned maxId = 0;
+        for (auto *loc : order)
+            maxId = std::max(maxId, loc->id);
+        std::vector<unsigned> position(maxId + 1);
+        for (unsigned i = 0; i < order.size(); ++i)
+            position[order[i]->id] = i;
+
+        // the locations that are queued before the current one
+        // (via a back edge) are processed in the next round,
+        // so that we do not iterate an inner part of a loop
+        // again and again before the changes get propagated
+        using Worklist = std::priority_queue<unsigned, std::vector<unsigned>,
+                                             std::greater<unsigned>>;
+        Worklist worklist, nextRound;
+        std::vector<unsigned> visits(order.size(), 0);
+        std::vector<bool> queued(order.size(), true);
+        for (unsigned i = 0; i < order.size(); ++i)
+            worklist.push(i);
+
+        bool fixpoint = true;
+        while (!worklist.empty()) {
+            auto idx = worklist.top();
+            worklist.pop();
+            queued[idx] = false;
+
+            if (_max_iterations > 0 && visits[idx] >= _max_iterations) {
+                fixpoint = false;
+            } else {
+                ++visits[idx];
+
+                auto *loc = order[idx];
+                bool changed;
+                if (_widen_after > 0 && visits[idx] > _widen_after)
+                    changed = collectWidened(loc);
+                else
+                    changed = collect(loc);
+
+                if (changed) {
+                    // the kills are computed also from the equalities
+                    // of the location itself, so process it again too
+                    queued[idx] = true;
+                    nextRound.push(idx);
+
+                    for (const auto& edge : loc->successors) {
+                        auto succ = position[edge->target->id];
+                        if (queued[succ])
+                            continue;
+                        queued[succ] = true;
+                        if (succ > idx)
+                            worklist.push(succ);
+                        else
+                            nextRound.push(succ);
+                    }
                 }
             }
-        } while (changed);
 
-#ifndef NDEBUG
-        llvm::errs() << "Number of iterations: " << n << "\n";
-#endif
-        return changed;
+            if (worklist.empty())
+                std::swap(worklist, nextRound);
+        }
+
+        return !fixpoint;
     }
 
     LLVMValueRelationsAnalysis(const llvm::Module *M,
-                               unsigned max_iterations = 0)
-    : _M(M), _max_iterations(max_iterations) {
+                               unsigned max_iterations = 0,
+                               unsigned widen_after = 0)
+    : _M(M), _max_iterations(max_iterations), _widen_after(widen_after) {
         initializeFixed();
     }
+
+    // the analysis of a single function (the relations
+    // are intraprocedural, so the function can be analyzed alone)
+    LLVMValueRelationsAnalysis(const llvm::Function *F,
+                               unsigned max_iterations = 0,
+                               unsigned widen_after = 0)
+    : _M(F->getParent()), _max_iterations(max_iterations), _widen_after(widen_after) {
+        initializeFixed(*F);
+    }
 };
 
 } // namespace analysis
@@ -0,0 +1,101 @@
+#ifndef _DG_LLVM_VALUE_RELATIONS_DRIVER_H_
+#define _DG_LLVM_VALUE_RELATIONS_DRIVER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "ValueRelations.h"
+
+namespace dg {
+namespace analysis {
+
+///
+// Value relations computed separately for every function.
+// The functions are analyzed on demand (getOrCompute)
+// or all at once by a pool of threads (computeAll).
+// The results for different functions do not share any data,
+// so the functions can be analyzed in parallel.
+class LLVMValueRelationsDriver {
+    const llvm::Module *_M;
+    unsigned _max_iter;
+    unsigned _widen_after;
+
+    std::unordered_map<const llvm::Function *,
+                       std::unique_ptr<LLVMValueRelations>> _results;
+
+    static std::unique_ptr<LLVMValueRelations>
+    analyze(const llvm::Function *F, unsigned max_iter, unsigned widen_after) {
+        std::unique_ptr<LLVMValueRelations> VR(new LLVMValueRelations(F));
+        VR->build();
+        VR->compute(max_iter, 1, widen_after);
+        return VR;
+    }
+
+public:
+    LLVMValueRelationsDriver(const llvm::Module *M,
+                             unsigned max_iter = 0,
+                             unsigned widen_after = 10)
+    : _M(M), _max_iter(max_iter), _widen_after(widen_after) {}
+
+    // analyze all defined functions that were not analyzed yet
+    // using 'threads' threads (0 = the number of hardware threads)
+    void computeAll(unsigned threads = 0) {
+        std::vector<const llvm::Function *> functions;
+        for (const auto& F : *_M) {
+            if (!F.isDeclaration() && _results.count(&F) == 0)
+                functions.push_back(&F);
+        }
+
+        std::vector<std::unique_ptr<LLVMValueRelations>> results(functions.size());
+        std::atomic<size_t> next{0};
+        auto worker = [&]() {
+            size_t i;
+            while ((i = next++) < functions.size()) {
+                results[i] = analyze(functions[i], _max_iter, _widen_after);
+            }
+        };
+
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        if (threads > functions.size())
+            threads = functions.size();
+
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < threads; ++t)
+            pool.emplace_back(worker);
+        worker();
+        for (auto& thread : pool)
+            thread.join();
+
+        for (size_t i = 0; i < functions.size(); ++i)
+            _results[functions[i]] = std::move(results[i]);
+    }
+
+    // get the relations of the function, analyze the function if needed
+    LLVMValueRelations *getOrCompute(const llvm::Function *F) {
+        auto& VR = _results[F];
+        if (!VR)
+            VR = analyze(F, _max_iter, _widen_after);
+        return VR.get();
+    }
+
+    // get the relations of the function if it was already analyzed
+    const LLVMValueRelations *get(const llvm::Function *F) const {
+        auto it = _results.find(F);
+        return it == _results.end() ? nullptr : it->second.get();
+    }
+
+    // get the location of the instruction (analyze its function if needed)
+    VRLocation *getMapping(const llvm::Instruction *I) {
+        return getOrCompute(I->getParent()->getParent())->getMapping(I);
+    }
+};
+
+} // namespace analysis
+} // namespace dg
+
+#endif // _DG_LLVM_VALUE_RELATIONS_DRIVER_H_
@@ -0,0 +1,89 @@
+#ifndef DG_UTIL_GRAPH_EXPORT_H_
+#define DG_UTIL_GRAPH_EXPORT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dg {
+namespace debug {
+
+///
+// Streaming writer of graphs for offline processing of big graphs
+// (the .dot dumps are not usable for graphs with more than several
+// thousands of nodes). The output is written directly into a file
+// descriptor through a buffer of a fixed size, so the memory used
+// by the writer does not depend on the size of the graph.
+//
+// The nodes are identified by numbers (0, 1, ...) assigned by the user
+// of the writer and the edges have a kind, which is an index into
+// the vector of the names of edge kinds given to the constructor.
+// Supported formats:
+//
+//  EDGE_LIST - a compact binary format. The header is the magic "DGEL",
+//              the version of the format (u32), the number of nodes (u64),
+//              the number of edge kinds (u32) and the names of the kinds
+//              (u32 length followed by the characters). Then follows one
+//              record per edge: source (u32), target (u32), kind (u8).
+//              All numbers are little-endian. The labels of nodes
+//              are not stored in this format.
+//  GRAPHML   - GraphML with the function and label of nodes and the kind
+//              of edges as data.
+//  JSONL     - one JSON object per line:
+//              {"node": ID, "function": "...", "label": "..."}
+//              {"src": ID, "dst": ID, "kind": "..."}
+class GraphExportWriter {
+public:
+    enum class Format { EDGE_LIST, GRAPHML, JSONL };
+
+    enum : uint32_t { EdgeListVersion = 1 };
+
+    GraphExportWriter(int fd, Format format, std::vector<std::string> kinds);
+    ~GraphExportWriter();
+
+    GraphExportWriter(const GraphExportWriter&) = delete;
+    GraphExportWriter& operator=(const GraphExportWriter&) = delete;
+
+    // "edges", "graphml" or "jsonl", returns false for unknown format
+    static bool parseFormat(const std::string& str, Format& format);
+
+    // must be called once before writing any node or edge
+    void begin(uint64_t nodesNum);
+    void node(uint32_t id, const std::string& function, const std::string& label);
+    void edge(uint32_t src, uint32_t dst, unsigned kind);
+    // finish the graph and flush the buffer. Returns false
+    // if writing into the file descriptor failed at any point.
+    bool finish();
+
+    uint64_t getWrittenBytes() const { return _written + _len; }
+    uint64_t getEdgesNum() const { return _edges; }
+
+private:
+    enum : size_t { BufferSize = 64 * 1024 };
+
+    const int _fd;
+    const Format _format;
+    const std::vector<std::string> _kinds;
+
+    char _buffer[BufferSize];
+    size_t _len{0};
+    uint64_t _written{0};
+    uint64_t _edges{0};
+    bool _begun{false};
+    bool _finished{false};
+    bool _error{false};
+
+    void flush();
+    void write(const char *data, size_t len);
+    void write(const std::string& str) { write(str.data(), str.size()); }
+    void write(const char *str);
+    void writeNumber(uint64_t n);
+    void writeLE(uint64_t n, unsigned bytes);
+    void writeEscaped(const std::string& str);
+};
+
+} // namespace debug
+} // namespace dg
+
+#endif // DG_UTIL_GRAPH_EXPORT_H_
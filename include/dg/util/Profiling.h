@@ -0,0 +1,132 @@
+#ifndef DG_UTIL_PROFILING_H_
+#define DG_UTIL_PROFILING_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dg {
+namespace debug {
+
+///
+// The profiling data of all the analyses. The data are grouped into
+// phases (e.g., "pta.build", "pta.solve", "dda.memssa", ...) that are
+// identified by their names. Every phase has the accumulated wall-clock
+// time, the number of runs, the peak RSS of the process sampled at the end
+// of the runs and a set of named counters (iterations, processed nodes,
+// created phi nodes, ...).
+//
+// The phases and counters are created on the first use and never removed,
+// so the references returned by counter() stay valid and can be cached
+// by the analyses (e.g., in a static variable). Incrementing a counter
+// is just an atomic increment.
+class Profiler {
+public:
+    using Counter = std::atomic<uint64_t>;
+
+    struct Phase {
+        const std::string name;
+        Counter nanoseconds{0};
+        Counter runs{0};
+        // in kilobytes
+        Counter peakRSS{0};
+        std::map<std::string, Counter> counters;
+
+        Phase(const std::string& name) : name(name) {}
+
+        double seconds() const { return nanoseconds / 1e9; }
+    };
+
+private:
+    // the phases in the order of creation
+    std::vector<std::unique_ptr<Phase>> _phases;
+    mutable std::mutex _mutex;
+
+    Profiler() = default;
+
+    Phase& _getPhase(const std::string& phase);
+
+public:
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    static Profiler& get();
+
+    Phase& getPhase(const std::string& phase) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _getPhase(phase);
+    }
+
+    Counter& counter(const std::string& phase, const std::string& name);
+
+    void count(const std::string& phase, const std::string& name, uint64_t n = 1) {
+        counter(phase, name) += n;
+    }
+
+    void setCounter(const std::string& phase, const std::string& name, uint64_t n) {
+        counter(phase, name) = n;
+    }
+
+    // set the counter to 'n' if 'n' is greater than its value
+    void maxCounter(const std::string& phase, const std::string& name, uint64_t n) {
+        auto& C = counter(phase, name);
+        uint64_t cur = C;
+        while (cur < n && !C.compare_exchange_weak(cur, n)) {}
+    }
+
+    // add one run of the phase that took 'ns' nanoseconds
+    void addRun(const std::string& phase, uint64_t ns);
+
+    // peak resident set size of the process in kilobytes
+    // (0 if not supported on this platform)
+    static size_t getPeakRSS();
+
+    // reset all the data (the phases and counters stay allocated)
+    void clear();
+
+    // {"peak_rss_kb": N, "phases": [{"name": ..., "seconds": ...,
+    //   "runs": ..., "peak_rss_kb": ..., "counters": {...}}, ...]}
+    // Phases that were never run nor counted anything are skipped.
+    void dumpJSON(std::ostream& out) const;
+
+    // write the JSON into the file, returns false on error
+    bool dumpJSON(const std::string& file) const;
+};
+
+///
+// Measure the wall-clock time of a scope and report it to the profiler
+// as one run of the given phase. If 'out' is given, the elapsed time
+// in seconds is also stored there.
+class ScopedTimer {
+    using Clock = std::chrono::steady_clock;
+
+    const char *_phase;
+    double *_out;
+    Clock::time_point _start;
+
+public:
+    ScopedTimer(const char *phase, double *out = nullptr)
+    : _phase(phase), _out(out), _start(Clock::now()) {}
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    ~ScopedTimer() {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        Clock::now() - _start).count();
+        if (_out)
+            *_out = ns / 1e9;
+        Profiler::get().addRun(_phase, static_cast<uint64_t>(ns));
+    }
+};
+
+} // namespace debug
+} // namespace dg
+
+#endif // DG_UTIL_PROFILING_H_
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <set>
+#include <unordered_map>
 
 #include "CDGraph.h"
 
@@ -11,7 +12,11 @@
 
 namespace dg {
 
-class StrongControlClosure {
+///
+// Straightforward implementation of the algorithm for the strong control
+// closure (conditions (a)-(c) are re-computed from scratch for every edge).
+// It is very slow, we keep it only to validate StrongControlClosure.
+class StrongControlClosureNaive {
 
     // this is basically the \Theta function from the paper
     template <typename Nodes, typename FunT>
@@ -68,6 +73,9 @@ class StrongControlClosure {
 
             for (auto *pred : node->predecessors()) {
                 auto& D = data[pred];
+                // do not process colored nodes again
+                if (D.colored)
+                    continue;
                 --D.counter;
                 if (D.counter == 0) {
                     D.colored = true;
@@ -163,6 +171,242 @@ public:
     }
 };
 
+///
+// Computation of the strong control closure that does not search the graph
+// from scratch for every edge. The information needed for checking the
+// conditions (a)-(c) is kept in dense arrays indexed by the IDs of nodes
+// and only updated when new nodes are added to the closure:
+//
+//  - the nodes not in \Gamma(X) (the nodes from which every path goes
+//    through X) only grow when X grows, so we keep the counters of
+//    not-yet-colored successors and continue the coloring from the new nodes,
+//  - the sets of the first reachable nodes from X (\Theta) are kept only
+//    up to two nodes (we just need to know whether there is one or more).
+//    Adding a node to X changes them only for nodes that can reach it
+//    without going through X, so only these are re-computed,
+//  - the nodes reachable from X do not change (new nodes of X are always
+//    reachable from X).
+//
+// Every node that meets the conditions belongs to the (unique) closure,
+// so we add all such nodes found in one pass over the graph at once.
+class StrongControlClosure {
+    // the IDs of the nodes are 1 ... graph.size()
+    std::vector<bool> _inX;
+    // nodes not in \Gamma(X) (all paths from the node go through X)
+    std::vector<bool> _colored;
+    std::vector<unsigned> _counter;
+    std::vector<bool> _reachable;
+    // up to two nodes from \Theta(X, n), 0 means no node
+    std::vector<unsigned> _theta1;
+    std::vector<unsigned> _theta2;
+
+    bool _hasOneTheta(unsigned id) const {
+        return _inX[id] || (_theta1[id] != 0 && _theta2[id] == 0);
+    }
+
+    bool _addTheta(unsigned id, unsigned x) {
+        if (_theta1[id] == 0) {
+            _theta1[id] = x;
+            return true;
+        }
+        if (_theta1[id] != x && _theta2[id] == 0) {
+            _theta2[id] = x;
+            return true;
+        }
+        return false;
+    }
+
+    // add \Theta of 'from' (as seen from its predecessors) to \Theta of 'to'
+    bool _mergeTheta(unsigned to, unsigned from) {
+        if (_inX[from])
+            return _addTheta(to, from);
+
+        bool changed = false;
+        if (_theta1[from] != 0)
+            changed |= _addTheta(to, _theta1[from]);
+        if (_theta2[from] != 0)
+            changed |= _addTheta(to, _theta2[from]);
+        return changed;
+    }
+
+    void _color(CDNode *node) {
+        if (_colored[node->getID()])
+            return;
+
+        ADT::QueueLIFO<CDNode *> queue;
+        _colored[node->getID()] = true;
+        queue.push(node);
+
+        while (!queue.empty()) {
+            auto *cur = queue.pop();
+            for (auto I = cur->pred_begin(), E = cur->pred_end(); I != E; ++I) {
+                auto id = (*I)->getID();
+                if (_colored[id])
+                    continue;
+                assert(_counter[id] > 0);
+                if (--_counter[id] == 0) {
+                    _colored[id] = true;
+                    queue.push(*I);
+                }
+            }
+        }
+    }
+
+    // propagate \Theta from the nodes in the queue backwards
+    // (through the nodes that are not in X)
+    void _propagateTheta(ADT::QueueLIFO<CDNode *>& queue) {
+        while (!queue.empty()) {
+            auto *cur = queue.pop();
+            for (auto I = cur->pred_begin(), E = cur->pred_end(); I != E; ++I) {
+                auto id = (*I)->getID();
+                if (_inX[id])
+                    continue;
+                if (_mergeTheta(id, cur->getID()))
+                    queue.push(*I);
+            }
+        }
+    }
+
+    void _initialize(CDGraph& G, const std::set<CDNode *>& X) {
+        auto size = G.size() + 1;
+        _inX.assign(size, false);
+        _colored.assign(size, false);
+        _reachable.assign(size, false);
+        _theta1.assign(size, 0);
+        _theta2.assign(size, 0);
+        _counter.resize(size);
+
+        for (auto *nd : G) {
+            _counter[nd->getID()] = nd->succ_end() - nd->succ_begin();
+        }
+
+        for (auto *n : X) {
+            _inX[n->getID()] = true;
+        }
+
+        ADT::QueueLIFO<CDNode *> queue;
+        for (auto *n : X) {
+            _color(n);
+            queue.push(n);
+        }
+        _propagateTheta(queue);
+
+        // nodes reachable from the successors of X
+        for (auto *n : X) {
+            queue.push(n);
+        }
+        while (!queue.empty()) {
+            auto *cur = queue.pop();
+            for (auto I = cur->succ_begin(), E = cur->succ_end(); I != E; ++I) {
+                if (!_reachable[(*I)->getID()]) {
+                    _reachable[(*I)->getID()] = true;
+                    queue.push(*I);
+                }
+            }
+        }
+    }
+
+    // is there an edge p -> r that meets the conditions (a) - (c)?
+    bool _shouldAdd(CDNode *p) const {
+        auto id = p->getID();
+        if (_inX[id] || !_reachable[id])
+            return false;
+
+        // (c) \Theta(X, p) has at least two nodes or p is in \Gamma(X)
+        if (_theta2[id] == 0 && _colored[id])
+            return false;
+
+        for (auto I = p->succ_begin(), E = p->succ_end(); I != E; ++I) {
+            auto rid = (*I)->getID();
+            // (a) \Theta(X, r) has one node and (b) r is not in \Gamma(X)
+            if (_hasOneTheta(rid) && _colored[rid])
+                return true;
+        }
+        return false;
+    }
+
+    void _add(const std::vector<CDNode *>& nodes) {
+        for (auto *n : nodes) {
+            _inX[n->getID()] = true;
+        }
+
+        // the nodes whose \Theta can change are those
+        // that reach the new nodes without going through X
+        std::vector<CDNode *> region;
+        std::vector<bool> inRegion(_inX.size(), false);
+        for (auto *n : nodes) {
+            for (auto I = n->pred_begin(), E = n->pred_end(); I != E; ++I) {
+                auto id = (*I)->getID();
+                if (!_inX[id] && !inRegion[id]) {
+                    inRegion[id] = true;
+                    region.push_back(*I);
+                }
+            }
+        }
+        for (size_t i = 0; i < region.size(); ++i) {
+            auto *cur = region[i];
+            for (auto I = cur->pred_begin(), E = cur->pred_end(); I != E; ++I) {
+                auto id = (*I)->getID();
+                if (!_inX[id] && !inRegion[id]) {
+                    inRegion[id] = true;
+                    region.push_back(*I);
+                }
+            }
+        }
+
+        for (auto *cur : region) {
+            _theta1[cur->getID()] = 0;
+            _theta2[cur->getID()] = 0;
+        }
+
+        // take \Theta from the nodes outside of the region
+        // (these did not change) and propagate it through the region
+        ADT::QueueLIFO<CDNode *> queue;
+        for (auto *cur : region) {
+            auto id = cur->getID();
+            for (auto I = cur->succ_begin(), E = cur->succ_end(); I != E; ++I) {
+                if (!inRegion[(*I)->getID()])
+                    _mergeTheta(id, (*I)->getID());
+            }
+            if (_theta1[id] != 0)
+                queue.push(cur);
+        }
+        _propagateTheta(queue);
+
+        for (auto *n : nodes) {
+            _color(n);
+        }
+    }
+
+public:
+    using ValVecT = std::vector<CDNode *>;
+
+    void closeSet(CDGraph& G, std::set<CDNode *>& X) {
+        _initialize(G, X);
+
+        std::vector<CDNode *> toadd;
+        while (true) {
+            for (auto *p : G) {
+                if (_shouldAdd(p))
+                    toadd.push_back(p);
+            }
+
+            if (toadd.empty())
+                break;
+
+            _add(toadd);
+            X.insert(toadd.begin(), toadd.end());
+            toadd.clear();
+        }
+    }
+
+    ValVecT getClosure(CDGraph& G, const std::set<CDNode *>& nodes) {
+        auto X = nodes;
+        closeSet(G, X);
+        return {X.begin(), X.end()};
+    }
+};
+
 } // namespace dg
 
 #endif
@@ -0,0 +1,152 @@
+#include <cstdint>
+#include <cstdlib>
+#include <istream>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include "dg/DataDependence/DataDependenceAnalysisOptions.h"
+
+namespace dg {
+
+static bool parseAllocationFunction(const std::string& str,
+                                    AllocationFunction& type) {
+    if (str == "malloc")
+        type = AllocationFunction::MALLOC;
+    else if (str == "calloc")
+        type = AllocationFunction::CALLOC;
+    else if (str == "alloca")
+        type = AllocationFunction::ALLOCA;
+    else if (str == "realloc")
+        type = AllocationFunction::REALLOC;
+    else if (str == "malloc0")
+        type = AllocationFunction::MALLOC0;
+    else if (str == "calloc0")
+        type = AllocationFunction::CALLOC0;
+    else
+        return false;
+    return true;
+}
+
+static bool parseNumber(const std::string& str, uint64_t& num) {
+    if (str.empty() || str[0] == '-')
+        return false;
+
+    char *end;
+    num = strtoull(str.c_str(), &end, 10);
+    return *end == '\0';
+}
+
+static bool parseOperand(const std::string& str, unsigned& operand) {
+    uint64_t num;
+    if (!parseNumber(str, num) || num > ~0u)
+        return false;
+    operand = static_cast<unsigned>(num);
+    return true;
+}
+
+// a number, 'unknown' or 'opN' (the value of the N-th argument)
+static bool parseOperandValue(const std::string& str,
+                              FunctionModel::OperandValue& val) {
+    if (str == "unknown") {
+        val = FunctionModel::OperandValue(Offset::getUnknown());
+        return true;
+    }
+
+    if (str.compare(0, 2, "op") == 0) {
+        unsigned operand;
+        if (!parseOperand(str.substr(2), operand))
+            return false;
+        val = FunctionModel::OperandValue(operand);
+        return true;
+    }
+
+    uint64_t num;
+    if (!parseNumber(str, num))
+        return false;
+    val = FunctionModel::OperandValue(Offset(num));
+    return true;
+}
+
+bool DataDependenceAnalysisOptions::readFunctionModels(std::istream& in,
+                                                       std::string& error) {
+    // parse the input into temporary maps, so that
+    // the options do not change if the input is malformed
+    std::map<const std::string, AllocationFunction> allocs;
+    std::map<const std::string, FunctionModel> models;
+    std::string line;
+    unsigned lineno = 0;
+
+    while (std::getline(in, line)) {
+        ++lineno;
+        auto comment = line.find('#');
+        if (comment != std::string::npos)
+            line.resize(comment);
+
+        std::istringstream ss(line);
+        std::string kind, name;
+        if (!(ss >> kind))
+            continue; // empty line
+
+        auto fail = [&](const std::string& msg) {
+            error = "line " + std::to_string(lineno) + ": " + msg;
+            return false;
+        };
+
+        if (!(ss >> name))
+            return fail("missing the name of the function");
+
+        std::string rest;
+        if (kind == "alloc") {
+            std::string typeStr;
+            AllocationFunction type;
+            if (!(ss >> typeStr) || !parseAllocationFunction(typeStr, type))
+                return fail("invalid type of allocation function");
+            if (ss >> rest)
+                return fail("unexpected '" + rest + "'");
+
+            // unlike addAllocationFunction(), re-defining
+            // an allocation function is not an error here
+            allocs[name] = type;
+            continue;
+        }
+
+        if (kind != "def" && kind != "use")
+            return fail("unknown entry '" + kind + "'");
+
+        std::string opStr, offStr, lenStr;
+        unsigned operand;
+        FunctionModel::OperandValue off{Offset(0)}, len{Offset(0)};
+        if (!(ss >> opStr >> offStr >> lenStr))
+            return fail("expected '" + kind + " NAME OPERAND OFFSET LEN'");
+        if (!parseOperand(opStr, operand))
+            return fail("invalid operand '" + opStr + "'");
+        if (!parseOperandValue(offStr, off))
+            return fail("invalid offset '" + offStr + "'");
+        if (!parseOperandValue(lenStr, len))
+            return fail("invalid length '" + lenStr + "'");
+        if (ss >> rest)
+            return fail("unexpected '" + rest + "'");
+
+        auto& M = models[name];
+        M.name = name;
+        if (kind == "def")
+            M.addDef({operand, off, len});
+        else
+            M.addUse({operand, off, len});
+    }
+
+    for (auto& it : allocs)
+        allocationFunctions[it.first] = it.second;
+
+    // the models of functions from the file replace the models
+    // that we already have (e.g., the built-in models)
+    for (auto& it : models) {
+        functionModels.erase(it.first);
+        functionModels.emplace(it.first, std::move(it.second));
+    }
+
+    return true;
+}
+
+} // namespace dg
@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+#include <unistd.h>
+
+#include "dg/util/GraphExport.h"
+
+namespace dg {
+namespace debug {
+
+GraphExportWriter::GraphExportWriter(int fd, Format format,
+                                     std::vector<std::string> kinds)
+: _fd(fd), _format(format), _kinds(std::move(kinds)) {
+    assert(_kinds.size() <= 256 && "The kind of edges must fit into a byte");
+}
+
+GraphExportWriter::~GraphExportWriter() {
+    if (_begun)
+        finish();
+}
+
+bool GraphExportWriter::parseFormat(const std::string& str, Format& format) {
+    if (str == "edges")
+        format = Format::EDGE_LIST;
+    else if (str == "graphml")
+        format = Format::GRAPHML;
+    else if (str == "jsonl")
+        format = Format::JSONL;
+    else
+        return false;
+    return true;
+}
+
+void GraphExportWriter::flush() {
+    size_t pos = 0;
+    while (!_error && pos < _len) {
+        ssize_t ret = ::write(_fd, _buffer + pos, _len - pos);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            _error = true;
+            break;
+        }
+        pos += static_cast<size_t>(ret);
+    }
+
+    _written += _len;
+    _len = 0;
+}
+
+void GraphExportWriter::write(const char *data, size_t len) {
+    while (len > 0) {
+        if (_len == BufferSize)
+            flush();
+
+        size_t n = std::min(len, BufferSize - _len);
+        memcpy(_buffer + _len, data, n);
+        _len += n;
+        data += n;
+        len -= n;
+    }
+}
+
+void GraphExportWriter::write(const char *str) {
+    write(str, strlen(str));
+}
+
+void GraphExportWriter::writeNumber(uint64_t n) {
+    char buf[20];
+    unsigned len = 0;
+    do {
+        buf[sizeof(buf) - ++len] = static_cast<char>('0' + n % 10);
+        n /= 10;
+    } while (n > 0);
+    write(buf + sizeof(buf) - len, len);
+}
+
+void GraphExportWriter::writeLE(uint64_t n, unsigned bytes) {
+    char buf[8];
+    assert(bytes <= sizeof(buf));
+    for (unsigned i = 0; i < bytes; ++i) {
+        buf[i] = static_cast<char>(n & 0xff);
+        n >>= 8;
+    }
+    write(buf, bytes);
+}
+
+// escape the string for JSON or XML (depending on the format)
+void GraphExportWriter::writeEscaped(const std::string& str) {
+    static const char hex[] = "0123456789abcdef";
+
+    for (char c : str) {
+        if (_format == Format::GRAPHML) {
+            switch (c) {
+            case '&': write("&amp;"); continue;
+            case '<': write("&lt;"); continue;
+            case '>': write("&gt;"); continue;
+            case '"': write("&quot;"); continue;
+            default: break;
+            }
+        } else {
+            switch (c) {
+            case '"': write("\\\""); continue;
+            case '\\': write("\\\\"); continue;
+            case '\n': write("\\n"); continue;
+            case '\t': write("\\t"); continue;
+            default: break;
+            }
+        }
+
+        if (static_cast<unsigned char>(c) < 0x20) {
+            // control characters are not allowed in XML 1.0 at all
+            if (_format == Format::GRAPHML)
+                continue;
+            const char esc[] = {'\\', 'u', '0', '0', hex[(c >> 4) & 0xf],
+                                hex[c & 0xf]};
+            write(esc, sizeof(esc));
+            continue;
+        }
+
+        write(&c, 1);
+    }
+}
+
+void GraphExportWriter::begin(uint64_t nodesNum) {
+    assert(!_begun && "Already began writing the graph");
+    _begun = true;
+
+    switch (_format) {
+    case Format::EDGE_LIST:
+        write("DGEL", 4);
+        writeLE(EdgeListVersion, 4);
+        writeLE(nodesNum, 8);
+        writeLE(_kinds.size(), 4);
+        for (const auto& kind : _kinds) {
+            writeLE(kind.size(), 4);
+            write(kind);
+        }
+        break;
+    case Format::GRAPHML:
+        write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+              "<graphml xmlns=\"http://graphml.graphdrawing.org/xmlns\">\n"
+              "  <key id=\"function\" for=\"node\" attr.name=\"function\" attr.type=\"string\"/>\n"
+              "  <key id=\"label\" for=\"node\" attr.name=\"label\" attr.type=\"string\"/>\n"
+              "  <key id=\"kind\" for=\"edge\" attr.name=\"kind\" attr.type=\"string\"/>\n"
+              "  <graph edgedefault=\"directed\">\n");
+        break;
+    case Format::JSONL:
+        break;
+    }
+}
+
+void GraphExportWriter::node(uint32_t id, const std::string& function,
+                             const std::string& label) {
+    assert(_begun && !_finished);
+
+    switch (_format) {
+    case Format::EDGE_LIST:
+        break;
+    case Format::GRAPHML:
+        write("    <node id=\"n");
+        writeNumber(id);
+        write("\"><data key=\"function\">");
+        writeEscaped(function);
+        write("</data><data key=\"label\">");
+        writeEscaped(label);
+        write("</data></node>\n");
+        break;
+    case Format::JSONL:
+        write("{\"node\": ");
+        writeNumber(id);
+        write(", \"function\": \"");
+        writeEscaped(function);
+        write("\", \"label\": \"");
+        writeEscaped(label);
+        write("\"}\n");
+        break;
+    }
+}
+
+void GraphExportWriter::edge(uint32_t src, uint32_t dst, unsigned kind) {
+    assert(_begun && !_finished);
+    assert(kind < _kinds.size() && "Invalid kind of edge");
+    ++_edges;
+
+    switch (_format) {
+    case Format::EDGE_LIST:
+        writeLE(src, 4);
+        writeLE(dst, 4);
+        writeLE(kind, 1);
+        break;
+    case Format::GRAPHML:
+        write("    <edge source=\"n");
+        writeNumber(src);
+        write("\" target=\"n");
+        writeNumber(dst);
+        write("\"><data key=\"kind\">");
+        writeEscaped(_kinds[kind]);
+        write("</data></edge>\n");
+        break;
+    case Format::JSONL:
+        write("{\"src\": ");
+        writeNumber(src);
+        write(", \"dst\": ");
+        writeNumber(dst);
+        write(", \"kind\": \"");
+        writeEscaped(_kinds[kind]);
+        write("\"}\n");
+        break;
+    }
+}
+
+bool GraphExportWriter::finish() {
+    if (_finished)
+        return !_error;
+    _finished = true;
+
+    if (_format == Format::GRAPHML)
+        write("  </graph>\n</graphml>\n");
+
+    flush();
+    return !_error;
+}
+
+} // namespace debug
+} // namespace dg
@@ -5,6 +5,7 @@
 //#include "dg/BBlocksBuilder.h"
 
 #include "dg/util/debug.h"
+#include "dg/util/Profiling.h"
 
 namespace dg {
 namespace dda {
@@ -88,6 +89,9 @@ MemorySSATransformation::findDefinitions(RWNode *node, const DefSite& ds) {
 }
 
 RWNode *MemorySSATransformation::createPhi(const DefSite& ds, RWNodeType type) {
+    static auto& phisCounter = debug::Profiler::get().counter("dda.memssa", "phis");
+    ++phisCounter;
+
     // This phi is the definition that we are looking for.
     _phis.emplace_back(&graph.create(type));
     auto *phi = _phis.back();
@@ -718,6 +722,8 @@ MemorySSATransformation::findAllDefinitions(RWNode *from) {
 
 void MemorySSATransformation::computeAllDefinitions() {
     DBG_SECTION_BEGIN(dda, "Computing definitions for all uses (requested)");
+    debug::ScopedTimer timer("dda.memssa");
+    uint64_t resolved = 0;
     for (auto *subg : graph.subgraphs()) {
         for (auto *b : subg->bblocks()) {
             for (auto *n : b->getNodes()) {
@@ -725,11 +731,13 @@ void MemorySSATransformation::computeAllDefinitions() {
                     if (!n->defuse.initialized()) {
                         n->addDefUse(findDefinitions(n));
                         assert(n->defuse.initialized());
+                        ++resolved;
                     }
                 }
             }
         }
     }
+    debug::Profiler::get().count("dda.memssa", "resolved_uses", resolved);
     DBG_SECTION_END(dda, "Computing definitions for all uses finished");
 }
 
@@ -818,6 +826,8 @@ std::vector<RWNode *>
 MemorySSATransformation::getDefinitions(RWNode *use) {
     // on demand triggering finding the definitions
     if (!use->defuse.initialized()) {
+        static auto& resolved = debug::Profiler::get().counter("dda.memssa", "resolved_uses");
+        ++resolved;
         use->addDefUse(findDefinitions(use));
         assert(use->defuse.initialized());
     }
@@ -837,6 +847,7 @@ MemorySSATransformation::getDefinitions(RWNode *where,
 
 void MemorySSATransformation::run() {
     DBG_SECTION_BEGIN(dda, "Initializing MemorySSA analysis");
+    debug::ScopedTimer timer("dda.memssa");
 
     initialize();
 
@@ -4,6 +4,7 @@
 #include "dg/PointerAnalysis/PointerAnalysis.h"
 
 #include "dg/util/debug.h"
+#include "dg/util/Profiling.h"
 
 namespace dg {
 namespace pta {
@@ -17,6 +18,12 @@ PSNode *UNKNOWN_MEMORY = &UNKNOWN_MEMLOC;
 PSNode INVALIDATED_LOC(PSNodeType::INVALIDATED);
 PSNode *INVALIDATED = &INVALIDATED_LOC;
 
+// count one union of points-to sets done by the solver
+static inline void countSetUnion() {
+    static auto& unions = debug::Profiler::get().counter("pta.solve", "set_unions");
+    ++unions;
+}
+
 // pointers to those memory
 const Pointer UnknownPointer(UNKNOWN_MEMORY, Offset::UNKNOWN);
 const Pointer NullPointer(NULLPTR, 0);
@@ -75,6 +82,8 @@ bool PointerAnalysis::processLoad(PSNode *node)
         }
 
         for (MemoryObject *o : objects) {
+            addReader(o, node);
+
             // is the offset to the memory unknown?
             // In that case everything can be referenced,
             // so we need to copy the whole points-to
@@ -82,7 +91,7 @@ bool PointerAnalysis::processLoad(PSNode *node)
                 // we should load from memory that has
                 // no pointers in it - it may be an error
                 // FIXME: don't duplicate the code
-                if (o->pointsTo.empty()) {
+                if (o->empty()) {
                     if (target->isZeroInitialized())
                         changed |= node->addPointsTo(NullPointer);
                     else if (objects.size() == 1)
@@ -91,9 +100,8 @@ bool PointerAnalysis::processLoad(PSNode *node)
 
                 // we have some pointers - copy them all,
                 // since the offset is unknown
-                for (auto& it : o->pointsTo) {
-                    changed |= node->addPointsTo(it.second);
-                }
+                countSetUnion();
+                changed |= node->addPointsTo(o->getPointsToUnion());
 
                 // this is all that we can do here...
                 continue;
@@ -101,8 +109,8 @@ bool PointerAnalysis::processLoad(PSNode *node)
 
             // load from empty points-to set
             // - that is load from unknown memory
-            auto it = o->pointsTo.find(ptr.offset);
-            if (it == o->pointsTo.end()) {
+            auto it = o->find(ptr.offset);
+            if (it == o->end()) {
                 // if the memory is zero initialized, then everything
                 // is fine, we add nullptr
                 if (target->isZeroInitialized())
@@ -110,18 +118,20 @@ bool PointerAnalysis::processLoad(PSNode *node)
                 // if we don't have a definition even with unknown offset
                 // it is an error
                 // FIXME: don't triplicate the code!
-                else if (!o->pointsTo.count(Offset::UNKNOWN))
+                else if (!o->has(Offset::UNKNOWN))
                     changed |= errorEmptyPointsTo(node, target);
             } else {
                 // we have pointers on that memory, so we can
                 // do the work
+                countSetUnion();
                 changed |= node->addPointsTo(it->second);
             }
 
             // plus always add the pointers at unknown offset,
             // since these can be what we need too
-            it = o->pointsTo.find(Offset::UNKNOWN);
-            if (it != o->pointsTo.end()) {
+            it = o->find(Offset::UNKNOWN);
+            if (it != o->end()) {
+                countSetUnion();
                 changed |= node->addPointsTo(it->second);
             }
         }
@@ -155,6 +165,9 @@ bool PointerAnalysis::processMemcpy(PSNode *node)
             return changed;
         }
 
+        for (MemoryObject *o : srcObjects)
+            addReader(o, node);
+
         // gather destNode objects
         for (const Pointer& dptr : destNode->pointsTo) {
             assert(dptr.target && "Got nullptr as target");
@@ -215,53 +228,168 @@ bool PointerAnalysis::processMemcpy(std::vector<MemoryObject *>& srcObjects,
         }
     }
 
+    MemoryObject::PointsToMapT copiedFields;
     for (MemoryObject *destO : destObjects) {
+        bool destChanged = false;
         if (contains_null_somewhere)
-            changed |= destO->addPointsTo(Offset::UNKNOWN, NullPointer);
+            destChanged |= destO->addPointsTo(Offset::UNKNOWN, NullPointer);
 
         // copy every pointer from srcObjects that is in
         // the range to destination's objects
         for (MemoryObject *so : srcObjects) {
-            for (auto& src : so->pointsTo) { // src.first is offset,
-                                             // src.second is a PointToSet
+            // adding the pointers to the destination could
+            // invalidate the iterators if it is the same object
+            const MemoryObject::PointsToMapT *fields = &so->fields();
+            if (so == destO) {
+                copiedFields = so->fields();
+                fields = &copiedFields;
+            }
+
+            for (auto& src : *fields) { // src.first is offset,
+                                        // src.second is a PointToSet
 
                 // if the offset is inbound of the copied memory
                 // or we copy from unknown offset, or this pointer
-                // is on unknown offset, copy this pointer
-                if (src.first.isUnknown() ||
+                // is on unknown offset (or the source is summarized,
+                // so we do not know the real offset), copy this pointer
+                if (src.first.isUnknown() || so->isSummarized() ||
                     srcOffset.isUnknown() ||
                     (srcOffset <= src.first &&
                      (len.isUnknown() ||
                       *src.first - *srcOffset < *len))) {
 
+                    countSetUnion();
                     // copy the pointer, but shift it by the offsets
                     // we are working with
-                    if (!src.first.isUnknown() && !srcOffset.isUnknown() &&
-                        !destOffset.isUnknown()) {
+                    if (!src.first.isUnknown() && !so->isSummarized() &&
+                        !srcOffset.isUnknown() && !destOffset.isUnknown()) {
                         // check that new offset does not overflow Offset::UNKNOWN
                         if (Offset::UNKNOWN - *destOffset <= *src.first - *srcOffset) {
-                            changed |= destO->addPointsTo(Offset::UNKNOWN, src.second);
+                            destChanged |= destO->addPointsTo(Offset::UNKNOWN, src.second);
                             continue;
                         }
 
                         Offset newOff = *src.first - *srcOffset + *destOffset;
                         if (newOff >= destO->node->getSize() ||
                             newOff >= options.fieldSensitivity) {
-                            changed |= destO->addPointsTo(Offset::UNKNOWN, src.second);
+                            destChanged |= destO->addPointsTo(Offset::UNKNOWN, src.second);
                         } else {
-                            changed |= destO->addPointsTo(newOff, src.second);
+                            destChanged |= destO->addPointsTo(newOff, src.second);
                         }
                     } else {
-                        changed |= destO->addPointsTo(Offset::UNKNOWN, src.second);
+                        destChanged |= destO->addPointsTo(Offset::UNKNOWN, src.second);
                     }
                 }
             }
         }
+
+        if (destChanged) {
+            summarizeObject(destO);
+            changed = true;
+        }
     }
 
     return changed;
 }
 
+void PointerAnalysis::queueReaders(PSNode *node, PSNode *pointer) {
+    std::vector<MemoryObject *> objects;
+    for (const Pointer& ptr : pointer->pointsTo) {
+        if (!canBeDereferenced(ptr))
+            continue;
+
+        objects.clear();
+        getMemoryObjects(node, ptr, objects);
+        for (MemoryObject *o : objects) {
+            auto id = o->node->getID();
+            if (id >= _readers.size())
+                continue;
+            for (PSNode *reader : _readers[id])
+                queueNode(reader);
+        }
+    }
+}
+
+void PointerAnalysis::setReachable(PSNode *n) {
+    _reachable[n->getID()] = true;
+
+    PointerSubgraph *subg = n->getParent();
+    if (!subg || isLive(subg))
+        return;
+
+    if (subg->getID() >= _liveSubgraphs.size())
+        _liveSubgraphs.resize(subg->getID() + 1, false);
+    _liveSubgraphs[subg->getID()] = true;
+
+    // the users of changed nodes from this subgraph could have been
+    // skipped until now, so queue the whole (newly live) subgraph
+    for (PSNode *nd : PG->getNodes(subg->getRoot(), false /* interproc */)) {
+        _reachable[nd->getID()] = true;
+        queueNode(nd);
+    }
+}
+
+void PointerAnalysis::initialize_worklist() {
+    _reachable.assign(PG->size(), false);
+    _queued.assign(PG->size(), false);
+    _liveSubgraphs.clear();
+
+    std::vector<PSNode *> nodes;
+    nodes.swap(to_process);
+    // keep the order of the nodes from the entry
+    for (PSNode *n : nodes) {
+        _reachable[n->getID()] = true;
+        queueNode(n);
+    }
+    for (PSNode *n : nodes)
+        setReachable(n);
+
+    for (PSNode *n : to_process)
+        _queued[n->getID()] = false;
+}
+
+void PointerAnalysis::queue_dependent() {
+    // the nodes that may have changed the graph (e.g., added
+    // a new called function). For these, we queue all the nodes
+    // reachable from them as in the BFS mode.
+    std::vector<PSNode *> graphChanged;
+
+    for (PSNode *n : changed) {
+        switch (n->getType()) {
+            case PSNodeType::CALL_FUNCPTR:
+            case PSNodeType::FORK:
+            case PSNodeType::JOIN:
+                graphChanged.push_back(n);
+                continue;
+            case PSNodeType::STORE:
+                queueReaders(n, n->getOperand(1));
+                break;
+            case PSNodeType::MEMCPY:
+                queueReaders(n, PSNodeMemcpy::get(n)->getDestination());
+                break;
+            default:
+                break;
+        }
+
+        for (PSNode *user : n->getUsers())
+            queueNode(user);
+    }
+
+    if (!graphChanged.empty()) {
+        ++_bfsFallbacks;
+        // the graph may have new nodes
+        _reachable.resize(PG->size(), false);
+        _queued.resize(PG->size(), false);
+        for (PSNode *n : PG->getNodes(graphChanged)) {
+            setReachable(n);
+            queueNode(n);
+        }
+    }
+
+    for (PSNode *n : to_process)
+        _queued[n->getID()] = false;
+}
+
 bool PointerAnalysis::processGep(PSNode *node) {
     bool changed = false;
 
@@ -312,8 +440,11 @@ bool PointerAnalysis::processNode(PSNode *node)
                 objects.clear();
                 getMemoryObjects(node, ptr, objects);
                 for (MemoryObject *o : objects) {
-                    changed |= o->addPointsTo(ptr.offset,
-                                              node->getOperand(0)->pointsTo);
+                    if (o->addPointsTo(ptr.offset,
+                                       node->getOperand(0)->pointsTo)) {
+                        summarizeObject(o);
+                        changed = true;
+                    }
                 }
             }
             break;
@@ -330,6 +461,7 @@ bool PointerAnalysis::processNode(PSNode *node)
             break;
         case PSNodeType::CAST:
             // cast only copies the pointers
+            countSetUnion();
             changed |= node->addPointsTo(node->getOperand(0)->pointsTo);
             break;
         case PSNodeType::CONSTANT:
@@ -358,8 +490,10 @@ bool PointerAnalysis::processNode(PSNode *node)
             // gather pointers returned from subprocedure - the same way
             // as PHI works
         case PSNodeType::PHI:
-            for (PSNode *op : node->operands)
+            for (PSNode *op : node->operands) {
+                countSetUnion();
                 changed |= node->addPointsTo(op->pointsTo);
+            }
             break;
         case PSNodeType::CALL_FUNCPTR:
             // call via function pointer:
@@ -467,6 +601,177 @@ void PointerAnalysis::sanityCheck() {
 #endif // not NDEBUG
 }
 
+// the allocation that the pointer points to if it can be found
+// without solving the graph
+static PSNode *getStaticTarget(PSNode *pointer) {
+    while (pointer->getType() == PSNodeType::GEP ||
+           pointer->getType() == PSNodeType::CAST)
+        pointer = pointer->getOperand(0);
+
+    return pointer->getType() == PSNodeType::ALLOC ? pointer : nullptr;
+}
+
+static PSNode *getWrittenPointer(PSNode *node) {
+    if (node->getType() == PSNodeType::STORE)
+        return node->getOperand(1);
+    if (node->getType() == PSNodeType::MEMCPY)
+        return PSNodeMemcpy::get(node)->getDestination();
+    return nullptr;
+}
+
+bool PointerAnalysis::initializeDemand() {
+    if (!supportsWorklist())
+        return false;
+
+    // the demanded part of the graph must not change during the analysis
+    for (const auto& nd : PG->getNodes()) {
+        if (!nd)
+            continue;
+        if (nd->getType() == PSNodeType::CALL_FUNCPTR ||
+            nd->getType() == PSNodeType::FORK ||
+            nd->getType() == PSNodeType::JOIN)
+            return false;
+    }
+
+    preprocess();
+    sanityCheck();
+
+    queue_globals();
+    iteration();
+    to_process.clear();
+    changed.clear();
+
+    _worklist = true;
+    _reachable.assign(PG->size(), false);
+    _queued.assign(PG->size(), false);
+    _liveSubgraphs.clear();
+    // globals are solved
+    for (auto& it : PG->getGlobals())
+        _reachable[it->getID()] = true;
+
+    _writers.clear();
+    _indirectWriters.clear();
+    _writersAdded.assign(PG->size(), false);
+    for (const auto& nd : PG->getNodes()) {
+        if (!nd)
+            continue;
+        PSNode *pointer = getWrittenPointer(nd.get());
+        if (!pointer)
+            continue;
+        if (PSNode *target = getStaticTarget(pointer))
+            _writers[target->getID()].push_back(nd.get());
+        else
+            _indirectWriters.push_back(nd.get());
+    }
+
+    return true;
+}
+
+bool PointerAnalysis::solveDemand(PSNode *node, size_t budget) {
+    assert(_worklist && "Demand-driven solving was not initialized");
+    if (isDemandSolved(node))
+        return true;
+
+    size_t added = 0;
+    std::vector<PSNode *> stack{node};
+    std::vector<MemoryObject *> objects;
+
+    while (!stack.empty()) {
+        // add the new nodes and their operands to the solved nodes
+        assert(to_process.empty());
+        while (!stack.empty()) {
+            PSNode *cur = stack.back();
+            stack.pop_back();
+            if (isDemandSolved(cur))
+                continue;
+
+            if (budget > 0 && ++added > budget) {
+                for (PSNode *n : to_process)
+                    _queued[n->getID()] = false;
+                to_process.clear();
+                return false;
+            }
+
+            _reachable[cur->getID()] = true;
+            queueNode(cur);
+            for (PSNode *op : cur->getOperands())
+                stack.push_back(op);
+        }
+
+        for (PSNode *n : to_process)
+            _queued[n->getID()] = false;
+
+        // the nodes that depend on the changes are only
+        // the solved nodes, so this is the usual fixpoint on them
+        while (!to_process.empty()) {
+            iteration();
+            queue_changed();
+        }
+
+        // add the writers of the memory that is read by the solved nodes
+        // (the nodes that read the memory are registered as its readers)
+        bool readsMemory = false;
+        for (size_t id = 0; id < _readers.size(); ++id) {
+            if (_readers[id].empty())
+                continue;
+            readsMemory = true;
+            if (_writersAdded[id])
+                continue;
+            _writersAdded[id] = true;
+            if (auto *writers = _writers.get(id)) {
+                for (PSNode *w : *writers)
+                    stack.push_back(w);
+            }
+        }
+
+        if (!readsMemory || _indirectWriters.empty())
+            continue;
+
+        // the writers through other pointers: we need to solve the pointers
+        // to find out whether they write to the read memory
+        bool pointersSolved = true;
+        for (PSNode *w : _indirectWriters) {
+            PSNode *pointer = getWrittenPointer(w);
+            if (!isDemandSolved(pointer)) {
+                stack.push_back(pointer);
+                pointersSolved = false;
+            }
+        }
+
+        if (!pointersSolved)
+            continue;
+
+        auto it = _indirectWriters.begin();
+        while (it != _indirectWriters.end()) {
+            bool writesRead = false;
+            for (const Pointer& ptr : getWrittenPointer(*it)->pointsTo) {
+                if (!canBeDereferenced(ptr))
+                    continue;
+                objects.clear();
+                getMemoryObjects(*it, ptr, objects);
+                for (MemoryObject *o : objects) {
+                    auto id = o->node->getID();
+                    if (id < _readers.size() && !_readers[id].empty()) {
+                        writesRead = true;
+                        break;
+                    }
+                }
+                if (writesRead)
+                    break;
+            }
+
+            if (writesRead) {
+                stack.push_back(*it);
+                it = _indirectWriters.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    return true;
+}
+
 static void setToEmpty(std::vector<PSNode *>& nodes) {
     for (auto *n : nodes) {
         if (n->getType() != PSNodeType::ALLOC &&
@@ -478,6 +783,7 @@ static void setToEmpty(std::vector<PSNode *>& nodes) {
 
 bool PointerAnalysis::run() {
     DBG_SECTION_BEGIN(pta, "Running pointer analysis");
+    debug::ScopedTimer timer("pta.solve");
     
     preprocess();
     
@@ -502,6 +808,7 @@ bool PointerAnalysis::run() {
     }
 
     size_t n = 0;
+    uint64_t processed = 0, changedNum = 0;
     // do fixpoint
     do {
         if (options.maxIterations > 0 && n > options.maxIterations) {
@@ -516,13 +823,23 @@ bool PointerAnalysis::run() {
         }
 #endif
         ++n;
+        processed += to_process.size();
 
         iteration();
+        changedNum += changed.size();
         queue_changed();
     } while (!to_process.empty());
 
     DBG(pta, "Reached fixpoint after " << n << " iterations\n");
 
+    auto& profiler = debug::Profiler::get();
+    profiler.count("pta.solve", "iterations", n);
+    profiler.count("pta.solve", "processed_nodes", processed);
+    profiler.count("pta.solve", "changed_nodes", changedNum);
+    profiler.maxCounter("pta.solve", "max_processed_nodes", _maxProcessed);
+    if (_worklist)
+        profiler.count("pta.solve", "bfs_fallbacks", _bfsFallbacks);
+
     assert(to_process.empty());
     assert(changed.empty());
 
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <fstream>
+#include <tuple>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include "dg/util/Profiling.h"
+
+namespace dg {
+namespace debug {
+
+Profiler& Profiler::get() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Phase& Profiler::_getPhase(const std::string& phase) {
+    // there are only a few phases, a linear search is fine
+    for (auto& P : _phases) {
+        if (P->name == phase)
+            return *P;
+    }
+    _phases.emplace_back(new Phase(phase));
+    return *_phases.back();
+}
+
+Profiler::Counter& Profiler::counter(const std::string& phase,
+                                     const std::string& name) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& counters = _getPhase(phase).counters;
+    auto it = counters.find(name);
+    if (it == counters.end()) {
+        it = counters.emplace(std::piecewise_construct,
+                              std::forward_as_tuple(name),
+                              std::forward_as_tuple(0)).first;
+    }
+    return it->second;
+}
+
+void Profiler::addRun(const std::string& phase, uint64_t ns) {
+    auto rss = getPeakRSS();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& P = _getPhase(phase);
+    P.nanoseconds += ns;
+    ++P.runs;
+    if (rss > P.peakRSS)
+        P.peakRSS = rss;
+}
+
+size_t Profiler::getPeakRSS() {
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    // macOS reports the size in bytes
+    return static_cast<size_t>(usage.ru_maxrss) / 1024;
+#else
+    return static_cast<size_t>(usage.ru_maxrss);
+#endif
+#else
+    return 0;
+#endif
+}
+
+void Profiler::clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto& P : _phases) {
+        P->nanoseconds = 0;
+        P->runs = 0;
+        P->peakRSS = 0;
+        for (auto& it : P->counters)
+            it.second = 0;
+    }
+}
+
+static void dumpString(std::ostream& out, const std::string& str) {
+    out << '"';
+    for (char c : str) {
+        if (c == '"' || c == '\\')
+            out << '\\';
+        out << c;
+    }
+    out << '"';
+}
+
+void Profiler::dumpJSON(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    out << "{\n  \"peak_rss_kb\": " << getPeakRSS() << ",\n";
+    out << "  \"phases\": [";
+
+    bool first = true;
+    for (const auto& P : _phases) {
+        bool used = P->runs > 0 ||
+                    std::any_of(P->counters.begin(), P->counters.end(),
+                                [](const std::pair<const std::string, Counter>& it) {
+                                    return it.second > 0;
+                                });
+        if (!used)
+            continue;
+
+        out << (first ? "\n" : ",\n");
+        first = false;
+
+        out << "    {\"name\": ";
+        dumpString(out, P->name);
+        out << ", \"seconds\": " << P->seconds()
+            << ", \"runs\": " << P->runs
+            << ", \"peak_rss_kb\": " << P->peakRSS
+            << ", \"counters\": {";
+
+        bool firstCounter = true;
+        for (const auto& it : P->counters) {
+            if (!firstCounter)
+                out << ", ";
+            firstCounter = false;
+            dumpString(out, it.first);
+            out << ": " << it.second;
+        }
+        out << "}}";
+    }
+
+    out << (first ? "]\n}\n" : "\n  ]\n}\n");
+}
+
+bool Profiler::dumpJSON(const std::string& file) const {
+    std::ofstream out(file);
+    if (!out.is_open())
+        return false;
+    dumpJSON(out);
+    return out.good();
+}
+
+} // namespace debug
+} // namespace dg
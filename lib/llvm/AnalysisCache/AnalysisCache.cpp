@@ -0,0 +1,689 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ignore unused parameters in LLVM libraries
+#if (__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-parameter"
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Metadata.h>
+#include <llvm/Support/raw_ostream.h>
+
+#if (__clang__)
+#pragma clang diagnostic pop // ignore -Wunused-parameter
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "dg/llvm/AnalysisCache/AnalysisCache.h"
+#include "dg/llvm/LLVMDependenceGraph.h"
+#include "dg/llvm/LLVMDependenceGraphBuilder.h"
+#include "dg/llvm/PointerAnalysis/PointerAnalysis.h"
+#include "dg/llvm/DataDependence/DataDependence.h"
+
+namespace dg {
+namespace llvmdg {
+
+namespace {
+
+// FNV-1a
+class Hash {
+    uint64_t _hash{14695981039346656037ULL};
+
+public:
+    void add(const char *data, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            _hash ^= static_cast<uint8_t>(data[i]);
+            _hash *= 1099511628211ULL;
+        }
+    }
+
+    void add(const std::string& s) {
+        add(s.c_str(), s.size() + 1);
+    }
+
+    void add(uint64_t n) {
+        add(reinterpret_cast<const char *>(&n), sizeof(n));
+    }
+
+    uint64_t get() const { return _hash; }
+};
+
+// stream that only computes the hash of the written data,
+// so that we do not need to keep the whole printed module in memory
+class HashingOStream : public llvm::raw_ostream {
+    Hash _hash;
+    uint64_t _pos{0};
+
+    void write_impl(const char *ptr, size_t size) override {
+        _hash.add(ptr, size);
+        _pos += size;
+    }
+
+    uint64_t current_pos() const override { return _pos; }
+
+public:
+    ~HashingOStream() override { flush(); }
+
+    uint64_t getHash() { flush(); return _hash.get(); }
+};
+
+enum Section {
+    FLAGS,
+    PTS_INDEX,
+    PTS,
+    DEFS_INDEX,
+    DEFS,
+    CD_EDGES,
+    FUNCTIONS,
+    GLOBALS,
+    SECTIONS_NUM
+};
+
+enum HeaderFlags : uint32_t {
+    // the control dependencies of all functions are stored
+    HEADER_HAS_CD = 1
+};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t numValues;
+    uint64_t moduleHash;
+    uint64_t optionsHash;
+    uint32_t flags;
+    // the number of incremental analyses that the results went through
+    // since they were computed from scratch (0 = computed from scratch)
+    uint32_t derived;
+    // offsets and sizes (in bytes) of the sections,
+    // the size 0 means that the section is not present
+    uint64_t sections[SECTIONS_NUM][2];
+};
+
+const char MAGIC[8] = {'D', 'G', 'C', 'A', 'C', 'H', 'E', '\0'};
+
+void addOptions(Hash& H, const AnalysisOptions& opts) {
+    H.add(*opts.fieldSensitivity);
+    for (auto& it : opts.allocationFunctions) {
+        H.add(it.first);
+        H.add(static_cast<uint64_t>(it.second));
+    }
+}
+
+void addOperand(Hash& H, const FunctionModel::Operand& op) {
+    H.add(uint64_t(op.operand));
+    for (const auto *val : {&op.from, &op.to}) {
+        if (val->isOffset()) {
+            H.add(uint64_t(0));
+            H.add(*val->getOffset());
+        } else {
+            H.add(uint64_t(1));
+            H.add(uint64_t(val->getOperand()));
+        }
+    }
+}
+
+// check that the compressed-row index starts at 0 and does not decrease,
+// so that every range [index[id], index[id + 1]) is valid
+bool checkIndex(const uint32_t *index, uint32_t numValues) {
+    if (index[0] != 0)
+        return false;
+    for (uint32_t id = 0; id < numValues; ++id) {
+        if (index[id] > index[id + 1])
+            return false;
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+ModuleValueNumbering::ModuleValueNumbering(const llvm::Module *M) {
+    for (const llvm::Function& F : *M)
+        _add(&F);
+    for (const llvm::GlobalVariable& G : M->globals())
+        _add(&G);
+    for (const llvm::GlobalAlias& A : M->aliases())
+        _add(&A);
+
+    for (const llvm::Function& F : *M) {
+        auto first = size();
+        for (const llvm::Argument& A : F.args())
+            _add(&A);
+        for (const llvm::BasicBlock& B : F) {
+            _add(&B);
+            for (const llvm::Instruction& I : B)
+                _add(&I);
+        }
+        _functionRanges[&F] = {first, size()};
+    }
+}
+
+uint64_t AnalysisCache::hashName(const llvm::StringRef& name) {
+    Hash H;
+    H.add(name.data(), name.size());
+    return H.get();
+}
+
+uint64_t AnalysisCache::hashFunction(const llvm::Function& F) {
+    Hash H;
+    std::string str;
+    llvm::raw_string_ostream os(str);
+
+    auto addType = [&H, &str, &os](const llvm::Type *T) {
+        str.clear();
+        T->print(os);
+        os.flush();
+        H.add(str);
+    };
+
+    H.add(uint64_t(F.isDeclaration()));
+    addType(F.getFunctionType());
+
+    // the values defined in the function are hashed by their position,
+    // so that the hash does not depend on their names
+    llvm::DenseMap<const llvm::Value *, uint64_t> local;
+    for (const llvm::Argument& A : F.args())
+        local[&A] = local.size();
+    for (const llvm::BasicBlock& B : F) {
+        local[&B] = local.size();
+        for (const llvm::Instruction& I : B)
+            local[&I] = local.size();
+    }
+
+    for (const llvm::BasicBlock& B : F) {
+        H.add(uint64_t(B.size()));
+        for (const llvm::Instruction& I : B) {
+            H.add(uint64_t(I.getOpcode()));
+            addType(I.getType());
+            H.add(uint64_t(I.getNumOperands()));
+
+            for (const llvm::Value *op : I.operands()) {
+                auto it = local.find(op);
+                if (it != local.end()) {
+                    H.add(uint64_t(1));
+                    H.add(it->second);
+                } else if (auto *GV = llvm::dyn_cast<llvm::GlobalValue>(op)) {
+                    H.add(uint64_t(2));
+                    H.add(GV->getName().str());
+                } else if (llvm::isa<llvm::MetadataAsValue>(op)) {
+                    // metadata do not change the results of the analyses
+                    H.add(uint64_t(3));
+                } else {
+                    // constants, inline assembly, ...
+                    H.add(uint64_t(4));
+                    str.clear();
+                    op->print(os);
+                    os.flush();
+                    H.add(str);
+                }
+            }
+
+            if (auto *C = llvm::dyn_cast<llvm::CmpInst>(&I))
+                H.add(uint64_t(C->getPredicate()));
+            else if (auto *A = llvm::dyn_cast<llvm::AllocaInst>(&I))
+                addType(A->getAllocatedType());
+            else if (auto *G = llvm::dyn_cast<llvm::GetElementPtrInst>(&I))
+                addType(G->getSourceElementType());
+        }
+    }
+
+    return H.get();
+}
+
+AnalysisCache::Key
+AnalysisCache::computeKey(const llvm::Module *M,
+                          const LLVMDependenceGraphOptions& opts) {
+    Key key;
+
+    HashingOStream hos;
+    M->print(hos, nullptr);
+    key.module = hos.getHash();
+
+    Hash H;
+    H.add(uint64_t(VERSION));
+    H.add(opts.entryFunction);
+    H.add(uint64_t(opts.threads));
+
+    const auto& PTAOpts = opts.PTAOptions;
+    addOptions(H, PTAOpts);
+    H.add(PTAOpts.entryFunction);
+    H.add(static_cast<uint64_t>(PTAOpts.analysisType));
+    H.add(uint64_t(PTAOpts.threads));
+    H.add(uint64_t(PTAOpts.preprocessGeps));
+    H.add(uint64_t(PTAOpts.invalidateNodes));
+    H.add(uint64_t(PTAOpts.maxIterations));
+    H.add(uint64_t(PTAOpts.contextDepth));
+    H.add(uint64_t(PTAOpts.cloneAllocWrappers));
+    H.add(uint64_t(PTAOpts.cloneSmallFunctions));
+    H.add(uint64_t(PTAOpts.maxClonedNodes));
+    H.add(uint64_t(PTAOpts.worklist));
+    H.add(uint64_t(PTAOpts.demandDriven));
+    H.add(uint64_t(PTAOpts.demandBudget));
+    H.add(uint64_t(PTAOpts.maxObjectFields));
+
+    const auto& DDAOpts = opts.DDAOptions;
+    addOptions(H, DDAOpts);
+    H.add(DDAOpts.entryFunction);
+    H.add(static_cast<uint64_t>(DDAOpts.analysisType));
+    H.add(static_cast<uint64_t>(DDAOpts.undefinedFunsBehavior));
+    H.add(uint64_t(DDAOpts.fieldInsensitive));
+    H.add(uint64_t(DDAOpts.threads));
+    for (auto& it : DDAOpts.functionModels) {
+        H.add(it.first);
+        H.add(uint64_t(it.second.getDefines().size()));
+        for (auto& def : it.second.getDefines())
+            addOperand(H, def.second);
+        H.add(uint64_t(it.second.getUses().size()));
+        for (auto& use : it.second.getUses())
+            addOperand(H, use.second);
+    }
+
+    const auto& CDAOpts = opts.CDAOptions;
+    addOptions(H, CDAOpts);
+    H.add(CDAOpts.entryFunction);
+    H.add(static_cast<uint64_t>(CDAOpts.algorithm));
+    H.add(uint64_t(CDAOpts.interprocedural));
+    H.add(uint64_t(CDAOpts.nodePerInstruction()));
+
+    key.options = H.get();
+    return key;
+}
+
+std::string AnalysisCache::getPath(const std::string& dir, const Key& key) {
+    char name[64];
+    snprintf(name, sizeof(name), "%016llx-%016llx.dgcache",
+             static_cast<unsigned long long>(key.module),
+             static_cast<unsigned long long>(key.options));
+    if (dir.empty())
+        return name;
+    return dir + "/" + name;
+}
+
+std::string AnalysisCache::getLatestPath(const std::string& dir, const Key& key) {
+    char name[64];
+    snprintf(name, sizeof(name), "latest-%016llx.dgcache",
+             static_cast<unsigned long long>(key.options));
+    if (dir.empty())
+        return name;
+    return dir + "/" + name;
+}
+
+AnalysisCache::~AnalysisCache() {
+    if (_data)
+        munmap(_data, _size);
+}
+
+bool AnalysisCache::_map(const std::string& path, const Key& key,
+                         bool checkModule) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        static_cast<size_t>(st.st_size) < sizeof(FileHeader)) {
+        close(fd);
+        return false;
+    }
+
+    _size = static_cast<size_t>(st.st_size);
+    _data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (_data == MAP_FAILED) {
+        _data = nullptr;
+        return false;
+    }
+
+    const auto *header = static_cast<const FileHeader *>(_data);
+    if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header->version != VERSION ||
+        header->optionsHash != key.options) {
+        return false;
+    }
+
+    if (checkModule && (header->moduleHash != key.module ||
+                        header->numValues != getNumbering().size())) {
+        return false;
+    }
+
+    _numValues = header->numValues;
+
+    for (unsigned i = 0; i < SECTIONS_NUM; ++i) {
+        // do not let the sum overflow
+        if (header->sections[i][0] > _size ||
+            header->sections[i][1] > _size - header->sections[i][0] ||
+            header->sections[i][0] % 8 != 0)
+            return false;
+    }
+
+    auto get = [this, header](Section s) -> const char * {
+        if (header->sections[s][1] == 0)
+            return nullptr;
+        return static_cast<const char *>(_data) + header->sections[s][0];
+    };
+
+    const uint64_t indexSize = (uint64_t(_numValues) + 1) * sizeof(uint32_t);
+    if (header->sections[FLAGS][1] != _numValues ||
+        header->sections[PTS_INDEX][1] != indexSize)
+        return false;
+
+    _flags = reinterpret_cast<const uint8_t *>(get(FLAGS));
+    _ptsIdx = reinterpret_cast<const uint32_t *>(get(PTS_INDEX));
+    _pts = reinterpret_cast<const Pointer *>(get(PTS));
+    if (!checkIndex(_ptsIdx, _numValues) ||
+        uint64_t(_ptsIdx[_numValues]) * sizeof(Pointer)
+            != header->sections[PTS][1])
+        return false;
+
+    if (header->sections[DEFS_INDEX][1] != 0) {
+        if (header->sections[DEFS_INDEX][1] != indexSize)
+            return false;
+        _defsIdx = reinterpret_cast<const uint32_t *>(get(DEFS_INDEX));
+        _defs = reinterpret_cast<const uint32_t *>(get(DEFS));
+        if (!checkIndex(_defsIdx, _numValues) ||
+            uint64_t(_defsIdx[_numValues]) * sizeof(uint32_t)
+                != header->sections[DEFS][1])
+            return false;
+    }
+
+    _hasCD = header->flags & HEADER_HAS_CD;
+    _derived = header->derived;
+    _cdEdges = reinterpret_cast<const uint32_t *>(get(CD_EDGES));
+    _cdEdgesNum = header->sections[CD_EDGES][1] / (2 * sizeof(uint32_t));
+    _functions = reinterpret_cast<const FunctionEntry *>(get(FUNCTIONS));
+    _functionsNum = header->sections[FUNCTIONS][1] / sizeof(FunctionEntry);
+    _globals = reinterpret_cast<const GlobalEntry *>(get(GLOBALS));
+    _globalsNum = header->sections[GLOBALS][1] / sizeof(GlobalEntry);
+
+    // check that the ids are in bounds, so that queries by ids are safe
+    for (uint64_t i = 0; i < 2*_cdEdgesNum; ++i) {
+        if (_cdEdges[i] >= _numValues)
+            return false;
+    }
+    for (uint64_t i = 0; i < _functionsNum; ++i) {
+        const auto& F = _functions[i];
+        if (F.id >= _numValues || F.first > F.last || F.last > _numValues)
+            return false;
+    }
+    for (uint64_t i = 0; i < _globalsNum; ++i) {
+        if (_globals[i].id >= _numValues)
+            return false;
+    }
+    for (uint64_t i = 0; i < _ptsIdx[_numValues]; ++i) {
+        if (_pts[i].target == 0 || _pts[i].target >= _numValues)
+            return false;
+    }
+    if (_defsIdx) {
+        for (uint64_t i = 0; i < _defsIdx[_numValues]; ++i) {
+            if (_defs[i] == 0 || _defs[i] >= _numValues)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+std::unique_ptr<AnalysisCache>
+AnalysisCache::load(const std::string& dir,
+                    const llvm::Module *M,
+                    const Key& key,
+                    bool allowDerived) {
+    std::unique_ptr<AnalysisCache> cache(new AnalysisCache(M));
+    if (!cache->_map(getPath(dir, key), key, /* checkModule = */ true))
+        return nullptr;
+
+    if (cache->isDerived() && !allowDerived)
+        return nullptr;
+
+    return cache;
+}
+
+std::unique_ptr<AnalysisCache>
+AnalysisCache::loadLatest(const std::string& dir, const Key& key) {
+    std::unique_ptr<AnalysisCache> cache(new AnalysisCache(nullptr));
+    if (!cache->_map(getLatestPath(dir, key), key, /* checkModule = */ false))
+        return nullptr;
+
+    return cache;
+}
+
+void AnalysisCache::getPointers(const llvm::Value *val,
+                                const Pointer *& first,
+                                const Pointer *& last) const {
+    auto id = getNumbering().getId(val);
+    if (id == 0) {
+        first = last = nullptr;
+        return;
+    }
+
+    getPointers(id, first, last);
+}
+
+void AnalysisCache::restoreControlDependencies() const {
+    assert(hasControlDependencies());
+
+    for (uint64_t i = 0; i < _cdEdgesNum; ++i) {
+        auto *from = llvm::cast<llvm::BasicBlock>(_numbering->getValue(_cdEdges[2*i]));
+        auto *to = llvm::cast<llvm::BasicBlock>(_numbering->getValue(_cdEdges[2*i + 1]));
+
+        auto it = getConstructedFunctions().find(from->getParent());
+        assert(it != getConstructedFunctions().end()
+                && "Cached CD for a function that is not in the graph");
+        auto& blocks = it->second->getBlocks();
+        auto *fromBB = blocks[from];
+        auto *toBB = blocks[to];
+        assert(fromBB && toBB && "Do not have constructed BB");
+        fromBB->addControlDependence(toBB);
+    }
+}
+
+///
+// Get the block-level control dependencies of the function from the graph.
+// Return false if some dependence cannot be stored
+// (e.g., it involves an artificial block)
+static bool getControlDependencies(const ModuleValueNumbering& numbering,
+                                   LLVMDependenceGraph *F,
+                                   std::vector<uint32_t>& edges) {
+    for (auto& it : F->getBlocks()) {
+        auto from = numbering.getId(it.first);
+        if (from == 0)
+            return false;
+
+        for (auto *dep : it.second->controlDependence()) {
+            auto to = numbering.getId(dep->getKey());
+            if (to == 0 || !llvm::isa<llvm::BasicBlock>(dep->getKey()))
+                return false;
+            edges.push_back(from);
+            edges.push_back(to);
+        }
+    }
+
+    return true;
+}
+
+template <typename T>
+static void writeSection(std::ofstream& out, FileHeader& header,
+                         Section s, const std::vector<T>& data) {
+    // keep the sections aligned
+    static const char zeros[8] = {0};
+    auto pos = static_cast<uint64_t>(out.tellp());
+    if (pos % 8 != 0) {
+        out.write(zeros, 8 - pos % 8);
+        pos += 8 - pos % 8;
+    }
+
+    header.sections[s][0] = pos;
+    header.sections[s][1] = data.size() * sizeof(T);
+    out.write(reinterpret_cast<const char *>(data.data()),
+              data.size() * sizeof(T));
+}
+
+bool AnalysisCache::store(const std::string& dir,
+                          const llvm::Module *M,
+                          const Key& key,
+                          LLVMPointerAnalysis *PTA,
+                          dda::LLVMDataDependenceAnalysis *DDA,
+                          const LLVMDependenceGraph *dg,
+                          uint32_t derived) {
+    assert(PTA && "Need the pointer analysis");
+
+    ModuleValueNumbering numbering(M);
+    const auto N = numbering.size();
+
+    std::vector<uint8_t> flags(N, 0);
+    std::vector<uint32_t> ptsIdx(N + 1, 0);
+    std::vector<Pointer> pts;
+    std::vector<uint32_t> defsIdx;
+    std::vector<uint32_t> defs;
+    std::vector<uint32_t> cdEdges;
+
+    if (DDA)
+        defsIdx.resize(N + 1, 0);
+
+    for (uint32_t id = 1; id < N; ++id) {
+        ptsIdx[id] = static_cast<uint32_t>(pts.size());
+        if (DDA)
+            defsIdx[id] = static_cast<uint32_t>(defs.size());
+
+        const llvm::Value *val = numbering.getValue(id);
+        if (llvm::isa<llvm::BasicBlock>(val))
+            continue;
+
+        auto ptsChecked = PTA->getLLVMPointsToChecked(val);
+        if (ptsChecked.first) {
+            const auto& ptset = ptsChecked.second;
+            flags[id] |= HAS_POINTS_TO;
+            if (ptset.hasUnknown())
+                flags[id] |= PTS_UNKNOWN;
+            if (ptset.hasNull())
+                flags[id] |= PTS_NULL;
+            if (ptset.hasInvalidated())
+                flags[id] |= PTS_INVALIDATED;
+
+            for (const auto& ptr : ptset) {
+                auto target = numbering.getId(ptr.value);
+                if (target == 0) {
+                    // we cannot refer to this memory,
+                    // so over-approximate it by unknown memory
+                    flags[id] |= PTS_UNKNOWN;
+                    continue;
+                }
+                pts.push_back(Pointer{target, 0, *ptr.offset});
+            }
+        }
+
+        if (DDA && llvm::isa<llvm::Instruction>(val) && DDA->isUse(val)) {
+            flags[id] |= IS_USE;
+            for (auto *def : DDA->getLLVMDefinitions(const_cast<llvm::Value *>(val))) {
+                auto defid = numbering.getId(def);
+                assert(defid != 0 && "Definition not in the module");
+                defs.push_back(defid);
+            }
+        }
+    }
+    ptsIdx[N] = static_cast<uint32_t>(pts.size());
+    if (DDA)
+        defsIdx[N] = static_cast<uint32_t>(defs.size());
+
+    std::vector<FunctionEntry> functions;
+    std::vector<GlobalEntry> globals;
+    bool hasCD = dg != nullptr;
+    for (const llvm::Function& F : *M) {
+        auto range = numbering.getRange(&F);
+        FunctionEntry entry{hashName(F.getName()), hashFunction(F),
+                            numbering.getId(&F),
+                            range.first, range.second, 0};
+
+        auto it = getConstructedFunctions().find(const_cast<llvm::Function *>(&F));
+        if (dg && it != getConstructedFunctions().end()) {
+            auto size = cdEdges.size();
+            if (getControlDependencies(numbering, it->second, cdEdges)) {
+                entry.hasCD = 1;
+            } else {
+                cdEdges.resize(size);
+                // recompute the control dependencies when loading the cache
+                hasCD = false;
+            }
+        }
+
+        functions.push_back(entry);
+    }
+    for (const llvm::GlobalVariable& G : M->globals())
+        globals.push_back(GlobalEntry{hashName(G.getName()), numbering.getId(&G)});
+    for (const llvm::GlobalAlias& A : M->aliases())
+        globals.push_back(GlobalEntry{hashName(A.getName()), numbering.getId(&A)});
+
+    // write into a temporary file and rename it afterwards,
+    // so that nobody can load a partially written cache
+    auto path = getPath(dir, key);
+    auto tmppath = path + ".tmp." + std::to_string(getpid());
+    std::ofstream out(tmppath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        llvm::errs() << "[dg] error: cannot write the analysis cache to "
+                     << tmppath << "\n";
+        return false;
+    }
+
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.numValues = N;
+    header.moduleHash = key.module;
+    header.optionsHash = key.options;
+    header.flags = hasCD ? HEADER_HAS_CD : 0;
+    header.derived = derived;
+
+    // reserve the space for the header, we will re-write it at the end
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    writeSection(out, header, FLAGS, flags);
+    writeSection(out, header, PTS_INDEX, ptsIdx);
+    writeSection(out, header, PTS, pts);
+    writeSection(out, header, DEFS_INDEX, defsIdx);
+    writeSection(out, header, DEFS, defs);
+    writeSection(out, header, CD_EDGES, cdEdges);
+    writeSection(out, header, FUNCTIONS, functions);
+    writeSection(out, header, GLOBALS, globals);
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.close();
+
+    if (!out || std::rename(tmppath.c_str(), path.c_str()) != 0) {
+        llvm::errs() << "[dg] error: failed writing the analysis cache "
+                     << path << "\n";
+        std::remove(tmppath.c_str());
+        return false;
+    }
+
+    // point the 'latest' link to the new file, it is used
+    // as the previous state by the incremental analysis
+    auto latest = getLatestPath(dir, key);
+    auto tmplatest = latest + ".tmp." + std::to_string(getpid());
+    std::remove(tmplatest.c_str());
+    if (symlink(getPath("", key).c_str(), tmplatest.c_str()) != 0 ||
+        std::rename(tmplatest.c_str(), latest.c_str()) != 0) {
+        llvm::errs() << "[dg] warning: failed updating " << latest << "\n";
+        std::remove(tmplatest.c_str());
+    }
+
+    return true;
+}
+
+} // namespace llvmdg
+} // namespace dg
@@ -0,0 +1,204 @@
+#include <map>
+
+// ignore unused parameters in LLVM libraries
+#if (__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-parameter"
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Module.h>
+
+#if (__clang__)
+#pragma clang diagnostic pop // ignore -Wunused-parameter
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "dg/llvm/AnalysisCache/IncrementalAnalysis.h"
+#include "dg/llvm/LLVMDependenceGraph.h"
+#include "dg/llvm/PointerAnalysis/PointerAnalysis.h"
+#include "dg/util/debug.h"
+
+namespace dg {
+namespace llvmdg {
+
+IncrementalAnalysis::IncrementalAnalysis(std::unique_ptr<AnalysisCache> previous,
+                                         const llvm::Module *M,
+                                         const std::set<const llvm::Function *>& changed)
+: _previous(std::move(previous)),
+  _mapping(_previous->getNumValues(), nullptr),
+  _changed(changed) {
+    _mapFunctions(M);
+}
+
+void IncrementalAnalysis::_mapFunctions(const llvm::Module *M) {
+    DBG_SECTION_BEGIN(llvmdg, "Matching the module with the previous state");
+
+    ModuleValueNumbering numbering(M);
+
+    // the values are matched by the hashes of names.
+    // Unnamed globals cannot be matched.
+    std::map<uint64_t, const llvm::Value *> globals;
+    for (const llvm::GlobalVariable& G : M->globals()) {
+        if (G.hasName())
+            globals.emplace(AnalysisCache::hashName(G.getName()), &G);
+    }
+    for (const llvm::GlobalAlias& A : M->aliases()) {
+        if (A.hasName())
+            globals.emplace(AnalysisCache::hashName(A.getName()), &A);
+    }
+
+    for (auto *G = _previous->globals_begin(); G != _previous->globals_end(); ++G) {
+        auto it = globals.find(G->name);
+        if (it != globals.end())
+            _mapping[G->id] = it->second;
+    }
+
+    std::map<uint64_t, const llvm::Function *> functions;
+    for (const llvm::Function& F : *M)
+        functions.emplace(AnalysisCache::hashName(F.getName()), &F);
+
+    std::set<const llvm::Function *> matched;
+    for (auto *FE = _previous->functions_begin();
+         FE != _previous->functions_end(); ++FE) {
+        auto it = functions.find(FE->name);
+        if (it == functions.end()) // removed function
+            continue;
+
+        const llvm::Function *F = it->second;
+        matched.insert(F);
+        // the function itself is a memory object
+        // that is identified by its name
+        _mapping[FE->id] = F;
+
+        if (isChanged(F))
+            continue;
+
+        auto range = numbering.getRange(F);
+        if (range.second - range.first != FE->last - FE->first ||
+            AnalysisCache::hashFunction(*F) != FE->hash) {
+            _changed.insert(F);
+            continue;
+        }
+
+        for (uint32_t i = 0; i < FE->last - FE->first; ++i)
+            _mapping[FE->first + i] = numbering.getValue(range.first + i);
+
+        ++_unchangedNum;
+        if (FE->hasCD)
+            _withCD.insert(F);
+    }
+
+    // new functions
+    for (const llvm::Function& F : *M) {
+        if (matched.count(&F) == 0)
+            _changed.insert(&F);
+    }
+
+    DBG_SECTION_END(llvmdg, "Matched " << _unchangedNum << " unchanged functions, "
+                            << _changed.size() << " functions changed");
+}
+
+size_t IncrementalAnalysis::seedPointsTo(DGLLVMPointerAnalysis *PTA) const {
+    using namespace dg::pta;
+
+    assert(PTA->getPS() && "The pointer analysis is not initialized");
+
+    // the memory objects of the current pointer graph
+    llvm::DenseMap<const llvm::Value *, PSNode *> objects;
+    for (const auto& nd : PTA->getNodes()) {
+        if (!nd)
+            continue;
+        if (nd->getType() != PSNodeType::ALLOC &&
+            nd->getType() != PSNodeType::FUNCTION)
+            continue;
+        if (auto *val = nd->getUserData<llvm::Value>())
+            objects[val] = nd.get();
+    }
+
+    size_t seeded = 0;
+    for (uint32_t id = 1; id < _mapping.size(); ++id) {
+        const llvm::Value *val = _mapping[id];
+        if (!val || llvm::isa<llvm::BasicBlock>(val))
+            continue;
+
+        auto flags = _previous->getFlags(id);
+        if (!(flags & AnalysisCache::HAS_POINTS_TO))
+            continue;
+
+        // the function may have not been built yet
+        // (e.g., it is called only via a function pointer)
+        PSNode *node = PTA->getPointsToNode(val);
+        if (!node)
+            continue;
+
+        if (flags & AnalysisCache::PTS_UNKNOWN)
+            node->addPointsTo(UNKNOWN_MEMORY, Offset::UNKNOWN);
+        if (flags & AnalysisCache::PTS_NULL)
+            node->addPointsTo(NULLPTR, 0);
+
+        const AnalysisCache::Pointer *first, *last;
+        _previous->getPointers(id, first, last);
+        for (auto *ptr = first; ptr != last; ++ptr) {
+            // the memory from changed functions is found
+            // again by the analysis if it is still there
+            auto *target = _mapping[ptr->target];
+            if (!target)
+                continue;
+            auto it = objects.find(target);
+            if (it == objects.end())
+                continue;
+            node->addPointsTo(it->second, Offset(ptr->offset));
+        }
+
+        if (!node->pointsTo.empty())
+            ++seeded;
+    }
+
+    return seeded;
+}
+
+std::set<const llvm::Function *>
+IncrementalAnalysis::restoreControlDependencies() const {
+    auto& constructed = getConstructedFunctions();
+
+    for (auto *it = _previous->cd_edges_begin();
+         it != _previous->cd_edges_end(); it += 2) {
+        auto *from = _mapping[it[0]];
+        auto *to = _mapping[it[1]];
+        if (!from || !to)
+            continue;
+
+        auto *B = llvm::cast<llvm::BasicBlock>(from);
+        auto *F = B->getParent();
+        if (_withCD.count(F) == 0)
+            continue;
+
+        auto fit = constructed.find(const_cast<llvm::Function *>(F));
+        if (fit == constructed.end())
+            continue;
+
+        auto& blocks = fit->second->getBlocks();
+        auto *fromBB = blocks[const_cast<llvm::Value *>(from)];
+        auto *toBB = blocks[const_cast<llvm::Value *>(to)];
+        assert(fromBB && toBB && "Do not have constructed BB");
+        fromBB->addControlDependence(toBB);
+    }
+
+    std::set<const llvm::Function *> functions;
+    for (auto& it : constructed) {
+        auto *F = llvm::cast<llvm::Function>(it.first);
+        if (_withCD.count(F) == 0)
+            functions.insert(F);
+    }
+
+    return functions;
+}
+
+} // namespace llvmdg
+} // namespace dg
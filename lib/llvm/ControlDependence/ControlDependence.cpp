@@ -5,12 +5,22 @@
 #include "llvm/ControlDependence/NTSCD.h"
 #include "llvm/ControlDependence/SCD.h"
 #include "llvm/ControlDependence/InterproceduralCD.h"
+#include "llvm/Dominators/PostDominance.h"
 
 namespace dg {
 
+LLVMControlDependenceAnalysis::LLVMControlDependenceAnalysis(const llvm::Module *module,
+                                                             const LLVMControlDependenceAnalysisOptions& opts)
+    : _module(module), _options(opts),
+      _postDominance(new llvmdg::PostDominance()) {
+    initializeImpl();
+}
+
+LLVMControlDependenceAnalysis::~LLVMControlDependenceAnalysis() = default;
+
 void LLVMControlDependenceAnalysis::initializeImpl() {
     if (getOptions().standardCD()) {
-        _impl.reset(new llvmdg::SCD(_module, _options));
+        _impl.reset(new llvmdg::SCD(_module, *_postDominance, _options));
     } else if (getOptions().ntscdCD() || getOptions().ntscd2CD() ||
                getOptions().ntscdRanganathCD()) {
         _impl.reset(new llvmdg::NTSCD(_module, _options));
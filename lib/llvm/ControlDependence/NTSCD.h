@@ -4,6 +4,7 @@
 #include <llvm/IR/Module.h>
 
 #include "dg/llvm/ControlDependence/ControlDependence.h"
+#include "dg/util/Profiling.h"
 #include "GraphBuilder.h"
 
 #include "ControlDependence/NTSCD.h"
@@ -170,6 +171,7 @@ private:
         DBG(cda, "Triggering on-demand computation for " << F->getName().str());
         assert(_getGraph(F) == nullptr
                && "Already have the graph");
+        debug::ScopedTimer timer("cda.ntscd");
 
         auto tmpgraph = graphBuilder.build(F, getOptions().nodePerInstruction());
         // FIXME: we can actually just forget the graph if we do not want to dump
@@ -197,6 +199,15 @@ private:
             info.controlDependence = std::move(result.first);
             info.revControlDependence = std::move(result.second);
         }
+
+        size_t deps = 0;
+        for (auto& it : info.controlDependence)
+            deps += it.second.size();
+
+        auto& profiler = debug::Profiler::get();
+        profiler.count("cda.ntscd", "functions");
+        profiler.count("cda.ntscd", "nodes", info.graph.size());
+        profiler.count("cda.ntscd", "dependencies", deps);
    }
 };
 
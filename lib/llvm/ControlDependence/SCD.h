@@ -6,6 +6,8 @@
 #include "dg/llvm/ControlDependence/ControlDependence.h"
 #include "dg/util/debug.h"
 
+#include "llvm/Dominators/PostDominance.h"
+
 #include <set>
 #include <map>
 #include <unordered_map>
@@ -27,7 +29,10 @@ namespace llvmdg {
 // like the other classes (we use the post-dominance computation from LLVM).
 class SCD : public LLVMControlDependenceAnalysisImpl {
 
-    void computePostDominators(llvm::Function& F);
+    // shared with the other users of post-dominators
+    PostDominance& _postDominance;
+
+    void computePostDominators(const llvm::Function& F);
 
     std::unordered_map<const llvm::BasicBlock *, std::set<llvm::BasicBlock *>> dependentBlocks;
     std::unordered_map<const llvm::BasicBlock *, std::set<llvm::BasicBlock *>> dependencies;
@@ -35,16 +40,17 @@ class SCD : public LLVMControlDependenceAnalysisImpl {
 
     void computeOnDemand(const llvm::Function *F) {
         if (_computed.insert(F).second) {
-            computePostDominators(*const_cast<llvm::Function*>(F));
+            computePostDominators(*F);
         }
     }
 
 public:
     using ValVec = LLVMControlDependenceAnalysis::ValVec;
 
-    SCD(const llvm::Module *module,
+    SCD(const llvm::Module *module, PostDominance& postDominance,
         const LLVMControlDependenceAnalysisOptions& opts = {})
-        : LLVMControlDependenceAnalysisImpl(module, opts) {}
+        : LLVMControlDependenceAnalysisImpl(module, opts),
+          _postDominance(postDominance) {}
 
     /// Getters of dependencies for a value
     ValVec getDependencies(const llvm::Instruction *) override { return {}; }
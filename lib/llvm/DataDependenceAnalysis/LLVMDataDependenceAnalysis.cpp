@@ -16,6 +16,8 @@
 #endif
 
 #include "dg/llvm/DataDependence/DataDependence.h"
+#include "dg/llvm/AnalysisCache/AnalysisCache.h"
+#include "dg/util/Profiling.h"
 #include "llvm/ReadWriteGraph/LLVMReadWriteGraphBuilder.h"
 
 namespace dg {
@@ -33,8 +35,13 @@ LLVMReadWriteGraphBuilder *LLVMDataDependenceAnalysis::createBuilder() {
 DataDependenceAnalysis *LLVMDataDependenceAnalysis::createDDA() {
     assert(builder);
 
+    debug::ScopedTimer timer("dda.build");
     // let the compiler do copy-ellision
     auto graph = builder->build();
+
+    auto& profiler = debug::Profiler::get();
+    profiler.count("dda.build", "nodes", graph.getNodesNum());
+    profiler.count("dda.build", "subgraphs", graph.size());
     return new DataDependenceAnalysis(std::move(graph), _options);
 }
 
@@ -50,6 +57,14 @@ const llvm::Value *LLVMDataDependenceAnalysis::getValue(const RWNode *node) cons
     return builder->getValue(node);
 }
 
+bool LLVMDataDependenceAnalysis::isUse(const llvm::Value *val) const {
+    if (_cache)
+        return _cache->isUse(val);
+
+    auto nd = getNode(val);
+    return nd && nd->isUse();
+}
+
 std::vector<llvm::Value *>
 LLVMDataDependenceAnalysis::getLLVMDefinitions(llvm::Instruction *where,
                                                llvm::Value *mem,
@@ -100,6 +115,9 @@ LLVMDataDependenceAnalysis::getLLVMDefinitions(llvm::Instruction *where,
 std::vector<llvm::Value *>
 LLVMDataDependenceAnalysis::getLLVMDefinitions(llvm::Value *use) {
 
+    if (_cache)
+        return _cache->getDefinitions(use);
+
     std::vector<llvm::Value *> defs;
 
     auto loc = getNode(use);
@@ -0,0 +1,128 @@
+// ignore unused parameters in LLVM libraries
+#if (__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-parameter"
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+
+#include <llvm/IR/Function.h>
+#include <llvm/IR/CFG.h>
+#include <llvm/Analysis/PostDominators.h>
+
+#if (__clang__)
+#pragma clang diagnostic pop // ignore -Wunused-parameter
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include "PostDominance.h"
+#include "dg/util/debug.h"
+
+namespace dg {
+namespace llvmdg {
+
+const unsigned PostDominance::ROOT;
+const unsigned PostDominance::NONE;
+
+const PostDominance::FunctionInfo&
+PostDominance::get(const llvm::Function *F) {
+    auto& info = _functions[F];
+    if (!info) {
+        info.reset(new FunctionInfo());
+        _compute(F, *info);
+    }
+
+    return *info;
+}
+
+void PostDominance::_compute(const llvm::Function *F, FunctionInfo& info) {
+    DBG_SECTION_BEGIN(cda, "Computing post-dominance for " << F->getName().str());
+    using namespace llvm;
+
+    const unsigned blocksNum = F->size();
+    info._blocks.reserve(blocksNum);
+    info._ids.reserve(blocksNum);
+    for (const BasicBlock& B : *F) {
+        info._ids[&B] = info._blocks.size();
+        info._blocks.push_back(&B);
+    }
+
+    info._ipdom.resize(blocksNum, NONE);
+
+    {
+    // the tree is needed only until we copy out the immediate post-dominators
+    Function& f = const_cast<Function&>(*F);
+#if ((LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR < 9))
+    PostDominatorTree pdtree;
+    pdtree.runOnFunction(f);
+#else
+    PostDominatorTree pdtree;
+    pdtree.recalculate(f);
+#endif
+
+    for (unsigned id = 0; id < blocksNum; ++id) {
+        auto *N = pdtree.getNode(const_cast<BasicBlock *>(info._blocks[id]));
+        // when function contains infinite loop, the block
+        // may not be in the tree (older LLVM)
+        if (!N)
+            continue;
+
+        info._hasTree = true;
+        auto *idom = N->getIDom();
+        BasicBlock *idomBB = idom ? idom->getBlock() : nullptr;
+        // PostDominatorTree may have a special root without BB set
+        info._ipdom[id] = idomBB ? info._ids[idomBB] : ROOT;
+    }
+    }
+
+    // compute the post-dominance frontiers: the block B is in the frontier
+    // of every block on the path in the tree from a successor of B
+    // up to (but excluding) the immediate post-dominator of B.
+    // The pairs (frontier owner, B) are then sorted into the flat arrays.
+    std::vector<std::pair<unsigned, unsigned>> pairs;
+    std::vector<unsigned> counts(blocksNum, 0);
+    // the last block whose walk went through the block
+    // (the walks from different successors may join)
+    std::vector<unsigned> visited(blocksNum, NONE);
+
+    for (unsigned id = 0; id < blocksNum; ++id) {
+        auto ipdom = info._ipdom[id];
+        if (ipdom == NONE)
+            continue;
+
+        for (const BasicBlock *succ : successors(info._blocks[id])) {
+            auto runner = info._ids[succ];
+            if (info._ipdom[runner] == NONE)
+                continue;
+
+            while (runner != ROOT && runner != ipdom && visited[runner] != id) {
+                visited[runner] = id;
+                pairs.emplace_back(runner, id);
+                ++counts[runner];
+                runner = info._ipdom[runner];
+            }
+        }
+    }
+
+    info._frontiersStart.resize(blocksNum + 1);
+    unsigned start = 0;
+    for (unsigned id = 0; id < blocksNum; ++id) {
+        info._frontiersStart[id] = start;
+        start += counts[id];
+        // use counts as the positions for filling the frontiers
+        counts[id] = info._frontiersStart[id];
+    }
+    info._frontiersStart[blocksNum] = start;
+
+    info._frontiers.resize(pairs.size());
+    for (auto& p : pairs) {
+        info._frontiers[counts[p.first]++] = p.second;
+    }
+
+    DBG_SECTION_END(cda, "Done computing post-dominance for " << F->getName().str());
+}
+
+} // namespace llvmdg
+} // namespace dg
@@ -0,0 +1,159 @@
+#ifndef DG_LLVM_POST_DOMINANCE_H_
+#define DG_LLVM_POST_DOMINANCE_H_
+
+#include <cassert>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// ignore unused parameters in LLVM libraries
+#if (__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-parameter"
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+
+#include <llvm/ADT/DenseMap.h>
+
+#if (__clang__)
+#pragma clang diagnostic pop // ignore -Wunused-parameter
+#else
+#pragma GCC diagnostic pop
+#endif
+
+namespace llvm {
+class BasicBlock;
+class Function;
+}
+
+namespace dg {
+namespace llvmdg {
+
+///
+// Post-dominance information of LLVM functions, shared by the
+// computations of control dependencies.
+//
+// For every function, the post-dominator tree is built only once
+// (by LLVM) and right away it is flattened into arrays indexed by
+// the blocks' ids (the position of the block in the function),
+// together with the post-dominance frontiers. The frontiers are computed
+// by walking up the tree from the successors of every block (the algorithm
+// by Cooper, Harvey and Kennedy applied to the reversed CFG), so no step
+// of the computation is recursive.
+//
+// K. D. Cooper, T. J. Harvey, and K. Kennedy. 2001.
+// A Simple, Fast Dominance Algorithm.
+class PostDominance {
+public:
+    // the immediate post-dominator of the block is the (virtual) root
+    // of the tree, i.e., the block is a root of the tree
+    static const unsigned ROOT = ~0U;
+    // the block is not in the post-dominator tree
+    static const unsigned NONE = ~0U - 1;
+
+    class FunctionInfo {
+        friend class PostDominance;
+
+        std::vector<const llvm::BasicBlock *> _blocks;
+        llvm::DenseMap<const llvm::BasicBlock *, unsigned> _ids;
+        std::vector<unsigned> _ipdom;
+        // post-dominance frontiers of block 'i' are
+        // _frontiers[_frontiersStart[i]] ... _frontiers[_frontiersStart[i + 1] - 1]
+        std::vector<unsigned> _frontiersStart;
+        std::vector<unsigned> _frontiers;
+        bool _hasTree{false};
+
+    public:
+        class BlocksRange {
+            const FunctionInfo *_info;
+            const unsigned *_begin;
+            const unsigned *_end;
+
+        public:
+            class iterator {
+                const FunctionInfo *_info;
+                const unsigned *_it;
+
+            public:
+                iterator(const FunctionInfo *info, const unsigned *it)
+                : _info(info), _it(it) {}
+
+                iterator& operator++() { ++_it; return *this; }
+                bool operator==(const iterator& rhs) const { return _it == rhs._it; }
+                bool operator!=(const iterator& rhs) const { return _it != rhs._it; }
+                const llvm::BasicBlock *operator*() const { return _info->getBlock(*_it); }
+            };
+
+            BlocksRange(const FunctionInfo *info, const unsigned *b, const unsigned *e)
+            : _info(info), _begin(b), _end(e) {}
+
+            iterator begin() const { return {_info, _begin}; }
+            iterator end() const { return {_info, _end}; }
+            size_t size() const { return _end - _begin; }
+            bool empty() const { return _begin == _end; }
+        };
+
+        size_t size() const { return _blocks.size(); }
+        // is any block of the function in the post-dominator tree?
+        bool hasTree() const { return _hasTree; }
+
+        const llvm::BasicBlock *getBlock(unsigned id) const {
+            assert(id < _blocks.size());
+            return _blocks[id];
+        }
+
+        unsigned getID(const llvm::BasicBlock *B) const {
+            auto it = _ids.find(B);
+            assert(it != _ids.end() && "Block from different function");
+            return it->second;
+        }
+
+        bool inTree(const llvm::BasicBlock *B) const {
+            return _ipdom[getID(B)] != NONE;
+        }
+
+        // return ROOT or NONE if the block does not have
+        // an immediate post-dominator that is a block
+        unsigned getIPostDomID(unsigned id) const {
+            assert(id < _ipdom.size());
+            return _ipdom[id];
+        }
+
+        const llvm::BasicBlock *getIPostDom(const llvm::BasicBlock *B) const {
+            auto ipdom = _ipdom[getID(B)];
+            if (ipdom == ROOT || ipdom == NONE)
+                return nullptr;
+            return _blocks[ipdom];
+        }
+
+        BlocksRange getFrontiers(unsigned id) const {
+            assert(id + 1 < _frontiersStart.size());
+            return {this, _frontiers.data() + _frontiersStart[id],
+                    _frontiers.data() + _frontiersStart[id + 1]};
+        }
+
+        BlocksRange getFrontiers(const llvm::BasicBlock *B) const {
+            return getFrontiers(getID(B));
+        }
+    };
+
+    // get the (cached) information for the function
+    const FunctionInfo& get(const llvm::Function *F);
+
+    // drop the cached information (e.g., after changing the CFG)
+    void invalidate(const llvm::Function *F) { _functions.erase(F); }
+    void clear() { _functions.clear(); }
+
+private:
+    std::unordered_map<const llvm::Function *,
+                       std::unique_ptr<FunctionInfo>> _functions;
+
+    static void _compute(const llvm::Function *F, FunctionInfo& info);
+};
+
+} // namespace llvmdg
+} // namespace dg
+
+#endif // DG_LLVM_POST_DOMINANCE_H_
@@ -8,7 +8,6 @@
 #endif
 
 #include <llvm/IR/Function.h>
-#include <llvm/Analysis/PostDominators.h>
 
 #if (__clang__)
 #pragma clang diagnostic pop // ignore -Wunused-parameter
@@ -16,63 +15,52 @@
 #pragma GCC diagnostic pop
 #endif
 
-#include "dg/BFS.h"
-#include "dg/Dominators/PostDominanceFrontiers.h"
+#include <vector>
 
 #include "dg/llvm/LLVMDependenceGraph.h"
 #include "dg/util/debug.h"
 
+#include "llvm/Dominators/PostDominance.h"
+
 namespace dg {
 
-void LLVMDependenceGraph::computePostDominators(bool addPostDomFrontiers)
+void LLVMDependenceGraph::computePostDominators(llvmdg::PostDominance& postDominance,
+                                                bool addPostDomFrontiers,
+                                                const std::set<const llvm::Function *> *functions)
 {
     DBG_SECTION_BEGIN(llvmdg, "Computing post-dominator frontiers (control deps.)");
     using namespace llvm;
+
     // iterate over all functions
     for (auto& F : getConstructedFunctions()) {
-        legacy::PostDominanceFrontiers<LLVMNode, LLVMBBlock> pdfrontiers;
+        if (functions && functions->count(llvm::cast<llvm::Function>(F.first)) == 0)
+            continue;
 
         // root of post-dominator tree
         LLVMBBlock *root = nullptr;
-        Value *val = const_cast<Value *>(F.first);
-        Function& f = *cast<Function>(val);
-        PostDominatorTree *pdtree;
+        const Function& f = *cast<Function>(F.first);
 
         DBG_SECTION_BEGIN(llvmdg, "Computing control deps. for " << f.getName().str());
 
-#if ((LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR < 9))
-        pdtree = new PostDominatorTree();
-        // compute post-dominator tree for this function
-        pdtree->runOnFunction(f);
-#else
-        PostDominatorTreeWrapperPass wrapper;
-        wrapper.runOnFunction(f);
-        pdtree = &wrapper.getPostDomTree();
-#ifndef NDEBUG
-        wrapper.verifyAnalysis();
-#endif
-#endif
+        const auto& info = postDominance.get(&f);
 
         // add immediate post-dominator edges
         auto& our_blocks = F.second->getBlocks();
-        bool built = false;
+        // our blocks indexed by the ids from the post-dominance info
+        std::vector<LLVMBBlock *> blocks(info.size(), nullptr);
         for (auto& it : our_blocks) {
             LLVMBBlock *BB = it.second;
-            BasicBlock *B = cast<BasicBlock>(const_cast<Value *>(it.first));
-            DomTreeNode *N = pdtree->getNode(B);
+            auto id = info.getID(cast<BasicBlock>(it.first));
+            blocks[id] = BB;
+
             // when function contains infinite loop, we're screwed
             // and we don't have anything
-            // FIXME: just check for the root,
-            // don't iterate over all blocks, stupid...
-            if (!N)
+            auto ipdom = info.getIPostDomID(id);
+            if (ipdom == llvmdg::PostDominance::NONE)
                 continue;
 
-            DomTreeNode *idom = N->getIDom();
-            BasicBlock *idomBB = idom ? idom->getBlock() : nullptr;
-            built = true;
-
-            if (idomBB) {
-                LLVMBBlock *pb = our_blocks[idomBB];
+            if (ipdom != llvmdg::PostDominance::ROOT) {
+                LLVMBBlock *pb = our_blocks[const_cast<BasicBlock *>(info.getBlock(ipdom))];
                 assert(pb && "Do not have constructed BB");
                 BB->setIPostDom(pb);
                 assert(cast<BasicBlock>(BB->getKey())->getParent()
@@ -95,7 +83,7 @@ void LLVMDependenceGraph::computePostDominators(bool addPostDomFrontiers)
         // well, if we haven't built the pdtree, this is probably infinite loop
         // that has no pdtree. Until we have anything better, just add sound control
         // edges that are not so precise - to predecessors.
-        if (!built && addPostDomFrontiers) {
+        if (!info.hasTree() && addPostDomFrontiers) {
             for (auto& it : our_blocks) {
                 LLVMBBlock *BB = it.second;
                 for (const LLVMBBlock::BBlockEdge& succ : BB->successors()) {
@@ -106,15 +94,25 @@ void LLVMDependenceGraph::computePostDominators(bool addPostDomFrontiers)
             }
         }
 
-        if (addPostDomFrontiers) {
-            // assert(root && "BUG: must have root");
-            if (root)
-                pdfrontiers.compute(root, true /* store also control depend. */);
+        if (addPostDomFrontiers && root) {
+            for (unsigned id = 0; id < info.size(); ++id) {
+                LLVMBBlock *BB = blocks[id];
+                assert(BB && "Do not have constructed BB");
+                for (auto *pdf : info.getFrontiers(id)) {
+                    LLVMBBlock *df = blocks[info.getID(pdf)];
+                    // the block is in its own frontier also when it only
+                    // encloses a loop, but we take it as control dependent
+                    // on itself only if it is a loop on its own
+                    if (df == BB && !BB->predecessors().contains(BB))
+                        continue;
+
+                    BB->addPostDomFrontier(df);
+                    // pd-frontiers are the reverse control dependencies
+                    df->addControlDependence(BB);
+                }
+            }
         }
 
-#if ((LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR < 9))
-        delete pdtree;
-#endif
         DBG_SECTION_END(llvmdg, "Done computing control deps. for " << f.getName().str());
     }
     DBG_SECTION_END(llvmdg, "Done computing post-dominator frontiers (control deps.)");
@@ -21,6 +21,12 @@
 #pragma GCC diagnostic pop
 #endif
 
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
 #include "dg/llvm/CallGraph/CallGraph.h"
 #include "dg/ADT/SetQueue.h"
 
@@ -68,6 +74,8 @@ class GraphBuilder {
 
         SubgraphT& subgraph;
         BlocksMappingT blocks{};
+        // the blocks in the order in which they are built
+        std::vector<const llvm::BasicBlock *> blocksOrder{};
 
         SubgraphInfo(SubgraphT& s) : subgraph(s) {}
         SubgraphInfo(SubgraphInfo&&) = default;
@@ -86,6 +94,68 @@ class GraphBuilder {
     ValuesMappingT _nodeToValue;
     GlobalsT _globals;
 
+    ///
+    // Building functions in parallel: the threads do not touch the shared
+    // mappings, the nodes of a function are stored in its FunctionNodes
+    // and merged into the shared mappings once all functions are built.
+    // The nodes that may be used in other functions (see isSharedValue())
+    // are built before the functions.
+    //
+    // The nodes get the IDs after the building. FunctionNodes::order
+    // keeps the nodes in the order in which the sequential building would
+    // create them (the created nodes and the first uses of shared nodes),
+    // so that the IDs are the same as with the sequential building,
+    // regardless of the number of threads.
+    struct FunctionNodes {
+        NodesMappingT nodes;
+        ValuesMappingT values;
+        std::vector<NodeT *> order;
+    };
+
+    struct Worker {
+        // the pool in which the worker creates the nodes
+        unsigned pool;
+        // nullptr when building the shared nodes
+        const llvm::Function *function{nullptr};
+        FunctionNodes *local{nullptr};
+        std::vector<NodeT *> *order{nullptr};
+
+        Worker(unsigned p) : pool(p) {}
+    };
+
+    // the state of the current thread (nullptr in sequential building)
+    static thread_local Worker *_worker;
+
+    // the nodes that were created when building a shared node
+    std::unordered_map<const NodeT *, std::vector<NodeT *>> _sharedOrder;
+
+    NodesMappingT& nodesMapping() {
+        return _worker && _worker->local ? _worker->local->nodes : _nodes;
+    }
+
+    ValuesMappingT& valuesMapping() {
+        return _worker && _worker->local ? _worker->local->values : _nodeToValue;
+    }
+
+    // a node that was created before may be used for the first time
+    // in the (sequential) order of building
+    void nodeUsed(NodeT *node) {
+        if (_worker && _worker->order)
+            _worker->order->push_back(node);
+    }
+
+    void addNodeInOrder(NodeT *node) {
+        if (node->getID() != 0)
+            return;
+
+        addNode(node);
+        auto it = _sharedOrder.find(node);
+        if (it != _sharedOrder.end()) {
+            for (NodeT *nd : it->second)
+                addNodeInOrder(nd);
+        }
+    }
+
     void buildCFG(SubgraphInfo& subginfo) {
         for (auto& it : subginfo.blocks) {
             auto llvmblk = it.first;
@@ -114,34 +184,89 @@ class GraphBuilder {
     }
 
 
+    // is 'val' an instruction of other function than the one
+    // that is built by the current thread?
+    bool buildsOtherFunction(const llvm::Value *val) const {
+        auto *I = llvm::dyn_cast<llvm::Instruction>(val);
+        return I && I->getParent()->getParent() != _worker->function;
+    }
+
 protected:
 
     NodesSeq<NodeT> buildNode(const llvm::Value *val) {
-        auto it = _nodes.find(val);
-        if (it != _nodes.end()) {
+        auto& nodes = nodesMapping();
+        auto it = nodes.find(val);
+        if (it != nodes.end()) {
             return it->second;
         }
 
+        if (&nodes != &_nodes) {
+            it = _nodes.find(val);
+            if (it != _nodes.end()) {
+                nodeUsed(it->second.getRepresentant());
+                return it->second;
+            }
+        }
+
+        if (&nodes != &_nodes && buildsOtherFunction(val)) {
+            // the node would be created in this worker only and the other
+            // functions would not see it (and the IDs would depend
+            // on the scheduling). This means that isSharedValue()
+            // misses some values, so this is a bug, not a user error.
+            llvm::errs() << "ERROR: building the node of '" << *val
+                         << "' from another function in parallel, "
+                            "the value must be shared (see isSharedValue())\n";
+            abort();
+        }
+
         const auto& nds = createNode(val);
         assert((nds.getRepresentant() || nds.empty())
                 && "Built node sequence has no representant");
 
         if (auto *repr = nds.getRepresentant()) {
-            _nodes.emplace(val, std::move(nds));
+            nodes.emplace(val, std::move(nds));
 
-            assert((_nodeToValue.find(repr) == _nodeToValue.end())
+            auto& values = valuesMapping();
+            assert((values.find(repr) == values.end())
                     && "Mapping a node that we already have");
-            _nodeToValue[repr] = val;
+            values[repr] = val;
         }
 
         return nds;
     }
 
+    ///
+    // Hooks for the parallel building.
+    // The nodes of values for which this returns true may be used
+    // as operands also in other functions than in the function of the value
+    // (e.g., allocations that are targets of pointers).
+    virtual bool isSharedValue(const llvm::Value *) const { return false; }
+    // Create the pools for nodes of the given number of threads.
+    virtual void createPools(unsigned) {}
+    // Add the node created in a pool to the graph (i.e., give it the ID).
+    // Called in the same order in which the sequential building creates
+    // the nodes.
+    virtual void addNode(NodeT *) {}
+
+    bool buildsInParallel() const { return _worker != nullptr; }
+    unsigned getPool() const { assert(_worker); return _worker->pool; }
+    // the function whose body is built by the current thread (nullptr
+    // in the sequential building and when building the shared nodes)
+    const llvm::Function *getBuiltFunction() const {
+        return _worker ? _worker->function : nullptr;
+    }
+
+    // must be called by createNode() for every created node
+    // when building in parallel
+    void nodeCreated(NodeT *node) {
+        assert(_worker && _worker->order);
+        _worker->order->push_back(node);
+    }
+
     BBlockT& buildBBlock(const llvm::BasicBlock& B, SubgraphInfo& subginfo) {
-        auto& bblock = createBBlock(&B, subginfo.subgraph);
-        assert(subginfo.blocks.find(&B) == subginfo.blocks.end()
-                && "Already have this basic block");
-        subginfo.blocks[&B] = &bblock;
+        assert(subginfo.blocks.find(&B) != subginfo.blocks.end()
+                && "Do not have this basic block");
+        auto& bblock = *subginfo.blocks[&B];
 
         for (auto& I : B) {
             for (auto *node : buildNode(&I)) {
@@ -152,16 +277,12 @@ protected:
         return bblock;
     }
 
-    void buildSubgraph(const llvm::Function& F) {
+    // create the (empty) blocks of the function. The blocks are created
+    // separately from their nodes so that the blocks get the same IDs
+    // no matter whether the functions are built in parallel or not.
+    void createBBlocks(const llvm::Function& F, SubgraphInfo& subginfo) {
         using namespace llvm;
 
-        DBG_SECTION_BEGIN(dg, "Building the subgraph for " << F.getName().str());
-        auto subgit = _subgraphs.find(&F);
-        assert(subgit != _subgraphs.end() && "Do not have that subgraph");
-
-        auto& subginfo = subgit->second;
-
-        DBG(dg, "Building basic blocks of " << F.getName().str());
         // do a walk through basic blocks such that all predecessors of
         // a block are searched before the block itself
         // (operands must be created before their use)
@@ -172,12 +293,33 @@ protected:
         while (!queue.empty()) {
             auto *cur = queue.pop();
 
-            buildBBlock(*cur, subginfo);
+            auto& bblock = createBBlock(cur, subginfo.subgraph);
+            assert(subginfo.blocks.find(cur) == subginfo.blocks.end()
+                    && "Already have this basic block");
+            subginfo.blocks[cur] = &bblock;
+            subginfo.blocksOrder.push_back(cur);
 
             for (auto *succ : successors(cur)) {
                 queue.push(succ);
             }
         }
+    }
+
+    SubgraphInfo& getSubgraphInfo(const llvm::Function& F) {
+        auto subgit = _subgraphs.find(&F);
+        assert(subgit != _subgraphs.end() && "Do not have that subgraph");
+        return subgit->second;
+    }
+
+    void buildSubgraph(const llvm::Function& F) {
+        DBG_SECTION_BEGIN(dg, "Building the subgraph for " << F.getName().str());
+        auto& subginfo = getSubgraphInfo(F);
+
+        DBG(dg, "Building basic blocks of " << F.getName().str());
+        if (subginfo.blocksOrder.empty())
+            createBBlocks(F, subginfo);
+        for (auto *B : subginfo.blocksOrder)
+            buildBBlock(*B, subginfo);
 
         DBG(dg, "Building CFG");
         buildCFG(subginfo);
@@ -185,8 +327,82 @@ protected:
         DBG_SECTION_END(dg, "Building the subgraph done");
     }
 
-    void buildAllFuns() {
+    void buildSubgraphs(const std::vector<const llvm::Function *>& funs,
+                        unsigned threads) {
+        if (threads > funs.size())
+            threads = funs.size();
+
+        if (threads <= 1) {
+            for (auto *F : funs)
+                buildSubgraph(*F);
+            return;
+        }
+
+        DBG_SECTION_BEGIN(dg, "Building " << funs.size()
+                              << " functions using " << threads << " threads");
+        createPools(threads);
+
+        // the creation of blocks is cheap and it is not thread-safe
+        // (the blocks take their IDs from a global counter)
+        for (auto *F : funs)
+            createBBlocks(*F, getSubgraphInfo(*F));
+
+        // build the shared nodes first (only of the functions
+        // that we build, other functions do not get any nodes)
+        Worker main(0);
+        _worker = &main;
+        for (auto *F : funs) {
+            for (auto& B : *F) {
+                for (auto& I : B) {
+                    if (!isSharedValue(&I))
+                        continue;
+                    std::vector<NodeT *> order;
+                    main.order = &order;
+                    if (auto *repr = buildNode(&I).getRepresentant())
+                        _sharedOrder[repr] = std::move(order);
+                }
+            }
+        }
+
+        // build the functions
+        std::vector<FunctionNodes> results(funs.size());
+        std::atomic<size_t> next{0};
+        auto worker = [&](unsigned pool) {
+            Worker W(pool);
+            _worker = &W;
+            size_t i;
+            while ((i = next++) < funs.size()) {
+                W.function = funs[i];
+                W.local = &results[i];
+                W.order = &results[i].order;
+                buildSubgraph(*funs[i]);
+            }
+            _worker = nullptr;
+        };
+
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < threads; ++t)
+            pool.emplace_back(worker, t);
+        worker(0);
+        for (auto& thread : pool)
+            thread.join();
+
+        // number the nodes and merge the mappings
+        for (auto& res : results) {
+            for (NodeT *node : res.order)
+                addNodeInOrder(node);
+            for (auto& it : res.nodes)
+                _nodes.emplace(it.first, std::move(it.second));
+            _nodeToValue.insert(res.values.begin(), res.values.end());
+        }
+        _sharedOrder.clear();
+
+        DBG_SECTION_END(dg, "Building functions done");
+    }
+
+    void buildAllFuns(unsigned threads) {
         DBG(dg, "Building all functions from LLVM module");
+        std::vector<const llvm::Function *> funs;
         for (auto& F : *_module) {
             if (F.isDeclaration()) {
                 continue;
@@ -195,35 +411,31 @@ protected:
                    && "Already have that subgraph");
             auto& subg = createSubgraph(&F);
             _subgraphs.emplace(&F, subg);
+            funs.push_back(&F);
         }
 
         // now do the real thing
-        for (auto& F : *_module) {
-            if (!F.isDeclaration()) {
-                buildSubgraph(F);
-            }
-        }
+        buildSubgraphs(funs, threads);
     }
 
-    void buildFunsFromCG(llvmdg::CallGraph *cg) {
+    void buildFunsFromCG(llvmdg::CallGraph *cg, unsigned threads) {
         const auto& funs = cg->functions();
         // we should have at least the entry fun
         assert(!funs.empty() && "No function in call graph");
 
+        std::vector<const llvm::Function *> defined;
         for (auto *F : funs) {
             DBG(dg, "Building functions based on call graph information");
             assert(_subgraphs.find(F) == _subgraphs.end()
                    && "Already have that subgraph");
             auto& subg = createSubgraph(F);
             _subgraphs.emplace(F, subg);
+            if (!F->isDeclaration())
+                defined.push_back(F);
         }
 
         // now do the real thing
-        for (auto *F : funs) {
-           if (!F->isDeclaration()) {
-               buildSubgraph(*F);
-           }
-        }
+        buildSubgraphs(defined, threads);
     }
 
 
@@ -249,8 +461,18 @@ public:
     }
 
     NodeT *getNode(const llvm::Value *v) {
+        if (_worker && _worker->local) {
+            auto it = _worker->local->nodes.find(v);
+            if (it != _worker->local->nodes.end())
+                return it->second.getRepresentant();
+        }
+
         auto it = _nodes.find(v);
-        return it == _nodes.end() ? nullptr : it->second.getRepresentant();
+        if (it == _nodes.end())
+            return nullptr;
+
+        nodeUsed(it->second.getRepresentant());
+        return it->second.getRepresentant();
     }
 
     const NodeT *getNode(const llvm::Value *v) const {
@@ -277,7 +499,10 @@ public:
     virtual BBlockT& createBBlock(const llvm::BasicBlock *, SubgraphT&) = 0;
     virtual SubgraphT& createSubgraph(const llvm::Function *) = 0;
 
-    void buildFromLLVM(llvmdg::CallGraph *cg = nullptr) {
+    // Build the graph. The bodies of functions are built by 'threads'
+    // threads (the derived class must implement the hooks for
+    // the parallel building to use more than one thread).
+    void buildFromLLVM(llvmdg::CallGraph *cg = nullptr, unsigned threads = 1) {
         assert(_module && "Do not have the LLVM module");
 
         buildGlobals();
@@ -286,13 +511,17 @@ public:
         // so that calls can use them as operands
 
         if (cg) {
-            buildFunsFromCG(cg);
+            buildFunsFromCG(cg, threads);
         } else {
-            buildAllFuns();
+            buildAllFuns(threads);
         }
     }
 };
 
+template <typename NodeT, typename BBlockT, typename SubgraphT>
+thread_local typename GraphBuilder<NodeT, BBlockT, SubgraphT>::Worker *
+GraphBuilder<NodeT, BBlockT, SubgraphT>::_worker = nullptr;
+
 } // namespace dg
 
 #endif
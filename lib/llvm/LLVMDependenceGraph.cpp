@@ -6,9 +6,13 @@
  #error "Need CFG enabled for building LLVM Dependence Graph"
 #endif
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
 #include <utility>
 #include <unordered_map>
 #include <set>
+#include <vector>
 
 // ignore unused parameters in LLVM libraries
 #if (__clang__)
@@ -27,6 +31,7 @@
  #include <llvm/IR/CFG.h>
 #endif
 
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Instructions.h>
 #include <llvm/IR/Value.h>
@@ -50,6 +55,7 @@
 #include "llvm/LLVMDGVerifier.h"
 #include "llvm-utils.h"
 #include "dg/util/debug.h"
+#include "dg/util/Profiling.h"
 
 #include "dg/ADT/Queue.h"
 
@@ -781,6 +787,7 @@ bool LLVMDependenceGraph::build(llvm::Module *m,
                                 LLVMDataDependenceAnalysis *rda,
                                 llvm::Function *entry)
 {
+    debug::ScopedTimer timer("dg.build");
     this->PTA = pts;
     this->DDA = rda;
     return build(m, entry);
@@ -960,11 +967,15 @@ bool LLVMDependenceGraph::getCallSites(const std::vector<std::string>& names,
     return callsites->size() != 0;
 }
 
-void LLVMDependenceGraph::computeNTSCD(const LLVMControlDependenceAnalysisOptions& opts) {
+void LLVMDependenceGraph::computeNTSCD(const LLVMControlDependenceAnalysisOptions& opts,
+                                       const std::set<const llvm::Function *> *functions) {
     DBG_SECTION_BEGIN(llvmdg, "Filling in CDA edges (NTSCD)");
     dg::llvmdg::NTSCD ntscd(this->module, opts);
 
     for (auto& it : getConstructedFunctions()) {
+        if (functions && functions->count(llvm::cast<llvm::Function>(it.first)) == 0)
+            continue;
+
         auto& blocks = it.second->getBlocks();
         for (auto& BB : *llvm::cast<llvm::Function>(it.first)) {
             auto *bb = blocks[&BB];
@@ -1031,24 +1042,208 @@ void LLVMDependenceGraph::computeNonTerminationControlDependencies() {
     DBG_SECTION_END(llvmdg, "Done computing NTSCD");
 }
 
-void LLVMDependenceGraph::computeInterferenceDependentEdges(ControlFlowGraph * controlFlowGraph)
+namespace {
+
+///
+// Index of memory accesses from thread regions for the computation
+// of interference dependencies. The points-to set of every access
+// is queried only once and the stores are bucketed by the accessed
+// memory (object and offset), so every load is matched only with
+// the stores that may write to the memory that it reads.
+class InterferenceIndex {
+    LLVMPointerAnalysis *PTA;
+
+    struct Access {
+        LLVMNode *node;
+        unsigned region;
+    };
+
+    struct PointsTo {
+        std::vector<std::pair<const llvm::Value *, Offset::type>> pointers;
+        bool unknown{false};
+    };
+
+    std::unordered_map<const llvm::Instruction *, PointsTo> _pointsTo;
+
+    std::vector<Access> _stores;
+    // (memory object, offset) -> stores (the offset may be unknown)
+    llvm::DenseMap<std::pair<const llvm::Value *, Offset::type>,
+                   std::vector<unsigned>> _storesByOffset;
+    // memory object -> stores
+    llvm::DenseMap<const llvm::Value *, std::vector<unsigned>> _storesByObject;
+    // stores via a pointer to unknown memory
+    std::vector<unsigned> _unknownStores;
+
+    // loads grouped by regions
+    std::vector<std::vector<std::pair<LLVMNode *, const PointsTo *>>> _loads;
+
+    // regions that may run in parallel, the regions are
+    // identified by their indices in this relation
+    MayHappenInParallel _mayHappenInParallel;
+
+    const PointsTo& getPointsTo(const llvm::Instruction *I, const llvm::Value *ptr) {
+        auto it = _pointsTo.find(I);
+        if (it != _pointsTo.end())
+            return it->second;
+
+        auto& pts = _pointsTo[I];
+        auto llvmPts = PTA->getLLVMPointsTo(ptr);
+        for (const auto& ptr : llvmPts) {
+            pts.pointers.emplace_back(ptr.value, *ptr.offset);
+        }
+        pts.unknown = llvmPts.hasUnknown();
+        return pts;
+    }
+
+    void addStore(LLVMNode *node, unsigned region, const PointsTo& pts) {
+        unsigned id = _stores.size();
+        _stores.push_back({node, region});
+
+        if (pts.unknown)
+            _unknownStores.push_back(id);
+
+        for (const auto& ptr : pts.pointers) {
+            _storesByOffset[ptr].push_back(id);
+            _storesByObject[ptr.first].push_back(id);
+        }
+    }
+
+    template <typename FunT>
+    void forEachStore(const std::vector<unsigned> *stores,
+                      unsigned loadRegion, const FunT& fun) const {
+        if (!stores)
+            return;
+        for (auto id : *stores) {
+            const auto& store = _stores[id];
+            if (_mayHappenInParallel.parallel(loadRegion, store.region))
+                fun(store.node);
+        }
+    }
+
+    template <typename MapT, typename KeyT>
+    static const std::vector<unsigned> *find(const MapT& map, const KeyT& key) {
+        auto it = map.find(key);
+        return it == map.end() ? nullptr : &it->second;
+    }
+
+public:
+    InterferenceIndex(LLVMPointerAnalysis *PTA,
+                      const std::set<ThreadRegion *>& regions)
+    : PTA(PTA), _loads(regions.size()), _mayHappenInParallel(regions) {
+        auto& constructed = getConstructedFunctions();
+        for (auto *region : regions) {
+            auto id = _mayHappenInParallel.index(region);
+            for (const auto *I : region->llvmInstructions()) {
+                if (!llvm::isa<llvm::LoadInst>(I) && !llvm::isa<llvm::StoreInst>(I))
+                    continue;
+
+                auto fun = constructed.find(const_cast<llvm::Function *>(I->getParent()->getParent()));
+                if (fun == constructed.end())
+                    continue;
+                auto *node = fun->second->findNode(const_cast<llvm::Instruction *>(I));
+                if (!node)
+                    continue;
+
+                if (auto *LI = llvm::dyn_cast<llvm::LoadInst>(I)) {
+                    _loads[id].emplace_back(node, &getPointsTo(I, LI->getPointerOperand()));
+                } else {
+                    auto *SI = llvm::cast<llvm::StoreInst>(I);
+                    addStore(node, id, getPointsTo(I, SI->getPointerOperand()));
+                }
+            }
+        }
+    }
+
+    // call fun(store, load) for the loads from the given region and the
+    // stores from parallel regions that may write the memory
+    // read by the loads. The regions can be processed independently.
+    template <typename FunT>
+    void forEachInterference(unsigned region, const FunT& fun) const {
+        for (const auto& load : _loads[region]) {
+            auto *loadNode = load.first;
+            const auto& pts = *load.second;
+            auto addEdge = [&fun, loadNode](LLVMNode *storeNode) {
+                fun(storeNode, loadNode);
+            };
+
+            if (pts.unknown) {
+                // the load may read anything
+                for (const auto& store : _stores) {
+                    if (_mayHappenInParallel.parallel(region, store.region))
+                        fun(store.node, loadNode);
+                }
+                continue;
+            }
+
+            forEachStore(&_unknownStores, region, addEdge);
+            for (const auto& ptr : pts.pointers) {
+                if (ptr.second == Offset::UNKNOWN) {
+                    forEachStore(find(_storesByObject, ptr.first), region, addEdge);
+                } else {
+                    forEachStore(find(_storesByOffset, ptr), region, addEdge);
+                    forEachStore(find(_storesByOffset, std::make_pair(ptr.first, Offset::UNKNOWN)),
+                                 region, addEdge);
+                }
+            }
+        }
+    }
+
+    unsigned getRegionsNum() const { return _mayHappenInParallel.size(); }
+};
+
+} // anonymous namespace
+
+void LLVMDependenceGraph::computeInterferenceDependentEdges(ControlFlowGraph * controlFlowGraph,
+                                                            unsigned threads)
 {
-    auto regions = controlFlowGraph->threadRegions();
-    MayHappenInParallel mayHappenInParallel(regions);
-
-    for (const auto &currentRegion : regions) {
-        auto llvmValuesForCurrentRegion     = currentRegion->llvmInstructions();
-        auto currentRegionLoads             = getLoadInstructions(llvmValuesForCurrentRegion);
-        auto currentRegionStores            = getStoreInstructions(llvmValuesForCurrentRegion);
-        auto parallelRegions                = mayHappenInParallel.parallelRegions(currentRegion);
-        for (const auto &parallelRegion : parallelRegions) {
-            auto llvmInstructionsForParallelRegion      = parallelRegion->llvmInstructions();
-            auto parallelRegionLoads                    = getLoadInstructions(llvmInstructionsForParallelRegion);
-            auto parallelRegionStores                   = getStoreInstructions(llvmInstructionsForParallelRegion);
-                computeInterferenceDependentEdges(currentRegionLoads, parallelRegionStores);
-                computeInterferenceDependentEdges(parallelRegionLoads, currentRegionStores);
+    DBG_SECTION_BEGIN(llvmdg, "Computing interference dependencies");
+
+    // the index queries the pointer analysis, so it is built sequentially
+    InterferenceIndex index(PTA, controlFlowGraph->threadRegions());
+    const unsigned regionsNum = index.getRegionsNum();
+
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    if (threads > regionsNum)
+        threads = regionsNum;
+
+    if (threads <= 1) {
+        for (unsigned region = 0; region < regionsNum; ++region) {
+            index.forEachInterference(region, [](LLVMNode *storeNode, LLVMNode *loadNode) {
+                storeNode->addInterferenceDependence(loadNode);
+            });
+        }
+    } else {
+        // the join only reads the index, so the regions are joined
+        // in parallel and the edges are added to the graph afterwards
+        // (in the order of regions, so that the graph is deterministic)
+        std::vector<std::vector<std::pair<LLVMNode *, LLVMNode *>>> edges(regionsNum);
+        std::atomic<unsigned> next{0};
+        auto worker = [&]() {
+            unsigned region;
+            while ((region = next++) < regionsNum) {
+                auto& regionEdges = edges[region];
+                index.forEachInterference(region, [&regionEdges](LLVMNode *storeNode,
+                                                                 LLVMNode *loadNode) {
+                    regionEdges.emplace_back(storeNode, loadNode);
+                });
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < threads; ++t)
+            pool.emplace_back(worker);
+        worker();
+        for (auto& thread : pool)
+            thread.join();
+
+        for (const auto& regionEdges : edges) {
+            for (const auto& edge : regionEdges)
+                edge.first->addInterferenceDependence(edge.second);
         }
     }
+
+    DBG_SECTION_END(llvmdg, "Done computing interference dependencies");
 }
 
 void LLVMDependenceGraph::computeForkJoinDependencies(ControlFlowGraph *controlFlowGraph) {
@@ -1092,73 +1287,6 @@ void LLVMDependenceGraph::computeCriticalSections(ControlFlowGraph *controlFlowG
     }
 }
 
-void LLVMDependenceGraph::computeInterferenceDependentEdges(const std::set<const llvm::Instruction *> &loads,
-                                                            const std::set<const llvm::Instruction *> &stores) {
-
-    for (const auto &load :loads) {
-        auto *loadInst = const_cast<llvm::Instruction *>(load);
-        auto loadFunction = constructedFunctions.find(const_cast<llvm::Function *>(load->getParent()->getParent()));
-        if (loadFunction == constructedFunctions.end())
-            continue;
-        auto loadNode = loadFunction->second->findNode(loadInst);
-        if (!loadNode)
-            continue;
-
-        for (const auto &store : stores) {
-            auto *storeInst = const_cast<llvm::Instruction *>(store);
-            auto storeFunction = constructedFunctions.find(const_cast<llvm::Function *>(store->getParent()->getParent()));
-            if (storeFunction == constructedFunctions.end())
-                continue;
-            auto storeNode = storeFunction->second->findNode(storeInst);
-            if (!storeNode)
-                continue;
-
-            auto loadPts = PTA->getLLVMPointsTo(load->getOperand(0));
-            auto storePts = PTA->getLLVMPointsTo(store->getOperand(1));
-            for (const auto& pointerLoad : loadPts) {
-                for (const auto& pointerStore : storePts) {
-                    if (pointerLoad.value == pointerStore.value &&
-                        (pointerLoad.offset.isUnknown()  ||
-                         pointerStore.offset.isUnknown() ||
-                         pointerLoad.offset == pointerStore.offset)) {
-
-                        storeNode->addInterferenceDependence(loadNode);
-                    }
-                }
-            }
-
-            // handle the unknown pointer
-            if (loadPts.hasUnknown() || storePts.hasUnknown())
-                storeNode->addInterferenceDependence(loadNode);
-        }
-    }
-}
-
-std::set<const llvm::Instruction *>
-LLVMDependenceGraph::getLoadInstructions(const std::set<const llvm::Instruction *> &llvmInstructions) const {
-    return getInstructionsOfType(llvm::Instruction::Load, llvmInstructions);
-}
-
-std::set<const llvm::Instruction *>
-LLVMDependenceGraph::getStoreInstructions(const std::set<const llvm::Instruction *> &llvmInstructions) const {
-    return getInstructionsOfType(llvm::Instruction::Store, llvmInstructions);
-}
-
-std::set<const llvm::Instruction *>
-LLVMDependenceGraph::getInstructionsOfType(const unsigned opCode,
-                                           const std::set<const llvm::Instruction *> &llvmInstructions) const {
-    std::set<const llvm::Instruction *> instructions;
-    for (const auto &llvmValue : llvmInstructions) {
-        if (llvm::isa<llvm::Instruction>(llvmValue)) {
-            const llvm::Instruction *instruction = static_cast<const llvm::Instruction *>(llvmValue);
-            if (instruction->getOpcode() == opCode) {
-                instructions.insert(instruction);
-            }
-        }
-    }
-    return instructions;
-}
-
 void LLVMDependenceGraph::addNoreturnDependencies(LLVMNode *noret, LLVMBBlock *from) {
     std::set<LLVMBBlock *> visited;
     ADT::QueueLIFO<LLVMBBlock *> queue;
@@ -1212,6 +1340,7 @@ void LLVMDependenceGraph::addNoreturnDependencies()
 }
 
 void LLVMDependenceGraph::addDefUseEdges() {
+    debug::ScopedTimer timer("dg.defuse");
     LLVMDefUseAnalysis DUA(this, DDA, PTA);
     DUA.run();
 }
@@ -0,0 +1,95 @@
+#include <algorithm>
+
+#include "dg/llvm/PointerAnalysis/AliasQueries.h"
+#include "dg/llvm/PointerAnalysis/PointerAnalysis.h"
+
+namespace dg {
+
+const LLVMAliasQueries::Summary&
+LLVMAliasQueries::_getSummary(LLVMPointerAnalysis *PTA, const llvm::Value *val) {
+    auto it = _summaries.find(val);
+    if (it != _summaries.end())
+        return it->second;
+
+    Summary& S = _summaries[val];
+    auto pts = PTA->getLLVMPointsTo(val);
+    S.unknown = pts.hasUnknown();
+    S.targets.reserve(pts.size());
+    for (const auto& ptr : pts) {
+        auto obj = _objects.emplace(ptr.value, _objects.size()).first->second;
+        S.targets.emplace_back(obj, *ptr.offset);
+    }
+
+    std::sort(S.targets.begin(), S.targets.end());
+    return S;
+}
+
+static bool overlapBytes(Offset::type offA, Offset sizeA,
+                         Offset::type offB, Offset sizeB) {
+    if (offA == Offset::UNKNOWN || offB == Offset::UNKNOWN)
+        return true;
+    // the unknown size (and an overflow) yields Offset::UNKNOWN,
+    // which is greater than any offset
+    return offA < *(Offset(offB) + sizeB) && offB < *(Offset(offA) + sizeA);
+}
+
+bool LLVMAliasQueries::_overlap(const Summary& A, Offset sizeA,
+                                const Summary& B, Offset sizeB) {
+    if (A.unknown || B.unknown)
+        return true;
+
+    auto itA = A.targets.begin(), endA = A.targets.end();
+    auto itB = B.targets.begin(), endB = B.targets.end();
+    while (itA != endA && itB != endB) {
+        if (itA->first < itB->first) {
+            ++itA;
+        } else if (itB->first < itA->first) {
+            ++itB;
+        } else {
+            // the same object, compare all the offsets of the object
+            auto obj = itA->first;
+            auto lastB = itB;
+            while (lastB != endB && lastB->first == obj)
+                ++lastB;
+
+            for (; itA != endA && itA->first == obj; ++itA) {
+                for (auto it = itB; it != lastB; ++it) {
+                    if (overlapBytes(itA->second, sizeA, it->second, sizeB))
+                        return true;
+                }
+            }
+            itB = lastB;
+        }
+    }
+
+    return false;
+}
+
+bool LLVMAliasQueries::mayOverlap(LLVMPointerAnalysis *PTA,
+                                  const LLVMAliasQuery& Q) {
+    // normalize the query, the relation is symmetric
+    LLVMAliasQuery key = Q;
+    if (*key.sizeA == 0)
+        key.sizeA = Offset::UNKNOWN;
+    if (*key.sizeB == 0)
+        key.sizeB = Offset::UNKNOWN;
+    if (std::less<const llvm::Value *>()(key.b, key.a) ||
+        (key.a == key.b && key.sizeB < key.sizeA)) {
+        std::swap(key.a, key.b);
+        std::swap(key.sizeA, key.sizeB);
+    }
+
+    auto it = _results.find(key);
+    if (it != _results.end())
+        return it->second;
+
+    // _getSummary may rehash _summaries, but the references
+    // to the elements of unordered_map stay valid
+    const auto& A = _getSummary(PTA, key.a);
+    const auto& B = _getSummary(PTA, key.b);
+    bool result = _overlap(A, key.sizeA, B, key.sizeB);
+    _results.emplace(key, result);
+    return result;
+}
+
+} // namespace dg
@@ -59,7 +59,7 @@ LLVMPointerGraphBuilder::buildPointerGraphBlock(const llvm::BasicBlock& block,
             continue;
         }
 
-        assert(nodes_map.count(&Inst) == 0
+        assert(getNodes(&Inst) == nullptr
                 && "Already built this instruction");
         auto& seq = buildInstruction(Inst);
 
@@ -35,6 +35,7 @@
 #endif
 
 #include "dg/llvm/PointerAnalysis/PointerGraph.h"
+#include "llvm/llvm-utils.h"
 
 namespace dg {
 namespace pta {
@@ -122,6 +123,8 @@ void LLVMPointerGraphBuilder::buildGlobals()
         // handle globals initialization
         if (const auto GV = llvm::dyn_cast<llvm::GlobalVariable>(&*I)) {
             node->setSize(getAllocatedSize(GV, &M->getDataLayout()));
+            node->setElementSize(llvmutils::getArrayElementSize(
+                    GV->getType()->getContainedType(0), &M->getDataLayout()));
 
             if (GV->hasInitializer() && !GV->isExternallyInitialized()) {
                 const llvm::Constant *C = GV->getInitializer();
@@ -9,8 +9,10 @@ LLVMPointerGraphBuilder::createAlloc(const llvm::Instruction *Inst) {
     PSNodeAlloc *node = PSNodeAlloc::get(PS.create(PSNodeType::ALLOC));
 
     const llvm::AllocaInst *AI = llvm::dyn_cast<llvm::AllocaInst>(Inst);
-    if (AI)
+    if (AI) {
         node->setSize(llvmutils::getAllocatedSize(AI, &M->getDataLayout()));
+        node->setElementSize(llvmutils::getArrayElementSize(AI, &M->getDataLayout()));
+    }
 
     return addNode(Inst, node);
 }
@@ -66,7 +66,8 @@ void LLVMPointerGraphBuilder::addArgumentOperands(const llvm::Function *F,
         const Value *use = I->getUser();
 #endif
         const CallInst *CI = dyn_cast<CallInst>(use);
-        if (CI && CI->getCalledFunction() == F)
+        // the calls of clones have their own arguments
+        if (CI && CI->getCalledFunction() == F && _clonedCalls.count(CI) == 0)
             addArgumentOperands(CI, arg, idx);
     }
 }
@@ -75,9 +76,9 @@ void LLVMPointerGraphBuilder::addArgumentsOperands(const llvm::Function *F,
                                                       const llvm::CallInst *CI, int index)
 {
     for (auto A = F->arg_begin(), E = F->arg_end(); A != E; ++A, ++index) {
-        auto it = nodes_map.find(&*A);
-        assert(it != nodes_map.end());
-        PSNodesSeq& cur = it->second;
+        auto *nds = getNodes(&*A);
+        assert(nds);
+        PSNodesSeq& cur = *nds;
 
         if (CI) {
             // with func ptr call we know from which
@@ -110,7 +111,7 @@ void LLVMPointerGraphBuilder::addVariadicArgumentOperands(const llvm::Function *
         const Value *use = I->getUser();
 #endif
         const CallInst *CI = dyn_cast<CallInst>(use);
-        if (CI && CI->getCalledFunction() == F)
+        if (CI && CI->getCalledFunction() == F && _clonedCalls.count(CI) == 0)
             addVariadicArgumentOperands(F, CI, arg);
         // if this is funcptr, we handle it in the other
         // version of addVariadicArgumentOperands
@@ -166,7 +167,7 @@ void LLVMPointerGraphBuilder::addReturnNodeOperand(const llvm::Function *F, PSNo
 #endif
         // get every call and its assocciated return and add the operand
         const CallInst *CI = dyn_cast<CallInst>(use);
-        if (CI && CI->getCalledFunction() == F) {
+        if (CI && CI->getCalledFunction() == F && _clonedCalls.count(CI) == 0) {
             auto *nodes = getNodes(CI);
             // since we're building the graph only for the reachable nodes from
             // the entry, we may not have all call-sites of this function
@@ -179,6 +180,26 @@ void LLVMPointerGraphBuilder::addReturnNodeOperand(const llvm::Function *F, PSNo
     }
 }
 
+void LLVMPointerGraphBuilder::addCloneOperands(FunctionClone *clone,
+                                               const llvm::CallInst *CI,
+                                               PSNode *callNode)
+{
+    // the actual arguments are taken from the current context
+    // (the caller), but the formal arguments are those of the clone
+    const llvm::Function *F = clone->function;
+    int idx = 0;
+    for (auto A = F->arg_begin(), E = F->arg_end(); A != E; ++A, ++idx) {
+        auto it = clone->nodes.find(&*A);
+        assert(it != clone->nodes.end());
+        addArgumentOperands(CI, it->second.getSingleNode(), idx);
+    }
+
+    assert(!F->isVarArg() && "We do not clone variadic functions");
+
+    if (!clone->subgraph->returnNodes.empty())
+        addReturnNodesOperands(F, *clone->subgraph, callNode);
+}
+
 void LLVMPointerGraphBuilder::addInterproceduralPthreadOperands(const llvm::Function *F, const llvm::CallInst *CI)
 {
     // last argument (with index 3) is argument to function pthread_create will call
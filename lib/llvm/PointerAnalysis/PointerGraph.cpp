@@ -72,11 +72,9 @@ PSNode *LLVMPointerGraphBuilder::getConstant(const llvm::Value *val)
 // try get operand, return null if no such value has been constructed
 PSNode *LLVMPointerGraphBuilder::tryGetOperand(const llvm::Value *val)
 {
-    auto it = nodes_map.find(val);
     PSNode *op = nullptr;
-
-    if (it != nodes_map.end())
-        op = it->second.getRepresentant();
+    if (auto *nds = getNodes(val))
+        op = nds->getRepresentant();
 
     // if we don't have the operand, then it is a ConstantExpr
     // or some operand of intToPtr instruction (or related to that)
@@ -124,7 +122,7 @@ LLVMPointerGraphBuilder::getAndConnectSubgraph(const llvm::Function *F,
                                                const llvm::CallInst *CInst,
                                                PSNode *callNode) {
     // find or build the subgraph for the function F
-    PointerSubgraph& subg = createOrGetSubgraph(F);
+    PointerSubgraph& subg = createOrGetSubgraph(F, CInst);
     assert(subg.root); // we took the subg by reference, so it should be filled now
 
     // setup call edges
@@ -156,8 +154,16 @@ LLVMPointerGraphBuilder::createCallToFunction(const llvm::CallInst *CInst,
     callNode->setPairedNode(returnNode);
 
     // this must be after we created the CALL_RETURN node
-    if (ad_hoc_building) {
-        // add operands to arguments and return nodes
+    auto clone = _clonesMap.find(&subg);
+    if (clone != _clonesMap.end()) {
+        // the clone is called only from this call-site
+        addCloneOperands(clone->second, CInst, callNode);
+        if (!_clone)
+            _clonedCalls.insert(CInst);
+    } else if (ad_hoc_building || _clone) {
+        // add operands to arguments and return nodes.
+        // In a clone, we must do it here, because the values
+        // of the clone are not visible later
         addInterproceduralOperands(F, subg, CInst, callNode);
     }
 
@@ -234,6 +240,10 @@ LLVMPointerGraphBuilder::createOrGetSubgraph(const llvm::Function *F)
 {
     auto it = subgraphs_map.find(F);
     if (it == subgraphs_map.end()) {
+        // the context-insensitive subgraph is not a part of any clone
+        FunctionClone *clone = _clone;
+        _clone = nullptr;
+
         // create a new subgraph
         PointerSubgraph& subg = buildFunction(*F);
         assert(subg.root != nullptr);
@@ -242,6 +252,7 @@ LLVMPointerGraphBuilder::createOrGetSubgraph(const llvm::Function *F)
             addProgramStructure(F, subg);
         }
 
+        _clone = clone;
         return subg;
     }
 
@@ -249,6 +260,204 @@ LLVMPointerGraphBuilder::createOrGetSubgraph(const llvm::Function *F)
     return *it->second;
 }
 
+PointerSubgraph&
+LLVMPointerGraphBuilder::createOrGetSubgraph(const llvm::Function *F,
+                                             const llvm::CallInst *CInst)
+{
+    (void)CInst; // used only in debugging messages
+    if (shouldClone(F)) {
+        DBG(pta, "Cloning function '" << F->getName().str()
+                 << "' for the call in '"
+                 << CInst->getParent()->getParent()->getName().str() << "'");
+        return buildClone(F);
+    }
+
+    return createOrGetSubgraph(F);
+}
+
+bool LLVMPointerGraphBuilder::isAllocationWrapper(const llvm::Function *F)
+{
+    if (!F->getReturnType()->isPointerTy())
+        return false;
+
+    for (const llvm::BasicBlock& B : *F) {
+        for (const llvm::Instruction& I : B) {
+            auto *CI = llvm::dyn_cast<llvm::CallInst>(&I);
+            if (!CI)
+                continue;
+
+            auto *callee = llvm::dyn_cast<llvm::Function>(
+                                CI->getCalledValue()->stripPointerCasts());
+            if (!callee)
+                continue;
+
+            if (callee->isDeclaration()) {
+                if (_models.isAllocationFunction(callee))
+                    return true;
+            } else if (isCloneCandidate(callee) &&
+                       isAllocationWrapper(callee)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool LLVMPointerGraphBuilder::isCloneCandidate(const llvm::Function *F)
+{
+    auto it = _cloneCandidates.find(F);
+    if (it != _cloneCandidates.end())
+        return it->second;
+
+    // if we get to F again while checking the callees,
+    // the function is recursive and we do not clone it
+    _cloneCandidates[F] = false;
+
+    if (F->isDeclaration() || F->isVarArg() ||
+        F->getName().equals(_options.entryFunction))
+        return false;
+
+    size_t instructions = 0;
+    for (const llvm::BasicBlock& B : *F) {
+        instructions += B.size();
+        for (const llvm::Instruction& I : B) {
+            auto *CI = llvm::dyn_cast<llvm::CallInst>(&I);
+            if (!CI)
+                continue;
+
+            // the clones must be connected only to their call-site,
+            // which we can not ensure with calls via pointers
+            // and threads
+            auto *callee = llvm::dyn_cast<llvm::Function>(
+                                CI->getCalledValue()->stripPointerCasts());
+            if (!callee || callee->getName().startswith("pthread_"))
+                return false;
+
+            if (!callee->isDeclaration() && !isCloneCandidate(callee))
+                return false;
+        }
+    }
+
+    bool candidate
+        = (_options.cloneSmallFunctions > 0 &&
+           instructions <= _options.cloneSmallFunctions) ||
+          (_options.cloneAllocWrappers && isAllocationWrapper(F));
+
+    _cloneCandidates[F] = candidate;
+    return candidate;
+}
+
+static size_t getCallSitesNum(const llvm::Function *F)
+{
+    size_t num = 0;
+    for (auto I = F->use_begin(), E = F->use_end(); I != E; ++I) {
+#if ((LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR < 5))
+        const llvm::Value *use = *I;
+#else
+        const llvm::Value *use = I->getUser();
+#endif
+        auto *CI = llvm::dyn_cast<llvm::CallInst>(use);
+        if (CI && CI->getCalledFunction() == F)
+            ++num;
+    }
+    return num;
+}
+
+static size_t getInstructionsNum(const llvm::Function *F)
+{
+    size_t num = 0;
+    for (const llvm::BasicBlock& B : *F)
+        num += B.size();
+    return num;
+}
+
+bool LLVMPointerGraphBuilder::shouldClone(const llvm::Function *F)
+{
+    // the functions that are called via pointers
+    // (built during the analysis) are not cloned
+    if (_options.contextDepth == 0 || ad_hoc_building)
+        return false;
+
+    if (_clone && _clone->depth >= _options.contextDepth)
+        return false;
+
+    if (!isCloneCandidate(F))
+        return false;
+
+    // a function called from a single place has only
+    // one context (unless the caller is a clone)
+    if (!_clone && getCallSitesNum(F) < 2)
+        return false;
+
+    // the number of nodes of the clone is roughly the number
+    // of instructions and arguments
+    if (_clonedNodes + getInstructionsNum(F) + F->arg_size()
+            > _options.maxClonedNodes) {
+        DBG(pta, "Reached the limit of cloned nodes, not cloning '"
+                 << F->getName().str() << "'");
+        return false;
+    }
+
+    return true;
+}
+
+PointerSubgraph&
+LLVMPointerGraphBuilder::buildClone(const llvm::Function *F)
+{
+    FunctionClone *caller = _clone;
+    _clones.emplace_back(new FunctionClone(F, caller ? caller->depth + 1 : 1));
+    _clone = _clones.back().get();
+
+    // reserve the estimated size, so that the clones
+    // built from this clone see it
+    size_t clonedNodes = _clonedNodes;
+    size_t nodesNum = PS.size();
+    _clonedNodes += getInstructionsNum(F) + F->arg_size();
+
+    PointerSubgraph& subg = buildFunction(*F);
+    // the clone has only one call-site and the callees of the clone
+    // are already connected, so we can add the structure right now
+    addProgramStructure(F, subg);
+
+    _clonedNodes = clonedNodes + (PS.size() - nodesNum);
+    _clonesMap.emplace(&subg, _clone);
+    _clone = caller;
+
+    return subg;
+}
+
+void LLVMPointerGraphBuilder::mergeClonedPointsTo()
+{
+    auto addOperand = [](PSNode *merged, PSNode *op) {
+        if (!merged->hasOperand(op))
+            merged->addOperand(op);
+    };
+
+    for (auto& clone : _clones) {
+        for (auto& it : clone->nodes) {
+            PSNode *&merged = _mergedNodes[it.first];
+            if (!merged) {
+                merged = PS.create(PSNodeType::PHI, nullptr);
+                merged->setUserData(const_cast<llvm::Value *>(it.first));
+                mapping.set(it.first, merged);
+            }
+            addOperand(merged, it.second.getRepresentant());
+        }
+    }
+
+    for (auto& it : _mergedNodes) {
+        // the context-insensitive copy of the value
+        // (it may have been built during the analysis)
+        auto nds = nodes_map.find(it.first);
+        if (nds != nodes_map.end())
+            addOperand(it.second, nds->second.getRepresentant());
+
+        for (PSNode *op : it.second->getOperands())
+            it.second->pointsTo.add(op->pointsTo);
+    }
+}
+
 PointerSubgraph*
 LLVMPointerGraphBuilder::getSubgraph(const llvm::Function *F)
 {
@@ -273,9 +482,8 @@ void LLVMPointerGraphBuilder::addPHIOperands(PSNode *node, const llvm::PHINode *
     }
 }
 
-template <typename OptsT>
 static bool isRelevantCall(const llvm::Instruction *Inst, bool invalidate_nodes,
-                           const OptsT& opts)
+                           const LLVMFunctionModels& models)
 {
     using namespace llvm;
 
@@ -292,8 +500,7 @@ static bool isRelevantCall(const llvm::Instruction *Inst, bool invalidate_nodes,
         return true;
 
     if (func->size() == 0) {
-        if (opts.getAllocationFunction(func->getName())
-            != AllocationFunction::NONE)
+        if (models.isAllocationFunction(func))
             // we need memory allocations
             return true;
 
@@ -434,7 +641,7 @@ bool LLVMPointerGraphBuilder::isRelevantInstruction(const llvm::Instruction& Ins
         case Instruction::Unreachable:
             return false;
         case Instruction::Call:
-            return isRelevantCall(&Inst, invalidate_nodes, _options);
+            return isRelevantCall(&Inst, invalidate_nodes, _models);
         default:
             return true;
     }
@@ -544,7 +751,7 @@ LLVMPointerGraphBuilder::buildFunction(const llvm::Function& F)
 {
     DBG_SECTION_BEGIN(pta, "building function '" << F.getName().str() << "'");
 
-    assert(!getSubgraph(&F) && "We already built this function");
+    assert((_clone || !getSubgraph(&F)) && "We already built this function");
     assert(!F.isDeclaration() && "Cannot build an undefined function");
 
     // create root and later (an unified) return nodes of this subgraph.
@@ -565,7 +772,10 @@ LLVMPointerGraphBuilder::buildFunction(const llvm::Function& F)
     // from buildPointerGraphBlock won't get stuck in infinite recursive call
     // when this function is recursive
     PointerSubgraph *subg = PS.createSubgraph(root, vararg);
-    subgraphs_map[&F] = subg;
+    if (_clone)
+        _clone->subgraph = subg;
+    else
+        subgraphs_map[&F] = subg;
 
     assert(subg->root == root && subg->vararg == vararg);
 
@@ -576,8 +786,8 @@ LLVMPointerGraphBuilder::buildFunction(const llvm::Function& F)
     if (vararg)
         vararg->setParent(subg);
 
-    assert(_funcInfo.find(&F) == _funcInfo.end());
-    auto& finfo = _funcInfo[&F];
+    assert((_clone || _funcInfo.find(&F) == _funcInfo.end()));
+    auto& finfo = getFuncInfo(&F);
     auto llvmBlocks =
         getBasicBlocksInDominatorOrder(const_cast<llvm::Function&>(F));
 
@@ -604,7 +814,7 @@ LLVMPointerGraphBuilder::buildFunction(const llvm::Function& F)
     // built, since the PHI gathers values from different blocks
     addPHIOperands(F);
 
-    assert(getSubgraph(&F)->root != nullptr);
+    assert(subg->root != nullptr);
     DBG_SECTION_END(pta, "building function '" << F.getName().str() << "' done");
     return *subg;
 }
@@ -71,11 +71,11 @@ LLVMPointerGraphBuilder::buildArgumentsStructure(const llvm::Function& F) {
 
     int idx = 0;
     for (auto A = F.arg_begin(), E = F.arg_end(); A != E; ++A, ++idx) {
-        auto it = nodes_map.find(&*A);
-        if (it == nodes_map.end())
+        auto *nds = getNodes(&*A);
+        if (!nds)
             continue;
 
-        PSNodesSeq& cur = it->second;
+        PSNodesSeq& cur = *nds;
         assert(cur.getFirst() == cur.getLast());
 
         blk.append(&cur);
@@ -91,8 +91,8 @@ void LLVMPointerGraphBuilder::addProgramStructure(const llvm::Function *F,
                                                   PointerSubgraph& subg) {
     assert(subg.root && "Subgraph has no root");
 
-    assert(_funcInfo.find(F) != _funcInfo.end());
-    auto& finfo = _funcInfo[F];
+    assert(_clone || _funcInfo.find(F) != _funcInfo.end());
+    auto& finfo = getFuncInfo(F);
 
     // with function pointer calls it may happen that we try
     // to add structure more times, so bail out in that case
@@ -73,7 +73,7 @@ LLVMReadWriteGraphBuilder::createCallToFunctions(
             continue;
         }
 
-        if (auto model = _options.getFunctionModel(F->getName())) {
+        if (auto model = _models.getFunctionModel(F)) {
             called_values.push_back(funcFromModel(model, CInst));
         } else if (F->isDeclaration()) {
             called_values.push_back(createCallToUndefinedFunction(F, CInst));
@@ -92,8 +92,14 @@ LLVMReadWriteGraphBuilder::createCallToFunctions(
         return {called_values[0]};
     } else {
         RWNodeCall *callNode = RWNodeCall::get(&create(RWNodeType::CALL));
-        for (auto *item : called_subgraphs)
-            callNode->addCallee(item);
+        for (auto *item : called_subgraphs) {
+            // the subgraphs are shared by the threads,
+            // the call is registered in them in addNode()
+            if (buildsInParallel())
+                callNode->addCallee(RWCalledValue(item));
+            else
+                callNode->addCallee(item);
+        }
         for (auto *item : called_values)
             callNode->addCallee(item);
         return {callNode};
@@ -142,7 +148,7 @@ RWNode *LLVMReadWriteGraphBuilder::createUnknownCall(const llvm::CallInst *CInst
                 continue;
         }
 
-        auto pts = PTA->getLLVMPointsToChecked(llvmOp);
+        auto pts = getPointsTo(llvmOp);
         // if we do not have a pts, this is not pointer
         // relevant instruction. We must do it this way
         // instead of type checking, due to the inttoptr.
@@ -221,7 +227,7 @@ RWNode *LLVMReadWriteGraphBuilder::createIntrinsicCall(const llvm::CallInst *CIn
 
     ret = &create(RWNodeType::GENERIC);
 
-    auto pts = PTA->getLLVMPointsToChecked(dest);
+    auto pts = getPointsTo(dest);
     if (!pts.first) {
         llvm::errs() << "[RD] Error: No points-to information for destination in\n";
         llvm::errs() << ValInfo(I) << "\n";
@@ -257,6 +263,7 @@ RWNode *LLVMReadWriteGraphBuilder::createIntrinsicCall(const llvm::CallInst *CIn
             // keeping such set is faster then printing it all to terminal
             // ... and we don't flood the terminal that way
             static std::set<const llvm::Value *> warned;
+            std::lock_guard<std::mutex> lock(_mutex);
             if (warned.insert(ptr.value).second) {
                 llvm::errs() << "[RD] error at " << ValInfo(CInst) << "\n"
                              << "[RD] error: Haven't created node for: "
@@ -294,7 +301,7 @@ RWNode *LLVMReadWriteGraphBuilder::funcFromModel(const FunctionModel *model,
             continue;
 
         const auto llvmOp = CInst->getArgOperand(i);
-        auto pts = PTA->getLLVMPointsToChecked(llvmOp);
+        auto pts = getPointsTo(llvmOp);
         // if we do not have a pts, this is not pointer
         // relevant instruction. We must do it this way
         // instead of type checking, due to the inttoptr.
@@ -353,7 +360,7 @@ LLVMReadWriteGraphBuilder::createCallToUndefinedFunction(const llvm::Function *f
         */
     }
 
-    auto type = _options.getAllocationFunction(function->getName());
+    auto type = _models.getAllocationFunction(function);
     if (type != AllocationFunction::NONE) {
         if (type == AllocationFunction::REALLOC)
             return createRealloc(CInst);
@@ -1,3 +1,4 @@
+#include <atomic>
 #include <vector>
 #include <cassert>
 
@@ -143,7 +144,7 @@ RWNode *LLVMReadWriteGraphBuilder::createRealloc(const llvm::Instruction *Inst)
 
     if (buildUses) {
         // realloc copies the memory
-        auto defSites = mapPointers(Inst, Inst->getOperand(0), size);
+        const auto& defSites = mapPointers(Inst, Inst->getOperand(0), size);
         for (const auto& ds : defSites) {
             node.addUse(ds);
         }
@@ -164,7 +165,7 @@ RWNode *LLVMReadWriteGraphBuilder::createStore(const llvm::Instruction *Inst) {
     if (size == 0)
         size = Offset::UNKNOWN;
 
-    auto defSites = mapPointers(Inst, Inst->getOperand(1), size);
+    const auto& defSites = mapPointers(Inst, Inst->getOperand(1), size);
 
     // strong update is possible only with must aliases that point
     // to the last instance of the memory object. Since detecting that
@@ -193,7 +194,7 @@ RWNode *LLVMReadWriteGraphBuilder::createLoad(const llvm::Instruction *Inst) {
     if (size == 0)
         size = Offset::UNKNOWN;
 
-    auto defSites = mapPointers(Inst, Inst->getOperand(0), size);
+    const auto& defSites = mapPointers(Inst, Inst->getOperand(0), size);
     for (const auto& ds : defSites) {
         node.addUse(ds);
     }
@@ -206,12 +207,11 @@ LLVMReadWriteGraphBuilder::createCall(const llvm::Instruction *Inst) {
     using namespace llvm;
     const CallInst *CInst = cast<CallInst>(Inst);
     const Value *calledVal = CInst->getCalledValue()->stripPointerCasts();
-    static bool warned_inline_assembly = false;
+    static std::atomic<bool> warned_inline_assembly{false};
 
     if (CInst->isInlineAsm()) {
-        if (!warned_inline_assembly) {
+        if (!warned_inline_assembly.exchange(true)) {
             llvm::errs() << "[RWG] WARNING: Inline assembler found\n";
-            warned_inline_assembly = true;
         }
         return {createUnknownCall(CInst)};
     }
@@ -221,7 +221,7 @@ LLVMReadWriteGraphBuilder::createCall(const llvm::Instruction *Inst) {
     }
 
 
-    const auto& functions = getCalledFunctions(calledVal, PTA);
+    const auto& functions = getCalledFunctions(calledVal);
     if (functions.empty()) {
         llvm::errs() << "[RWG] error: could not determine the called function "
                         "in a call via pointer: \n"
@@ -231,9 +231,8 @@ LLVMReadWriteGraphBuilder::createCall(const llvm::Instruction *Inst) {
     return createCallToFunctions(functions, CInst);
 }
 
-template <typename OptsT>
 static bool isRelevantCall(const llvm::Instruction *Inst,
-                           OptsT& opts)
+                           const LLVMFunctionModels& models)
 {
     using namespace llvm;
 
@@ -251,10 +250,11 @@ static bool isRelevantCall(const llvm::Instruction *Inst,
 
     if (func->size() == 0) {
         // we have a model for this function
-        if (opts.getFunctionModel(func->getName()))
+        auto info = models.get(func);
+        if (info.model)
             return true;
         // memory allocation
-        if (opts.isAllocationFunction(func->getName()))
+        if (info.allocation != AllocationFunction::NONE)
             return true;
 
         if (func->isIntrinsic()) {
@@ -307,7 +307,7 @@ NodesSeq<RWNode> LLVMReadWriteGraphBuilder::createNode(const llvm::Value *v) {
              // these modify CFG and thus data-flow
              return {createReturn(I)};
          case Instruction::Call:
-             if (!isRelevantCall(I, _options))
+             if (!isRelevantCall(I, _models))
                  break;
 
              return createCall(I);
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <set>
 #include <cassert>
 
@@ -67,22 +68,54 @@ llvm::raw_ostream& operator<<(llvm::raw_ostream& os, const ValInfo& vi) {
 // Map pointers of 'val' to def-sites.
 // \param where  location in the program, for debugging
 // \param size is the number of bytes used from the memory
-std::vector<DefSite>
+const std::vector<DefSite>&
 LLVMReadWriteGraphBuilder::mapPointers(const llvm::Value *where,
                                        const llvm::Value *val,
                                        Offset size)
 {
-    std::vector<DefSite> result;
+    // the shared nodes are built (sequentially) each with its own
+    // order of used nodes, so do not cache the results for them
+    const llvm::Function *F = getBuiltFunction();
+    if (buildsInParallel() && !F) {
+        // keep the result alive as long as the builder
+        auto result = computeDefSites(where, val, size);
+        _uncachedDefSites.push_back(result);
+        return *result;
+    }
+
+    DefSitesKey key{F, val, *size};
+    {
+        std::unique_lock<std::mutex> lock(_defSitesMutex, std::defer_lock);
+        if (buildsInParallel())
+            lock.lock();
+        auto it = _defSites.find(key);
+        if (it != _defSites.end())
+            return *it->second;
+    }
+
+    // compute the result without holding the lock, mapping
+    // the pointers may build new nodes (see getOperand())
+    auto result = computeDefSites(where, val, size);
 
-    auto psn = PTA->getLLVMPointsToChecked(val);
+    std::unique_lock<std::mutex> lock(_defSitesMutex, std::defer_lock);
+    if (buildsInParallel())
+        lock.lock();
+    return *_defSites.emplace(key, std::move(result)).first->second;
+}
+
+LLVMReadWriteGraphBuilder::DefSitesPtr
+LLVMReadWriteGraphBuilder::computeDefSites(const llvm::Value *where,
+                                           const llvm::Value *val,
+                                           Offset size)
+{
+    auto psn = getPointsTo(val);
     if (!psn.first) {
-        result.push_back(DefSite(UNKNOWN_MEMORY));
 #ifndef NDEBUG
         llvm::errs() << "[RD] warning at: " << ValInfo(where) << "\n";
         llvm::errs() << "No points-to set for: " << ValInfo(val) << "\n";
 #endif
         // don't have points-to information for used pointer
-        return result;
+        return _unknownDefSites;
     }
 
     if (psn.second.empty()) {
@@ -99,14 +132,14 @@ LLVMReadWriteGraphBuilder::mapPointers(const llvm::Value *where,
         // (there should be &p and &q)
         // NOTE: maybe this is a bit strong to say unknown memory,
         // but better be sound then incorrect
-        result.push_back(DefSite(UNKNOWN_MEMORY));
-        return result;
+        return _unknownDefSites;
     }
 
-    result.reserve(psn.second.size());
+    auto result = std::make_shared<std::vector<DefSite>>();
+    result->reserve(psn.second.size());
 
     if (psn.second.hasUnknown()) {
-        result.push_back(DefSite(UNKNOWN_MEMORY));
+        result->push_back(DefSite(UNKNOWN_MEMORY));
     }
 
     for (const auto& ptr: psn.second) {
@@ -118,6 +151,7 @@ LLVMReadWriteGraphBuilder::mapPointers(const llvm::Value *where,
             // keeping such set is faster then printing it all to terminal
             // ... and we don't flood the terminal that way
             static std::set<const llvm::Value *> warned;
+            std::lock_guard<std::mutex> lock(_mutex);
             if (warned.insert(ptr.value).second) {
                 llvm::errs() << "[RD] error at "  << ValInfo(where) << "\n";
                 llvm::errs() << "[RD] error for " << ValInfo(val) << "\n";
@@ -130,7 +164,7 @@ LLVMReadWriteGraphBuilder::mapPointers(const llvm::Value *where,
         // FIXME: we should pass just size to the DefSite ctor, but the old code relies
         // on the behavior that when offset is unknown, the length is also unknown.
         // So for now, mimic the old code. Remove it once we fix the old code.
-        result.push_back(DefSite(ptrNode, ptr.offset,
+        result->push_back(DefSite(ptrNode, ptr.offset,
                                  ptr.offset.isUnknown() ?
                                     Offset::UNKNOWN : size));
     }
@@ -138,6 +172,75 @@ LLVMReadWriteGraphBuilder::mapPointers(const llvm::Value *where,
     return result;
 }
 
+std::pair<bool, LLVMPointsToSet>
+LLVMReadWriteGraphBuilder::getPointsTo(const llvm::Value *val) {
+    // the pointer analysis may create nodes for constants when queried
+    // and these may add new pointers into the global tables of DG points-to
+    // sets, so the result must not refer to the data of the analysis
+    // when it is used after the lock is released
+    if (buildsInParallel()) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto pts = PTA->getLLVMPointsToChecked(val);
+        return {pts.first, pts.second.copy()};
+    }
+    return PTA->getLLVMPointsToChecked(val);
+}
+
+std::vector<const llvm::Function *>
+LLVMReadWriteGraphBuilder::getCalledFunctions(const llvm::Value *val) {
+    if (buildsInParallel()) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return dg::getCalledFunctions(val, PTA);
+    }
+    return dg::getCalledFunctions(val, PTA);
+}
+
+unsigned LLVMReadWriteGraphBuilder::getBuildThreads() const {
+    // the points-to sets must not change while they are queried
+    // from more threads
+    if (PTA->getOptions().demandDriven)
+        return 1;
+
+    if (_options.buildThreads == 0)
+        return std::max(1u, std::thread::hardware_concurrency());
+    return _options.buildThreads;
+}
+
+bool LLVMReadWriteGraphBuilder::isSharedValue(const llvm::Value *val) const {
+    using namespace llvm;
+
+    if (isa<AllocaInst>(val))
+        return true;
+
+    const CallInst *CInst = dyn_cast<CallInst>(val);
+    if (!CInst)
+        return false;
+
+    const Value *calledVal = CInst->getCalledValue()->stripPointerCasts();
+    const Function *func = dyn_cast<Function>(calledVal);
+    if (!func)
+        return false;
+
+    if (func->isIntrinsic())
+        return func->getIntrinsicID() == Intrinsic::vastart;
+
+    return _models.isAllocationFunction(func) ||
+           _ptaAllocations.isAllocationFunction(func);
+}
+
+void LLVMReadWriteGraphBuilder::addNode(RWNode *node) {
+    graph.addNode(node);
+
+    // the calls were not registered in the called subgraphs,
+    // these are shared by the threads
+    if (auto *C = RWNodeCall::get(node)) {
+        for (auto& cv : C->getCallees()) {
+            if (auto *subg = cv.getSubgraph())
+                subg->addCaller(C);
+        }
+    }
+}
+
 RWNode *LLVMReadWriteGraphBuilder::getOperand(const llvm::Value *val) {
     auto *op = getNode(val);
     if (!op) {
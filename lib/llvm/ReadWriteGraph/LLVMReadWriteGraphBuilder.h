@@ -4,6 +4,8 @@
 #include <unordered_map>
 #include <set>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 // ignore unused parameters in LLVM libraries
 #if (__clang__)
@@ -28,6 +30,7 @@
 #include "dg/ReadWriteGraph/ReadWriteGraph.h"
 #include "dg/llvm/PointerAnalysis/PointerAnalysis.h"
 #include "dg/llvm/DataDependence/LLVMDataDependenceAnalysisOptions.h"
+#include "dg/llvm/LLVMFunctionModels.h"
 #include "dg/llvm/CallGraph/CallGraph.h"
 
 #include "llvm/GraphBuilder.h"
@@ -44,6 +47,10 @@ class LLVMReadWriteGraphBuilder : public GraphBuilder<RWNode, RWBBlock, RWSubgra
     const LLVMDataDependenceAnalysisOptions& _options;
     // points-to information
     dg::LLVMPointerAnalysis *PTA;
+    // models and allocation functions resolved for the functions
+    // of the module (and the allocation functions of pointer analysis)
+    LLVMFunctionModels _models;
+    LLVMFunctionModels _ptaAllocations;
     // even the data-flow analysis needs uses to have the mapping of llvm values
     bool buildUses{true};
     // optimization for reaching-definitions analysis
@@ -54,6 +61,47 @@ class LLVMReadWriteGraphBuilder : public GraphBuilder<RWNode, RWBBlock, RWSubgra
 
     ReadWriteGraph graph;
 
+    // serializes the queries to pointer analysis (and the warnings)
+    // when building the functions in parallel
+    std::mutex _mutex;
+
+    ///
+    // Memoized results of mapPointers(). The same pointer is usually
+    // mapped many times (e.g., the base of a structure used in the whole
+    // function), so the points-to set is converted to def-sites only once
+    // for every pair (pointer, size) and the result is shared by the uses.
+    // When building in parallel, the results are cached per function,
+    // because mapping the pointers records the first use of the shared
+    // nodes in the function (see GraphBuilder::nodeUsed()).
+    struct DefSitesKey {
+        const llvm::Function *function;
+        const llvm::Value *ptr;
+        Offset::type size;
+
+        bool operator==(const DefSitesKey& rhs) const {
+            return function == rhs.function && ptr == rhs.ptr && size == rhs.size;
+        }
+    };
+
+    struct DefSitesKeyHash {
+        size_t operator()(const DefSitesKey& K) const {
+            size_t h = std::hash<const llvm::Function *>()(K.function);
+            h = h * 31 + std::hash<const llvm::Value *>()(K.ptr);
+            return h * 31 + std::hash<Offset::type>()(K.size);
+        }
+    };
+
+    using DefSitesPtr = std::shared_ptr<const std::vector<DefSite>>;
+
+    std::unordered_map<DefSitesKey, DefSitesPtr, DefSitesKeyHash> _defSites;
+    // the result for pointers without (or with empty) points-to set
+    const DefSitesPtr _unknownDefSites{
+        std::make_shared<const std::vector<DefSite>>(1, DefSite(UNKNOWN_MEMORY))};
+    // the results for the shared nodes, these are not cached
+    std::vector<DefSitesPtr> _uncachedDefSites;
+    // guards _defSites when building in parallel
+    std::mutex _defSitesMutex;
+
     //RWNode& getOperand(const llvm::Value *) override;
     NodesSeq<RWNode> createNode(const llvm::Value *) override;
     RWBBlock& createBBlock(const llvm::BasicBlock *, RWSubgraph& subg) override {
@@ -74,20 +122,35 @@ class LLVMReadWriteGraphBuilder : public GraphBuilder<RWNode, RWBBlock, RWSubgra
     std::map<std::pair<RWNode *, RWNode *>, std::set<Subgraph *>> calls;
     */
 
-    RWNode& create(RWNodeType t) { return graph.create(t); }
+    RWNode& create(RWNodeType t) {
+        if (!buildsInParallel())
+            return graph.create(t);
+
+        auto& node = graph.createInPool(getPool(), t);
+        nodeCreated(&node);
+        return node;
+    }
+
+    // allocations may be targets of pointers in any function
+    bool isSharedValue(const llvm::Value *val) const override;
+    void createPools(unsigned num) override { graph.setPoolsNum(num); }
+    void addNode(RWNode *node) override;
+
+    unsigned getBuildThreads() const;
 
 public:
     LLVMReadWriteGraphBuilder(const llvm::Module *m,
                               dg::LLVMPointerAnalysis *p,
                               const LLVMDataDependenceAnalysisOptions& opts)
-        : GraphBuilder(m), _options(opts), PTA(p) {}
+        : GraphBuilder(m), _options(opts), PTA(p),
+          _models(m, opts, &opts), _ptaAllocations(m, p->getOptions()) {}
 
     ReadWriteGraph&& build() {
         // FIXME: this is a bit of a hack
         if (!PTA->getOptions().isSVF()) {
             auto dgpta = static_cast<DGLLVMPointerAnalysis *>(PTA);
             llvmdg::CallGraph CG(dgpta->getPTA()->getPG()->getCallGraph());
-            buildFromLLVM(&CG);
+            buildFromLLVM(&CG, getBuildThreads());
         } else {
             buildFromLLVM();
         }
@@ -101,9 +164,17 @@ public:
 
     RWNode *getOperand(const llvm::Value *val);
 
-    std::vector<DefSite> mapPointers(const llvm::Value *where,
-                                     const llvm::Value *val,
-                                     Offset size);
+    std::pair<bool, LLVMPointsToSet> getPointsTo(const llvm::Value *val);
+    std::vector<const llvm::Function *> getCalledFunctions(const llvm::Value *val);
+
+    // the returned vector is shared and valid as long as the builder
+    const std::vector<DefSite>& mapPointers(const llvm::Value *where,
+                                            const llvm::Value *val,
+                                            Offset size);
+    // map the pointers without the cache (mapPointers() memoizes this)
+    DefSitesPtr computeDefSites(const llvm::Value *where,
+                                const llvm::Value *val,
+                                Offset size);
 
     RWNode *createStore(const llvm::Instruction *Inst);
     RWNode *createLoad(const llvm::Instruction *Inst);
@@ -1,12 +1,18 @@
-#include <utility>
-#include <unordered_map>
+#include <cassert>
+#include <cstdint>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "dg/llvm/LLVMDependenceGraph.h"
 #include "dg/llvm/LLVMNode.h"
-//#include "llvm-utils.h"
+#include "dg/llvm/LLVMSummaryEdges.h"
 
 #include "dg/ADT/Queue.h"
+#include "dg/CallGraph/CallGraph.h"
+#include "dg/CallGraph/CallGraphScheduler.h"
 
 namespace dg {
 
@@ -14,141 +20,304 @@ namespace dg {
 //  -- LLVMDependenceGraph -- summary edges
 /// ------------------------------------------------------------------
 
-extern std::map<llvm::Value *, LLVMDependenceGraph *> constructedFunctions;
-class SummaryEdgesComputation {
+struct LLVMSummaryEdges::FunctionInfo {
     using NodeT = LLVMNode;
-    using Edge = std::pair<NodeT *, NodeT *>;
-    ADT::QueueLIFO<Edge> workList;
-    // FIXME: optimize this: we can store only a subset of these edges
-    // and we can store only a set of nodes (beginnings of the paths)
-    std::set<Edge> pathEdge;
-
-    // collected vertices for fast checks
-    std::set<NodeT *> actualOutVertices;
-    std::set<NodeT *> formalInVertices;
-
-    void propagate(const Edge& e) {
-        if (pathEdge.insert(e).second) {
-            workList.push(e);
-        }
+    using Word = uint64_t;
+    static const unsigned WordBits = 64;
+
+    LLVMDependenceGraph *dg;
+
+    // formal parameters, the index of a formal-out parameter
+    // is its bit in the bitsets
+    std::vector<NodeT *> formalIns;
+    std::unordered_map<NodeT *, unsigned> formalInIdx;
+    std::unordered_map<NodeT *, unsigned> formalOutIdx;
+
+    struct CallSite {
+        FunctionInfo *callee;
+        // (index of the formal-in of the callee, actual-in)
+        std::vector<std::pair<unsigned, NodeT *>> ins;
+        // actual-out for every formal-out of the callee (or nullptr)
+        std::vector<NodeT *> outs;
+    };
+
+    std::vector<CallSite> calls;
+    std::unordered_set<NodeT *> actualOuts;
+
+    // the bitsets of the nodes reached so far, 'words' words per node
+    unsigned words{0};
+    std::unordered_map<NodeT *, unsigned> nodeIdx;
+    std::vector<Word> bits;
+    ADT::QueueLIFO<NodeT *> workList;
+
+    // the summary edges of the call-sites in this function
+    std::unordered_map<NodeT *, std::set<NodeT *>> summary;
+    std::unordered_map<NodeT *, std::set<NodeT *>> revSummary;
+    size_t edgesNum{0};
+    // the bits of a formal-in parameter (i.e., the summary
+    // of this function) changed
+    bool summaryChanged{false};
+
+    FunctionInfo(LLVMDependenceGraph *g) : dg(g) {}
+
+    template <typename Fun>
+    static void forEachParameter(LLVMDGParameters *params, Fun fun) {
+        if (!params)
+            return;
+
+        for (auto& it : *params)
+            fun(it.second);
+        for (auto it = params->global_begin(), et = params->global_end();
+             it != et; ++it)
+            fun(it->second);
+        if (auto *vararg = params->getVarArg())
+            fun(*vararg);
     }
 
-    void propagate(NodeT* n1, NodeT *n2) {
-        propagate({n1, n2});
+    void initFormals() {
+        forEachParameter(dg->getParameters(), [this](LLVMDGParameter& p) {
+            if (p.in && formalInIdx.emplace(p.in, formalIns.size()).second)
+                formalIns.push_back(p.in);
+            if (p.out)
+                formalOutIdx.emplace(p.out, formalOutIdx.size());
+        });
+        words = (formalOutIdx.size() + WordBits - 1) / WordBits;
     }
 
-    void initialize() {
-        // collect all actual out and formal in vertices,
-        // as we need to check whether a node is of this type
-        for (auto& it : getConstructedFunctions()) {
-            LLVMDependenceGraph *dg = it.second;
-            assert(dg && "null as dg");
-
-            // formal parameters of this dg
-            if (auto params = dg->getParameters()) {
-                for (auto& paramIt : *params) {
-                    // Initialize the worklist (using formal out params).
-                    propagate({paramIt.second.out, paramIt.second.out});
-                    // Gather formal in params.
-                    formalInVertices.insert(paramIt.second.in);
-                }
+    // map the formal parameters of the callee to the actual parameters
+    // of the call-site (actual-in -> formal-in and formal-out -> actual-out
+    // are data dependencies)
+    void initCallSite(NodeT *callNode, FunctionInfo *callee) {
+        CallSite cs;
+        cs.callee = callee;
+        cs.outs.resize(callee->formalOutIdx.size(), nullptr);
 
-                // XXX: what about params for globals?
+        forEachParameter(callNode->getParameters(), [&](LLVMDGParameter& p) {
+            if (p.in) {
+                for (auto I = p.in->data_begin(), E = p.in->data_end(); I != E; ++I) {
+                    auto it = callee->formalInIdx.find(*I);
+                    if (it != callee->formalInIdx.end())
+                        cs.ins.emplace_back(it->second, p.in);
+                }
             }
-
-            for (auto callNode : dg->getCallNodes()) {
-                // gather actual-out vertices
-                if (auto params = callNode->getParameters()) {
-                    for (auto& paramIt : *params) {
-                        actualOutVertices.insert(paramIt.second.out);
-                    }
-
-                    // XXX: what about params for globals?
+            if (p.out) {
+                actualOuts.insert(p.out);
+                for (auto I = p.out->rev_data_begin(), E = p.out->rev_data_end(); I != E; ++I) {
+                    auto it = callee->formalOutIdx.find(*I);
+                    if (it != callee->formalOutIdx.end())
+                        cs.outs[it->second] = p.out;
                 }
             }
-        }
+        });
+
+        if (!cs.ins.empty())
+            calls.push_back(std::move(cs));
     }
 
-    bool isActualOut(NodeT *n) const { return actualOutVertices.count(n) > 0; }
-    bool isFormalIn(NodeT *n) const { return formalInVertices.count(n) > 0; }
+    unsigned getIndex(NodeT *n) {
+        auto it = nodeIdx.emplace(n, nodeIdx.size());
+        if (it.second)
+            bits.resize(bits.size() + words, 0);
+        return it.first->second;
+    }
 
-    void handleActualOut(const Edge& e) {
-        for (auto I = e.first->rev_control_begin(),
-                  E = e.first->rev_control_end(); I != E; ++I) {
-            propagate(*I, e.second);
-        }
-        for (auto I = e.first->rev_summary_begin(),
-                  E = e.first->rev_summary_end(); I != E; ++I) {
-            propagate(*I, e.second);
-        }
+    const Word *getBits(NodeT *n) const {
+        auto it = nodeIdx.find(n);
+        return it == nodeIdx.end() ? nullptr : &bits[it->second * words];
     }
 
-    void handleGenericEdge(const Edge& e) {
-        for (auto I = e.first->rev_control_begin(),
-                  E = e.first->rev_control_end(); I != E; ++I) {
-            propagate(*I, e.second);
+    // add the bits of the node 'from' to the node 'to', queue
+    // the node 'to' if something changed
+    void addBits(NodeT *to, NodeT *from) {
+        unsigned toIdx = getIndex(to);
+        unsigned fromIdx = getIndex(from);
+        bool changed = false;
+        for (unsigned w = 0; w < words; ++w) {
+            Word& dst = bits[toIdx * words + w];
+            Word nw = dst | bits[fromIdx * words + w];
+            if (nw != dst) {
+                dst = nw;
+                changed = true;
+            }
         }
-        for (auto I = e.first->rev_data_begin(),
-                  E = e.first->rev_data_end(); I != E; ++I) {
-            propagate(*I, e.second);
+
+        if (changed) {
+            workList.push(to);
+            if (formalInIdx.count(to) > 0)
+                summaryChanged = true;
         }
-        for (auto I = e.first->user_begin(),
-                  E = e.first->user_end(); I != E; ++I) {
-            propagate(*I, e.second);
+    }
+
+    void initialize() {
+        for (auto& it : formalOutIdx) {
+            unsigned idx = getIndex(it.first);
+            bits[idx * words + it.second / WordBits]
+                |= Word(1) << (it.second % WordBits);
+            workList.push(it.first);
         }
     }
 
-    void handleFormalIn(const Edge& e) {
-        using namespace llvm;
-
-        // the edge 'e' is a summary edge between formal parameters,
-        // we want to map it to actual parameters
-        assert(e.first->getDG());
-        assert(e.second->getDG());
-
-        auto params = LLVMDGFormalParameters::get(e.second->getDG()->getParameters());
-        assert(params);
-        assert(params->formalToActual.find(e.second) != params->formalToActual.end()
-                && "Cannot find formal -> actual parameter mapping");
-        for (auto& it : params->formalToActual[e.second]) {
-            // it = pair of (call-site, actual (out) param)
-            // get the actual in param too }
-            assert(params->formalToActual.find(e.first) != params->formalToActual.end());
-            auto actIn = params->formalToActual[e.first][it.first];
-            assert(actIn && "Do not have actual in param");
-
-            // add summary edge
-            actIn->addSummaryEdge(it.second);
-
-            // XXX: very inefficient
-            for (auto& pe : pathEdge) {
-                if (pe.first == it.second) {
-                    propagate(actIn, pe.second);
+    void propagateTo(NodeT *pred, NodeT *n) {
+        // the dependencies of the other functions are summarized
+        // by the summary edges
+        if (pred->getDG() == dg)
+            addBits(pred, n);
+    }
+
+    void propagate() {
+        while (!workList.empty()) {
+            NodeT *n = workList.pop();
+            // the paths end in formal-in parameters
+            if (formalInIdx.count(n) > 0)
+                continue;
+
+            for (auto I = n->rev_control_begin(), E = n->rev_control_end(); I != E; ++I)
+                propagateTo(*I, n);
+
+            if (actualOuts.count(n) > 0) {
+                // do not go into the called function, use the summary edges
+                auto it = revSummary.find(n);
+                if (it != revSummary.end()) {
+                    for (NodeT *actIn : it->second)
+                        propagateTo(actIn, n);
                 }
+                continue;
             }
+
+            for (auto I = n->rev_data_begin(), E = n->rev_data_end(); I != E; ++I)
+                propagateTo(*I, n);
+            for (auto I = n->user_begin(), E = n->user_end(); I != E; ++I)
+                propagateTo(*I, n);
         }
     }
 
-   public:
-    void computeSummaryEdges() {
-        initialize();
+    void addSummaryEdge(NodeT *actIn, NodeT *actOut) {
+        if (!summary[actIn].insert(actOut).second)
+            return;
 
-        while (!workList.empty()) {
-            Edge e = workList.pop();
-
-            if (isActualOut(e.first)) {
-                handleActualOut(e);
-            } else if (isFormalIn(e.first)) {
-                handleFormalIn(e);
-            } else {
-                handleGenericEdge(e);
+        revSummary[actOut].insert(actIn);
+        ++edgesNum;
+
+        if (nodeIdx.count(actOut) > 0)
+            propagateTo(actIn, actOut);
+    }
+
+    // add the summary edges of the called functions to the call-sites
+    void applySummaries() {
+        std::vector<Word> calleeBits;
+        for (auto& cs : calls) {
+            FunctionInfo *callee = cs.callee;
+            for (auto& in : cs.ins) {
+                const Word *fb = callee->getBits(callee->formalIns[in.first]);
+                if (!fb)
+                    continue;
+                // copy the bits, the callee may be this function
+                calleeBits.assign(fb, fb + callee->words);
+
+                for (unsigned w = 0; w < callee->words; ++w) {
+                    unsigned idx = w * WordBits;
+                    for (Word b = calleeBits[w]; b != 0; b >>= 1, ++idx) {
+                        if (!(b & 1))
+                            continue;
+                        if (NodeT *actOut = cs.outs[idx])
+                            addSummaryEdge(in.second, actOut);
+                    }
+                }
             }
         }
     }
 };
 
-void LLVMDependenceGraph::computeSummaryEdges() {
-    SummaryEdgesComputation C;
-    C.computeSummaryEdges();
+LLVMSummaryEdges::LLVMSummaryEdges() = default;
+LLVMSummaryEdges::~LLVMSummaryEdges() = default;
+
+void LLVMSummaryEdges::compute(unsigned threads) {
+    GenericCallGraph<FunctionInfo *> CG;
+
+    for (auto& it : getConstructedFunctions()) {
+        LLVMDependenceGraph *dg = it.second;
+        assert(dg && "null as dg");
+
+        auto& info = _functions[dg];
+        if (!info) {
+            info.reset(new FunctionInfo(dg));
+            info->initFormals();
+            CG.createNode(info.get());
+        }
+    }
+
+    for (auto& it : _functions) {
+        FunctionInfo *info = it.second.get();
+        for (LLVMNode *callNode : info->dg->getCallNodes()) {
+            for (auto *subgraph : callNode->getSubgraphs()) {
+                auto cit = _functions.find(subgraph);
+                if (cit == _functions.end())
+                    continue;
+
+                info->initCallSite(callNode, cit->second.get());
+                CG.addCall(info, cit->second.get());
+            }
+        }
+    }
+
+    // the SCCs in the bottom-up order have the summaries
+    // of all functions that they call from other SCCs
+    CallGraphScheduler<FunctionInfo *> scheduler(CG, threads);
+    scheduler.bottomUp([](const GenericCallGraph<FunctionInfo *>::SCCNode& scc) {
+        for (auto *node : scc.getNodes())
+            node->getValue()->initialize();
+
+        // the functions of a recursive SCC are iterated
+        // until their summaries do not change
+        bool changed;
+        do {
+            changed = false;
+            for (auto *node : scc.getNodes()) {
+                node->getValue()->summaryChanged = false;
+                node->getValue()->applySummaries();
+            }
+            for (auto *node : scc.getNodes()) {
+                node->getValue()->propagate();
+                changed |= node->getValue()->summaryChanged;
+            }
+        } while (changed && scc.isRecursive());
+    });
+}
+
+LLVMSummaryEdges::FunctionInfo *
+LLVMSummaryEdges::getInfo(const LLVMNode *node) const {
+    auto *dg = static_cast<const LLVMDependenceGraph *>(node->getDG());
+    auto it = _functions.find(dg);
+    return it == _functions.end() ? nullptr : it->second.get();
 }
+
+const std::set<LLVMNode *>&
+LLVMSummaryEdges::getSummaryEdges(LLVMNode *actualIn) const {
+    static const std::set<LLVMNode *> empty;
+    if (auto *info = getInfo(actualIn)) {
+        auto it = info->summary.find(actualIn);
+        if (it != info->summary.end())
+            return it->second;
+    }
+    return empty;
+}
+
+const std::set<LLVMNode *>&
+LLVMSummaryEdges::getRevSummaryEdges(LLVMNode *actualOut) const {
+    static const std::set<LLVMNode *> empty;
+    if (auto *info = getInfo(actualOut)) {
+        auto it = info->revSummary.find(actualOut);
+        if (it != info->revSummary.end())
+            return it->second;
+    }
+    return empty;
+}
+
+size_t LLVMSummaryEdges::getEdgesNum() const {
+    size_t num = 0;
+    for (auto& it : _functions)
+        num += it.second->edgesNum;
+    return num;
+}
+
 } // namespace dg
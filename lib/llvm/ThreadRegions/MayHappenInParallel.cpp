@@ -1,9 +1,251 @@
 #include "MayHappenInParallel.h"
+#include "llvm/ThreadRegions/Nodes/Nodes.h"
+
+#include <algorithm>
+#include <cassert>
 
 using namespace std;
 
-MayHappenInParallel::MayHappenInParallel(set<ThreadRegion *> threadRegions):threadRegions_(move(threadRegions)) {}
+namespace {
+
+// edges of the graph of thread regions (by the indices of the regions)
+struct RegionEdges {
+    // the control flow inside of a thread (including calls and returns)
+    vector<unsigned> flow;
+    // from a fork to the entry of the forked thread
+    vector<unsigned> forks;
+    // from the exit of a thread to the joins
+    vector<unsigned> joins;
+};
+
+void addEdge(vector<unsigned> &edges, unsigned target) {
+    if (find(edges.begin(), edges.end(), target) == edges.end()) {
+        edges.push_back(target);
+    }
+}
+
+} // anonymous namespace
+
+MayHappenInParallel::MayHappenInParallel(set<ThreadRegion *> threadRegions)
+    :regions_(threadRegions.begin(), threadRegions.end())
+{
+    sort(regions_.begin(), regions_.end(),
+         [](const ThreadRegion *lhs, const ThreadRegion *rhs) {
+             return lhs->id() < rhs->id();
+         });
+
+    indices_.reserve(regions_.size());
+    for (unsigned i = 0; i < regions_.size(); ++i) {
+        indices_.emplace(regions_[i], i);
+    }
+
+    rowWords_ = (regions_.size() + 63) / 64;
+    matrix_.resize(rowWords_ * regions_.size(), 0);
+
+    compute();
+}
+
+void MayHappenInParallel::compute() {
+    const unsigned regionsNum = regions_.size();
+
+    unordered_map<const Node *, unsigned> nodeRegions;
+    for (unsigned i = 0; i < regionsNum; ++i) {
+        const ThreadRegion *threadRegion = regions_[i];
+        for (auto *node : threadRegion->nodes()) {
+            nodeRegions.emplace(node, i);
+        }
+    }
+
+    auto regionOf = [&nodeRegions](const Node *node) -> int {
+        auto iterator = nodeRegions.find(node);
+        if (iterator == nodeRegions.end()) {
+            return -1;
+        }
+        return static_cast<int>(iterator->second);
+    };
+
+    // the edges are taken from the nodes, because the edges
+    // of the regions do not say which kind of edge they are
+    vector<RegionEdges> edges(regionsNum);
+    vector<pair<const ForkNode *, unsigned>> forks;
+    for (unsigned i = 0; i < regionsNum; ++i) {
+        const ThreadRegion *threadRegion = regions_[i];
+        for (auto *node : threadRegion->nodes()) {
+            for (auto *successor : node->successors()) {
+                int target = regionOf(successor);
+                // an edge inside of the region (unless it goes back to its beginning)
+                if (target < 0 ||
+                    (static_cast<unsigned>(target) == i && successor != threadRegion->foundingNode())) {
+                    continue;
+                }
+                addEdge(edges[i].flow, target);
+            }
+
+            if (auto forkNode = castNode<NodeType::FORK>(node)) {
+                forks.emplace_back(forkNode, i);
+                for (auto *entry : forkNode->forkSuccessors()) {
+                    int target = regionOf(entry);
+                    if (target >= 0) {
+                        addEdge(edges[i].forks, target);
+                    }
+                }
+            } else if (auto exitNode = castNode<NodeType::EXIT>(node)) {
+                for (auto *join : exitNode->joinSuccessors()) {
+                    int target = regionOf(join);
+                    if (target >= 0) {
+                        addEdge(edges[i].joins, target);
+                    }
+                }
+            }
+        }
+    }
+
+    // the states of the search are (region, inForkedThread),
+    // the join edges are followed only from the code of the thread
+    // in which the search started (and its callers)
+    vector<uint8_t> visited(regionsNum);
+    vector<pair<unsigned, bool>> stack;
+    vector<uint64_t> threadRegions(rowWords_);
+    vector<uint64_t> parallelRegions(rowWords_);
+    vector<uint8_t> joinRegions(regionsNum);
+
+    auto push = [&visited, &stack](unsigned region, bool inForkedThread) {
+        uint8_t flag = inForkedThread ? 2 : 1;
+        if (!(visited[region] & flag)) {
+            visited[region] |= flag;
+            stack.emplace_back(region, inForkedThread);
+        }
+    };
+
+    auto collect = [&visited, regionsNum](vector<uint64_t> &bits) {
+        fill(bits.begin(), bits.end(), 0);
+        for (unsigned i = 0; i < regionsNum; ++i) {
+            if (visited[i]) {
+                bits[i / 64] |= uint64_t(1) << (i % 64);
+            }
+        }
+    };
+
+    for (const auto &fork : forks) {
+        const ForkNode *forkNode = fork.first;
+        const unsigned forkRegion = fork.second;
+
+        // the regions of the forked thread (and of the threads it forks)
+        fill(visited.begin(), visited.end(), 0);
+        bool forksThreads = false;
+        for (auto target : edges[forkRegion].forks) {
+            push(target, false);
+        }
+        while (!stack.empty()) {
+            unsigned region = stack.back().first;
+            stack.pop_back();
+            for (auto target : edges[region].flow) {
+                push(target, false);
+            }
+            for (auto target : edges[region].forks) {
+                forksThreads = true;
+                push(target, false);
+            }
+        }
+        collect(threadRegions);
+
+        // the regions that may run after the fork and before the join
+        fill(joinRegions.begin(), joinRegions.end(), 0);
+        bool stopAtJoins = !forksThreads;
+        for (auto *join : forkNode->correspondingJoins()) {
+            // the join may also wait for another thread (the handle may
+            // point to several threads), so it does not surely wait
+            // for this one
+            if (join->correspondingForks().size() != 1) {
+                continue;
+            }
+            int target = regionOf(join);
+            if (target >= 0) {
+                joinRegions[target] = 1;
+            }
+        }
+
+        bool repeat = true;
+        while (repeat) {
+            repeat = false;
+            fill(visited.begin(), visited.end(), 0);
+            stack.clear();
+            for (auto *successor : forkNode->successors()) {
+                int target = regionOf(successor);
+                if (target >= 0 && !(stopAtJoins && joinRegions[target])) {
+                    push(target, false);
+                }
+            }
+
+            while (!stack.empty()) {
+                unsigned region = stack.back().first;
+                bool inForkedThread = stack.back().second;
+                stack.pop_back();
+
+                if (region == forkRegion && stopAtJoins) {
+                    // the thread may be forked again before it is joined,
+                    // so the join does not wait for all its instances
+                    stopAtJoins = false;
+                    repeat = true;
+                    stack.clear();
+                    break;
+                }
+
+                auto follow = [&](unsigned target, bool forked) {
+                    if (!(stopAtJoins && joinRegions[target])) {
+                        push(target, forked);
+                    }
+                };
+
+                for (auto target : edges[region].flow) {
+                    follow(target, inForkedThread);
+                }
+                for (auto target : edges[region].forks) {
+                    follow(target, true);
+                }
+                if (!inForkedThread) {
+                    for (auto target : edges[region].joins) {
+                        follow(target, false);
+                    }
+                }
+            }
+        }
+        collect(parallelRegions);
+
+        // the relation is symmetric
+        for (unsigned i = 0; i < regionsNum; ++i) {
+            auto *bits = row(i);
+            if (threadRegions[i / 64] & (uint64_t(1) << (i % 64))) {
+                for (size_t w = 0; w < rowWords_; ++w) {
+                    bits[w] |= parallelRegions[w];
+                }
+            }
+            if (parallelRegions[i / 64] & (uint64_t(1) << (i % 64))) {
+                for (size_t w = 0; w < rowWords_; ++w) {
+                    bits[w] |= threadRegions[w];
+                }
+            }
+        }
+    }
+}
+
+set<ThreadRegion *> MayHappenInParallel::parallelRegions(ThreadRegion *threadRegion) {
+    set<ThreadRegion *> result;
+    unsigned threadRegionIndex = index(threadRegion);
+    for (unsigned i = 0; i < regions_.size(); ++i) {
+        if (parallel(threadRegionIndex, i)) {
+            result.insert(regions_[i]);
+        }
+    }
+    return result;
+}
+
+bool MayHappenInParallel::mayHappenInParallel(const ThreadRegion *lhs, const ThreadRegion *rhs) const {
+    return parallel(index(lhs), index(rhs));
+}
 
-set<ThreadRegion *> MayHappenInParallel::parallelRegions(ThreadRegion *) {
-    return threadRegions_;
+unsigned MayHappenInParallel::index(const ThreadRegion *threadRegion) const {
+    auto iterator = indices_.find(threadRegion);
+    assert(iterator != indices_.end() && "Unknown thread region");
+    return iterator->second;
 }
@@ -162,6 +162,29 @@ inline uint64_t getAllocatedSize(llvm::Type *Ty, const llvm::DataLayout *DL)
     return DL->getTypeAllocSize(Ty);
 }
 
+// the size of the elements of an array type (the innermost type
+// that is not an array), 0 if the type is not an array
+inline uint64_t getArrayElementSize(llvm::Type *Ty, const llvm::DataLayout *DL)
+{
+    if (!Ty->isArrayTy())
+        return 0;
+
+    while (Ty->isArrayTy())
+        Ty = Ty->getArrayElementType();
+    return getAllocatedSize(Ty, DL);
+}
+
+inline uint64_t getArrayElementSize(const llvm::AllocaInst *AI,
+                                    const llvm::DataLayout *DL)
+{
+    llvm::Type *Ty = AI->getAllocatedType();
+    if (AI->isArrayAllocation()) {
+        uint64_t size = getArrayElementSize(Ty, DL);
+        return size == 0 ? getAllocatedSize(Ty, DL) : size;
+    }
+    return getArrayElementSize(Ty, DL);
+}
+
 inline bool isConstantZero(const llvm::Value *val)
 {
     using namespace llvm;
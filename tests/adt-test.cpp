@@ -6,6 +6,8 @@
 
 #include "dg/ADT/Queue.h"
 #include "dg/ADT/Bitvector.h"
+#include "dg/ADT/Arena.h"
+#include "dg/ADT/IDMap.h"
 #include "dg/ReadWriteGraph/DefSite.h"
 
 using namespace dg::ADT;
@@ -150,6 +152,81 @@ public:
     }
 };
 
+class TestArena : public Test
+{
+    struct Obj {
+        int *destroyed;
+        uint64_t val;
+        Obj(int *d, uint64_t v) : destroyed(d), val(v) {}
+        ~Obj() { ++*destroyed; }
+    };
+
+public:
+    TestArena() : Test("arena test")
+    {}
+
+    void test()
+    {
+        int destroyed = 0;
+        {
+            Arena arena;
+            std::vector<ArenaPtr<Obj>> objs;
+            for (uint64_t i = 0; i < 10000; ++i)
+                objs.emplace_back(arena.create<Obj>(&destroyed, i));
+
+            check(arena.getAllocatedBytes() == 10000 * sizeof(Obj),
+                  "Wrong number of allocated bytes");
+            check(arena.getChunksNum() > 1, "Should have several chunks");
+
+            bool ok = true;
+            for (uint64_t i = 0; i < 10000; ++i) {
+                ok &= objs[i]->val == i;
+                ok &= reinterpret_cast<uintptr_t>(objs[i].get()) % alignof(Obj) == 0;
+            }
+            check(ok, "Wrong value or alignment of an object");
+
+            objs[5].reset();
+            check(destroyed == 1, "Object not destroyed");
+
+            // bigger than a chunk
+            char *big = static_cast<char *>(arena.allocate(1 << 20, 1));
+            big[(1 << 20) - 1] = 1;
+
+            Arena moved(std::move(arena));
+            check(moved.getAllocatedBytes() == 10000 * sizeof(Obj) + (1 << 20),
+                  "Wrong number of allocated bytes after move");
+            check(arena.getChunksNum() == 0, "Moved arena has chunks");
+            objs.clear();
+        }
+        check(destroyed == 10000, "Objects not destroyed");
+    }
+};
+
+class TestIDMap : public Test
+{
+public:
+    TestIDMap() : Test("ID map test")
+    {}
+
+    void test()
+    {
+        IDMap<int *> map;
+        int a, b;
+        check(map.empty(), "Map not empty");
+        check(map.lookup(10) == nullptr, "Lookup out of the map");
+        check(map.get(10) == nullptr, "Get out of the map");
+
+        map[3] = &a;
+        map[100] = &b;
+        check(map.size() == 101, "Wrong size");
+        check(map.lookup(3) == &a, "Wrong value");
+        check(map.lookup(100) == &b, "Wrong value");
+        check(map.lookup(50) == nullptr, "Wrong default value");
+        check(*map.get(3) == &a, "Wrong value");
+        check(map.get(101) == nullptr, "Get out of the map");
+    }
+};
+
 }; // namespace tests
 }; // namespace dg
 
@@ -162,6 +239,8 @@ int main()
     Runner.add(new TestFIFO());
     Runner.add(new TestPrioritySet());
     Runner.add(new TestIntervalsHandling());
+    Runner.add(new TestArena());
+    Runner.add(new TestIDMap());
 
     return Runner();
 }
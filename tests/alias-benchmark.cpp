@@ -0,0 +1,150 @@
+// ignore unused parameters in LLVM libraries
+#if (__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-parameter"
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+
+#include <llvm/IR/Module.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/IRReader/IRReader.h>
+
+#if (__clang__)
+#pragma clang diagnostic pop // ignore -Wunused-parameter
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "dg/llvm/PointerAnalysis/PointerAnalysis.h"
+#include "../tools/TimeMeasure.h"
+
+using namespace dg;
+
+// the memory accesses of the module: (pointer, number of bytes)
+static std::vector<std::pair<const llvm::Value *, Offset>>
+getAccesses(const llvm::Module& M) {
+    std::vector<std::pair<const llvm::Value *, Offset>> accesses;
+    const auto& DL = M.getDataLayout();
+    for (const auto& F : M) {
+        for (const auto& B : F) {
+            for (const auto& I : B) {
+                if (auto *LI = llvm::dyn_cast<llvm::LoadInst>(&I)) {
+                    accesses.emplace_back(LI->getPointerOperand(),
+                                          DL.getTypeStoreSize(LI->getType()));
+                } else if (auto *SI = llvm::dyn_cast<llvm::StoreInst>(&I)) {
+                    accesses.emplace_back(SI->getPointerOperand(),
+                                          DL.getTypeStoreSize(SI->getValueOperand()->getType()));
+                }
+            }
+        }
+    }
+    return accesses;
+}
+
+// intersect the points-to sets by hand (the way the clients did it)
+static bool mayOverlapByHand(LLVMPointerAnalysis *PTA, const LLVMAliasQuery& Q) {
+    auto ptsA = PTA->getLLVMPointsTo(Q.a);
+    auto ptsB = PTA->getLLVMPointsTo(Q.b);
+    if (ptsA.hasUnknown() || ptsB.hasUnknown())
+        return true;
+
+    for (const auto& ptrA : ptsA) {
+        for (const auto& ptrB : ptsB) {
+            if (ptrA.value != ptrB.value)
+                continue;
+            if (ptrA.offset.isUnknown() || ptrB.offset.isUnknown())
+                return true;
+            if (ptrA.offset < ptrB.offset + Q.sizeB &&
+                ptrB.offset < ptrA.offset + Q.sizeA)
+                return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2) {
+        std::cerr << "Usage: alias-benchmark module.ll\n";
+        return 1;
+    }
+
+    llvm::LLVMContext context;
+    llvm::SMDiagnostic SMD;
+    auto M = llvm::parseIRFile(argv[1], SMD, context);
+    if (!M) {
+        SMD.print(argv[0], llvm::errs());
+        return 1;
+    }
+
+    dg::debug::TimeMeasure tm;
+    DGLLVMPointerAnalysis PTA(M.get());
+    tm.start();
+    PTA.run();
+    tm.stop();
+    tm.report("Pointer analysis took");
+
+    // query every access against the next 200 accesses
+    auto accesses = getAccesses(*M);
+    std::vector<LLVMAliasQuery> queries;
+    for (size_t i = 0; i < accesses.size(); ++i) {
+        for (size_t j = i; j < accesses.size() && j < i + 200; ++j) {
+            queries.emplace_back(accesses[i].first, accesses[i].second,
+                                 accesses[j].first, accesses[j].second);
+        }
+    }
+    std::cout << "Accesses: " << accesses.size()
+              << ", queries: " << queries.size() << "\n";
+
+    std::vector<bool> expected;
+    expected.reserve(queries.size());
+    tm.start();
+    for (const auto& Q : queries)
+        expected.push_back(mayOverlapByHand(&PTA, Q));
+    tm.stop();
+    tm.report(" -- intersecting points-to sets by hand took");
+
+    tm.start();
+    auto result = PTA.mayOverlap(queries);
+    tm.stop();
+    tm.report(" -- mayOverlap() (cold) took");
+    assert(result == expected && "mayOverlap() disagrees");
+
+    tm.start();
+    result = PTA.mayOverlap(queries);
+    tm.stop();
+    tm.report(" -- mayOverlap() (memoized) took");
+    assert(result == expected && "mayOverlap() disagrees");
+
+    size_t overlapping = 0;
+    for (bool r : result)
+        overlapping += r;
+    std::cout << "May overlap: " << overlapping << "\n";
+
+    std::vector<std::pair<const llvm::Value *, const llvm::Value *>> pairs;
+    pairs.reserve(queries.size());
+    for (const auto& Q : queries)
+        pairs.emplace_back(Q.a, Q.b);
+
+    tm.start();
+    auto aliases = PTA.alias(pairs);
+    tm.stop();
+    tm.report(" -- alias() took");
+
+#ifndef NDEBUG
+    // overlapping accesses must alias
+    for (size_t i = 0; i < aliases.size(); ++i)
+        assert(!result[i] || aliases[i]);
+#endif
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <set>
+
+#include "dg/CallGraph/CallGraph.h"
+#include "dg/CallGraph/CallGraphScheduler.h"
+
+using namespace dg;
+
+using CG = GenericCallGraph<int>;
+
+TEST_CASE("Duplicate calls", "CallGraph") {
+    CG cg;
+    REQUIRE(cg.addCall(1, 2));
+    REQUIRE(!cg.addCall(1, 2));
+    REQUIRE(cg.addCall(2, 1));
+    REQUIRE(cg.addCall(1, 1));
+    REQUIRE(!cg.addCall(1, 1));
+
+    auto *n1 = cg.get(1);
+    auto *n2 = cg.get(2);
+    REQUIRE(n1->getCalls().size() == 2);
+    REQUIRE(n1->getCallers().size() == 2);
+    REQUIRE(n2->getCalls().size() == 1);
+    REQUIRE(n2->getCallers().size() == 1);
+    REQUIRE(n1->calls(n2));
+    REQUIRE(n2->calls(n1));
+    REQUIRE(n1->calls(n1));
+    REQUIRE(!n2->calls(n2));
+    REQUIRE(n2->isCalledBy(n1));
+}
+
+TEST_CASE("SCCs", "CallGraph") {
+    // 1 -> 2 -> 3 -> 2, 3 -> 4, 1 -> 5 -> 5, 6 (not called)
+    CG cg;
+    cg.addCall(1, 2);
+    cg.addCall(2, 3);
+    cg.addCall(3, 2);
+    cg.addCall(3, 4);
+    cg.addCall(1, 5);
+    cg.addCall(5, 5);
+    cg.createNode(6);
+
+    const auto& sccs = cg.getSCCs();
+    REQUIRE(sccs.size() == 5);
+
+    auto scc = [&cg](int v) { return cg.get(v)->getSCCId(); };
+    REQUIRE(scc(2) == scc(3));
+    REQUIRE(sccs[scc(2)].getNodes().size() == 2);
+    REQUIRE(sccs[scc(2)].isRecursive());
+    REQUIRE(sccs[scc(5)].isRecursive());
+    REQUIRE(!sccs[scc(1)].isRecursive());
+    REQUIRE(!sccs[scc(4)].isRecursive());
+
+    // callees come first
+    REQUIRE(scc(4) < scc(2));
+    REQUIRE(scc(2) < scc(1));
+    REQUIRE(scc(5) < scc(1));
+
+    REQUIRE(sccs[scc(2)].getCalls().size() == 1);
+    REQUIRE(sccs[scc(2)].getCalls()[0] == scc(4));
+    REQUIRE(sccs[scc(2)].getCallers().size() == 1);
+    REQUIRE(sccs[scc(2)].getCallers()[0] == scc(1));
+    REQUIRE(sccs[scc(6)].getCalls().empty());
+    REQUIRE(sccs[scc(6)].getCallers().empty());
+
+    // the SCCs are recomputed after a change
+    cg.addCall(4, 1);
+    REQUIRE(cg.getSCCs().size() == 3);
+    REQUIRE(scc(1) == scc(4));
+    REQUIRE(scc(2) == scc(4));
+    REQUIRE(scc(5) < scc(1));
+    REQUIRE(cg.getSCCs()[scc(1)].getNodes().size() == 4);
+}
+
+TEST_CASE("Long call chain", "CallGraph") {
+    CG cg;
+    const int N = 100000;
+    for (int i = 0; i < N; ++i)
+        cg.addCall(i, i + 1);
+    cg.addCall(N, 0);
+
+    REQUIRE(cg.getSCCs().size() == 1);
+    REQUIRE(cg.getSCCs()[0].getNodes().size() == N + 1);
+}
+
+static CG diamonds(int n) {
+    // 0 -> 1, 2 -> 3 -> 4, 5 -> 6 ...
+    CG cg;
+    for (int i = 0; i < n; ++i) {
+        cg.addCall(3*i, 3*i + 1);
+        cg.addCall(3*i, 3*i + 2);
+        cg.addCall(3*i + 1, 3*i + 3);
+        cg.addCall(3*i + 2, 3*i + 3);
+    }
+    return cg;
+}
+
+static void checkOrder(unsigned threads, bool bottomUp) {
+    CG cg = diamonds(50);
+    std::mutex mtx;
+    std::set<unsigned> done;
+    bool ok = true;
+
+    auto fun = [&](const CG::SCCNode& scc) {
+        unsigned id = scc.getNodes()[0]->getSCCId();
+        std::lock_guard<std::mutex> lock(mtx);
+        for (unsigned dep : bottomUp ? scc.getCalls() : scc.getCallers()) {
+            if (done.count(dep) == 0)
+                ok = false;
+        }
+        if (!done.insert(id).second)
+            ok = false;
+    };
+
+    CallGraphScheduler<int> scheduler(cg, threads);
+    if (bottomUp)
+        scheduler.bottomUp(fun);
+    else
+        scheduler.topDown(fun);
+
+    REQUIRE(ok);
+    REQUIRE(done.size() == cg.getSCCs().size());
+}
+
+TEST_CASE("Bottom-up scheduling", "CallGraphScheduler") {
+    checkOrder(1, true);
+    checkOrder(4, true);
+}
+
+TEST_CASE("Top-down scheduling", "CallGraphScheduler") {
+    checkOrder(1, false);
+    checkOrder(4, false);
+}
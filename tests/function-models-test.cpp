@@ -0,0 +1,121 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <sstream>
+#include <string>
+
+#include "dg/DataDependence/DataDependenceAnalysisOptions.h"
+
+using namespace dg;
+
+static bool read(DataDependenceAnalysisOptions& opts,
+                 const std::string& input, std::string& error) {
+    std::istringstream in(input);
+    return opts.readFunctionModels(in, error);
+}
+
+TEST_CASE("Read a valid model library", "[models]") {
+    DataDependenceAnalysisOptions opts;
+    std::string error;
+
+    REQUIRE(read(opts,
+                 "# a model library\n"
+                 "alloc my_malloc malloc\n"
+                 "\n"
+                 "def my_memset 0 0 op2   # writes op2 bytes\n"
+                 "use my_memcpy 1 0 op2\n"
+                 "def my_memcpy 0 0 op2\n"
+                 "def my_free 0 unknown unknown\n",
+                 error));
+    REQUIRE(error.empty());
+
+    REQUIRE(opts.getAllocationFunction("my_malloc") == AllocationFunction::MALLOC);
+
+    auto *memset = opts.getFunctionModel("my_memset");
+    REQUIRE(memset);
+    REQUIRE(memset->defines(0));
+    REQUIRE(!memset->uses(0));
+    REQUIRE(memset->defines(0)->from.isOffset());
+    REQUIRE(memset->defines(0)->from.getOffset() == 0);
+    REQUIRE(memset->defines(0)->to.isOperand());
+    REQUIRE(memset->defines(0)->to.getOperand() == 2);
+
+    auto *memcpy = opts.getFunctionModel("my_memcpy");
+    REQUIRE(memcpy);
+    REQUIRE(memcpy->defines(0));
+    REQUIRE(memcpy->uses(1));
+
+    auto *free = opts.getFunctionModel("my_free");
+    REQUIRE(free);
+    REQUIRE(free->defines(0)->from.getOffset().isUnknown());
+    REQUIRE(free->defines(0)->to.getOffset().isUnknown());
+}
+
+TEST_CASE("Models from the library replace the old models", "[models]") {
+    DataDependenceAnalysisOptions opts;
+    opts.functionModelAddDef("foo", {0, Offset(0), Offset(4)});
+    opts.functionModelAddUse("foo", {1, Offset(0), Offset(4)});
+    std::string error;
+
+    REQUIRE(read(opts, "def foo 1 0 8\n", error));
+
+    auto *foo = opts.getFunctionModel("foo");
+    REQUIRE(foo);
+    REQUIRE(!foo->defines(0));
+    REQUIRE(!foo->uses(1));
+    REQUIRE(foo->defines(1));
+    REQUIRE(foo->defines(1)->to.getOffset() == 8);
+}
+
+TEST_CASE("Malformed model library", "[models]") {
+    DataDependenceAnalysisOptions opts;
+    opts.functionModelAddDef("foo", {0, Offset(0), Offset(4)});
+    const auto allocs = opts.allocationFunctions.size();
+    const auto models = opts.functionModels.size();
+    std::string error;
+
+    SECTION("malformed line") {
+        REQUIRE(!read(opts,
+                      "alloc my_malloc malloc\n"
+                      "def foo 1 0 8\n"
+                      "def bar 0 0\n",
+                      error));
+        REQUIRE(error.compare(0, 7, "line 3:") == 0);
+    }
+
+    SECTION("unknown operand") {
+        REQUIRE(!read(opts,
+                      "alloc my_malloc malloc\n"
+                      "def foo 1 0 8\n"
+                      "use bar x 0 8\n",
+                      error));
+        REQUIRE(error.compare(0, 7, "line 3:") == 0);
+    }
+
+    SECTION("unknown offset") {
+        REQUIRE(!read(opts,
+                      "alloc my_malloc malloc\n"
+                      "def foo 1 0 8\n"
+                      "use bar 0 opx 8\n",
+                      error));
+        REQUIRE(error.compare(0, 7, "line 3:") == 0);
+    }
+
+    SECTION("unknown entry") {
+        REQUIRE(!read(opts,
+                      "alloc my_malloc malloc\n"
+                      "def foo 1 0 8\n"
+                      "free bar\n",
+                      error));
+        REQUIRE(error.compare(0, 7, "line 3:") == 0);
+    }
+
+    // nothing from the malformed input is used
+    REQUIRE(opts.allocationFunctions.size() == allocs);
+    REQUIRE(opts.getAllocationFunction("my_malloc") == AllocationFunction::NONE);
+    REQUIRE(opts.functionModels.size() == models);
+    auto *foo = opts.getFunctionModel("foo");
+    REQUIRE(foo);
+    REQUIRE(foo->defines(0));
+    REQUIRE(!foo->defines(1));
+}
@@ -0,0 +1,95 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <cstdio>
+#include <string>
+
+#include "dg/util/GraphExport.h"
+
+using namespace dg::debug;
+
+using Format = GraphExportWriter::Format;
+
+// write a small graph in the given format and return the output
+static std::string writeGraph(Format format, size_t edges = 2) {
+    FILE *tmp = tmpfile();
+    REQUIRE(tmp != nullptr);
+
+    {
+        GraphExportWriter writer(fileno(tmp), format, {"dd", "cd"});
+        writer.begin(2);
+        writer.node(0, "main", "%x = load i32, i32* %\"p\"");
+        writer.node(1, "main", "a<b>&c\n");
+        for (size_t i = 0; i < edges; ++i)
+            writer.edge(i % 2, (i + 1) % 2, i % 2);
+        REQUIRE(writer.finish());
+        REQUIRE(writer.getEdgesNum() == edges);
+    }
+
+    std::string out;
+    rewind(tmp);
+    int c;
+    while ((c = fgetc(tmp)) != EOF)
+        out.push_back(static_cast<char>(c));
+    fclose(tmp);
+    return out;
+}
+
+static uint64_t readLE(const std::string& str, size_t pos, unsigned bytes) {
+    uint64_t n = 0;
+    for (unsigned i = 0; i < bytes; ++i)
+        n |= static_cast<uint64_t>(static_cast<unsigned char>(str[pos + i])) << (8 * i);
+    return n;
+}
+
+TEST_CASE("Edge list", "GraphExport") {
+    std::string out = writeGraph(Format::EDGE_LIST);
+
+    REQUIRE(out.compare(0, 4, "DGEL") == 0);
+    REQUIRE(readLE(out, 4, 4) == GraphExportWriter::EdgeListVersion);
+    REQUIRE(readLE(out, 8, 8) == 2);
+    REQUIRE(readLE(out, 16, 4) == 2);
+    REQUIRE(readLE(out, 20, 4) == 2);
+    REQUIRE(out.compare(24, 2, "dd") == 0);
+    REQUIRE(readLE(out, 26, 4) == 2);
+    REQUIRE(out.compare(30, 2, "cd") == 0);
+
+    // two records of 9 bytes
+    REQUIRE(out.size() == 32 + 2*9);
+    REQUIRE(readLE(out, 32, 4) == 0);
+    REQUIRE(readLE(out, 36, 4) == 1);
+    REQUIRE(readLE(out, 40, 1) == 0);
+    REQUIRE(readLE(out, 41, 4) == 1);
+    REQUIRE(readLE(out, 45, 4) == 0);
+    REQUIRE(readLE(out, 49, 1) == 1);
+}
+
+TEST_CASE("JSON lines", "GraphExport") {
+    std::string out = writeGraph(Format::JSONL);
+
+    REQUIRE(out ==
+        "{\"node\": 0, \"function\": \"main\", \"label\": \"%x = load i32, i32* %\\\"p\\\"\"}\n"
+        "{\"node\": 1, \"function\": \"main\", \"label\": \"a<b>&c\\n\"}\n"
+        "{\"src\": 0, \"dst\": 1, \"kind\": \"dd\"}\n"
+        "{\"src\": 1, \"dst\": 0, \"kind\": \"cd\"}\n");
+}
+
+TEST_CASE("GraphML", "GraphExport") {
+    std::string out = writeGraph(Format::GRAPHML);
+
+    REQUIRE(out.find("<graph edgedefault=\"directed\">") != std::string::npos);
+    REQUIRE(out.find("<node id=\"n1\"><data key=\"function\">main</data>"
+                     "<data key=\"label\">a&lt;b&gt;&amp;c</data></node>")
+            != std::string::npos);
+    REQUIRE(out.find("<edge source=\"n1\" target=\"n0\"><data key=\"kind\">cd</data></edge>")
+            != std::string::npos);
+    REQUIRE(out.size() > 22);
+    REQUIRE(out.compare(out.size() - 22, 22, "  </graph>\n</graphml>\n") == 0);
+}
+
+TEST_CASE("Output bigger than the buffer", "GraphExport") {
+    const size_t edges = 100000;
+    std::string out = writeGraph(Format::EDGE_LIST, edges);
+    REQUIRE(out.size() == 32 + edges*9);
+    REQUIRE(readLE(out, 32 + (edges - 1)*9, 4) == 1);
+}
@@ -0,0 +1,113 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <set>
+
+#include "test-llvm.h"
+
+#include "dg/llvm/PointerAnalysis/PointerAnalysis.h"
+
+using namespace dg;
+
+// 'id' is called from two contexts, with different pointers
+static const char *twoContexts = R"(
+define i32* @id(i32* %p) {
+  %q = getelementptr i32, i32* %p, i64 0
+  ret i32* %q
+}
+
+define i32 @main() {
+  %a = alloca i32
+  %b = alloca i32
+  %r1 = call i32* @id(i32* %a)
+  %r2 = call i32* @id(i32* %b)
+  ret i32 0
+}
+)";
+
+using TargetsT = std::set<const llvm::Value *>;
+
+static TargetsT getTargets(const pta::PointsToSetT& S) {
+    TargetsT targets;
+    for (const auto& ptr : S)
+        targets.insert(ptr.target->getUserData<llvm::Value>());
+    return targets;
+}
+
+static TargetsT getTargets(LLVMPointerAnalysis& PTA, const llvm::Value *val) {
+    TargetsT targets;
+    for (const auto& ptr : PTA.getLLVMPointsTo(val))
+        targets.insert(ptr.value);
+    return targets;
+}
+
+static const llvm::Value *getInstruction(const llvm::Function *F,
+                                         const char *name) {
+    for (const auto& B : *F) {
+        for (const auto& I : B) {
+            if (I.getName() == name)
+                return &I;
+        }
+    }
+    return nullptr;
+}
+
+static LLVMPointerAnalysisOptions getOptions(unsigned contextDepth) {
+    LLVMPointerAnalysisOptions opts;
+    opts.setEntryFunction("main");
+    opts.contextDepth = contextDepth;
+    opts.cloneSmallFunctions = 10;
+    return opts;
+}
+
+TEST_CASE("Clones of a function called from two contexts", "[pta][clones]") {
+    llvm::LLVMContext ctx;
+    auto M = tests::parseModule(ctx, twoContexts);
+    REQUIRE(M);
+
+    auto *main = M->getFunction("main");
+    auto *a = getInstruction(main, "a");
+    auto *b = getInstruction(main, "b");
+    auto *r1 = getInstruction(main, "r1");
+    auto *r2 = getInstruction(main, "r2");
+    auto *q = getInstruction(M->getFunction("id"), "q");
+    REQUIRE((a && b && r1 && r2 && q));
+
+    SECTION("Context-insensitive analysis merges the contexts") {
+        DGLLVMPointerAnalysis PTA(M.get(), getOptions(0));
+        PTA.run();
+
+        REQUIRE(PTA.getBuilder()->getClonesNum() == 0);
+        REQUIRE(getTargets(PTA, r1) == TargetsT({a, b}));
+        REQUIRE(getTargets(PTA, r2) == TargetsT({a, b}));
+    }
+
+    SECTION("The clones keep the contexts separate") {
+        DGLLVMPointerAnalysis PTA(M.get(), getOptions(1));
+        PTA.run();
+
+        REQUIRE(PTA.getBuilder()->getClonesNum() == 2);
+        REQUIRE(getTargets(PTA, r1) == TargetsT({a}));
+        REQUIRE(getTargets(PTA, r2) == TargetsT({b}));
+
+        // the value from the cloned function is represented by a phi
+        // that merges the nodes of the clones
+        pta::PSNode *merged = PTA.getPointsToNode(q);
+        REQUIRE(merged);
+        REQUIRE(merged->getType() == pta::PSNodeType::PHI);
+
+        std::set<TargetsT> contexts;
+        TargetsT all;
+        for (pta::PSNode *op : merged->getOperands()) {
+            auto targets = getTargets(op->pointsTo);
+            all.insert(targets.begin(), targets.end());
+            if (!targets.empty())
+                contexts.insert(targets);
+        }
+        REQUIRE(contexts == std::set<TargetsT>({TargetsT({a}), TargetsT({b})}));
+
+        // and has the union of the points-to sets of the clones
+        REQUIRE(getTargets(merged->pointsTo) == all);
+        REQUIRE(getTargets(PTA, q) == TargetsT({a, b}));
+    }
+}
@@ -0,0 +1,84 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <set>
+
+#include "test-llvm.h"
+#include "llvm-slicer.h"
+
+using namespace dg;
+
+static const char *twoCriteria = R"(
+@a = global i32 0
+@b = global i32 0
+
+declare void @crit1(i32)
+declare void @crit2(i32)
+
+define i32 @main() {
+entry:
+  store i32 1, i32* @a
+  store i32 2, i32* @b
+  %x = load i32, i32* @a
+  call void @crit1(i32 %x)
+  %y = load i32, i32* @b
+  call void @crit2(i32 %y)
+  ret i32 0
+}
+)";
+
+static const llvm::CallInst *findCall(const llvm::Function *F, const char *callee) {
+    for (const auto& B : *F) {
+        for (const auto& I : B) {
+            auto *C = llvm::dyn_cast<llvm::CallInst>(&I);
+            if (!C)
+                continue;
+            auto *fun = C->getCalledFunction();
+            if (fun && fun->getName() == callee)
+                return C;
+        }
+    }
+    return nullptr;
+}
+
+TEST_CASE("Extract slices for more criteria", "[slicer]") {
+    llvm::LLVMContext ctx;
+    auto M = tests::parseModule(ctx, twoCriteria);
+    REQUIRE(M);
+
+    SlicerOptions options;
+    ::Slicer slicer(M.get(), options);
+    REQUIRE(slicer.buildDG());
+
+    auto *main = M->getFunction("main");
+    auto getCriterion = [&](const char *callee) {
+        auto *C = findCall(main, callee);
+        REQUIRE(C);
+        auto *node = slicer.getDG().findNode(const_cast<llvm::CallInst *>(C));
+        REQUIRE(node);
+        return std::set<LLVMNode *>{node};
+    };
+
+    auto crit1 = getCriterion("crit1");
+    REQUIRE(slicer.mark(crit1));
+    auto slice1 = slicer.extract();
+
+    auto crit2 = getCriterion("crit2");
+    REQUIRE(slicer.mark(crit2));
+    auto slice2 = slicer.extract();
+
+    REQUIRE(slice1);
+    REQUIRE(slice2);
+
+    // the modules are extracted from the module that is not changed
+    REQUIRE(findCall(main, "crit1"));
+    REQUIRE(findCall(main, "crit2"));
+
+    // every slice contains only its own criterion
+    auto *main1 = slice1->getFunction("main");
+    auto *main2 = slice2->getFunction("main");
+    REQUIRE(findCall(main1, "crit1"));
+    REQUIRE(!findCall(main1, "crit2"));
+    REQUIRE(findCall(main2, "crit2"));
+    REQUIRE(!findCall(main2, "crit1"));
+}
@@ -0,0 +1,127 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include "test-llvm.h"
+
+#include "dg/llvm/PointerAnalysis/PointerAnalysis.h"
+#include "dg/llvm/ThreadRegions/ControlFlowGraph.h"
+#include "dg/llvm/ThreadRegions/MayHappenInParallel.h"
+#include "dg/llvm/ThreadRegions/ThreadRegion.h"
+
+// ignore unused parameters in LLVM libraries
+#if (__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-parameter"
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Instructions.h>
+
+#if (__clang__)
+#pragma clang diagnostic pop // ignore -Wunused-parameter
+#else
+#pragma GCC diagnostic pop
+#endif
+
+// the threads store to @x and main stores to @x after the join,
+// %join is given by the test (it loads one of the handles)
+static std::string program(const std::string& join) {
+    return R"(
+%union.pthread_attr_t = type { i64, [48 x i8] }
+
+@x = global i32 0
+
+declare i32 @pthread_create(i64*, %union.pthread_attr_t*, i8* (i8*)*, i8*)
+declare i32 @pthread_join(i64, i8**)
+
+define i8* @t1(i8* %arg) {
+  store i32 1, i32* @x
+  ret i8* null
+}
+
+define i8* @t2(i8* %arg) {
+  store i32 2, i32* @x
+  ret i8* null
+}
+
+define i32 @main(i32 %c) {
+  %h1 = alloca i64
+  %h2 = alloca i64
+  %r1 = call i32 @pthread_create(i64* %h1, %union.pthread_attr_t* null, i8* (i8*)* @t1, i8* null)
+  %r2 = call i32 @pthread_create(i64* %h2, %union.pthread_attr_t* null, i8* (i8*)* @t2, i8* null)
+  %cond = icmp eq i32 %c, 0
+)" + join + R"(
+  %rj = call i32 @pthread_join(i64 %v, i8** null)
+  store i32 3, i32* @x
+  ret i32 0
+}
+)";
+}
+
+// the region that contains the (only) store in the function
+static const ThreadRegion *storeRegion(const std::set<ThreadRegion *>& regions,
+                                       const llvm::Function *fun) {
+    const llvm::Instruction *store = nullptr;
+    for (auto& block : *fun) {
+        for (auto& I : block) {
+            if (llvm::isa<llvm::StoreInst>(&I))
+                store = &I;
+        }
+    }
+    REQUIRE(store);
+
+    for (auto *region : regions) {
+        if (region->llvmInstructions().count(store) > 0)
+            return region;
+    }
+    return nullptr;
+}
+
+struct Result {
+    bool t1AfterJoin;
+    bool t2AfterJoin;
+};
+
+static Result compute(const std::string& join) {
+    llvm::LLVMContext ctx;
+    auto M = dg::tests::parseModule(ctx, program(join));
+
+    dg::DGLLVMPointerAnalysis PTA(M.get(), "main", dg::Offset::UNKNOWN, true);
+    PTA.run();
+
+    ControlFlowGraph controlFlowGraph(&PTA);
+    controlFlowGraph.buildFunction(M->getFunction("main"));
+    auto regions = controlFlowGraph.threadRegions();
+    MayHappenInParallel mhp(regions);
+
+    auto *t1 = storeRegion(regions, M->getFunction("t1"));
+    auto *t2 = storeRegion(regions, M->getFunction("t2"));
+    auto *after = storeRegion(regions, M->getFunction("main"));
+    REQUIRE(t1);
+    REQUIRE(t2);
+    REQUIRE(after);
+
+    // the threads run in parallel with each other in any case
+    REQUIRE(mhp.mayHappenInParallel(t1, t2));
+
+    return {mhp.mayHappenInParallel(t1, after),
+            mhp.mayHappenInParallel(t2, after)};
+}
+
+TEST_CASE("Join of one thread", "[MHP]") {
+    auto result = compute("  %v = load i64, i64* %h1");
+    REQUIRE_FALSE(result.t1AfterJoin);
+    REQUIRE(result.t2AfterJoin);
+}
+
+TEST_CASE("Ambiguous join", "[MHP]") {
+    // pthread_join(c ? t1 : t2) may wait for any of the threads,
+    // so none of them is surely finished after the join
+    auto result = compute("  %h = select i1 %cond, i64* %h1, i64* %h2\n"
+                          "  %v = load i64, i64* %h");
+    REQUIRE(result.t1AfterJoin);
+    REQUIRE(result.t2AfterJoin);
+}
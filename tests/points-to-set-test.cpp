@@ -4,8 +4,10 @@
 #include "dg/PointerAnalysis/PSNode.h"
 #include "dg/PointerAnalysis/PointerGraph.h"
 #include "dg/PointerAnalysis/Pointer.h"
+#include "dg/PointerAnalysis/MemoryObject.h"
 
 using namespace dg::pta;
+using dg::Offset;
 
 template<typename PTSetT>
 void queryingEmptySet() {
@@ -340,3 +342,95 @@ TEST_CASE("Test aligned overflow set behavior", "PointsToSet") {
     testAlignedOverflowBehavior<AlignedSmallOffsetsPointsToSet>();
     testAlignedOverflowBehavior<AlignedPointerIdPointsToSet>();
 }
+
+TEST_CASE("Memory object keeps the fields sorted", "MemoryObject") {
+    PointerGraph PS;
+    PSNode* A = PS.create(PSNodeType::ALLOC);
+    PSNode* B = PS.create(PSNodeType::ALLOC);
+    MemoryObject mo(A);
+
+    REQUIRE(mo.empty());
+    REQUIRE(mo.addPointsTo(16, Pointer(A, 0)));
+    REQUIRE(mo.addPointsTo(Offset::UNKNOWN, Pointer(B, 0)));
+    REQUIRE(mo.addPointsTo(0, Pointer(B, 8)));
+    REQUIRE(!mo.addPointsTo(0, Pointer(B, 8)));
+
+    REQUIRE(mo.size() == 3);
+    REQUIRE(mo.getFieldsNum() == 2);
+    Offset last = 0;
+    for (const auto& it : mo.fields()) {
+        REQUIRE(last <= it.first);
+        last = it.first;
+    }
+    REQUIRE(last.isUnknown());
+
+    REQUIRE(mo.has(0));
+    REQUIRE(!mo.has(8));
+    REQUIRE(mo.find(16)->second.count(Pointer(A, 0)) == 1);
+}
+
+TEST_CASE("Memory object union of fields", "MemoryObject") {
+    PointerGraph PS;
+    PSNode* A = PS.create(PSNodeType::ALLOC);
+    PSNode* B = PS.create(PSNodeType::ALLOC);
+    MemoryObject mo(A);
+
+    mo.addPointsTo(0, Pointer(A, 0));
+    mo.addPointsTo(8, Pointer(B, 0));
+    REQUIRE(mo.getPointsToUnion().size() == 2);
+
+    // adding to a cached union
+    mo.addPointsTo(16, Pointer(B, 4));
+    REQUIRE(mo.getPointsToUnion().size() == 3);
+
+    // the union is computed again after the fields are modified
+    mo.getPointsTo(8).add(Pointer(A, 8));
+    REQUIRE(mo.getPointsToUnion().size() == 4);
+    REQUIRE(mo.getPointsToUnion().count(Pointer(A, 8)) == 1);
+
+    // a pointer with unknown offset replaces the pointers to B
+    // in the field, but not in the other fields
+    mo.addPointsTo(8, Pointer(B, Offset::UNKNOWN));
+    const auto& U = mo.getPointsToUnion();
+    REQUIRE(U.count(Pointer(B, 4)) == 1);
+    REQUIRE(U.count(Pointer(B, Offset::UNKNOWN)) == 1);
+}
+
+TEST_CASE("Memory object summarization", "MemoryObject") {
+    PointerGraph PS;
+    PSNode* A = PS.create(PSNodeType::ALLOC);
+    PSNode* B = PS.create(PSNodeType::ALLOC);
+    PSNode* C = PS.create(PSNodeType::ALLOC);
+    MemoryObject mo(A);
+
+    // array of structures {A *, long, B *} with the size 24
+    // where the last element has only the first field set
+    mo.addPointsTo(0, Pointer(A, 0));
+    mo.addPointsTo(16, Pointer(B, 0));
+    mo.addPointsTo(24, Pointer(C, 0));
+    mo.addPointsTo(40, Pointer(B, 0));
+    mo.addPointsTo(48, Pointer(A, 0));
+    REQUIRE(mo.computeStride() == 24);
+
+    mo.summarize(24);
+    REQUIRE(mo.isSummarized());
+    REQUIRE(mo.getFieldsNum() == 2);
+    REQUIRE(mo.find(72)->second.size() == 2); // A and C
+    REQUIRE(mo.find(64)->second.size() == 1); // B
+    REQUIRE(!mo.has(8));
+
+    // the new pointers go to the summary
+    mo.addPointsTo(88, Pointer(C, 0));
+    REQUIRE(mo.getFieldsNum() == 2);
+    REQUIRE(mo.find(16)->second.size() == 2);
+
+    // merging an object summarized with a different stride
+    MemoryObject other(A);
+    other.addPointsTo(4, Pointer(B, 8));
+    other.summarize(12);
+    mo.merge(other);
+    REQUIRE(mo.getStride() == 12);
+    REQUIRE(mo.getFieldsNum() == 2);
+    REQUIRE(mo.find(0)->second.size() == 2);
+    REQUIRE(mo.find(28)->second.size() == 3);
+}
@@ -1,7 +1,10 @@
 #include <assert.h>
 #include <cstdarg>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <set>
+#include <vector>
 
 #include "test-runner.h"
 #include "test-dg.h"
@@ -946,6 +949,73 @@ public:
           ("flow-insensitive points-to test") {}
 };
 
+// The flow-insensitive analysis that queues only the dependent nodes
+// (the default). It runs also the analysis that queues all nodes reachable
+// from the changed nodes and aborts if the results are not the same.
+class WorklistCheckedPointerAnalysisFI : public pta::PointerAnalysisFI
+{
+    PointerGraph *_PS;
+
+    std::vector<std::set<Pointer>> results() const
+    {
+        std::vector<std::set<Pointer>> ret;
+        for (const auto& nd : _PS->getNodes()) {
+            ret.emplace_back();
+            if (!nd)
+                continue;
+            for (const auto& ptr : nd->pointsTo)
+                ret.back().insert(ptr);
+        }
+        return ret;
+    }
+
+public:
+    WorklistCheckedPointerAnalysisFI(PointerGraph *PS)
+        : pta::PointerAnalysisFI(PS, PointerAnalysisOptions().setWorklist(true)),
+          _PS(PS) {}
+
+    void run()
+    {
+        // the points-to sets that the nodes have before the analysis
+        // (e.g., allocations point to themselves)
+        std::vector<PointsToSetT> initial;
+        for (const auto& nd : _PS->getNodes())
+            initial.push_back(nd ? nd->pointsTo : PointsToSetT());
+
+        std::vector<std::set<Pointer>> bfs;
+        {
+            pta::PointerAnalysisFI PA(_PS, PointerAnalysisOptions().setWorklist(false));
+            PA.run();
+            bfs = results();
+        }
+
+        for (size_t i = 0; i < initial.size(); ++i) {
+            if (const auto& nd = _PS->getNodes()[i])
+                nd->pointsTo = initial[i];
+        }
+
+        pta::PointerAnalysisFI::run();
+
+        auto worklist = results();
+        for (size_t i = 0; i < bfs.size(); ++i) {
+            if (bfs[i] != worklist[i]) {
+                fprintf(stderr, "The worklist changed the points-to set of node %u\n",
+                        _PS->getNodes()[i]->getID());
+                abort();
+            }
+        }
+    }
+};
+
+class WorklistPointsToTest
+    : public PointsToTest<WorklistCheckedPointerAnalysisFI>
+{
+public:
+    WorklistPointsToTest()
+        : PointsToTest<WorklistCheckedPointerAnalysisFI>
+          ("flow-insensitive worklist points-to test") {}
+};
+
 class FlowSensitivePointsToTest
     : public PointsToTest<pta::PointerAnalysisFS>
 {
@@ -955,6 +1025,125 @@ public:
           ("flow-sensitive points-to test") {}
 };
 
+class DemandDrivenPointsToTest : public Test
+{
+public:
+    DemandDrivenPointsToTest()
+        : Test("demand-driven points-to test") {}
+
+    void direct_store()
+    {
+        PointerGraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *C = PS.create(PSNodeType::ALLOC);
+        PSNode *D = PS.create(PSNodeType::ALLOC);
+        PSNode *S1 = PS.create(PSNodeType::STORE, A, B);
+        PSNode *S2 = PS.create(PSNodeType::STORE, C, D);
+        PSNode *L1 = PS.create(PSNodeType::LOAD, B);
+        PSNode *L2 = PS.create(PSNodeType::LOAD, D);
+
+        A->addSuccessor(B);
+        B->addSuccessor(C);
+        C->addSuccessor(D);
+        D->addSuccessor(S1);
+        S1->addSuccessor(S2);
+        S2->addSuccessor(L1);
+        L1->addSuccessor(L2);
+
+        auto subg = PS.createSubgraph(A);
+        PS.setEntry(subg);
+        PointerAnalysisFI PA(&PS);
+        check(PA.initializeDemand(), "demand-driven PTA not supported");
+        check(PA.solveDemand(L1), "query failed");
+
+        check(L1->doesPointsTo(A), "L1 does not point to A");
+        check(PA.isDemandSolved(S1), "S1 not solved");
+        // the unrelated nodes are not solved
+        check(!PA.isDemandSolved(S2), "S2 solved");
+        check(!PA.isDemandSolved(L2), "L2 solved");
+        check(L2->pointsTo.empty(), "L2 has points-to set");
+
+        check(PA.solveDemand(L2), "query failed");
+        check(L2->doesPointsTo(C), "L2 does not point to C");
+    }
+
+    void indirect_store()
+    {
+        // B = &A; C = load P (P = &B); store D, C; L = load B
+        PointerGraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *D = PS.create(PSNodeType::ALLOC);
+        PSNode *P = PS.create(PSNodeType::ALLOC);
+        PSNode *S1 = PS.create(PSNodeType::STORE, A, B);
+        PSNode *S2 = PS.create(PSNodeType::STORE, B, P);
+        PSNode *C = PS.create(PSNodeType::LOAD, P);
+        PSNode *S3 = PS.create(PSNodeType::STORE, D, C);
+        PSNode *L = PS.create(PSNodeType::LOAD, B);
+
+        A->addSuccessor(B);
+        B->addSuccessor(D);
+        D->addSuccessor(P);
+        P->addSuccessor(S1);
+        S1->addSuccessor(S2);
+        S2->addSuccessor(C);
+        C->addSuccessor(S3);
+        S3->addSuccessor(L);
+
+        auto subg = PS.createSubgraph(A);
+        PS.setEntry(subg);
+        PointerAnalysisFI PA(&PS);
+        check(PA.initializeDemand(), "demand-driven PTA not supported");
+        check(PA.solveDemand(L), "query failed");
+
+        check(L->doesPointsTo(A), "L does not point to A");
+        check(L->doesPointsTo(D), "L does not point to D");
+        check(PA.isDemandSolved(S3), "S3 not solved");
+    }
+
+    void budget()
+    {
+        PointerGraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        PSNode *B = PS.create(PSNodeType::ALLOC);
+        PSNode *S = PS.create(PSNodeType::STORE, A, B);
+        PSNode *L = PS.create(PSNodeType::LOAD, B);
+
+        A->addSuccessor(B);
+        B->addSuccessor(S);
+        S->addSuccessor(L);
+
+        auto subg = PS.createSubgraph(A);
+        PS.setEntry(subg);
+        PointerAnalysisFI PA(&PS);
+        check(PA.initializeDemand(), "demand-driven PTA not supported");
+        check(!PA.solveDemand(L, 2), "query did not exceed the budget");
+
+        // the exhaustive analysis is the fallback
+        PA.run();
+        check(L->doesPointsTo(A), "L does not point to A");
+    }
+
+    void flow_sensitive()
+    {
+        PointerGraph PS;
+        PSNode *A = PS.create(PSNodeType::ALLOC);
+        auto subg = PS.createSubgraph(A);
+        PS.setEntry(subg);
+        PointerAnalysisFS PA(&PS);
+        check(!PA.initializeDemand(), "flow-sensitive PTA on demand");
+    }
+
+    void test()
+    {
+        direct_store();
+        indirect_store();
+        budget();
+        flow_sensitive();
+    }
+};
+
 class PSNodeTest : public Test
 {
 
@@ -993,7 +1182,9 @@ int main(void)
     TestRunner Runner;
 
     Runner.add(new FlowInsensitivePointsToTest());
+    Runner.add(new WorklistPointsToTest());
     Runner.add(new FlowSensitivePointsToTest());
+    Runner.add(new DemandDrivenPointsToTest());
     Runner.add(new PSNodeTest());
 
     return Runner();
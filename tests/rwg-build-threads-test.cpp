@@ -0,0 +1,190 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "test-llvm.h"
+
+#include "dg/llvm/PointerAnalysis/PointerAnalysis.h"
+#include "dg/llvm/DataDependence/DataDependence.h"
+
+#include "llvm/ReadWriteGraph/LLVMReadWriteGraphBuilder.h"
+#include "llvm/llvm-utils.h"
+
+using namespace dg;
+
+static const char *program = R"(
+@g = global i32* null
+@h = global i32 0
+
+declare i8* @malloc(i64)
+
+define i32* @alloc() {
+  %m = call i8* @malloc(i64 4)
+  %p = bitcast i8* %m to i32*
+  ret i32* %p
+}
+
+define void @setg(i32* %p) {
+  store i32* %p, i32** @g
+  store i32 1, i32* %p
+  ret void
+}
+
+define i32 @getg() {
+  %p = load i32*, i32** @g
+  %v = load i32, i32* %p
+  %w = load i32, i32* @h
+  %s = add i32 %v, %w
+  ret i32 %s
+}
+
+define void @copy(i32* %p, i32* %q) {
+  %v = load i32, i32* %p
+  store i32 %v, i32* %q
+  store i32 %v, i32* @h
+  ret void
+}
+
+define void @loop(i32* %p, i32 %n) {
+entry:
+  %x = alloca i32
+  store i32 0, i32* %x
+  br label %head
+head:
+  %i = phi i32 [0, %entry], [%j, %body]
+  %c = icmp slt i32 %i, %n
+  br i1 %c, label %body, label %end
+body:
+  call void @copy(i32* %p, i32* %x)
+  %j = add i32 %i, 1
+  br label %head
+end:
+  ret void
+}
+
+define i32 @main() {
+  %a = alloca i32
+  %b = call i32* @alloc()
+  %c = call i32* @alloc()
+  store i32 2, i32* %a
+  call void @setg(i32* %b)
+  call void @copy(i32* %a, i32* %c)
+  call void @loop(i32* %c, i32 3)
+  %r = call i32 @getg()
+  ret i32 %r
+}
+)";
+
+static void dumpDefSites(std::ostream& out, const char *kind,
+                         const dda::DefSiteSetT& sites) {
+    for (const auto& ds : sites) {
+        out << " " << kind << "(" << ds.target->getID() << ", "
+            << *ds.offset << ", " << *ds.len << ")";
+    }
+}
+
+// the nodes of the graph in the order of subgraphs and blocks,
+// with their IDs and the memory that they define and use
+static std::vector<std::string> dumpGraph(dda::ReadWriteGraph *graph) {
+    std::vector<std::string> dump;
+    for (auto *subg : graph->subgraphs()) {
+        for (auto *block : subg->bblocks()) {
+            for (auto *node : block->getNodes()) {
+                std::ostringstream out;
+                out << node->getID();
+                dumpDefSites(out, "def", node->getDefines());
+                dumpDefSites(out, "use", node->getUses());
+                dump.push_back(out.str());
+            }
+            dump.push_back("--");
+        }
+    }
+    return dump;
+}
+
+TEST_CASE("Parallel build of RWG gives the same graph", "[rwg][threads]") {
+    llvm::LLVMContext ctx;
+    auto M = tests::parseModule(ctx, program);
+    REQUIRE(M);
+
+    DGLLVMPointerAnalysis PTA(M.get());
+    PTA.run();
+
+    LLVMDataDependenceAnalysisOptions opts;
+    dda::LLVMDataDependenceAnalysis sequential(M.get(), &PTA, opts);
+    sequential.buildGraph();
+    const auto expected = dumpGraph(sequential.getGraph());
+    REQUIRE(sequential.getGraph()->getNodesNum() > 0);
+
+    for (unsigned threads : {2u, 4u, 8u}) {
+        opts.buildThreads = threads;
+        dda::LLVMDataDependenceAnalysis parallel(M.get(), &PTA, opts);
+        parallel.buildGraph();
+
+        REQUIRE(parallel.getGraph()->getNodesNum()
+                    == sequential.getGraph()->getNodesNum());
+        REQUIRE(dumpGraph(parallel.getGraph()) == expected);
+
+        // the values are mapped to the nodes with the same IDs
+        for (const auto& F : *M) {
+            for (const auto& B : F) {
+                for (const auto& I : B) {
+                    auto *seqNode = sequential.getNode(&I);
+                    auto *parNode = parallel.getNode(&I);
+                    REQUIRE((seqNode == nullptr) == (parNode == nullptr));
+                    if (seqNode)
+                        REQUIRE(seqNode->getID() == parNode->getID());
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Memoized def-sites are the same as computed", "[rwg]") {
+    llvm::LLVMContext ctx;
+    auto M = tests::parseModule(ctx, program);
+    REQUIRE(M);
+
+    DGLLVMPointerAnalysis PTA(M.get());
+    PTA.run();
+
+    LLVMDataDependenceAnalysisOptions opts;
+    dda::LLVMReadWriteGraphBuilder builder(M.get(), &PTA, opts);
+    auto graph = builder.build();
+    REQUIRE(graph.getNodesNum() > 0);
+
+    // the pointers that the graph was built from
+    // are mapped again, now with the results from the cache
+    unsigned mapped = 0;
+    for (const auto& F : *M) {
+        for (const auto& B : F) {
+            for (const auto& I : B) {
+                const llvm::Value *ptr;
+                llvm::Type *type;
+                if (auto *load = llvm::dyn_cast<llvm::LoadInst>(&I)) {
+                    ptr = load->getPointerOperand();
+                    type = load->getType();
+                } else if (auto *store = llvm::dyn_cast<llvm::StoreInst>(&I)) {
+                    ptr = store->getPointerOperand();
+                    type = store->getValueOperand()->getType();
+                } else {
+                    continue;
+                }
+
+                Offset size = llvmutils::getAllocatedSize(type, &M->getDataLayout());
+                if (size == 0)
+                    size = Offset::UNKNOWN;
+
+                const auto& memoized = builder.mapPointers(&I, ptr, size);
+                REQUIRE(&builder.mapPointers(&I, ptr, size) == &memoized);
+                REQUIRE(memoized == *builder.computeDefSites(&I, ptr, size));
+                ++mapped;
+            }
+        }
+    }
+
+    REQUIRE(mapped > 0);
+}
@@ -0,0 +1,271 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "test-llvm.h"
+
+#include "dg/llvm/LLVMDependenceGraph.h"
+#include "dg/llvm/LLVMDependenceGraphBuilder.h"
+#include "dg/llvm/LLVMSummaryEdges.h"
+
+using namespace dg;
+
+// 'rec' is recursive, 'even' and 'odd' are mutually recursive
+// (and call also themselves, so that they have some summary edges:
+// the formal-out parameters are control dependent on the entry
+// of the function, so they depend on the formal-in parameters
+// only through the recursive calls)
+static const char *recursiveProgram = R"(
+@g = global i32 0
+
+define void @copy(i32* %p, i32* %q) {
+  %v = load i32, i32* %p
+  store i32 %v, i32* %q
+  ret void
+}
+
+define void @setg(i32* %p) {
+  %v = load i32, i32* %p
+  store i32 %v, i32* @g
+  ret void
+}
+
+define void @rec(i32* %p, i32* %q, i32 %n) {
+entry:
+  %c = icmp sgt i32 %n, 0
+  br i1 %c, label %then, label %else
+then:
+  %m = sub i32 %n, 1
+  call void @rec(i32* %q, i32* %p, i32 %m)
+  br label %end
+else:
+  %v = load i32, i32* %p
+  %gv = load i32, i32* @g
+  %s = add i32 %v, %gv
+  store i32 %s, i32* %q
+  br label %end
+end:
+  ret void
+}
+
+define void @even(i32* %p, i32* %q, i32 %n) {
+entry:
+  %c = icmp sgt i32 %n, 0
+  br i1 %c, label %then, label %else
+then:
+  %m = sub i32 %n, 1
+  call void @odd(i32* %q, i32* %p, i32 %m)
+  call void @even(i32* %p, i32* %q, i32 %m)
+  br label %end
+else:
+  call void @copy(i32* %p, i32* %q)
+  br label %end
+end:
+  ret void
+}
+
+define void @odd(i32* %p, i32* %q, i32 %n) {
+entry:
+  %c = icmp sgt i32 %n, 0
+  br i1 %c, label %then, label %else
+then:
+  %m = sub i32 %n, 1
+  call void @even(i32* %p, i32* %q, i32 %m)
+  call void @odd(i32* %q, i32* %p, i32 %m)
+  br label %end
+else:
+  %v = load i32, i32* %q
+  %gv = load i32, i32* @g
+  %s = add i32 %v, %gv
+  store i32 %s, i32* %p
+  call void @setg(i32* %q)
+  br label %end
+end:
+  ret void
+}
+
+define i32 @main() {
+  %x = alloca i32
+  %y = alloca i32
+  %z = alloca i32
+  %w = alloca i32
+  store i32 1, i32* %x
+  store i32 2, i32* %y
+  store i32 3, i32* %z
+  call void @copy(i32* %x, i32* %y)
+  call void @setg(i32* %z)
+  call void @rec(i32* %x, i32* %w, i32 3)
+  call void @even(i32* %y, i32* %z, i32 4)
+  %a = load i32, i32* %y
+  %b = load i32, i32* %w
+  %c = load i32, i32* %z
+  %s = add i32 %a, %b
+  %t = add i32 %s, %c
+  %gv = load i32, i32* @g
+  %r = add i32 %t, %gv
+  ret i32 %r
+}
+)";
+
+using SummaryT = std::map<LLVMNode *, std::set<LLVMNode *>>;
+
+template <typename Fun>
+static void forEachParameter(LLVMDGParameters *params, Fun fun) {
+    if (!params)
+        return;
+
+    for (auto& it : *params)
+        fun(it.second);
+    for (auto it = params->global_begin(), et = params->global_end();
+         it != et; ++it)
+        fun(it->second);
+    if (auto *vararg = params->getVarArg())
+        fun(*vararg);
+}
+
+static bool hasDataEdge(LLVMNode *from, LLVMNode *to) {
+    for (auto I = from->data_begin(), E = from->data_end(); I != E; ++I) {
+        if (*I == to)
+            return true;
+    }
+    return false;
+}
+
+///
+// The summary edges computed by the worklist algorithm
+// of Horwitz, Reps and Binkley that keeps all the path edges
+// (from a node to the formal-out parameter that depends on it).
+static SummaryT computeReferenceSummaryEdges() {
+    using EdgeT = std::pair<LLVMNode *, LLVMNode *>;
+
+    std::set<LLVMNode *> formalIns, formalOuts, actualOuts;
+    std::vector<LLVMNode *> calls;
+    for (auto& it : getConstructedFunctions()) {
+        forEachParameter(it.second->getParameters(), [&](LLVMDGParameter& p) {
+            if (p.in)
+                formalIns.insert(p.in);
+            if (p.out)
+                formalOuts.insert(p.out);
+        });
+        for (LLVMNode *call : it.second->getCallNodes()) {
+            calls.push_back(call);
+            forEachParameter(call->getParameters(), [&](LLVMDGParameter& p) {
+                if (p.out)
+                    actualOuts.insert(p.out);
+            });
+        }
+    }
+
+    SummaryT summary, revSummary;
+    std::set<EdgeT> pathEdges;
+    std::vector<EdgeT> workList;
+
+    auto propagate = [&](LLVMNode *from, LLVMNode *to) {
+        if (from->getDG() != to->getDG())
+            return;
+        if (pathEdges.insert({from, to}).second)
+            workList.emplace_back(from, to);
+    };
+
+    for (LLVMNode *out : formalOuts)
+        propagate(out, out);
+
+    while (!workList.empty()) {
+        EdgeT edge = workList.back();
+        workList.pop_back();
+        LLVMNode *n = edge.first;
+
+        if (formalIns.count(n) > 0) {
+            // add the summary edges to the call-sites of the function
+            for (LLVMNode *call : calls) {
+                bool callsFunction = false;
+                for (auto *subgraph : call->getSubgraphs())
+                    callsFunction |= subgraph == n->getDG();
+                if (!callsFunction)
+                    continue;
+
+                LLVMNode *actIn = nullptr, *actOut = nullptr;
+                forEachParameter(call->getParameters(), [&](LLVMDGParameter& p) {
+                    if (p.in && hasDataEdge(p.in, n))
+                        actIn = p.in;
+                    if (p.out && hasDataEdge(edge.second, p.out))
+                        actOut = p.out;
+                });
+                if (!actIn || !actOut)
+                    continue;
+
+                if (summary[actIn].insert(actOut).second) {
+                    revSummary[actOut].insert(actIn);
+                    std::vector<EdgeT> edges(pathEdges.begin(), pathEdges.end());
+                    for (auto& e : edges) {
+                        if (e.first == actOut)
+                            propagate(actIn, e.second);
+                    }
+                }
+            }
+            continue;
+        }
+
+        for (auto I = n->rev_control_begin(), E = n->rev_control_end(); I != E; ++I)
+            propagate(*I, edge.second);
+
+        if (actualOuts.count(n) > 0) {
+            for (LLVMNode *actIn : revSummary[n])
+                propagate(actIn, edge.second);
+            continue;
+        }
+
+        for (auto I = n->rev_data_begin(), E = n->rev_data_end(); I != E; ++I)
+            propagate(*I, edge.second);
+        for (auto I = n->user_begin(), E = n->user_end(); I != E; ++I)
+            propagate(*I, edge.second);
+    }
+
+    return summary;
+}
+
+TEST_CASE("Summary edges of recursive functions", "[summary-edges]") {
+    llvm::LLVMContext ctx;
+    auto M = tests::parseModule(ctx, recursiveProgram);
+    REQUIRE(M);
+
+    llvmdg::LLVMDependenceGraphOptions options;
+    llvmdg::LLVMDependenceGraphBuilder builder(M.get(), options);
+    auto dg = builder.build();
+    REQUIRE(dg);
+
+    auto reference = computeReferenceSummaryEdges();
+    size_t referenceNum = 0;
+    for (auto& it : reference)
+        referenceNum += it.second.size();
+    REQUIRE(referenceNum > 0);
+
+    // the recursive call-sites must have summary edges too
+    auto hasSummaryEdges = [&](const char *fun) {
+        for (auto& it : reference) {
+            auto *caller = static_cast<LLVMDependenceGraph *>(it.first->getDG());
+            if (caller->getEntry()->getKey()->getName() == fun)
+                return true;
+        }
+        return false;
+    };
+    REQUIRE(hasSummaryEdges("rec"));
+    REQUIRE(hasSummaryEdges("even"));
+    REQUIRE(hasSummaryEdges("odd"));
+
+    for (unsigned threads : {1u, 4u}) {
+        LLVMSummaryEdges summary;
+        summary.compute(threads);
+
+        CHECK(summary.getEdgesNum() == referenceNum);
+        for (auto& it : reference) {
+            CHECK(summary.getSummaryEdges(it.first) == it.second);
+            for (LLVMNode *actOut : it.second)
+                CHECK(summary.getRevSummaryEdges(actOut).count(it.first) > 0);
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef _TEST_LLVM_H_
+#define _TEST_LLVM_H_
+
+#include <memory>
+#include <string>
+
+// ignore unused parameters in LLVM libraries
+#if (__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-parameter"
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/raw_ostream.h>
+
+#if (__clang__)
+#pragma clang diagnostic pop // ignore -Wunused-parameter
+#else
+#pragma GCC diagnostic pop
+#endif
+
+namespace dg {
+namespace tests {
+
+///
+// Parse the module from the textual LLVM IR
+// (the IR of tests is written with typed pointers).
+inline std::unique_ptr<llvm::Module> parseModule(llvm::LLVMContext& ctx,
+                                                 const std::string& ir) {
+    llvm::SMDiagnostic SMD;
+    auto buf = llvm::MemoryBuffer::getMemBuffer(ir, "test", false);
+    auto M = llvm::parseIR(buf->getMemBufferRef(), SMD, ctx);
+    if (!M)
+        SMD.print("test", llvm::errs());
+    return M;
+}
+
+} // namespace tests
+} // namespace dg
+
+#endif // _TEST_LLVM_H_
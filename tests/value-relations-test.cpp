@@ -0,0 +1,441 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+// ignore unused parameters in LLVM libraries
+#if (__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-parameter"
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Type.h>
+
+#if (__clang__)
+#pragma clang diagnostic pop // ignore -Wunused-parameter
+#else
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "test-llvm.h"
+
+#include "dg/llvm/ValueRelations/EqualityMap.h"
+#include "dg/llvm/ValueRelations/Relations.h"
+#include "dg/llvm/ValueRelations/ValueRelations.h"
+#include "dg/llvm/ValueRelations/ValueRelationsDriver.h"
+
+using namespace dg;
+
+using EqMap = EqualityMap<const llvm::Value *>;
+
+// values to put into the maps
+struct Values {
+    llvm::LLVMContext ctx;
+    std::vector<const llvm::Value *> vals;
+
+    Values(unsigned n = 64) {
+        for (unsigned i = 0; i < n; ++i)
+            vals.push_back(llvm::ConstantInt::get(llvm::Type::getInt32Ty(ctx), i));
+    }
+
+    const llvm::Value *operator[](unsigned i) const { return vals[i]; }
+};
+
+static bool equal(const EqMap& M, const llvm::Value *a, const llvm::Value *b) {
+    auto cls = M.get(a);
+    return cls && cls->count(b) > 0;
+}
+
+TEST_CASE("Union of equality maps", "[EqualityMap]") {
+    Values V;
+    EqMap A, B;
+    A.add(V[0], V[1]);
+    B.add(V[1], V[2]);
+    B.add(V[3], V[4]);
+
+    REQUIRE(A.add(B));
+    REQUIRE(equal(A, V[0], V[2]));
+    REQUIRE(equal(A, V[3], V[4]));
+    REQUIRE_FALSE(equal(A, V[0], V[3]));
+    REQUIRE(A.size() == 5);
+    REQUIRE(A.get(V[0])->size() == 3);
+
+    // nothing new
+    REQUIRE_FALSE(A.add(B));
+    REQUIRE_FALSE(A.add(V[2], V[0]));
+
+    // B did not change
+    REQUIRE_FALSE(equal(B, V[0], V[1]));
+    REQUIRE(B.size() == 4);
+}
+
+TEST_CASE("Intersection of equality maps", "[EqualityMap]") {
+    Values V;
+    EqMap A, B;
+    A.add(V[0], V[1]);
+    A.add(V[1], V[2]);
+    A.add(V[3], V[4]);
+    B.add(V[0], V[1]);
+    B.add(V[2], V[5]);
+
+    auto copy = A;
+    A.intersect(B);
+
+    REQUIRE(equal(A, V[0], V[1]));
+    REQUIRE(A.get(V[0])->size() == 2);
+    // the value is in both maps, but it is equal to nothing else
+    REQUIRE(A.get(V[2])->size() == 1);
+    // the values are not in B
+    REQUIRE(A.get(V[3]) == nullptr);
+    REQUIRE(A.get(V[4]) == nullptr);
+    REQUIRE(A.size() == 3);
+
+    unsigned n = 0;
+    for (const auto& it : A) {
+        REQUIRE(it.second == A.get(it.first));
+        ++n;
+    }
+    REQUIRE(n == 3);
+
+    // the copy is not affected and gets back what it had
+    REQUIRE(equal(copy, V[0], V[2]));
+    REQUIRE(equal(copy, V[3], V[4]));
+    REQUIRE(A.add(copy));
+    REQUIRE(equal(A, V[0], V[2]));
+    REQUIRE(equal(A, V[3], V[4]));
+}
+
+TEST_CASE("Copies of equality maps share data", "[EqualityMap]") {
+    Values V;
+    EqMap A;
+    A.add(V[0], V[1]);
+    A.add(V[2], V[3]);
+
+    EqMap B = A;
+    REQUIRE(B.get(V[0]) == A.get(V[0]));
+    REQUIRE(B.get(V[2]) == A.get(V[2]));
+
+    REQUIRE(B.add(V[0], V[4]));
+    REQUIRE(equal(B, V[1], V[4]));
+    REQUIRE_FALSE(equal(A, V[1], V[4]));
+    REQUIRE(A.get(V[4]) == nullptr);
+    // the class that did not change is still shared
+    REQUIRE(B.get(V[2]) == A.get(V[2]));
+    REQUIRE(B.get(V[0]) != A.get(V[0]));
+
+    // A gets the change from B, the rest stays shared
+    const auto *cls = A.get(V[2]);
+    REQUIRE(A.add(B));
+    REQUIRE(equal(A, V[1], V[4]));
+    REQUIRE(A.get(V[2]) == cls);
+    REQUIRE_FALSE(A.add(B));
+
+    // diverged copies
+    EqMap C = A, D = A;
+    C.add(V[5], V[6]);
+    D.add(V[7], V[8]);
+    REQUIRE(C.add(D));
+    REQUIRE(equal(C, V[5], V[6]));
+    REQUIRE(equal(C, V[7], V[8]));
+    REQUIRE(C.get(V[2]) == cls);
+    REQUIRE(D.get(V[5]) == nullptr);
+}
+
+// the classes of the map as the smallest member of the class of every value
+static std::map<const llvm::Value *, const llvm::Value *> classes(const EqMap& M) {
+    std::map<const llvm::Value *, const llvm::Value *> ret;
+    for (const auto& it : M) {
+        REQUIRE(it.second->count(it.first) > 0);
+        ret[it.first] = *it.second->begin();
+    }
+    REQUIRE(ret.size() == M.size());
+    return ret;
+}
+
+// a straightforward implementation of the same map
+struct RefMap {
+    std::map<const llvm::Value *, unsigned> cls;
+    unsigned next{0};
+
+    void add(const llvm::Value *a, const llvm::Value *b) {
+        if (cls.count(a) == 0)
+            cls[a] = next++;
+        if (cls.count(b) == 0)
+            cls[b] = cls[a];
+        auto from = cls[b], to = cls[a];
+        for (auto& it : cls) {
+            if (it.second == from)
+                it.second = to;
+        }
+    }
+
+    void add(const RefMap& rhs) {
+        for (const auto& it : rhs.cls) {
+            for (const auto& it2 : rhs.cls) {
+                if (it.second == it2.second)
+                    add(it.first, it2.first);
+            }
+        }
+    }
+
+    void intersect(const RefMap& rhs) {
+        std::map<std::pair<unsigned, unsigned>, unsigned> ids;
+        std::map<const llvm::Value *, unsigned> tmp;
+        for (const auto& it : cls) {
+            auto r = rhs.cls.find(it.first);
+            if (r == rhs.cls.end())
+                continue;
+            auto key = std::make_pair(it.second, r->second);
+            if (ids.count(key) == 0) {
+                auto id = next++;
+                ids[key] = id;
+            }
+            tmp[it.first] = ids[key];
+        }
+        cls.swap(tmp);
+    }
+
+    std::map<const llvm::Value *, const llvm::Value *> classes() const {
+        std::map<unsigned, const llvm::Value *> first;
+        for (const auto& it : cls) {
+            if (first.count(it.second) == 0)
+                first[it.second] = it.first;
+        }
+        std::map<const llvm::Value *, const llvm::Value *> ret;
+        for (const auto& it : cls)
+            ret[it.first] = first[it.second];
+        return ret;
+    }
+};
+
+TEST_CASE("Equality maps match a reference", "[EqualityMap]") {
+    // the values must be ordered by their addresses as in the sets
+    Values V(40);
+    std::vector<const llvm::Value *> vals(V.vals);
+    std::sort(vals.begin(), vals.end());
+
+    std::mt19937 gen(1);
+    auto rnd = [&gen](unsigned n) { return static_cast<unsigned>(gen() % n); };
+
+    // a pool of maps that are derived from each other
+    std::vector<EqMap> maps(1);
+    std::vector<RefMap> refs(1);
+    for (unsigned step = 0; step < 2000; ++step) {
+        auto i = rnd(maps.size());
+        switch (rnd(8)) {
+        case 0:
+            maps.push_back(maps[i]);
+            refs.push_back(refs[i]);
+            break;
+        case 1: {
+            auto j = rnd(maps.size());
+            maps[i].add(maps[j]);
+            refs[i].add(refs[j]);
+            break;
+        }
+        case 2: {
+            auto j = rnd(maps.size());
+            maps[i].intersect(maps[j]);
+            refs[i].intersect(refs[j]);
+            break;
+        }
+        default: {
+            auto a = vals[rnd(vals.size())], b = vals[rnd(vals.size())];
+            maps[i].add(a, b);
+            refs[i].add(a, b);
+        }
+        }
+
+        if (maps.size() > 16) {
+            maps.erase(maps.begin());
+            refs.erase(refs.begin());
+        }
+
+        for (unsigned k = 0; k < maps.size(); ++k)
+            REQUIRE(classes(maps[k]) == refs[k].classes());
+    }
+}
+
+TEST_CASE("Copies of relations maps share data", "[RelationsMap]") {
+    Values V;
+    RelationsMap A;
+    for (unsigned i = 0; i + 1 < 50; ++i)
+        A.add(dg::VRRelation::Lt(V[i], V[i + 1]));
+
+    RelationsMap B = A;
+    REQUIRE(B.get(V[0]) == A.get(V[0]));
+
+    REQUIRE(B.add(dg::VRRelation::Neq(V[0], V[2])));
+    REQUIRE(B.has(dg::VRRelation::Neq(V[0], V[2])));
+    REQUIRE_FALSE(A.has(dg::VRRelation::Neq(V[0], V[2])));
+    REQUIRE(B.get(V[0]) != A.get(V[0]));
+    // only the changed relations were copied
+    for (unsigned i = 1; i < 49; ++i)
+        REQUIRE(B.get(V[i]) == A.get(V[i]));
+
+    RelationsMap C = A;
+    REQUIRE(C.add(dg::VRRelation::Le(V[10], V[20])));
+    REQUIRE(C.add(B));
+    REQUIRE_FALSE(C.add(B));
+    REQUIRE(C.has(dg::VRRelation::Neq(V[0], V[2])));
+    REQUIRE(C.has(dg::VRRelation::Le(V[10], V[20])));
+    REQUIRE(C.get(V[30]) == A.get(V[30]));
+
+    unsigned n = 0;
+    for (const auto& it : C) {
+        REQUIRE(C.get(it.first) == &it.second);
+        for (const auto& rel : it.second) {
+            REQUIRE(rel.getLHS() == it.first);
+            ++n;
+        }
+    }
+    // 49 < relations, != and <=
+    REQUIRE(n == 51);
+}
+
+// the functions do not call each other, so the whole-module analysis
+// passes no relations from call-sites into them
+static const char *program = R"(
+declare i32 @get()
+
+define i32 @loop(i32 %n) {
+entry:
+  %i = alloca i32
+  store i32 0, i32* %i
+  br label %cond
+
+cond:
+  %iv = load i32, i32* %i
+  %cmp = icmp slt i32 %iv, %n
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %inc = add nsw i32 %iv, 1
+  store i32 %inc, i32* %i
+  br label %cond
+
+exit:
+  %r = load i32, i32* %i
+  ret i32 %r
+}
+
+define i32 @branch(i32 %a, i32 %b) {
+entry:
+  %x = alloca i32
+  %eq = icmp eq i32 %a, %b
+  br i1 %eq, label %then, label %else
+
+then:
+  store i32 %a, i32* %x
+  br label %join
+
+else:
+  %le = icmp sle i32 %a, %b
+  br i1 %le, label %less, label %join
+
+less:
+  store i32 %b, i32* %x
+  br label %join
+
+join:
+  %v = load i32, i32* %x
+  %ne = icmp ne i32 %v, 0
+  br i1 %ne, label %nz, label %z
+
+nz:
+  %w = load i32, i32* %x
+  ret i32 %w
+
+z:
+  ret i32 %a
+}
+
+define i32 @main() {
+entry:
+  %a = call i32 @get()
+  %b = call i32 @get()
+  %c = icmp ult i32 %a, %b
+  br i1 %c, label %lt, label %ge
+
+lt:
+  %s = sub i32 %b, %a
+  ret i32 %s
+
+ge:
+  ret i32 0
+}
+)";
+
+// the relations that hold at the location as tuples (lhs, relation, rhs)
+static std::set<std::tuple<const llvm::Value *, int, const llvm::Value *>>
+relations(const dg::analysis::VRLocation *loc) {
+    std::set<std::tuple<const llvm::Value *, int, const llvm::Value *>> ret;
+    for (const auto& it : loc->relations) {
+        for (const auto& rel : it.second) {
+            int type = rel.isEq() ? 1 : rel.isNeq() ? 2 : rel.isLe() ? 3
+                     : rel.isLt() ? 4 : rel.isGe() ? 5 : 6;
+            ret.emplace(rel.getLHS(), type, rel.getRHS());
+        }
+    }
+    return ret;
+}
+
+// the equal values at the location as pairs (value, class)
+static std::map<const llvm::Value *, std::set<const llvm::Value *>>
+equalities(const dg::analysis::VRLocation *loc) {
+    std::map<const llvm::Value *, std::set<const llvm::Value *>> ret;
+    for (const auto& it : loc->equalities)
+        ret[it.first].insert(it.second->begin(), it.second->end());
+    return ret;
+}
+
+TEST_CASE("Per-function relations match the whole module", "[ValueRelations]") {
+    using namespace dg::analysis;
+
+    llvm::LLVMContext ctx;
+    auto M = dg::tests::parseModule(ctx, program);
+    REQUIRE(M);
+
+    LLVMValueRelations whole(M.get());
+    whole.build();
+    whole.compute(0, 3, 10);
+
+    LLVMValueRelationsDriver onDemand(M.get(), 0, 10);
+    LLVMValueRelationsDriver parallel(M.get(), 0, 10);
+    parallel.computeAll(4);
+
+    unsigned nonempty = 0;
+    for (const auto& F : *M) {
+        if (F.isDeclaration())
+            continue;
+
+        REQUIRE(parallel.get(&F) != nullptr);
+        for (const auto& B : F) {
+            for (const auto& I : B) {
+                const auto *expected = whole.getMapping(&I);
+                REQUIRE(expected);
+                for (auto *loc : {onDemand.getMapping(&I),
+                                  parallel.getOrCompute(&F)->getMapping(&I)}) {
+                    REQUIRE(loc);
+                    REQUIRE(relations(loc) == relations(expected));
+                    REQUIRE(equalities(loc) == equalities(expected));
+                }
+
+                if (!relations(expected).empty())
+                    ++nonempty;
+            }
+        }
+    }
+
+    // the test makes sense only if something was computed
+    REQUIRE(nonempty > 0);
+}
@@ -333,6 +333,7 @@ int main(int argc, char *argv[])
 
     SlicerOptions options = parseSlicerOptions(argc, argv,
                                                /* requireCrit = */ false);
+    ProfileDumper profileDumper(options);
 
     if (enable_debug) {
         DBG_ENABLE();
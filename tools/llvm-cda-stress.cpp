@@ -29,6 +29,7 @@
 #include "ControlDependence/NTSCD.h"
 #include "ControlDependence/DOD.h"
 #include "ControlDependence/DODNTSCD.h"
+#include "ControlDependence/ControlClosure.h"
 
 using namespace dg;
 
@@ -91,6 +92,11 @@ llvm::cl::opt<bool> compare("compare",
     llvm::cl::desc("Compare the resulting control dependencies (default=false)."),
     llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
 
+llvm::cl::opt<unsigned> closureNodes("closure-nodes",
+    llvm::cl::desc("The number of random nodes whose strong control closure "
+                   "is computed with -scc (default=1)."),
+    llvm::cl::init(1), llvm::cl::cat(SlicingOpts));
+
 llvm::cl::opt<unsigned> Vn("nodes",
     llvm::cl::desc("The number of nodes (default=100)."),
     llvm::cl::init(100), llvm::cl::cat(SlicingOpts));
@@ -128,6 +134,21 @@ void generateRandomGraph(CDGraph& G, unsigned Vnum = 100, unsigned Enum = 0) {
     }
 }
 
+std::set<CDNode *> getRandomNodes(CDGraph& G, unsigned num) {
+    std::set<CDNode *> nodes;
+    if (G.empty())
+        return nodes;
+
+    std::random_device dev;
+    std::mt19937 rng(dev());
+    std::uniform_int_distribution<std::mt19937::result_type> ids(1, G.size());
+
+    while (num-- > 0) {
+        nodes.insert(G.getNode(ids(rng)));
+    }
+    return nodes;
+}
+
 int main(int argc, char *argv[])
 {
     SlicerOptions options = parseSlicerOptions(argc, argv,
@@ -210,17 +231,37 @@ int main(int argc, char *argv[])
                   << static_cast<float>(elapsed) / CLOCKS_PER_SEC << " s ("
                   << elapsed << " ticks)\n";
     }
-    /*
+    if (scc) {
+        auto X = getRandomNodes(G, closureNodes);
 
+        dg::StrongControlClosure closure;
+        start = clock();
+        auto cls = closure.getClosure(G, X);
+        end = clock();
+        elapsed = end - start;
+
+        std::cout << "scc: "
+                  << static_cast<float>(elapsed) / CLOCKS_PER_SEC << " s ("
+                  << elapsed << " ticks)\n";
+
+        if (compare) {
+            dg::StrongControlClosureNaive naive;
+            start = clock();
+            auto ncls = naive.getClosure(G, X);
+            end = clock();
+            elapsed = end - start;
+
+            std::cout << "scc-naive: "
+                      << static_cast<float>(elapsed) / CLOCKS_PER_SEC << " s ("
+                      << elapsed << " ticks)\n";
+
+            if (std::set<CDNode *>(cls.begin(), cls.end()) !=
+                std::set<CDNode *>(ncls.begin(), ncls.end())) {
+                std::cout << "scc: the closures differ!\n";
+                return 1;
+            }
+        }
     }
-    if (ntscd_legacy) {
-        opts.algorithm = dg::ControlDependenceAnalysisOptions::CDAlgorithm::NTSCD_LEGACY;
-        analyses.emplace_back("ntscd-legacy", new LLVMControlDependenceAnalysis(M.get(), opts), 0);
-    }
-   if (scc) {
-        opts.algorithm = dg::ControlDependenceAnalysisOptions::CDAlgorithm::STRONG_CC;
-        analyses.emplace_back("scc", new LLVMControlDependenceAnalysis(M.get(), opts), 0);
-    }
-    */
+
     return 0;
 }
@@ -653,6 +653,7 @@ std::unique_ptr<llvm::Module> parseModule(llvm::LLVMContext& context,
 int main(int argc, char *argv[])
 {
     SlicerOptions options = parseSlicerOptions(argc, argv);
+    ProfileDumper profileDumper(options);
 
     if (enable_debug) {
         DBG_ENABLE();
@@ -11,6 +11,9 @@
 #include <cassert>
 #include <cstdio>
 
+#include <fcntl.h>
+#include <unistd.h>
+
 // ignore unused parameters in LLVM libraries
 #if (__clang__)
 #pragma clang diagnostic push
@@ -44,6 +47,8 @@
 #include "dg/llvm/LLVMDependenceGraphBuilder.h"
 #include "dg/llvm/LLVMSlicer.h"
 #include "dg/llvm/LLVMDG2Dot.h"
+#include "dg/llvm/LLVMDGExport.h"
+#include "dg/llvm/LLVMSummaryEdges.h"
 #include "dg/llvm/PointerAnalysis/PointerAnalysis.h"
 #include "dg/PointerAnalysis/PointerAnalysisFS.h"
 #include "dg/PointerAnalysis/PointerAnalysisFI.h"
@@ -68,6 +73,15 @@ int main(int argc, char *argv[])
     const char *dump_func_only = nullptr;
     const char *pts = "fi";
     const char *entry_func = "main";
+    const char *analysis_cache = nullptr;
+    const char *export_file = nullptr;
+    const char *export_around = nullptr;
+    bool summary_edges = false;
+    unsigned summary_threads = 1;
+    unsigned interference_threads = 1;
+    debug::GraphExportWriter::Format export_format
+        = debug::GraphExportWriter::Format::JSONL;
+    debug::LLVMDGExporter::Options export_opts;
     LLVMControlDependenceAnalysisOptions::CDAlgorithm cd_alg =
         LLVMControlDependenceAnalysisOptions::CDAlgorithm::STANDARD;
 
@@ -110,6 +124,30 @@ int main(int argc, char *argv[])
             threads = true;
         } else if (strcmp(argv[i], "-entry") == 0) {
             entry_func = argv[++i];
+        } else if (strcmp(argv[i], "-analysis-cache") == 0) {
+            analysis_cache = argv[++i];
+        } else if (strcmp(argv[i], "-export") == 0) {
+            export_file = argv[++i];
+        } else if (strcmp(argv[i], "-export-format") == 0) {
+            if (!debug::GraphExportWriter::parseFormat(argv[++i], export_format)) {
+                errs() << "Invalid export format, try: edges, graphml, jsonl\n";
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-export-funcs") == 0) {
+            std::istringstream funs(argv[++i]);
+            std::string fun;
+            while (std::getline(funs, fun, ','))
+                export_opts.functions.insert(fun);
+        } else if (strcmp(argv[i], "-export-around") == 0) {
+            export_around = argv[++i];
+        } else if (strcmp(argv[i], "-export-hops") == 0) {
+            export_opts.hops = static_cast<unsigned>(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "-summary-edges") == 0) {
+            summary_edges = true;
+        } else if (strcmp(argv[i], "-summary-threads") == 0) {
+            summary_threads = static_cast<unsigned>(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "-interference-threads") == 0) {
+            interference_threads = static_cast<unsigned>(atoi(argv[++i]));
         } else if (strcmp(argv[i], "-cd-alg") == 0) {
             const char *arg = argv[++i];
             if (strcmp(arg, "standard") == 0)
@@ -151,10 +189,14 @@ int main(int argc, char *argv[])
 
     options.CDAOptions.algorithm = cd_alg;
     options.threads = threads;
+    options.interferenceThreads = interference_threads;
     options.PTAOptions.threads = threads;
     options.DDAOptions.threads = threads;
     options.PTAOptions.entryFunction = entry_func;
     options.DDAOptions.entryFunction = entry_func;
+    // NOTE: post-dominators (-postdom) are not stored in the cache
+    if (analysis_cache)
+        options.analysisCacheDir = analysis_cache;
     if (strcmp(pts, "fs") == 0) {
         options.PTAOptions.analysisType
             = LLVMPointerAnalysisOptions::AnalysisType::fs;
@@ -172,6 +214,69 @@ int main(int argc, char *argv[])
     llvmdg::LLVMDependenceGraphBuilder builder(M, options);
     auto dg = builder.build();
 
+    LLVMSummaryEdges summary;
+    if (summary_edges) {
+        debug::TimeMeasure tm;
+        tm.start();
+        summary.compute(summary_threads);
+        tm.stop();
+        tm.report("INFO: Computing summary edges took");
+        errs() << "INFO: computed " << summary.getEdgesNum()
+               << " summary edges\n";
+    }
+
+    if (export_file) {
+        using Exporter = debug::LLVMDGExporter;
+        export_opts.edges = 0;
+        if (opts & PRINT_CFG)
+            export_opts.edges |= 1 << Exporter::CFG;
+        if (opts & PRINT_DD)
+            export_opts.edges |= 1 << Exporter::DD;
+        if (opts & PRINT_USE)
+            export_opts.edges |= 1 << Exporter::USE;
+        if (opts & PRINT_CD)
+            export_opts.edges |= 1 << Exporter::CD;
+        if (opts & PRINT_ID)
+            export_opts.edges |= 1 << Exporter::ID;
+        if (opts & PRINT_CALL)
+            export_opts.edges |= 1 << Exporter::CALL;
+        if (summary_edges) {
+            export_opts.edges |= 1 << Exporter::SUMMARY;
+            export_opts.summaryEdges = &summary;
+        }
+
+        if (export_around) {
+            dg->getCallSites(export_around, &export_opts.around);
+            if (export_opts.around.empty()) {
+                errs() << "ERR: no call of " << export_around << " found\n";
+                return 1;
+            }
+        }
+
+        int fd = strcmp(export_file, "-") == 0 ? STDOUT_FILENO :
+                    open(export_file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            errs() << "ERR: failed opening " << export_file << "\n";
+            return 1;
+        }
+
+        debug::GraphExportWriter writer(fd, export_format,
+                                        Exporter::getKindNames());
+        Exporter exporter(M, export_opts);
+        bool ret = exporter.exportGraph(writer);
+        if (fd != STDOUT_FILENO)
+            close(fd);
+
+        if (!ret) {
+            errs() << "ERR: exporting the graph failed\n";
+            return 1;
+        }
+
+        errs() << "INFO: exported " << exporter.getNodesNum() << " nodes and "
+               << writer.getEdgesNum() << " edges ("
+               << writer.getWrittenBytes() << " bytes)\n";
+        return 0;
+    }
 
     std::set<LLVMNode *> callsites;
     if (slicing_criterion) {
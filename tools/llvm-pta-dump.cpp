@@ -241,7 +241,7 @@ static void dumpPointer(const Pointer& ptr, bool dot) {
 
 static void dumpMemoryObject(MemoryObject *mo, int ind, bool dot) {
     bool printed_multi = false;
-    for (auto& it : mo->pointsTo) {
+    for (auto& it : mo->fields()) {
         int width = 0;
         for (const Pointer& ptr : it.second) {
             // print indentation
@@ -258,7 +258,7 @@ static void dumpMemoryObject(MemoryObject *mo, int ind, bool dot) {
                 // print a new line if there are multiple items
                 if (dot &&
                     (it.second.size() > 1 ||
-                     (printed_multi && mo->pointsTo.size() > 1))) {
+                     (printed_multi && mo->size() > 1))) {
                     printed_multi = true;
                     printf("\\l%*s",ind + width, "");
                 }
@@ -298,15 +298,21 @@ dumpMemoryMap(PointerAnalysisFS::MemoryMapT *mm, int ind, bool dot) {
     }
 }
 
+// the analysis whose results we dump (set in dumpPointerGraph)
+static const pta::PointerAnalysis *dumpedPTA = nullptr;
+
+static PointerAnalysisFS::MemoryMapT *getMemoryMap(PSNode *n) {
+    return static_cast<const PointerAnalysisFS *>(dumpedPTA)->getMemoryMap(n);
+}
+
 static bool mmChanged(PSNode *n) {
     if (n->predecessorsNum() == 0)
         return true;
 
-    PointerAnalysisFS::MemoryMapT *mm
-        = n->getData<PointerAnalysisFS::MemoryMapT>();
+    PointerAnalysisFS::MemoryMapT *mm = getMemoryMap(n);
 
     for (PSNode *pred : n->predecessors()) {
-        if (pred->getData<PointerAnalysisFS::MemoryMapT>() != mm)
+        if (getMemoryMap(pred) != mm)
             return true;
     }
 
@@ -316,8 +322,12 @@ static bool mmChanged(PSNode *n) {
 static void
 dumpPointerGraphData(PSNode *n, PTType type, bool dot = false) {
     assert(n && "No node given");
+    if (!dumpedPTA)
+        return;
+
     if (type == dg::LLVMPointerAnalysisOptions::AnalysisType::fi) {
-        MemoryObject *mo = n->getData<MemoryObject>();
+        MemoryObject *mo
+            = static_cast<const PointerAnalysisFI *>(dumpedPTA)->getMemoryObject(n);
         if (!mo)
             return;
 
@@ -331,8 +341,7 @@ dumpPointerGraphData(PSNode *n, PTType type, bool dot = false) {
         if (!dot)
             printf("    -----------\n");
     } else {
-        PointerAnalysisFS::MemoryMapT *mm
-            = n->getData<PointerAnalysisFS::MemoryMapT>();
+        PointerAnalysisFS::MemoryMapT *mm = getMemoryMap(n);
         if (!mm)
             return;
 
@@ -476,7 +485,7 @@ static void dumpNodeEdgesToDot(PSNode *node) {
 }
 
 PSNode *getNodePtr(PSNode *ptr) { return ptr; }
-PSNode *getNodePtr(const std::unique_ptr<PSNode>& ptr) { return ptr.get(); }
+PSNode *getNodePtr(const PointerGraph::NodesT::value_type& ptr) { return ptr.get(); }
 
 
 template <typename ContT> static void
@@ -595,6 +604,7 @@ dumpPointerGraphdot(DGLLVMPointerAnalysis *pta, PTType type) {
 static void
 dumpPointerGraph(DGLLVMPointerAnalysis *pta, PTType type) {
     assert(pta);
+    dumpedPTA = pta->getPTA();
 
     if (todot)
         dumpPointerGraphdot(pta, type);
@@ -806,6 +816,7 @@ int main(int argc, char *argv[]) {
 
     SlicerOptions options = parseSlicerOptions(argc, argv,
                                                /* requireCrit = */ false);
+    ProfileDumper profileDumper(options);
 
     if (enable_debug) {
         DBG_ENABLE();
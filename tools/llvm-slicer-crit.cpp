@@ -34,6 +34,7 @@
 #pragma GCC diagnostic pop
 #endif
 
+#include "llvm-slicer-crit.h"
 #include "llvm-slicer-utils.h"
 #include "dg/llvm/LLVMNode.h"
 #include "dg/llvm/LLVMDependenceGraph.h"
@@ -44,98 +45,140 @@ using namespace dg;
 
 using llvm::errs;
 
-// mapping of AllocaInst to the names of C variables
-static std::map<const llvm::Value *, std::string> valuesToVariables;
-
-static bool usesTheVariable(LLVMDependenceGraph& dg,
-                            const llvm::Value *v,
-                            const std::string& var)
+SlicingCriteriaIndex::SlicingCriteriaIndex(LLVMDependenceGraph& dg) : _dg(dg)
 {
-    auto pts = dg.getPTA()->getLLVMPointsTo(v);
-    if (pts.empty() || pts.hasUnknown())
-        return true; // it may be a definition of the variable, we do not know
-
-    for (const auto& ptr : pts) {
-        auto name = valuesToVariables.find(ptr.value);
-        if (name != valuesToVariables.end()) {
-            if (name->second == var)
-                return true;
+    for (auto& it : getConstructedFunctions()) {
+        for (auto& I : llvm::instructions(*llvm::cast<llvm::Function>(it.first))) {
+#if (LLVM_VERSION_MAJOR > 3 || (LLVM_VERSION_MAJOR == 3 && LLVM_VERSION_MINOR >= 7))
+            // create the mapping from LLVM values to C variable names
+            if (const llvm::DbgDeclareInst *DD = llvm::dyn_cast<llvm::DbgDeclareInst>(&I)) {
+                auto val = DD->getAddress();
+                _variables[val] = DD->getVariable()->getName().str();
+                continue;
+            } else if (const llvm::DbgValueInst *DV
+                        = llvm::dyn_cast<llvm::DbgValueInst>(&I)) {
+                auto val = DV->getValue();
+                _variables[val] = DV->getVariable()->getName().str();
+                continue;
+            }
+#endif
+
+            if (llvm::isa<llvm::CallInst>(&I)) {
+                LLVMNode *nd = it.second->getNode(&I);
+                assert(nd);
+                _addCallSite(nd);
+            } else if (llvm::isa<llvm::LoadInst>(&I) ||
+                       llvm::isa<llvm::StoreInst>(&I)) {
+                auto& Loc = I.getDebugLoc();
+#if (LLVM_VERSION_MAJOR == 3 && LLVM_VERSION_MINOR < 7)
+                if (Loc.getLine() <= 0) {
+#else
+                if (!Loc) {
+#endif
+                    continue;
+                }
+
+                LLVMNode *nd = it.second->getNode(&I);
+                assert(nd);
+                _lines[Loc.getLine()].accesses.push_back(nd);
+            }
         }
     }
 
-    return false;
+    _hasDebugInfo = !_variables.empty();
+
+    for (const auto& GV : dg.getModule()->globals()) {
+        _variables[&GV] = GV.getName().str();
+        if (LLVMNode *nd = dg.getGlobalNode(const_cast<llvm::GlobalVariable *>(&GV)))
+            _globals[GV.getName().str()] = nd;
+    }
 }
 
-template <typename InstT>
-static bool useOfTheVar(LLVMDependenceGraph& dg,
-                        const llvm::Instruction& I,
-                        const std::string& var)
+void SlicingCriteriaIndex::_addCallSite(LLVMNode *nd)
 {
-    // check that we store to that variable
-    const InstT *tmp = llvm::dyn_cast<InstT>(&I);
-    if (!tmp)
-        return false;
+    using namespace llvm;
 
-    return usesTheVariable(dg, tmp->getPointerOperand(), var);
-}
+    // if the function is undefined, it has no subgraphs,
+    // but is not called via function pointer
+    if (!nd->hasSubgraphs()) {
+        const CallInst *callInst = cast<CallInst>(nd->getValue());
+        const Value *calledValue = callInst->getCalledValue();
+        const Function *func = dyn_cast<Function>(calledValue->stripPointerCasts());
+        // in the case we haven't run points-to analysis
+        if (func)
+            _callSites[func->getName().str()].push_back(nd);
+    } else {
+        for (LLVMDependenceGraph *subdg : nd->getSubgraphs()) {
+            LLVMNode *entry = subdg->getEntry();
+            assert(entry && "No entry node in graph");
 
-static bool isStoreToTheVar(LLVMDependenceGraph& dg,
-                            const llvm::Instruction& I,
-                            const std::string& var)
-{
-    return useOfTheVar<llvm::StoreInst>(dg, I, var);
+            const Function *func
+                = cast<Function>(entry->getValue()->stripPointerCasts());
+            auto& sites = _callSites[func->getName().str()];
+            if (sites.empty() || sites.back() != nd)
+                sites.push_back(nd);
+        }
+    }
 }
 
-static bool isLoadOfTheVar(LLVMDependenceGraph& dg,
-                           const llvm::Instruction& I,
-                           const std::string& var)
+static const llvm::Value *getPointerOperand(const llvm::Value *val)
 {
-    return useOfTheVar<llvm::LoadInst>(dg, I, var);
+    if (auto *L = llvm::dyn_cast<llvm::LoadInst>(val))
+        return L->getPointerOperand();
+    return llvm::cast<llvm::StoreInst>(val)->getPointerOperand();
 }
 
-
-static bool instMatchesCrit(LLVMDependenceGraph& dg,
-                            const llvm::Instruction& I,
-                            const std::vector<std::pair<int, std::string>>& parsedCrit)
+void SlicingCriteriaIndex::_resolve(LineInfo& info) const
 {
-    for (const auto& c : parsedCrit) {
-        auto& Loc = I.getDebugLoc();
-#if (LLVM_VERSION_MAJOR == 3 && LLVM_VERSION_MINOR < 7)
-        if (Loc.getLine() <= 0) {
-#else
-        if (!Loc) {
-#endif
+    for (LLVMNode *nd : info.accesses) {
+        auto pts = _dg.getPTA()->getLLVMPointsTo(getPointerOperand(nd->getValue()));
+        if (pts.empty() || pts.hasUnknown()) {
+            // it may be an access to any variable, we do not know
+            info.unknown.push_back(nd);
             continue;
         }
 
-        if (static_cast<int>(Loc.getLine()) != c.first)
-            continue;
-
-        if (isStoreToTheVar(dg, I, c.second) ||
-            isLoadOfTheVar(dg, I, c.second)) {
-            llvm::errs() << "Matched line " << c.first << " with variable "
-                         << c.second << " to:\n" << I << "\n";
-            return true;
+        for (const auto& ptr : pts) {
+            auto name = _variables.find(ptr.value);
+            if (name != _variables.end()) {
+                auto& nodes = info.variables[name->second];
+                if (nodes.empty() || nodes.back() != nd)
+                    nodes.push_back(nd);
+            }
         }
     }
 
-    return false;
+    info.resolved = true;
 }
 
-static bool globalMatchesCrit(const llvm::GlobalVariable& G,
-                              const std::vector<std::pair<int, std::string>>& parsedCrit)
+std::vector<LLVMNode *>
+SlicingCriteriaIndex::getAccesses(unsigned line, const std::string& var) const
 {
-    for (const auto& c : parsedCrit) {
-        if (c.first != -1)
-            continue;
-        if (c.second == G.getName().str()) {
-            llvm::errs() << "Matched global variable "
-                         << c.second << " to:\n" << G << "\n";
-            return true;
-        }
-    }
+    auto it = _lines.find(line);
+    if (it == _lines.end())
+        return {};
 
-    return false;
+    auto& info = it->second;
+    if (!info.resolved)
+        _resolve(info);
+
+    std::vector<LLVMNode *> nodes(info.unknown);
+    auto vit = info.variables.find(var);
+    if (vit != info.variables.end())
+        nodes.insert(nodes.end(), vit->second.begin(), vit->second.end());
+
+    return nodes;
+}
+
+bool SlicingCriteriaIndex::getCallSites(const std::string& name,
+                                        std::set<LLVMNode *>& nodes) const
+{
+    auto it = _callSites.find(name);
+    if (it == _callSites.end())
+        return false;
+
+    nodes.insert(it->second.begin(), it->second.end());
+    return true;
 }
 
 static inline bool isNumber(const std::string& s) {
@@ -148,7 +191,7 @@ static inline bool isNumber(const std::string& s) {
     return true;
 }
 
-static void getLineCriteriaNodes(LLVMDependenceGraph& dg,
+static void getLineCriteriaNodes(const SlicingCriteriaIndex& index,
                                  std::vector<std::string>& criteria,
                                  std::set<LLVMNode *>& nodes)
 {
@@ -179,21 +222,7 @@ static void getLineCriteriaNodes(LLVMDependenceGraph& dg,
     llvm::errs() << "WARNING: Variables names matching is not supported for LLVM older than 3.7\n";
     llvm::errs() << "WARNING: The slicing criteria with variables names will not work\n";
 #else
-    // create the mapping from LLVM values to C variable names
-    for (auto& it : getConstructedFunctions()) {
-        for (auto& I : llvm::instructions(*llvm::cast<llvm::Function>(it.first))) {
-            if (const llvm::DbgDeclareInst *DD = llvm::dyn_cast<llvm::DbgDeclareInst>(&I)) {
-                auto val = DD->getAddress();
-                valuesToVariables[val] = DD->getVariable()->getName().str();
-            } else if (const llvm::DbgValueInst *DV
-                        = llvm::dyn_cast<llvm::DbgValueInst>(&I)) {
-                auto val = DV->getValue();
-                valuesToVariables[val] = DV->getVariable()->getName().str();
-            }
-        }
-    }
-
-    bool no_dbg = valuesToVariables.empty();
+    bool no_dbg = !index.hasDebugInfo();
     if (no_dbg) {
         llvm::errs() << "No debugging information found in program,\n"
                      << "slicing criteria with lines and variables will work\n"
@@ -201,15 +230,14 @@ static void getLineCriteriaNodes(LLVMDependenceGraph& dg,
                      << "You can still use the criteria based on call sites ;)\n";
     }
 
-    for (const auto& GV : dg.getModule()->globals()) {
-        valuesToVariables[&GV] = GV.getName().str();
-    }
-
     // try match globals
-    for (auto& G : dg.getModule()->globals()) {
-        if (globalMatchesCrit(G, parsedCrit)) {
-            LLVMNode *nd = dg.getGlobalNode(&G);
-            assert(nd);
+    for (const auto& c : parsedCrit) {
+        if (c.first != -1)
+            continue;
+
+        if (LLVMNode *nd = index.getGlobal(c.second)) {
+            llvm::errs() << "Matched global variable "
+                         << c.second << " to:\n" << *nd->getValue() << "\n";
             nodes.insert(nd);
         }
     }
@@ -220,19 +248,22 @@ static void getLineCriteriaNodes(LLVMDependenceGraph& dg,
     }
 
     // map line criteria to nodes
-    for (auto& it : getConstructedFunctions()) {
-        for (auto& I : llvm::instructions(*llvm::cast<llvm::Function>(it.first))) {
-            if (instMatchesCrit(dg, I, parsedCrit)) {
-                LLVMNode *nd = it.second->getNode(&I);
-                assert(nd);
-                nodes.insert(nd);
+    for (const auto& c : parsedCrit) {
+        if (c.first == -1)
+            continue;
+
+        for (LLVMNode *nd : index.getAccesses(c.first, c.second)) {
+            if (nodes.insert(nd).second) {
+                llvm::errs() << "Matched line " << c.first << " with variable "
+                             << c.second << " to:\n" << *nd->getValue() << "\n";
             }
         }
     }
 #endif // LLVM > 3.6
 }
 
-std::set<LLVMNode *> getSlicingCriteriaNodes(LLVMDependenceGraph& dg,
+std::set<LLVMNode *> getSlicingCriteriaNodes(const SlicingCriteriaIndex& index,
+                                             LLVMDependenceGraph& dg,
                                              const std::string& slicingCriteria)
 {
     std::set<LLVMNode *> nodes;
@@ -261,14 +292,21 @@ std::set<LLVMNode *> getSlicingCriteriaNodes(LLVMDependenceGraph& dg,
     }
 
     // map the criteria to nodes
-    if (!node_criteria.empty())
-        dg.getCallSites(node_criteria, &nodes);
+    for (const auto& c : node_criteria)
+        index.getCallSites(c, nodes);
     if (!line_criteria.empty())
-        getLineCriteriaNodes(dg, line_criteria, nodes);
+        getLineCriteriaNodes(index, line_criteria, nodes);
 
     return nodes;
 }
 
+std::set<LLVMNode *> getSlicingCriteriaNodes(LLVMDependenceGraph& dg,
+                                             const std::string& slicingCriteria)
+{
+    SlicingCriteriaIndex index(dg);
+    return getSlicingCriteriaNodes(index, dg, slicingCriteria);
+}
+
 std::pair<std::set<std::string>, std::set<std::string>>
 parseSecondarySlicingCriteria(const std::string& slicingCriteria)
 {
@@ -0,0 +1,81 @@
+#ifndef _DG_LLVM_SLICER_CRIT_H_
+#define _DG_LLVM_SLICER_CRIT_H_
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "dg/llvm/LLVMDependenceGraph.h"
+
+///
+// Index of the nodes that can be slicing criteria.
+// It is built in one pass over the constructed functions
+// and then every criterion is resolved by a look-up, so the index
+// can be re-used for many criteria (e.g., when slicing in a batch).
+// The criteria do not contain file names, so the lines are not
+// distinguished by files (the same as when matching the criteria
+// by scanning the instructions).
+class SlicingCriteriaIndex {
+    struct LineInfo {
+        // loads and stores on the line
+        std::vector<dg::LLVMNode *> accesses;
+        // the accesses are resolved to variables (using pointer analysis)
+        // on the first query for the line
+        bool resolved{false};
+        // variable -> loads and stores of the variable
+        std::unordered_map<std::string, std::vector<dg::LLVMNode *>> variables;
+        // loads and stores that may access any variable
+        // (the pointer points to unknown memory)
+        std::vector<dg::LLVMNode *> unknown;
+    };
+
+    dg::LLVMDependenceGraph& _dg;
+    // mapping of LLVM values (e.g., AllocaInst) to the names of C variables
+    std::unordered_map<const llvm::Value *, std::string> _variables;
+    mutable std::unordered_map<unsigned, LineInfo> _lines;
+    // name of global variable -> its node
+    std::unordered_map<std::string, dg::LLVMNode *> _globals;
+    // name of called function -> call sites
+    std::unordered_map<std::string, std::vector<dg::LLVMNode *>> _callSites;
+    bool _hasDebugInfo{false};
+
+    void _addCallSite(dg::LLVMNode *nd);
+    void _resolve(LineInfo& info) const;
+
+public:
+    SlicingCriteriaIndex(dg::LLVMDependenceGraph& dg);
+
+    // were there any debugging information (mapping to variables) in the program?
+    bool hasDebugInfo() const { return _hasDebugInfo; }
+
+    // loads and stores of the variable 'var' on the line 'line'
+    std::vector<dg::LLVMNode *> getAccesses(unsigned line,
+                                            const std::string& var) const;
+
+    dg::LLVMNode *getGlobal(const std::string& name) const {
+        auto it = _globals.find(name);
+        return it == _globals.end() ? nullptr : it->second;
+    }
+
+    // return true if some call site was found
+    bool getCallSites(const std::string& name,
+                      std::set<dg::LLVMNode *>& nodes) const;
+};
+
+std::set<dg::LLVMNode *> getSlicingCriteriaNodes(const SlicingCriteriaIndex& index,
+                                                 dg::LLVMDependenceGraph& dg,
+                                                 const std::string& slicingCriteria);
+
+// build the index and get the nodes
+std::set<dg::LLVMNode *> getSlicingCriteriaNodes(dg::LLVMDependenceGraph& dg,
+                                                 const std::string& slicingCriteria);
+
+std::pair<std::set<std::string>, std::set<std::string>>
+parseSecondarySlicingCriteria(const std::string& slicingCriteria);
+
+bool findSecondarySlicingCriteria(std::set<dg::LLVMNode *>& criteria_nodes,
+                                  const std::set<std::string>& secondaryControlCriteria,
+                                  const std::set<std::string>& secondaryDataCriteria);
+
+#endif // _DG_LLVM_SLICER_CRIT_H_
@@ -1,3 +1,5 @@
+#include <cstdlib>
+
 #include "dg/Offset.h"
 #include "dg/llvm/LLVMDependenceGraph.h"
 #include "dg/llvm/LLVMDependenceGraphBuilder.h"
@@ -134,6 +136,51 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit, bool
                        llvm::cl::value_desc("N"), llvm::cl::init(dg::Offset::UNKNOWN),
                        llvm::cl::cat(SlicingOpts));
 
+    llvm::cl::opt<unsigned> ptaContextDepth("pta-context-depth",
+        llvm::cl::desc("Clone allocation wrappers (and small functions, see\n"
+                       "-pta-clone-small-functions) in pointer analysis for every\n"
+                       "call-string of the length up to N. Default: 0 (no cloning).\n"),
+                       llvm::cl::value_desc("N"), llvm::cl::init(0),
+                       llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<unsigned> ptaCloneSmallFunctions("pta-clone-small-functions",
+        llvm::cl::desc("With -pta-context-depth, clone also functions\n"
+                       "with at most N instructions. Default: 0.\n"),
+                       llvm::cl::value_desc("N"), llvm::cl::init(0),
+                       llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<uint64_t> ptaMaxClonedNodes("pta-max-cloned-nodes",
+        llvm::cl::desc("Stop cloning functions in pointer analysis when the clones\n"
+                       "have N nodes. Default: 100000.\n"),
+                       llvm::cl::value_desc("N"), llvm::cl::init(100000),
+                       llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<bool> ptaWorklist("pta-worklist",
+        llvm::cl::desc("In flow-insensitive pointer analysis, re-process only\n"
+                       "the nodes that depend on the changed nodes. If false,\n"
+                       "re-process all nodes reachable from the changed nodes.\n"
+                       "Default: true.\n"),
+                       llvm::cl::init(true), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<bool> ptaDemand("pta-demand",
+        llvm::cl::desc("Solve the points-to sets of flow-insensitive pointer\n"
+                       "analysis only when they are queried. Default: false.\n"),
+                       llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<uint64_t> ptaDemandBudget("pta-demand-budget",
+        llvm::cl::desc("With -pta-demand, solve the whole pointer analysis\n"
+                       "when a query needs to process more than N nodes\n"
+                       "(0 = no limit). Default: 100000.\n"),
+                       llvm::cl::value_desc("N"), llvm::cl::init(100000),
+                       llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<uint64_t> ptaMaxObjectFields("pta-max-object-fields",
+        llvm::cl::desc("Summarize memory objects with pointers at more than\n"
+                       "N different offsets (e.g., big arrays of structures)\n"
+                       "in pointer analysis (0 = no limit). Default: 0.\n"),
+                       llvm::cl::value_desc("N"), llvm::cl::init(0),
+                       llvm::cl::cat(SlicingOpts));
+
     llvm::cl::opt<dg::dda::UndefinedFunsBehavior> undefinedFunsBehavior("undefined-funs",
         llvm::cl::desc("Set the behavior of undefined functions\n"),
         llvm::cl::values(
@@ -169,6 +216,30 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit, bool
         llvm::cl::desc("Consider threads are in input file (default=false)."),
         llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
 
+    llvm::cl::opt<std::string> analysisCache("analysis-cache",
+        llvm::cl::desc("Store the results of the analyses into the given\n"
+                       "directory and re-use them in later runs on the same\n"
+                       "module with the same options (not used with threads).\n"),
+                       llvm::cl::value_desc("dir"),
+                       llvm::cl::init(""), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<bool> analysisCacheIncremental("analysis-cache-incremental",
+        llvm::cl::desc("If there are no cached results for the module,\n"
+                       "re-use the control dependencies of unchanged functions\n"
+                       "from the last results cached with the same options.\n"
+                       "Pointer and data dependence analyses are re-run on the\n"
+                       "whole module (the flow-insensitive pointer analysis\n"
+                       "starts from the cached points-to sets). The results\n"
+                       "are cached as derived, so that further runs can be\n"
+                       "incremental too (default=false).\n"),
+                       llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<std::string> profileFile("profile",
+        llvm::cl::desc("Dump the wall-clock times, counters and peak memory\n"
+                       "of the analyses as JSON into the given file.\n"),
+                       llvm::cl::value_desc("file"),
+                       llvm::cl::init(""), llvm::cl::cat(SlicingOpts));
+
     llvm::cl::opt<std::string> allocationFuns("allocation-funs",
         llvm::cl::desc("Treat these functions as allocation functions\n"
                        "The argument is a comma-separated list of func:type,\n"
@@ -177,6 +248,12 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit, bool
                        "E.g., myAlloc:malloc will treat myAlloc as malloc.\n"),
                        llvm::cl::cat(SlicingOpts));
 
+    llvm::cl::opt<std::string> modelLibrary("model-library",
+        llvm::cl::desc("Read models of functions and allocation functions\n"
+                       "from the given file (see doc/DDA.md).\n"),
+                       llvm::cl::value_desc("file"),
+                       llvm::cl::init(""), llvm::cl::cat(SlicingOpts));
+
     llvm::cl::opt<LLVMPointerAnalysisOptions::AnalysisType> ptaType("pta",
         llvm::cl::desc("Choose pointer analysis to use:"),
         llvm::cl::values(
@@ -204,6 +281,18 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit, bool
         llvm::cl::init(LLVMDataDependenceAnalysisOptions::AnalysisType::ssa),
                        llvm::cl::cat(SlicingOpts));
 
+    llvm::cl::opt<unsigned> ddaBuildThreads("dda-build-threads",
+        llvm::cl::desc("Build the read-write graph of functions using N threads\n"
+                       "(0 = the number of hardware threads). Default: 1.\n"),
+                       llvm::cl::value_desc("N"), llvm::cl::init(1),
+                       llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<unsigned> interferenceThreads("interference-threads",
+        llvm::cl::desc("Compute the interference dependencies using N threads\n"
+                       "(0 = the number of hardware threads). Default: 1.\n"),
+                       llvm::cl::value_desc("N"), llvm::cl::init(1),
+                       llvm::cl::cat(SlicingOpts));
+
     llvm::cl::opt<dg::ControlDependenceAnalysisOptions::CDAlgorithm> cdAlgorithm("cda",
         llvm::cl::desc("Choose control dependencies algorithm:"),
         llvm::cl::values(
@@ -270,6 +359,7 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit, bool
     options.preservedFunctions = splitList(preservedFuns);
     options.removeSlicingCriteria = removeSlicingCriteria;
     options.forwardSlicing = forwardSlicing;
+    options.profileFile = profileFile;
 
     auto& dgOptions = options.dgOptions;
     auto& PTAOptions = dgOptions.PTAOptions;
@@ -278,6 +368,9 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit, bool
 
     dgOptions.entryFunction = entryFunction;
     dgOptions.threads = threads;
+    dgOptions.interferenceThreads = interferenceThreads;
+    dgOptions.analysisCacheDir = analysisCache;
+    dgOptions.incrementalAnalysis = analysisCacheIncremental;
 
     CDAOptions.algorithm = cdAlgorithm;
     CDAOptions.interprocedural = interprocCd;
@@ -285,15 +378,31 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit, bool
 
     addAllocationFuns(dgOptions, allocationFuns);
 
+    if (!modelLibrary.empty()) {
+        std::string error;
+        if (!dgOptions.readFunctionModels(modelLibrary, error)) {
+            llvm::errs() << "ERROR: Invalid model library: " << error << "\n";
+            exit(1);
+        }
+    }
+
     PTAOptions.entryFunction = entryFunction;
     PTAOptions.fieldSensitivity = dg::Offset(ptaFieldSensitivity);
     PTAOptions.analysisType = ptaType;
     PTAOptions.threads = threads;
+    PTAOptions.contextDepth = ptaContextDepth;
+    PTAOptions.cloneSmallFunctions = ptaCloneSmallFunctions;
+    PTAOptions.maxClonedNodes = ptaMaxClonedNodes;
+    PTAOptions.worklist = ptaWorklist;
+    PTAOptions.demandDriven = ptaDemand;
+    PTAOptions.demandBudget = ptaDemandBudget;
+    PTAOptions.maxObjectFields = ptaMaxObjectFields;
 
     DDAOptions.threads = threads;
     DDAOptions.entryFunction = entryFunction;
     DDAOptions.undefinedFunsBehavior = undefinedFunsBehavior;
     DDAOptions.analysisType = ddaType;
+    DDAOptions.buildThreads = ddaBuildThreads;
 
     return options;
 }
@@ -21,6 +21,7 @@
 #endif
 
 #include "dg/llvm/LLVMDependenceGraphBuilder.h"
+#include "dg/util/Profiling.h"
 
 // CommandLine Category for slicer options
 extern llvm::cl::OptionCategory SlicingOpts;
@@ -46,6 +47,26 @@ struct SlicerOptions {
     std::string secondarySlicingCriteria{};
     std::string inputFile{};
     std::string outputFile{};
+
+    // dump the profiling data of the analyses as JSON into this file
+    std::string profileFile{};
+};
+
+///
+// Dump the data collected by dg::debug::Profiler into the file
+// given by -profile when going out of scope (i.e., on any return from main).
+class ProfileDumper {
+    const std::string _file;
+
+public:
+    ProfileDumper(const SlicerOptions& options) : _file(options.profileFile) {}
+
+    ~ProfileDumper() {
+        if (_file.empty())
+            return;
+        if (!dg::debug::Profiler::get().dumpJSON(_file))
+            llvm::errs() << "Failed writing profiling data to '" << _file << "'\n";
+    }
 };
 
 ///
@@ -16,6 +16,7 @@
 #endif
 
 #include "llvm-slicer.h"
+#include "llvm-slicer-crit.h"
 #include "llvm-slicer-opts.h"
 #include "llvm-slicer-utils.h"
 
@@ -73,6 +74,11 @@ llvm::cl::opt<bool> should_verify_module("dont-verify",
     llvm::cl::desc("Verify sliced module (default=true)."),
     llvm::cl::init(true), llvm::cl::cat(SlicingOpts));
 
+llvm::cl::opt<bool> extract_slice("extract-slice",
+    llvm::cl::desc("Extract the slice into a copy of the module instead of\n"
+                   "slicing the module in place (default=false)."),
+    llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
 llvm::cl::opt<bool> remove_unused_only("remove-unused-only",
     llvm::cl::desc("Only remove unused parts of module (default=false)."),
     llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
@@ -509,23 +515,13 @@ void setupStackTraceOnError(int argc, char *argv[])
 void setupStackTraceOnError(int, char **) {}
 #endif // not USING_SANITIZERS
 
-// defined in llvm-slicer-crit.cpp
-std::set<LLVMNode *> getSlicingCriteriaNodes(LLVMDependenceGraph& dg,
-                                             const std::string& slicingCriteria);
-
-std::pair<std::set<std::string>, std::set<std::string>>
-parseSecondarySlicingCriteria(const std::string& slicingCriteria);
-
-bool findSecondarySlicingCriteria(std::set<LLVMNode *>& criteria_nodes,
-                                  const std::set<std::string>& secondaryControlCriteria,
-                                  const std::set<std::string>& secondaryDataCriteria);
-
 
 int main(int argc, char *argv[])
 {
     setupStackTraceOnError(argc, argv);
 
     SlicerOptions options = parseSlicerOptions(argc, argv, true /* require crit*/);
+    ProfileDumper profileDumper(options);
 
     if (enable_debug) {
         DBG_ENABLE();
@@ -622,6 +618,18 @@ int main(int argc, char *argv[])
             return 0;
     }
 
+    if (extract_slice) {
+        auto sliced = slicer.extract();
+        if (!sliced) {
+            errs() << "ERROR: Extracting the slice failed\n";
+            return 1;
+        }
+
+        maybe_print_statistics(sliced.get(), "Statistics after ");
+        ModuleWriter slicedWriter(options, sliced.get());
+        return slicedWriter.cleanAndSaveModule(should_verify_module);
+    }
+
     // slice the graph
     if (!slicer.slice()) {
         errs() << "ERROR: Slicing failed\n";
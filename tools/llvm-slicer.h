@@ -27,7 +27,7 @@
 
 #include "dg/llvm/LLVMDGAssemblyAnnotationWriter.h"
 #include "llvm-slicer-opts.h"
-#include "TimeMeasure.h"
+#include "dg/util/Profiling.h"
 
 /// --------------------------------------------------------------------
 //   - Slicer class -
@@ -41,6 +41,14 @@
 //  slicer.mark(criteria);
 //  slicer.slice();
 //
+//  To get more slices from one graph, use extract() instead of slice()
+//  (extract() does not modify the module nor the graph):
+//
+//  slicer.mark(criteria1);
+//  auto slice1 = slicer.extract();
+//  slicer.mark(criteria2);
+//  auto slice2 = slicer.extract();
+//
 //  In the case that the slicer is not used for slicing,
 //  but just for building the graph, the user may do the following:
 //
@@ -104,10 +112,20 @@ public:
         _dg = _builder.computeDependencies(std::move(_dg));
         _computed_deps = true;
 
+        if (_builder.usedAnalysisCache())
+            llvm::errs() << "[llvm-slicer] Results of analyses loaded from the cache\n";
+        if (auto *incremental = _builder.getIncrementalAnalysis()) {
+            llvm::errs() << "[llvm-slicer] Re-used the results of "
+                         << incremental->getUnchangedFunctionsNum()
+                         << " unchanged functions ("
+                         << incremental->getChangedFunctions().size()
+                         << " changed)\n";
+        }
+
         const auto& stats = _builder.getStatistics();
-        llvm::errs() << "[llvm-slicer] CPU time of pointer analysis: " << double(stats.ptaTime) / CLOCKS_PER_SEC << " s\n";
-        llvm::errs() << "[llvm-slicer] CPU time of reaching definitions analysis: " << double(stats.rdaTime) / CLOCKS_PER_SEC << " s\n";
-        llvm::errs() << "[llvm-slicer] CPU time of control dependence analysis: " << double(stats.cdaTime) / CLOCKS_PER_SEC << " s\n";
+        llvm::errs() << "[llvm-slicer] Time of pointer analysis: " << stats.ptaTime << " s\n";
+        llvm::errs() << "[llvm-slicer] Time of reaching definitions analysis: " << stats.rdaTime << " s\n";
+        llvm::errs() << "[llvm-slicer] Time of control dependence analysis: " << stats.cdaTime << " s\n";
     }
 
     // Mark the nodes from the slice.
@@ -118,10 +136,9 @@ public:
         assert(_dg && "mark() called without the dependence graph built");
         assert(!criteria_nodes.empty() && "Do not have slicing criteria");
 
-        dg::debug::TimeMeasure tm;
-
-        // compute dependece edges
-        computeDependencies();
+        // compute dependece edges (if this is the first slice)
+        if (!_computed_deps)
+            computeDependencies();
 
         // unmark this set of nodes after marking the relevant ones.
         // Used to mimic the Weissers algorithm
@@ -135,20 +152,24 @@ public:
         for (auto& funcName : _options.preservedFunctions)
             slicer.keepFunctionUntouched(funcName.c_str());
 
-        slice_id = 0xdead;
+        // get a new slice id from the slicer, so that the nodes
+        // marked by the previous calls of mark() are not in this slice
+        slice_id = 0;
 
-        tm.start();
-        for (dg::LLVMNode *start : criteria_nodes)
-            slice_id = slicer.mark(start, slice_id, _options.forwardSlicing);
+        double time;
+        {
+            dg::debug::ScopedTimer timer("slicer.mark", &time);
+            for (dg::LLVMNode *start : criteria_nodes)
+                slice_id = slicer.mark(start, slice_id, _options.forwardSlicing);
 
-        assert(slice_id != 0 && "Somethig went wrong when marking nodes");
+            assert(slice_id != 0 && "Somethig went wrong when marking nodes");
 
-        // if we have some nodes in the unmark set, unmark them
-        for (dg::LLVMNode *nd : unmark)
-            nd->setSlice(0);
+            // if we have some nodes in the unmark set, unmark them
+            for (dg::LLVMNode *nd : unmark)
+                nd->setSlice(0);
+        }
 
-        tm.stop();
-        tm.report("[llvm-slicer] Finding dependent nodes took");
+        llvm::errs() << "[llvm-slicer] Finding dependent nodes took " << time << " s\n";
 
         return true;
     }
@@ -158,13 +179,13 @@ public:
         assert(_dg && "Must run buildDG() and computeDependencies()");
         assert(slice_id != 0 && "Must run mark() method before slice()");
 
-        dg::debug::TimeMeasure tm;
-
-        tm.start();
-        slicer.slice(_dg.get(), nullptr, slice_id);
+        double time;
+        {
+            dg::debug::ScopedTimer timer("slicer.slice", &time);
+            slicer.slice(_dg.get(), nullptr, slice_id);
+        }
 
-        tm.stop();
-        tm.report("[llvm-slicer] Slicing dependence graph took");
+        llvm::errs() << "[llvm-slicer] Slicing dependence graph took " << time << " s\n";
 
         dg::SlicerStatistics& st = slicer.getStatistics();
         llvm::errs() << "[llvm-slicer] Sliced away " << st.nodesRemoved
@@ -173,6 +194,32 @@ public:
         return true;
     }
 
+    // Extract the marked nodes into a new module. Unlike slice(),
+    // this method leaves the module and the dependence graph untouched,
+    // so more slices can be extracted by calling mark() and extract()
+    // repeatedly.
+    std::unique_ptr<llvm::Module> extract()
+    {
+        assert(_dg && "Must run buildDG() and computeDependencies()");
+        assert(slice_id != 0 && "Must run mark() method before extract()");
+
+        double time;
+        std::unique_ptr<llvm::Module> sliced;
+        {
+            dg::debug::ScopedTimer timer("slicer.extract", &time);
+            slicer.getStatistics() = dg::SlicerStatistics();
+            sliced = slicer.extract(M, slice_id);
+        }
+
+        llvm::errs() << "[llvm-slicer] Extracting the slice took " << time << " s\n";
+
+        dg::SlicerStatistics& st = slicer.getStatistics();
+        llvm::errs() << "[llvm-slicer] Sliced away " << st.nodesRemoved
+                     << " from " << st.nodesTotal << " nodes in DG\n";
+
+        return sliced;
+    }
+
     ///
     // Create new empty main in the module. If 'call_entry' is set to true,
     // then call the entry function from the new main (if entry is not main),
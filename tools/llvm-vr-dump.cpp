@@ -42,6 +42,7 @@
 
 #undef NDEBUG // we need dump methods
 #include "dg/llvm/ValueRelations/ValueRelations.h"
+#include "dg/llvm/ValueRelations/ValueRelationsDriver.h"
 #include "dg/llvm/ValueRelations/getValName.h"
 
 #include "TimeMeasure.h"
@@ -60,6 +61,25 @@ llvm::cl::opt<bool> todot("dot",
 llvm::cl::opt<unsigned> max_iter("max-iter",
     llvm::cl::desc("Maximal number of iterations"), llvm::cl::init(0));
 
+llvm::cl::opt<unsigned> widen_after("widen-after",
+    llvm::cl::desc("Drop the reads whose value changes after this number of\n"
+                   "visits of a location (0 = never, default 10)"),
+    llvm::cl::init(10));
+
+llvm::cl::opt<bool> per_function("per-function",
+    llvm::cl::desc("Analyze every function separately (the relations from\n"
+                   "call-sites are not passed into the called functions)"),
+    llvm::cl::init(false));
+
+llvm::cl::opt<unsigned> threads("threads",
+    llvm::cl::desc("The number of threads for -per-function\n"
+                   "(0 = the number of hardware threads, default 1)"),
+    llvm::cl::init(1));
+
+llvm::cl::opt<std::string> function("function",
+    llvm::cl::desc("Analyze only the given function (implies -per-function)"),
+    llvm::cl::init(""));
+
 llvm::cl::opt<std::string> inputFile(llvm::cl::Positional, llvm::cl::Required,
     llvm::cl::desc("<input file>"), llvm::cl::init(""));
 
@@ -90,15 +110,37 @@ int main(int argc, char *argv[])
         return 1;
     }
 
-    dg::debug::TimeMeasure tm;
+    const llvm::Function *onlyFunction = nullptr;
+    if (!function.empty()) {
+        onlyFunction = M->getFunction(function);
+        if (!onlyFunction || onlyFunction->isDeclaration()) {
+            llvm::errs() << "Did not find the definition of '" << function << "'\n";
+            return 1;
+        }
+    }
 
+    dg::debug::TimeMeasure tm;
 
     LLVMValueRelations VR(M);
+    LLVMValueRelationsDriver driver(M, max_iter, widen_after);
+    // the analyses whose results we dump
+    std::vector<LLVMValueRelations *> results;
 
     tm.start();
 
-    VR.build();
-    VR.compute(max_iter);
+    if (onlyFunction) {
+        results.push_back(driver.getOrCompute(onlyFunction));
+    } else if (per_function) {
+        driver.computeAll(threads);
+        for (auto& F : *M) {
+            if (!F.isDeclaration())
+                results.push_back(driver.getOrCompute(&F));
+        }
+    } else {
+        VR.build();
+        VR.compute(max_iter, 3, widen_after);
+        results.push_back(&VR);
+    }
 
     tm.stop();
     tm.report("INFO: Value Relations analysis took");
@@ -106,31 +148,43 @@ int main(int argc, char *argv[])
     std::cout << std::endl;
 
     if (todot) {
+        // the ids of locations are unique only in one analysis
+        auto nodeName = [&results](unsigned r, const VRLocation *loc) {
+            std::string name = "NODE";
+            if (results.size() > 1)
+                name += std::to_string(r) + "_";
+            return name + std::to_string(loc->id);
+        };
+
         std::cout << "digraph VR {\n";
-        for (const auto& block : VR.getBlocks()) {
-            for (const auto& loc : block.second->locations) {
-                std::cout << "  NODE" << loc->id;
-                std::cout << "[label=\"";
-                std::cout << "\\n";
-                loc->dump();
-                std::cout << "\\n------ REL ------\\n";
-                loc->relations.dump();
-                std::cout << "\\n------ EQ ------\\n";
-                loc->equalities.dump();
-                std::cout << "\\n----- READS -----\\n";
-                loc->reads.dump();
-                std::cout << "\"];\n";
+        for (unsigned r = 0; r < results.size(); ++r) {
+            for (const auto& block : results[r]->getBlocks()) {
+                for (const auto& loc : block.second->locations) {
+                    std::cout << "  " << nodeName(r, loc.get());
+                    std::cout << "[label=\"";
+                    std::cout << "\\n";
+                    loc->dump();
+                    std::cout << "\\n------ REL ------\\n";
+                    loc->relations.dump();
+                    std::cout << "\\n------ EQ ------\\n";
+                    loc->equalities.dump();
+                    std::cout << "\\n----- READS -----\\n";
+                    loc->reads.dump();
+                    std::cout << "\"];\n";
+                }
             }
         }
 
-        for (const auto& block : VR.getBlocks()) {
-            for (const auto& loc : block.second->locations) {
-                for (const auto& succ : loc->successors) {
-                    std::cout << "  NODE" << loc->id
-                              << " -> NODE" << succ->target->id
-                              << " [label=\"";
-                    succ->op->dump();
-                    std::cout << "\"];\n";
+        for (unsigned r = 0; r < results.size(); ++r) {
+            for (const auto& block : results[r]->getBlocks()) {
+                for (const auto& loc : block.second->locations) {
+                    for (const auto& succ : loc->successors) {
+                        std::cout << "  " << nodeName(r, loc.get())
+                                  << " -> " << nodeName(r, succ->target)
+                                  << " [label=\"";
+                        succ->op->dump();
+                        std::cout << "\"];\n";
+                    }
                 }
             }
         }
@@ -138,9 +192,13 @@ int main(int argc, char *argv[])
         std::cout << "}\n";
     } else {
         for (auto& F : *M) {
+            if (F.isDeclaration() || (onlyFunction && onlyFunction != &F))
+                continue;
+
+            auto *R = (per_function || onlyFunction) ? driver.getOrCompute(&F) : &VR;
             for (auto& B : F) {
                 for (auto& I : B) {
-                    auto loc = VR.getMapping(&I);
+                    auto loc = R->getMapping(&I);
                     if (!loc)
                         continue;
 